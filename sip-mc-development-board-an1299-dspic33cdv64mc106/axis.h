@@ -0,0 +1,176 @@
+/*******************************************************************************
+* Copyright (c) 2017 released Microchip Technology Inc.  All rights reserved.
+*
+* SOFTWARE LICENSE AGREEMENT:
+* 
+* Microchip Technology Incorporated ("Microchip") retains all ownership and
+* intellectual property rights in the code accompanying this message and in all
+* derivatives hereto.  You may use this code, and any derivatives created by
+* any person or entity by or on your behalf, exclusively with Microchip's
+* proprietary products.  Your acceptance and/or use of this code constitutes
+* agreement to the terms and conditions of this notice.
+*
+* CODE ACCOMPANYING THIS MESSAGE IS SUPPLIED BY MICROCHIP "AS IS".  NO
+* WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
+* TO, IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE APPLY TO THIS CODE, ITS INTERACTION WITH MICROCHIP'S
+* PRODUCTS, COMBINATION WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION.
+*
+* YOU ACKNOWLEDGE AND AGREE THAT, IN NO EVENT, SHALL MICROCHIP BE LIABLE,
+* WHETHER IN CONTRACT, WARRANTY, TORT (INCLUDING NEGLIGENCE OR BREACH OF
+* STATUTORY DUTY),STRICT LIABILITY, INDEMNITY, CONTRIBUTION, OR OTHERWISE,
+* FOR ANY INDIRECT, SPECIAL,PUNITIVE, EXEMPLARY, INCIDENTAL OR CONSEQUENTIAL
+* LOSS, DAMAGE, FOR COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE CODE,
+* HOWSOEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE POSSIBILITY OR
+* THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT ALLOWABLE BY LAW,
+* MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY RELATED TO THIS CODE,
+* SHALL NOT EXCEED THE PRICE YOU PAID DIRECTLY TO MICROCHIP SPECIFICALLY TO
+* HAVE THIS CODE DEVELOPED.
+*
+* You agree that you are solely responsible for testing the code and
+* determining its suitability.  Microchip has no obligation to modify, test,
+* certify, or support the code.
+*
+*******************************************************************************/
+
+#ifndef __AXIS_H
+#define __AXIS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "motor_control_noinline.h"
+#include "userparms.h"
+#include "control.h"
+#include "estim.h"
+#include "fdweak.h"
+#include "overmod.h"
+#include "deadbeat.h"
+#include "mechid.h"
+#include "profile.h"
+#include "cogging.h"
+#include "dpwm.h"
+#include "dcbus.h"
+#include "meter.h"
+#include "i2t.h"
+#include "stall.h"
+#include "snapshot.h"
+#include "flashlog.h"
+#include "singleshunt.h"
+#include "measure.h"
+
+#if (defined(CURRENT_DECOUPLING) || defined(BEMF_FEED_FORWARD)) && \
+    !defined(DEADBEAT_CURRENT_CONTROL)
+    #define VOLTAGE_FEED_FORWARD
+#endif
+#if defined(MOSFET_TEMPERATURE_DERATING) || defined(I2T_PROTECTION)
+    #define IQ_LIMIT_DERATING
+#endif
+
+/* Motor Axis data type
+
+  Description:
+    This structure will host the control state of one motor and inverter.
+    The control functions operate on the axis passed to them, so more 
+    motors can be driven from the same interrupt schedule with one instance
+    per inverter. Only the PWM and ADC access of the interrupt routines is 
+    specific to an inverter.
+ */
+typedef struct
+{
+    /* Application flags */
+    volatile UGF_T uGF;
+    /* Application control */
+    CTRL_PARM_T ctrlParm;
+    MOTOR_STARTUP_DATA_T motorStartUpData;
+    /* Angle and speed estimator */
+    ESTIM_PARM_T estimator;
+    MOTOR_ESTIM_PARM_T motorParm;
+    MC_ALPHABETA_T bemfAlphaBeta;
+    /* Field weakening */
+    FDWEAK_PARM_T fdWeakParm;
+    /* Current and speed controllers */
+    MC_PIPARMIN_T piInputId;
+    MC_PIPARMOUT_T piOutputId;
+    MC_PIPARMIN_T piInputIq;
+    MC_PIPARMOUT_T piOutputIq;
+    MC_PIPARMIN_T piInputOmega;
+    MC_PIPARMOUT_T piOutputOmega;
+    /* Transforms */
+    MC_ABC_T iabc;
+    MC_ALPHABETA_T ialphabeta;
+    MC_DQ_T idq;
+    /* Voltages shifted right by VOLTAGE_SCALE_SHIFT */
+    MC_DQ_T vdq;
+    MC_ALPHABETA_T valphabeta;
+    MC_ABC_T vabc;
+    MC_SINCOS_T sincosTheta;
+    int16_t thetaElectrical;
+    int16_t thetaElectricalOpenLoop;
+    /* Space vector modulation */
+    uint16_t pwmPeriod;
+    MC_DUTYCYCLEOUT_T pwmDutycycle;
+    SINGLE_SHUNT_PARM_T singleShuntParam;
+    /* Current, DC bus voltage and potentiometer measurement */
+    MCAPP_MEASURE_T measureInputs;
+#ifdef VOLTAGE_FEED_FORWARD
+    /* Feed forward voltage added to the current PI outputs */
+    MC_DQ_T vdqFeedForward;
+#endif
+#if defined(VOLTAGE_FEED_FORWARD) || defined(DEADBEAT_CURRENT_CONTROL) || \
+    defined(DOUBLE_UPDATE)
+    /* Electrical speed to omega*Ts scaling for the loop time of the axis,
+       OMEGA_TS_SCALE (pmsm.c) */
+    int16_t omegaTsScale;
+#endif
+#ifdef OVERMODULATION
+    OVERMOD_PARM_T overmodParm;
+#endif
+#ifdef DEADBEAT_CURRENT_CONTROL
+    DEADBEAT_PARM_T deadbeatParm;
+#endif
+#ifdef MECHANICAL_IDENTIFICATION
+    MECHID_PARM_T mechIdParm;
+#endif
+#ifdef SPEED_PROFILE_SCURVE
+    SPEED_PROFILE_T speedProfile;
+#endif
+#ifdef COGGING_COMPENSATION
+    COGGING_PARM_T coggingParm;
+#endif
+#ifdef DISCONTINUOUS_PWM
+    DPWM_PARM_T dpwmParm;
+#endif
+#ifdef DOUBLE_UPDATE
+    DOUBLE_UPDATE_T doubleUpdate;
+#endif
+#ifdef DC_BUS_COMPENSATION
+    DCBUS_COMP_T dcBusComp;
+#endif
+#ifdef POWER_METERING
+    METER_T meter;
+#endif
+#ifdef I2T_PROTECTION
+    I2T_PARM_T i2tParm;
+#endif
+#ifdef STALL_DETECTION
+    STALL_PARM_T stallParm;
+#endif
+#ifdef FAULT_SNAPSHOT
+    SNAPSHOT_T snapshot;
+#endif
+#ifdef FLASH_FAULT_LOG
+    FLASHLOG_T flashLog;
+#endif
+} MOTOR_AXIS_T;
+
+/* Motor driven through Inverter A */
+extern MOTOR_AXIS_T axisA;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __AXIS_H */
@@ -0,0 +1,127 @@
+/*******************************************************************************
+ * Copyright (c) 2017 released Microchip Technology Inc.  All rights reserved.
+ *
+ * SOFTWARE LICENSE AGREEMENT:
+ *
+ * Microchip Technology Incorporated ("Microchip") retains all ownership and
+ * intellectual property rights in the code accompanying this message and in all
+ * derivatives hereto.  You may use this code, and any derivatives created by
+ * any person or entity by or on your behalf, exclusively with Microchip's
+ * proprietary products.  Your acceptance and/or use of this code constitutes
+ * agreement to the terms and conditions of this notice.
+ *
+ * CODE ACCOMPANYING THIS MESSAGE IS SUPPLIED BY MICROCHIP "AS IS".  NO
+ * WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
+ * TO, IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE APPLY TO THIS CODE, ITS INTERACTION WITH MICROCHIP'S
+ * PRODUCTS, COMBINATION WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION.
+ *
+ * YOU ACKNOWLEDGE AND AGREE THAT, IN NO EVENT, SHALL MICROCHIP BE LIABLE,
+ * WHETHER IN CONTRACT, WARRANTY, TORT (INCLUDING NEGLIGENCE OR BREACH OF
+ * STATUTORY DUTY),STRICT LIABILITY, INDEMNITY, CONTRIBUTION, OR OTHERWISE,
+ * FOR ANY INDIRECT, SPECIAL,PUNITIVE, EXEMPLARY, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, FOR COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE CODE,
+ * HOWSOEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE POSSIBILITY OR
+ * THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT ALLOWABLE BY LAW,
+ * MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY RELATED TO THIS CODE,
+ * SHALL NOT EXCEED THE PRICE YOU PAID DIRECTLY TO MICROCHIP SPECIFICALLY TO
+ * HAVE THIS CODE DEVELOPED.
+ *
+ * You agree that you are solely responsible for testing the code and
+ * determining its suitability.  Microchip has no obligation to modify, test,
+ * certify, or support the code.
+ *
+ *******************************************************************************/
+#include <stdint.h>
+#include "cicfilter.h"
+
+// *****************************************************************************
+/* Function:
+    CicFilterInitialize()
+
+  Summary:
+    Initializes a CIC decimation filter
+
+  Description:
+    Clears the integrators and the comb delays and sets the decimation.
+
+  Precondition:
+    None.
+
+  Parameters:
+    pFilter        - CIC filter data
+    decimationBits - Decimation 2^decimationBits, at most 
+                     CIC_DECIMATION_BITS_MAX
+
+  Returns:
+    None.
+
+  Remarks:
+    The first output after the initialization is the average of a partly 
+    filled window, the output settles after the second output.
+ */
+void CicFilterInitialize(CIC_FILTER_T *pFilter,uint16_t decimationBits)
+{
+    pFilter->integrator1 = 0;
+    pFilter->integrator2 = 0;
+    pFilter->comb1Delay = 0;
+    pFilter->comb2Delay = 0;
+    pFilter->counter = 0;
+    if (decimationBits > CIC_DECIMATION_BITS_MAX)
+    {
+        decimationBits = CIC_DECIMATION_BITS_MAX;
+    }
+    pFilter->decimationBits = decimationBits;
+    pFilter->output = 0;
+}
+// *****************************************************************************
+/* Function:
+    CicFilterStep()
+
+  Summary:
+    Filters one input sample
+
+  Description:
+    The sample is added to the two integrators. Every 2^decimationBits 
+    samples the combs are executed and the output is divided by the filter
+    gain. The response is a triangular weighted average over two 
+    decimation periods, with zeros of the frequency response at multiples 
+    of the output rate.
+
+  Precondition:
+    None.
+
+  Parameters:
+    pFilter - CIC filter data
+    input   - Input sample
+
+  Returns:
+    1 when the output is updated, 0 otherwise.
+
+  Remarks:
+    The wrap around of the integrators is cancelled by the combs, unsigned
+    arithmetic is used so the wrap around is defined.
+ */
+uint16_t CicFilterStep(CIC_FILTER_T *pFilter,int16_t input)
+{
+    uint32_t comb1,comb2;
+    
+    pFilter->integrator1 += (uint32_t)(int32_t)input;
+    pFilter->integrator2 += pFilter->integrator1;
+    
+    pFilter->counter++;
+    if (pFilter->counter < (1u << pFilter->decimationBits))
+    {
+        return 0;
+    }
+    pFilter->counter = 0;
+    
+    comb1 = pFilter->integrator2 - pFilter->comb1Delay;
+    pFilter->comb1Delay = pFilter->integrator2;
+    comb2 = comb1 - pFilter->comb2Delay;
+    pFilter->comb2Delay = comb1;
+    
+    pFilter->output = (int16_t)((int32_t)comb2 >> 
+                                (pFilter->decimationBits << 1));
+    return 1;
+}
@@ -0,0 +1,78 @@
+/*******************************************************************************
+* Copyright (c) 2017 released Microchip Technology Inc.  All rights reserved.
+*
+* SOFTWARE LICENSE AGREEMENT:
+* 
+* Microchip Technology Incorporated ("Microchip") retains all ownership and
+* intellectual property rights in the code accompanying this message and in all
+* derivatives hereto.  You may use this code, and any derivatives created by
+* any person or entity by or on your behalf, exclusively with Microchip's
+* proprietary products.  Your acceptance and/or use of this code constitutes
+* agreement to the terms and conditions of this notice.
+*
+* CODE ACCOMPANYING THIS MESSAGE IS SUPPLIED BY MICROCHIP "AS IS".  NO
+* WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
+* TO, IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE APPLY TO THIS CODE, ITS INTERACTION WITH MICROCHIP'S
+* PRODUCTS, COMBINATION WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION.
+*
+* YOU ACKNOWLEDGE AND AGREE THAT, IN NO EVENT, SHALL MICROCHIP BE LIABLE,
+* WHETHER IN CONTRACT, WARRANTY, TORT (INCLUDING NEGLIGENCE OR BREACH OF
+* STATUTORY DUTY),STRICT LIABILITY, INDEMNITY, CONTRIBUTION, OR OTHERWISE,
+* FOR ANY INDIRECT, SPECIAL,PUNITIVE, EXEMPLARY, INCIDENTAL OR CONSEQUENTIAL
+* LOSS, DAMAGE, FOR COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE CODE,
+* HOWSOEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE POSSIBILITY OR
+* THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT ALLOWABLE BY LAW,
+* MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY RELATED TO THIS CODE,
+* SHALL NOT EXCEED THE PRICE YOU PAID DIRECTLY TO MICROCHIP SPECIFICALLY TO
+* HAVE THIS CODE DEVELOPED.
+*
+* You agree that you are solely responsible for testing the code and
+* determining its suitability.  Microchip has no obligation to modify, test,
+* certify, or support the code.
+*
+*******************************************************************************/
+#ifndef __CICFILTER_H
+#define __CICFILTER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/* Maximum decimation 2^CIC_DECIMATION_BITS_MAX, the gain of the filter 
+   (2^(2*decimationBits)) times the Q15 input has to stay within 32 bits */
+#define CIC_DECIMATION_BITS_MAX     8
+    
+/* CIC Filter data type
+
+  Description:
+    This structure will host the state of a second order CIC (cascaded 
+    integrator comb) decimation filter. The integrators run at the input 
+    rate and wrap around, the combs run at the output rate.
+ */
+typedef struct
+{
+    /* Integrators, modulo 2^32 */
+    uint32_t integrator1;
+    uint32_t integrator2;
+    /* Comb delays */
+    uint32_t comb1Delay;
+    uint32_t comb2Delay;
+    /* Input samples since the last output */
+    uint16_t counter;
+    /* Decimation 2^decimationBits */
+    uint16_t decimationBits;
+    /* Filtered value, updated every 2^decimationBits input samples */
+    int16_t output;
+} CIC_FILTER_T;
+
+void CicFilterInitialize(CIC_FILTER_T *,uint16_t);
+uint16_t CicFilterStep(CIC_FILTER_T *,int16_t);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __CICFILTER_H */
@@ -0,0 +1,227 @@
+/*******************************************************************************
+ * Copyright (c) 2017 released Microchip Technology Inc.  All rights reserved.
+ *
+ * SOFTWARE LICENSE AGREEMENT:
+ *
+ * Microchip Technology Incorporated ("Microchip") retains all ownership and
+ * intellectual property rights in the code accompanying this message and in all
+ * derivatives hereto.  You may use this code, and any derivatives created by
+ * any person or entity by or on your behalf, exclusively with Microchip's
+ * proprietary products.  Your acceptance and/or use of this code constitutes
+ * agreement to the terms and conditions of this notice.
+ *
+ * CODE ACCOMPANYING THIS MESSAGE IS SUPPLIED BY MICROCHIP "AS IS".  NO
+ * WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
+ * TO, IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE APPLY TO THIS CODE, ITS INTERACTION WITH MICROCHIP'S
+ * PRODUCTS, COMBINATION WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION.
+ *
+ * YOU ACKNOWLEDGE AND AGREE THAT, IN NO EVENT, SHALL MICROCHIP BE LIABLE,
+ * WHETHER IN CONTRACT, WARRANTY, TORT (INCLUDING NEGLIGENCE OR BREACH OF
+ * STATUTORY DUTY),STRICT LIABILITY, INDEMNITY, CONTRIBUTION, OR OTHERWISE,
+ * FOR ANY INDIRECT, SPECIAL,PUNITIVE, EXEMPLARY, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, FOR COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE CODE,
+ * HOWSOEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE POSSIBILITY OR
+ * THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT ALLOWABLE BY LAW,
+ * MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY RELATED TO THIS CODE,
+ * SHALL NOT EXCEED THE PRICE YOU PAID DIRECTLY TO MICROCHIP SPECIFICALLY TO
+ * HAVE THIS CODE DEVELOPED.
+ *
+ * You agree that you are solely responsible for testing the code and
+ * determining its suitability.  Microchip has no obligation to modify, test,
+ * certify, or support the code.
+ *
+ *******************************************************************************/
+#include "cogging.h"
+#include "userparms.h"
+#include "general.h"
+#include "pwm.h"
+
+// *****************************************************************************
+/* Function:
+    CoggingInitialize()
+
+  Summary:
+    Initializes the cogging compensation
+
+  Description:
+    Loads the learning parameters and resets the mean filter. The learned
+    table is kept, CoggingClearTable() starts the learning from zero.
+
+  Precondition:
+    PWM timing calculated for the loop time.
+
+  Parameters:
+    pParm - Cogging compensation data
+
+  Returns:
+    None.
+
+  Remarks:
+    None.
+ */
+void CoggingInitialize(COGGING_PARM_T *pParm)
+{
+    pParm->learn = 1;
+    pParm->learnGain = COGGING_LEARN_GAIN;
+    /* Learning interval kept constant in time when the loop time changes */
+    pParm->learnDivider = PWMScaleLoopFrequency(COGGING_LEARN_DIVIDER);
+    if (pParm->learnDivider == 0)
+    {
+        pParm->learnDivider = 1;
+    }
+    pParm->learnCount = 0;
+    pParm->meanStateVar = 0;
+    pParm->qMean = 0;
+    pParm->qCompensation = 0;
+}
+// *****************************************************************************
+/* Function:
+    CoggingClearTable()
+
+  Summary:
+    Clears the learned compensation table
+
+  Description:
+    Clears the learned compensation table
+
+  Precondition:
+    None.
+
+  Parameters:
+    pParm - Cogging compensation data
+
+  Returns:
+    None.
+
+  Remarks:
+    None.
+ */
+void CoggingClearTable(COGGING_PARM_T *pParm)
+{
+    uint16_t i;
+
+    for (i = 0; i < COGGING_TABLE_SIZE; i++)
+    {
+        pParm->table[i] = 0;
+    }
+}
+// *****************************************************************************
+/* Function:
+    CoggingCompensation()
+
+  Summary:
+    Adds the learned correction to the q current reference
+
+  Description:
+    Table lookup with the electrical angle, executed every cycle.
+
+  Precondition:
+    None.
+
+  Parameters:
+    pParm - Cogging compensation data
+    angle - Electrical angle (estimator.qRho)
+    iqRef - q current reference from the speed controller
+
+  Returns:
+    Compensated q current reference, limited to SPEEDCNTR_OUTMAX.
+
+  Remarks:
+    None.
+ */
+int16_t CoggingCompensation(COGGING_PARM_T *pParm,int16_t angle,int16_t iqRef)
+{
+    int32_t reference;
+
+    pParm->qCompensation = 
+                pParm->table[(uint16_t)angle >> COGGING_INDEX_SHIFT];
+    reference = (int32_t)iqRef + pParm->qCompensation;
+    if (reference > SPEEDCNTR_OUTMAX)
+    {
+        reference = SPEEDCNTR_OUTMAX;
+    }
+    else if (reference < -SPEEDCNTR_OUTMAX)
+    {
+        reference = -SPEEDCNTR_OUTMAX;
+    }
+    return (int16_t)reference;
+}
+// *****************************************************************************
+/* Function:
+    CoggingLearn()
+
+  Summary:
+    Learns the torque ripple correction
+
+  Description:
+    Executed every COGGING_LEARN_DIVIDER calls, scaled to the loop time, 
+    learnCount = 0 restarts the learning intervals. The speed change over the 
+    learning interval is proportional to the torque not compensated at the
+    angles of the interval (J*dw/dt), in phase with the torque ripple. Its deviation
+    from the mean (acceleration of the speed reference) is learned:
+        table[angle] -= LearnGain * (dw - mean(dw))
+    As the table takes over the ripple, the speed ripple and the learning 
+    go to zero. The values are limited to COGGING_TABLE_LIMIT.
+
+  Precondition:
+    None.
+
+  Parameters:
+    pParm - Cogging compensation data
+    angle - Electrical angle (estimator.qRho)
+    speed - Estimated speed (estimator.qVelEstim)
+
+  Returns:
+    None.
+
+  Remarks:
+    None.
+ */
+void CoggingLearn(COGGING_PARM_T *pParm,int16_t angle,int16_t speed)
+{
+    int16_t *pBin;
+    int16_t speedChange,deviation,midAngle;
+    int32_t value;
+
+    if (pParm->learn == 0)
+    {
+        return;
+    }
+    if (pParm->learnCount == 0)
+    {
+        /* (Re)start of the learning, first interval begins */
+        pParm->previousSpeed = speed;
+        pParm->previousAngle = angle;
+        pParm->learnCount = 1;
+        return;
+    }
+    if (++pParm->learnCount <= pParm->learnDivider)
+    {
+        return;
+    }
+    pParm->learnCount = 1;
+
+    speedChange = speed - pParm->previousSpeed;
+    pParm->previousSpeed = speed;
+    /* The speed change is assigned to the middle of the interval */
+    midAngle = pParm->previousAngle + ((int16_t)(angle - 
+                                        pParm->previousAngle) >> 1);
+    pParm->previousAngle = angle;
+    /* Mean speed change, first order filter */
+    deviation = speedChange - pParm->qMean;
+    pParm->meanStateVar += __builtin_mulss(deviation,COGGING_MEAN_FILTER);
+    pParm->qMean = (int16_t)((pParm->meanStateVar + 0x4000) >> 15);
+
+    pBin = &pParm->table[(uint16_t)midAngle >> COGGING_INDEX_SHIFT];
+    value = (int32_t)*pBin - __builtin_mulss(deviation,pParm->learnGain);
+    if (value > COGGING_TABLE_LIMIT)
+    {
+        value = COGGING_TABLE_LIMIT;
+    }
+    else if (value < -COGGING_TABLE_LIMIT)
+    {
+        value = -COGGING_TABLE_LIMIT;
+    }
+    *pBin = (int16_t)value;
+}
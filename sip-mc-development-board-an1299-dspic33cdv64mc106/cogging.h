@@ -0,0 +1,87 @@
+/*******************************************************************************
+* Copyright (c) 2017 released Microchip Technology Inc.  All rights reserved.
+*
+* SOFTWARE LICENSE AGREEMENT:
+* 
+* Microchip Technology Incorporated ("Microchip") retains all ownership and
+* intellectual property rights in the code accompanying this message and in all
+* derivatives hereto.  You may use this code, and any derivatives created by
+* any person or entity by or on your behalf, exclusively with Microchip's
+* proprietary products.  Your acceptance and/or use of this code constitutes
+* agreement to the terms and conditions of this notice.
+*
+* CODE ACCOMPANYING THIS MESSAGE IS SUPPLIED BY MICROCHIP "AS IS".  NO
+* WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
+* TO, IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE APPLY TO THIS CODE, ITS INTERACTION WITH MICROCHIP'S
+* PRODUCTS, COMBINATION WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION.
+*
+* YOU ACKNOWLEDGE AND AGREE THAT, IN NO EVENT, SHALL MICROCHIP BE LIABLE,
+* WHETHER IN CONTRACT, WARRANTY, TORT (INCLUDING NEGLIGENCE OR BREACH OF
+* STATUTORY DUTY),STRICT LIABILITY, INDEMNITY, CONTRIBUTION, OR OTHERWISE,
+* FOR ANY INDIRECT, SPECIAL,PUNITIVE, EXEMPLARY, INCIDENTAL OR CONSEQUENTIAL
+* LOSS, DAMAGE, FOR COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE CODE,
+* HOWSOEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE POSSIBILITY OR
+* THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT ALLOWABLE BY LAW,
+* MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY RELATED TO THIS CODE,
+* SHALL NOT EXCEED THE PRICE YOU PAID DIRECTLY TO MICROCHIP SPECIFICALLY TO
+* HAVE THIS CODE DEVELOPED.
+*
+* You agree that you are solely responsible for testing the code and
+* determining its suitability.  Microchip has no obligation to modify, test,
+* certify, or support the code.
+*
+*******************************************************************************/
+#ifndef __COGGING_H
+#define __COGGING_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/* Number of angle bins over one electrical revolution, power of 2 */
+#define COGGING_TABLE_SIZE      256
+/* Electrical angle (estimator.qRho) to bin index shift */
+#define COGGING_INDEX_SHIFT     8
+
+/* Cogging Compensation Parameter data type
+
+  Description:
+    This structure will host parameters related to the angle indexed torque
+    ripple and cogging compensation. Table values are q axis currents 
+    normalized as ctrlParm.qVqRef.
+ */
+typedef struct
+{
+    /* Learned q current correction for each angle bin */
+    int16_t table[COGGING_TABLE_SIZE];
+    /* Learning enabled when not 0 */
+    uint16_t learn;
+    /* Learning gain - current per speed change */
+    int16_t learnGain;
+    /* COGGING_LEARN_DIVIDER scaled to the loop time */
+    uint16_t learnDivider;
+    /* Learning decimation counter, 0 restarts the learning intervals */
+    uint16_t learnCount;
+    /* Speed and angle at the last learning update */
+    int16_t previousSpeed;
+    int16_t previousAngle;
+    /* Mean speed change per learning update (filter state and output) */
+    int32_t meanStateVar;
+    int16_t qMean;
+    /* Correction applied in the last cycle */
+    int16_t qCompensation;
+} COGGING_PARM_T;
+
+void CoggingInitialize(COGGING_PARM_T *);
+void CoggingClearTable(COGGING_PARM_T *);
+int16_t CoggingCompensation(COGGING_PARM_T *,int16_t,int16_t);
+void CoggingLearn(COGGING_PARM_T *,int16_t,int16_t);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __COGGING_H */
@@ -64,7 +64,40 @@ typedef struct
     int16_t  targetSpeed;
     /* The Speed Control Loop will be executed only every speedRampCount*/
     int16_t   speedRampCount;  
+    /* Current sensing mode in use - CURRENT_SENSING_SINGLE_SHUNT or
+       CURRENT_SENSING_DUAL_SHUNT */
+    uint16_t  currentSensing;
+    /* Requested current sensing mode, applied while the motor is stopped */
+    uint16_t  currentSensingRequest;
+    /* Speed reference is updated when speedRampCount reaches this limit */
+    int16_t   speedRampCountLimit;
+    /* Requested PWM frequency (loop time) in Hertz, applied while the motor 
+       is stopped */
+    uint16_t  pwmFrequencyRequest;
+    /* q current limit, SPEEDCNTR_OUTMAX reduced by the thermal derating 
+       and the I2t protection */
+    int16_t   qIqLimit;
+    /* q current limit of the MOSFET temperature derating */
+    int16_t   qIqLimitTemperature;
 } CTRL_PARM_T;
+/* Double Update data type
+
+  Description:
+    This structure will host parameters related to the PWM peak control 
+    step of the double update mode.
+ */
+typedef struct
+{
+    /* Peak step enabled, cleared when the control steps do not complete
+       within their half cycle */
+    uint16_t active;
+    /* Number of control steps that did not complete within their half 
+       cycle */
+    uint16_t overrunCount;
+    /* d-q voltage calculated at the peak, applied in the first half cycle */
+    int16_t  qVdPeak;
+    int16_t  qVqPeak;
+} DOUBLE_UPDATE_T;
 /* Motor Parameter data type
 
   Description:
@@ -79,6 +112,11 @@ typedef struct
     /* Start up ramp increment */
     uint16_t tuningAddRampup;	
     uint16_t tuningDelayRampup;
+    /* LOCK_TIME, END_SPEED and OPENLOOP_RAMPSPEED_INCREASERATE scaled to 
+       the run time loop time */
+    uint16_t lockTime;
+    uint32_t endSpeed;
+    uint16_t rampIncreaseRate;
 } MOTOR_STARTUP_DATA_T;
 
 /* General system flag data type
@@ -104,15 +142,6 @@ typedef union
     uint16_t Word;
 } UGF_T;
 
-extern CTRL_PARM_T ctrlParm;
-extern MOTOR_STARTUP_DATA_T motorStartUpData;
-extern MC_ALPHABETA_T valphabeta,ialphabeta;
-extern MC_ALPHABETA_T valphabeta,ialphabeta;
-extern MC_SINCOS_T sincosTheta;
-extern MC_DQ_T vdq,idq;
-extern MC_DUTYCYCLEOUT_T pwmDutycycle;
-extern MC_ABC_T   vabc,iabc;
-
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,220 @@
+/*******************************************************************************
+ * Copyright (c) 2017 released Microchip Technology Inc.  All rights reserved.
+ *
+ * SOFTWARE LICENSE AGREEMENT:
+ *
+ * Microchip Technology Incorporated ("Microchip") retains all ownership and
+ * intellectual property rights in the code accompanying this message and in all
+ * derivatives hereto.  You may use this code, and any derivatives created by
+ * any person or entity by or on your behalf, exclusively with Microchip's
+ * proprietary products.  Your acceptance and/or use of this code constitutes
+ * agreement to the terms and conditions of this notice.
+ *
+ * CODE ACCOMPANYING THIS MESSAGE IS SUPPLIED BY MICROCHIP "AS IS".  NO
+ * WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
+ * TO, IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE APPLY TO THIS CODE, ITS INTERACTION WITH MICROCHIP'S
+ * PRODUCTS, COMBINATION WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION.
+ *
+ * YOU ACKNOWLEDGE AND AGREE THAT, IN NO EVENT, SHALL MICROCHIP BE LIABLE,
+ * WHETHER IN CONTRACT, WARRANTY, TORT (INCLUDING NEGLIGENCE OR BREACH OF
+ * STATUTORY DUTY),STRICT LIABILITY, INDEMNITY, CONTRIBUTION, OR OTHERWISE,
+ * FOR ANY INDIRECT, SPECIAL,PUNITIVE, EXEMPLARY, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, FOR COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE CODE,
+ * HOWSOEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE POSSIBILITY OR
+ * THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT ALLOWABLE BY LAW,
+ * MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY RELATED TO THIS CODE,
+ * SHALL NOT EXCEED THE PRICE YOU PAID DIRECTLY TO MICROCHIP SPECIFICALLY TO
+ * HAVE THIS CODE DEVELOPED.
+ *
+ * You agree that you are solely responsible for testing the code and
+ * determining its suitability.  Microchip has no obligation to modify, test,
+ * certify, or support the code.
+ *
+ *******************************************************************************/
+#include <stdint.h>
+#include "dcbus.h"
+#include "userparms.h"
+#include "general.h"
+#include "pwm.h"
+
+inline static int16_t DcBus_Multiply(int16_t,int16_t);
+
+// *****************************************************************************
+/* Function:
+    DcBusCompInitialize()
+
+  Summary:
+    Initializes the DC bus voltage compensation
+
+  Description:
+    The filter starts from the nominal voltage, so the modulation is not 
+    scaled until the measured voltage has settled.
+
+  Precondition:
+    The PWM timing (pwmTiming) is calculated.
+
+  Parameters:
+    pParm - DC bus compensation data
+
+  Returns:
+    None.
+
+  Remarks:
+    None.
+ */
+void DcBusCompInitialize(DCBUS_COMP_T *pParm)
+{
+    pParm->qVbusFilt = DCBUS_NOMINAL;
+    pParm->qVbusStateVar = (int32_t)DCBUS_NOMINAL << 15;
+    pParm->qKfilter = PWMScaleLoopTime(DCBUS_KFILTER);
+    pParm->qVbusMin = Q15(DCBUS_RATIO_MIN*DC_BUS_NOMINAL_VOLTS/
+                          DC_BUS_FULL_SCALE_VOLTS);
+    pParm->qVbusMax = Q15(DCBUS_RATIO_MAX*DC_BUS_NOMINAL_VOLTS/
+                          DC_BUS_FULL_SCALE_VOLTS);
+    pParm->qScale = (int16_t)(1 << DCBUS_SCALE_SHIFT);
+    pParm->qRatio = (int16_t)(1 << DCBUS_SCALE_SHIFT);
+}
+// *****************************************************************************
+/* Function:
+    DcBusCompUpdate()
+
+  Summary:
+    Updates the compensation scale factors from the DC bus voltage
+
+  Description:
+    The measured voltage is filtered and limited, the scale factor is the 
+    reciprocal of the voltage relative to the nominal voltage, 
+    scale = Vnominal/Vbus and ratio = Vbus/Vnominal in Q14. The hardware 
+    divide (div.sd) is shorter than a normalized Newton-Raphson reciprocal 
+    with the same resolution.
+
+  Precondition:
+    None.
+
+  Parameters:
+    pParm - DC bus compensation data
+    vbus  - Measured DC bus voltage
+
+  Returns:
+    None.
+
+  Remarks:
+    None.
+ */
+void DcBusCompUpdate(DCBUS_COMP_T *pParm,int16_t vbus)
+{
+    int16_t vbusFilt;
+    
+    pParm->qVbusStateVar += __builtin_mulss(vbus - pParm->qVbusFilt,
+                                            pParm->qKfilter);
+    vbusFilt = (int16_t)(pParm->qVbusStateVar >> 15);
+    pParm->qVbusFilt = vbusFilt;
+    
+    if (vbusFilt < pParm->qVbusMin)
+    {
+        vbusFilt = pParm->qVbusMin;
+    }
+    else if (vbusFilt > pParm->qVbusMax)
+    {
+        vbusFilt = pParm->qVbusMax;
+    }
+    pParm->qScale = __builtin_divsd((int32_t)DCBUS_NOMINAL << DCBUS_SCALE_SHIFT,
+                                    vbusFilt);
+    pParm->qRatio = __builtin_divsd((int32_t)vbusFilt << DCBUS_SCALE_SHIFT,
+                                    DCBUS_NOMINAL);
+}
+// *****************************************************************************
+/* Function:
+    DcBusCompScale()
+
+  Summary:
+    Voltage command to modulation
+
+  Description:
+    The voltage command, normalized to the nominal DC bus voltage, is 
+    multiplied with Vnominal/Vbus.
+
+  Precondition:
+    None.
+
+  Parameters:
+    pParm - DC bus compensation data
+    value - Voltage at nominal DC bus voltage
+
+  Returns:
+    Modulation at the measured DC bus voltage, saturated.
+
+  Remarks:
+    None.
+ */
+int16_t DcBusCompScale(const DCBUS_COMP_T *pParm,int16_t value)
+{
+    return DcBus_Multiply(value,pParm->qScale);
+}
+// *****************************************************************************
+/* Function:
+    DcBusCompUnscale()
+
+  Summary:
+    Modulation to voltage command
+
+  Description:
+    The modulation is multiplied with Vbus/Vnominal, the inverse of 
+    DcBusCompScale().
+
+  Precondition:
+    None.
+
+  Parameters:
+    pParm - DC bus compensation data
+    value - Modulation at the measured DC bus voltage
+
+  Returns:
+    Voltage at nominal DC bus voltage, saturated.
+
+  Remarks:
+    None.
+ */
+int16_t DcBusCompUnscale(const DCBUS_COMP_T *pParm,int16_t value)
+{
+    return DcBus_Multiply(value,pParm->qRatio);
+}
+// *****************************************************************************
+/* Function:
+    DcBus_Multiply()
+
+  Summary:
+    Q15 by Q14 multiplication with saturation
+
+  Description:
+    Q15 by Q14 multiplication with saturation
+
+  Precondition:
+    None.
+
+  Parameters:
+    value - Q15 value
+    scale - Q14 scale factor
+
+  Returns:
+    Q15 product.
+
+  Remarks:
+    None.
+ */
+inline static int16_t DcBus_Multiply(int16_t value,int16_t scale)
+{
+    int32_t product;
+    
+    product = __builtin_mulss(value,scale) >> DCBUS_SCALE_SHIFT;
+    if (product > INT16_MAX)
+    {
+        product = INT16_MAX;
+    }
+    else if (product < INT16_MIN)
+    {
+        product = INT16_MIN;
+    }
+    return (int16_t)product;
+}
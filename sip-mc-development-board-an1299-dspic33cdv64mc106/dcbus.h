@@ -0,0 +1,90 @@
+/*******************************************************************************
+* Copyright (c) 2017 released Microchip Technology Inc.  All rights reserved.
+*
+* SOFTWARE LICENSE AGREEMENT:
+* 
+* Microchip Technology Incorporated ("Microchip") retains all ownership and
+* intellectual property rights in the code accompanying this message and in all
+* derivatives hereto.  You may use this code, and any derivatives created by
+* any person or entity by or on your behalf, exclusively with Microchip's
+* proprietary products.  Your acceptance and/or use of this code constitutes
+* agreement to the terms and conditions of this notice.
+*
+* CODE ACCOMPANYING THIS MESSAGE IS SUPPLIED BY MICROCHIP "AS IS".  NO
+* WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
+* TO, IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE APPLY TO THIS CODE, ITS INTERACTION WITH MICROCHIP'S
+* PRODUCTS, COMBINATION WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION.
+*
+* YOU ACKNOWLEDGE AND AGREE THAT, IN NO EVENT, SHALL MICROCHIP BE LIABLE,
+* WHETHER IN CONTRACT, WARRANTY, TORT (INCLUDING NEGLIGENCE OR BREACH OF
+* STATUTORY DUTY),STRICT LIABILITY, INDEMNITY, CONTRIBUTION, OR OTHERWISE,
+* FOR ANY INDIRECT, SPECIAL,PUNITIVE, EXEMPLARY, INCIDENTAL OR CONSEQUENTIAL
+* LOSS, DAMAGE, FOR COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE CODE,
+* HOWSOEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE POSSIBILITY OR
+* THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT ALLOWABLE BY LAW,
+* MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY RELATED TO THIS CODE,
+* SHALL NOT EXCEED THE PRICE YOU PAID DIRECTLY TO MICROCHIP SPECIFICALLY TO
+* HAVE THIS CODE DEVELOPED.
+*
+* You agree that you are solely responsible for testing the code and
+* determining its suitability.  Microchip has no obligation to modify, test,
+* certify, or support the code.
+*
+*******************************************************************************/
+#ifndef __DCBUS_H
+#define __DCBUS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "motor_control_noinline.h"
+
+/* DC bus voltage at DC_BUS_NOMINAL_VOLTS in the Q15 scale of dcBusVoltage */
+#define DCBUS_NOMINAL           Q15(DC_BUS_NOMINAL_VOLTS/ \
+                                    DC_BUS_FULL_SCALE_VOLTS)
+/* Range of the measured voltage used for the compensation, relative to the
+   nominal voltage. Both scale factors stay within the Q14 range */
+#define DCBUS_RATIO_MIN         0.6
+#define DCBUS_RATIO_MAX         1.5
+/* Filter of the measured voltage at 20 kHz, about 1 ms time constant */
+#define DCBUS_KFILTER           Q15(0.05)
+/* Fraction bits of the scale factors */
+#define DCBUS_SCALE_SHIFT       14
+    
+/* DC Bus Compensation data type
+
+  Description:
+    This structure will host parameters related to the DC bus voltage 
+    compensation of the modulation.
+ */
+typedef struct
+{
+    /* Filtered DC bus voltage, limited to the compensation range */
+    int16_t qVbusFilt;
+    int32_t qVbusStateVar;
+    /* Filter constant, scaled to the loop time */
+    int16_t qKfilter;
+    /* Limits of the filtered voltage */
+    int16_t qVbusMin;
+    int16_t qVbusMax;
+    /* Nominal over measured voltage in Q14, modulation to apply per unit 
+       voltage command */
+    int16_t qScale;
+    /* Measured over nominal voltage in Q14, voltage available per unit 
+       modulation */
+    int16_t qRatio;
+} DCBUS_COMP_T;
+
+void DcBusCompInitialize(DCBUS_COMP_T *);
+void DcBusCompUpdate(DCBUS_COMP_T *,int16_t);
+int16_t DcBusCompScale(const DCBUS_COMP_T *,int16_t);
+int16_t DcBusCompUnscale(const DCBUS_COMP_T *,int16_t);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DCBUS_H */
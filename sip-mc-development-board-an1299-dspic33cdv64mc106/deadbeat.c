@@ -0,0 +1,183 @@
+/*******************************************************************************
+ * Copyright (c) 2017 released Microchip Technology Inc.  All rights reserved.
+ *
+ * SOFTWARE LICENSE AGREEMENT:
+ *
+ * Microchip Technology Incorporated ("Microchip") retains all ownership and
+ * intellectual property rights in the code accompanying this message and in all
+ * derivatives hereto.  You may use this code, and any derivatives created by
+ * any person or entity by or on your behalf, exclusively with Microchip's
+ * proprietary products.  Your acceptance and/or use of this code constitutes
+ * agreement to the terms and conditions of this notice.
+ *
+ * CODE ACCOMPANYING THIS MESSAGE IS SUPPLIED BY MICROCHIP "AS IS".  NO
+ * WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
+ * TO, IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE APPLY TO THIS CODE, ITS INTERACTION WITH MICROCHIP'S
+ * PRODUCTS, COMBINATION WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION.
+ *
+ * YOU ACKNOWLEDGE AND AGREE THAT, IN NO EVENT, SHALL MICROCHIP BE LIABLE,
+ * WHETHER IN CONTRACT, WARRANTY, TORT (INCLUDING NEGLIGENCE OR BREACH OF
+ * STATUTORY DUTY),STRICT LIABILITY, INDEMNITY, CONTRIBUTION, OR OTHERWISE,
+ * FOR ANY INDIRECT, SPECIAL,PUNITIVE, EXEMPLARY, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, FOR COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE CODE,
+ * HOWSOEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE POSSIBILITY OR
+ * THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT ALLOWABLE BY LAW,
+ * MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY RELATED TO THIS CODE,
+ * SHALL NOT EXCEED THE PRICE YOU PAID DIRECTLY TO MICROCHIP SPECIFICALLY TO
+ * HAVE THIS CODE DEVELOPED.
+ *
+ * You agree that you are solely responsible for testing the code and
+ * determining its suitability.  Microchip has no obligation to modify, test,
+ * certify, or support the code.
+ *
+ *******************************************************************************/
+#include "deadbeat.h"
+#include "userparms.h"
+#include "general.h"
+#include "predict.h"
+
+// *****************************************************************************
+/* Function:
+    DeadbeatInitialize()
+
+  Summary:
+    Initializes the deadbeat current controller
+
+  Description:
+    Loads the gains, clears the integrators and takes the present voltage
+    as the output of the last cycle, so the first prediction uses the
+    voltage applied by the controller that was active before.
+
+  Precondition:
+    None.
+
+  Parameters:
+    pParm - Deadbeat controller data
+    pVdq  - d-q voltage applied in the present cycle
+
+  Returns:
+    None.
+
+  Remarks:
+    None.
+ */
+void DeadbeatInitialize(DEADBEAT_PARM_T *pParm,const MC_DQ_T *pVdq)
+{
+    pParm->qGain = DEADBEAT_GAIN;
+    pParm->qKi = DEADBEAT_KI;
+    pParm->integratorD = 0;
+    pParm->integratorQ = 0;
+    pParm->idqPredict.d = 0;
+    pParm->idqPredict.q = 0;
+    pParm->vdqOut = *pVdq;
+}
+// *****************************************************************************
+/* Function:
+    DeadbeatCurrentControl()
+
+  Summary:
+    Deadbeat (one step predictive) d-q current controller
+
+  Description:
+    Motor model in the rotor frame, normalized as in Estim():
+        Ls/dt*di_d = v_d - Rs*i_d + omega*Ls*i_q - E_d
+        Ls/dt*di_q = v_q - Rs*i_q - omega*Ls*i_d - E_q
+    with Rs*i = qRs*i >> 11 and Ls/dt*di = qLsDt*di >> 7.
+    The voltage calculated now is applied from the next PWM cycle, so the
+    currents at the next sampling instant are predicted from the voltage
+    applied in the present cycle (delay compensation). The new voltage then
+    moves the predicted currents to the references in one cycle:
+        v_d = Rs*ip_d - omega*Ls*ip_q + E_d + Gain*Ls/dt*(Iref_d - ip_d)
+        v_q = Rs*ip_q + omega*Ls*ip_d + E_q + Gain*Ls/dt*(Iref_q - ip_q)
+    An integral term of the measured current error removes the steady state
+    error from Rs and BEMF mismatch. It is held while the voltage limit of
+    the caller is active.
+
+  Precondition:
+    None.
+
+  Parameters:
+    pParm    - Deadbeat controller data
+    pIdq     - Measured d-q currents
+    pIdqRef  - d-q current references
+    pBemf    - Estimated d-q BEMF/2 (estimator qEsdf, qEsqf)
+    rs       - normalized Rs (motorParm.qRs)
+    lsDt     - normalized Ls/dt (motorParm.qLsDt)
+    omegaLs  - omega*Ts*qLsDt in Q15
+    pVdq     - Input  - d-q voltage applied in the present cycle
+               Output - d-q voltage for the next cycle, to be limited by the
+               caller
+
+  Returns:
+    None.
+
+  Remarks:
+    The d-q voltage limit is applied by the caller after this function.
+ */
+void DeadbeatCurrentControl(DEADBEAT_PARM_T *pParm,const MC_DQ_T *pIdq,
+                            const MC_DQ_T *pIdqRef,const MC_DQ_T *pBemf,
+                            int16_t rs,int16_t lsDt,int16_t omegaLs,
+                            MC_DQ_T *pVdq)
+{
+    int32_t vd,vq;
+    int16_t idPredict,iqPredict,lsDtGain,error;
+
+    /* Integral correction - only while the output was not limited */
+    if ((pVdq->d == pParm->vdqOut.d) && (pVdq->q == pParm->vdqOut.q))
+    {
+        error = SaturateQ15((int32_t)pIdqRef->d - pIdq->d);
+        pParm->integratorD += __builtin_mulss(pParm->qKi,error);
+        error = SaturateQ15((int32_t)pIdqRef->q - pIdq->q);
+        pParm->integratorQ += __builtin_mulss(pParm->qKi,error);
+        
+        if (pParm->integratorD > ((int32_t)32767 << 15))
+        {
+            pParm->integratorD = (int32_t)32767 << 15;
+        }
+        else if (pParm->integratorD < -((int32_t)32767 << 15))
+        {
+            pParm->integratorD = -((int32_t)32767 << 15);
+        }
+        if (pParm->integratorQ > ((int32_t)32767 << 15))
+        {
+            pParm->integratorQ = (int32_t)32767 << 15;
+        }
+        else if (pParm->integratorQ < -((int32_t)32767 << 15))
+        {
+            pParm->integratorQ = -((int32_t)32767 << 15);
+        }
+    }
+
+    /* Delay compensation - currents at the next sampling instant */
+    idPredict = PredictCurrent(pVdq->d,pIdq->d,pBemf->d,
+                               __builtin_mulss(omegaLs,pIdq->q) >> 7,
+                               rs,lsDt,PREDICT_SHIFT_CYCLE);
+    iqPredict = PredictCurrent(pVdq->q,pIdq->q,pBemf->q,
+                               -(__builtin_mulss(omegaLs,pIdq->d) >> 7),
+                               rs,lsDt,PREDICT_SHIFT_CYCLE);
+    pParm->idqPredict.d = idPredict;
+    pParm->idqPredict.q = iqPredict;
+
+    /* Voltage moving the predicted currents to the references, the motor
+       model terms are full scale and are shifted to the scale of vdq */
+    lsDtGain = (int16_t)(__builtin_mulss(pParm->qGain,lsDt) >> 15);
+    
+    error = SaturateQ15((int32_t)pIdqRef->d - idPredict);
+    vd = (((__builtin_mulss(rs,idPredict) >> 11) - 
+          (__builtin_mulss(omegaLs,iqPredict) >> 7) +
+          (__builtin_mulss(lsDtGain,error) >> 7) + 
+          (pParm->integratorD >> 15) + 
+          ((int32_t)pBemf->d << 1)) >> VOLTAGE_SCALE_SHIFT);
+    
+    error = SaturateQ15((int32_t)pIdqRef->q - iqPredict);
+    vq = (((__builtin_mulss(rs,iqPredict) >> 11) + 
+          (__builtin_mulss(omegaLs,idPredict) >> 7) +
+          (__builtin_mulss(lsDtGain,error) >> 7) + 
+          (pParm->integratorQ >> 15) + 
+          ((int32_t)pBemf->q << 1)) >> VOLTAGE_SCALE_SHIFT);
+
+    pParm->vdqOut.d = SaturateQ15(vd);
+    pParm->vdqOut.q = SaturateQ15(vq);
+    *pVdq = pParm->vdqOut;
+}
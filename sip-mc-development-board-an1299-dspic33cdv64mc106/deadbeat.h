@@ -0,0 +1,78 @@
+/*******************************************************************************
+* Copyright (c) 2017 released Microchip Technology Inc.  All rights reserved.
+*
+* SOFTWARE LICENSE AGREEMENT:
+* 
+* Microchip Technology Incorporated ("Microchip") retains all ownership and
+* intellectual property rights in the code accompanying this message and in all
+* derivatives hereto.  You may use this code, and any derivatives created by
+* any person or entity by or on your behalf, exclusively with Microchip's
+* proprietary products.  Your acceptance and/or use of this code constitutes
+* agreement to the terms and conditions of this notice.
+*
+* CODE ACCOMPANYING THIS MESSAGE IS SUPPLIED BY MICROCHIP "AS IS".  NO
+* WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
+* TO, IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE APPLY TO THIS CODE, ITS INTERACTION WITH MICROCHIP'S
+* PRODUCTS, COMBINATION WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION.
+*
+* YOU ACKNOWLEDGE AND AGREE THAT, IN NO EVENT, SHALL MICROCHIP BE LIABLE,
+* WHETHER IN CONTRACT, WARRANTY, TORT (INCLUDING NEGLIGENCE OR BREACH OF
+* STATUTORY DUTY),STRICT LIABILITY, INDEMNITY, CONTRIBUTION, OR OTHERWISE,
+* FOR ANY INDIRECT, SPECIAL,PUNITIVE, EXEMPLARY, INCIDENTAL OR CONSEQUENTIAL
+* LOSS, DAMAGE, FOR COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE CODE,
+* HOWSOEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE POSSIBILITY OR
+* THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT ALLOWABLE BY LAW,
+* MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY RELATED TO THIS CODE,
+* SHALL NOT EXCEED THE PRICE YOU PAID DIRECTLY TO MICROCHIP SPECIFICALLY TO
+* HAVE THIS CODE DEVELOPED.
+*
+* You agree that you are solely responsible for testing the code and
+* determining its suitability.  Microchip has no obligation to modify, test,
+* certify, or support the code.
+*
+*******************************************************************************/
+#ifndef __DEADBEAT_H
+#define __DEADBEAT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "motor_control_noinline.h"
+
+/* Deadbeat Current Controller Parameter data type
+
+  Description:
+    This structure will host parameters related to the deadbeat current 
+    controller. Voltages are normalized as the PI outputs (vdq, shifted 
+    right by VOLTAGE_SCALE_SHIFT), Rs and Ls/dt as in Estim().
+ */
+typedef struct
+{
+    /* Fraction of the current error removed in one cycle, Q15(1) = deadbeat.
+       Lower values trade response time for robustness to Ls mismatch */
+    int16_t qGain;
+    /* Integral gain of the steady state error correction (Rs, BEMF 
+       mismatch) */
+    int16_t qKi;
+    /* Integrators of the d and q current error, voltage = integrator >> 15 */
+    int32_t integratorD;
+    int32_t integratorQ;
+    /* Currents predicted at the next sampling instant */
+    MC_DQ_T idqPredict;
+    /* Voltage calculated in the last cycle, before the voltage limit */
+    MC_DQ_T vdqOut;
+} DEADBEAT_PARM_T;
+
+void DeadbeatInitialize(DEADBEAT_PARM_T *,const MC_DQ_T *);
+void DeadbeatCurrentControl(DEADBEAT_PARM_T *,const MC_DQ_T *,
+                            const MC_DQ_T *,const MC_DQ_T *,int16_t,int16_t,
+                            int16_t,MC_DQ_T *);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DEADBEAT_H */
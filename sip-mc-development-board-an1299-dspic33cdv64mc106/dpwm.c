@@ -0,0 +1,264 @@
+/*******************************************************************************
+ * Copyright (c) 2017 released Microchip Technology Inc.  All rights reserved.
+ *
+ * SOFTWARE LICENSE AGREEMENT:
+ *
+ * Microchip Technology Incorporated ("Microchip") retains all ownership and
+ * intellectual property rights in the code accompanying this message and in all
+ * derivatives hereto.  You may use this code, and any derivatives created by
+ * any person or entity by or on your behalf, exclusively with Microchip's
+ * proprietary products.  Your acceptance and/or use of this code constitutes
+ * agreement to the terms and conditions of this notice.
+ *
+ * CODE ACCOMPANYING THIS MESSAGE IS SUPPLIED BY MICROCHIP "AS IS".  NO
+ * WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
+ * TO, IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE APPLY TO THIS CODE, ITS INTERACTION WITH MICROCHIP'S
+ * PRODUCTS, COMBINATION WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION.
+ *
+ * YOU ACKNOWLEDGE AND AGREE THAT, IN NO EVENT, SHALL MICROCHIP BE LIABLE,
+ * WHETHER IN CONTRACT, WARRANTY, TORT (INCLUDING NEGLIGENCE OR BREACH OF
+ * STATUTORY DUTY),STRICT LIABILITY, INDEMNITY, CONTRIBUTION, OR OTHERWISE,
+ * FOR ANY INDIRECT, SPECIAL,PUNITIVE, EXEMPLARY, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, FOR COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE CODE,
+ * HOWSOEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE POSSIBILITY OR
+ * THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT ALLOWABLE BY LAW,
+ * MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY RELATED TO THIS CODE,
+ * SHALL NOT EXCEED THE PRICE YOU PAID DIRECTLY TO MICROCHIP SPECIFICALLY TO
+ * HAVE THIS CODE DEVELOPED.
+ *
+ * You agree that you are solely responsible for testing the code and
+ * determining its suitability.  Microchip has no obligation to modify, test,
+ * certify, or support the code.
+ *
+ *******************************************************************************/
+#include "dpwm.h"
+#include "userparms.h"
+#include "general.h"
+
+// *****************************************************************************
+/* Function:
+    DpwmInitialize()
+
+  Summary:
+    Initializes the discontinuous PWM
+
+  Description:
+    Loads the default mode and the modulation index thresholds, the 
+    modulation starts continuous.
+
+  Precondition:
+    None.
+
+  Parameters:
+    pParm - Discontinuous PWM data
+
+  Returns:
+    None.
+
+  Remarks:
+    None.
+ */
+void DpwmInitialize(DPWM_PARM_T *pParm)
+{
+    pParm->mode = DPWM_MODE_DEFAULT;
+    pParm->active = 0;
+    pParm->qModulationOn = Q15(DPWM_MODULATION_ON * DPWM_MODULATION_ON);
+    pParm->qModulationOff = Q15(DPWM_MODULATION_OFF * DPWM_MODULATION_OFF);
+    pParm->clamp = DPWM_CLAMP_NONE;
+}
+// *****************************************************************************
+/* Function:
+    DpwmUpdateModulation()
+
+  Summary:
+    Enables the discontinuous mode above the modulation index threshold
+
+  Description:
+    The squared amplitude of the d-q voltage is compared with the on and 
+    off thresholds. At low modulation index the continuous SVM is used, 
+    the current ripple of the clamped patterns is higher there and the 
+    switching losses are low anyway.
+
+  Precondition:
+    None.
+
+  Parameters:
+    pParm - Discontinuous PWM data
+    pVdq  - Voltage reference in d-q frame, shifted right by 
+            VOLTAGE_SCALE_SHIFT
+
+  Returns:
+    None.
+
+  Remarks:
+    None.
+ */
+void DpwmUpdateModulation(DPWM_PARM_T *pParm,const MC_DQ_T *pVdq)
+{
+    int32_t magnitude;
+
+    magnitude = (__builtin_mulss(pVdq->d,pVdq->d) + 
+                 __builtin_mulss(pVdq->q,pVdq->q)) >> 
+                                            (15 - 2*VOLTAGE_SCALE_SHIFT);
+
+    if ((pParm->mode == DPWM_MODE_CONTINUOUS) || 
+        (magnitude < pParm->qModulationOff))
+    {
+        pParm->active = 0;
+    }
+    else if (magnitude >= pParm->qModulationOn)
+    {
+        pParm->active = 1;
+    }
+}
+// *****************************************************************************
+/* Function:
+    DpwmSelectClamp()
+
+  Summary:
+    Selects the rail the phase is clamped to
+
+  Description:
+    The phase with the longest duty can be clamped to the positive rail or 
+    the phase with the shortest duty to the negative rail. 
+    DPWM1 clamps the phase with the highest phase voltage amplitude, which 
+    is the longest duty if the middle duty is closer to the shortest one.
+    DPWM0 and DPWM2 clamp the phase with the highest line voltage amplitude
+    to the leading or lagging phase, the longest and shortest duty phases
+    form this line voltage. 
+
+  Precondition:
+    None.
+
+  Parameters:
+    pParm    - Discontinuous PWM data
+    phaseMax - Phase with the longest duty, 0 = a, 1 = b, 2 = c
+    phaseMin - Phase with the shortest duty
+    tMaxMid  - Longest minus middle duty
+    tMidMin  - Middle minus shortest duty
+
+  Returns:
+    DPWM_CLAMP_HIGH, DPWM_CLAMP_LOW or DPWM_CLAMP_NONE if not active.
+
+  Remarks:
+    None.
+ */
+int16_t DpwmSelectClamp(const DPWM_PARM_T *pParm,uint16_t phaseMax,
+                        uint16_t phaseMin,int16_t tMaxMid,int16_t tMidMin)
+{
+    uint16_t phaseLead;
+
+    if (pParm->active == 0)
+    {
+        return DPWM_CLAMP_NONE;
+    }
+    /* Phase a leads b, b leads c and c leads a */
+    phaseLead = (phaseMax == 0) ? 2 : (phaseMax - 1);
+
+    switch (pParm->mode)
+    {
+        case DPWM_MODE_DPWM0:
+            /* Line voltage of the phase and the phase it leads, 
+               v(a) - v(b) peaks 30 degrees before v(a) */
+            return (phaseLead == phaseMin) ? DPWM_CLAMP_LOW : DPWM_CLAMP_HIGH;
+        case DPWM_MODE_DPWM1:
+            return (tMaxMid > tMidMin) ? DPWM_CLAMP_HIGH : DPWM_CLAMP_LOW;
+        case DPWM_MODE_DPWM2:
+            /* Line voltage of the phase and the phase leading it, 
+               v(a) - v(c) peaks 30 degrees after v(a) */
+            return (phaseLead == phaseMin) ? DPWM_CLAMP_HIGH : DPWM_CLAMP_LOW;
+        case DPWM_MODE_DPWMMIN:
+            return DPWM_CLAMP_LOW;
+        case DPWM_MODE_DPWMMAX:
+            return DPWM_CLAMP_HIGH;
+        default:
+            return DPWM_CLAMP_NONE;
+    }
+}
+// *****************************************************************************
+/* Function:
+    DpwmApply()
+
+  Summary:
+    Moves the continuous SVM duty cycles to the discontinuous pattern
+
+  Description:
+    The same offset is added to the three duty cycles so the clamped phase 
+    reaches 0 or the PWM period, all the zero vector time is moved to one 
+    side. The active vectors and so the line voltages do not change.
+    The dual shunt currents of phases a and b are sampled in the low side 
+    shunts while the low side switches are on, so only phase c is clamped
+    to the positive rail. A high clamp selected for phase a or b is 
+    replaced by the low clamp of the phase with the shortest duty.
+
+  Precondition:
+    Duty cycles are calculated by the continuous SVM for the PWM period.
+
+  Parameters:
+    pParm       - Discontinuous PWM data
+    pDutycycle  - Duty cycles, modified
+    iPwmPeriod  - PWM period
+
+  Returns:
+    None.
+
+  Remarks:
+    Used with dual shunt current sensing, the single shunt pattern is 
+    clamped in SingleShunt_CalculateSpaceVectorPhaseShifted().
+ */
+void DpwmApply(DPWM_PARM_T *pParm,MC_DUTYCYCLEOUT_T *pDutycycle,
+               uint16_t iPwmPeriod)
+{
+    uint16_t duty[3];
+    uint16_t phaseMax = 0, phaseMin = 0, phaseMid, i;
+    int16_t offset;
+
+    duty[0] = pDutycycle->dutycycle1;
+    duty[1] = pDutycycle->dutycycle2;
+    duty[2] = pDutycycle->dutycycle3;
+
+    for (i = 1; i < 3; i++)
+    {
+        if (duty[i] > duty[phaseMax])
+        {
+            phaseMax = i;
+        }
+        if (duty[i] < duty[phaseMin])
+        {
+            phaseMin = i;
+        }
+    }
+    if (phaseMax == phaseMin)
+    {
+        /* Zero voltage vector, nothing to clamp */
+        pParm->clamp = DPWM_CLAMP_NONE;
+        return;
+    }
+    /* Sum of the phase indexes is 3 */
+    phaseMid = 3 - phaseMax - phaseMin;
+
+    pParm->clamp = DpwmSelectClamp(pParm,phaseMax,phaseMin,
+                                   duty[phaseMax] - duty[phaseMid],
+                                   duty[phaseMid] - duty[phaseMin]);
+    /* Phases a and b keep their low side on time for the current sample */
+    if ((pParm->clamp == DPWM_CLAMP_HIGH) && (phaseMax != 2))
+    {
+        pParm->clamp = DPWM_CLAMP_LOW;
+    }
+    if (pParm->clamp == DPWM_CLAMP_HIGH)
+    {
+        offset = iPwmPeriod - duty[phaseMax];
+    }
+    else if (pParm->clamp == DPWM_CLAMP_LOW)
+    {
+        offset = -duty[phaseMin];
+    }
+    else
+    {
+        return;
+    }
+    pDutycycle->dutycycle1 = duty[0] + offset;
+    pDutycycle->dutycycle2 = duty[1] + offset;
+    pDutycycle->dutycycle3 = duty[2] + offset;
+}
@@ -0,0 +1,96 @@
+/*******************************************************************************
+* Copyright (c) 2017 released Microchip Technology Inc.  All rights reserved.
+*
+* SOFTWARE LICENSE AGREEMENT:
+* 
+* Microchip Technology Incorporated ("Microchip") retains all ownership and
+* intellectual property rights in the code accompanying this message and in all
+* derivatives hereto.  You may use this code, and any derivatives created by
+* any person or entity by or on your behalf, exclusively with Microchip's
+* proprietary products.  Your acceptance and/or use of this code constitutes
+* agreement to the terms and conditions of this notice.
+*
+* CODE ACCOMPANYING THIS MESSAGE IS SUPPLIED BY MICROCHIP "AS IS".  NO
+* WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
+* TO, IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE APPLY TO THIS CODE, ITS INTERACTION WITH MICROCHIP'S
+* PRODUCTS, COMBINATION WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION.
+*
+* YOU ACKNOWLEDGE AND AGREE THAT, IN NO EVENT, SHALL MICROCHIP BE LIABLE,
+* WHETHER IN CONTRACT, WARRANTY, TORT (INCLUDING NEGLIGENCE OR BREACH OF
+* STATUTORY DUTY),STRICT LIABILITY, INDEMNITY, CONTRIBUTION, OR OTHERWISE,
+* FOR ANY INDIRECT, SPECIAL,PUNITIVE, EXEMPLARY, INCIDENTAL OR CONSEQUENTIAL
+* LOSS, DAMAGE, FOR COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE CODE,
+* HOWSOEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE POSSIBILITY OR
+* THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT ALLOWABLE BY LAW,
+* MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY RELATED TO THIS CODE,
+* SHALL NOT EXCEED THE PRICE YOU PAID DIRECTLY TO MICROCHIP SPECIFICALLY TO
+* HAVE THIS CODE DEVELOPED.
+*
+* You agree that you are solely responsible for testing the code and
+* determining its suitability.  Microchip has no obligation to modify, test,
+* certify, or support the code.
+*
+*******************************************************************************/
+#ifndef __DPWM_H
+#define __DPWM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "motor_control_noinline.h"
+
+/* Modulation modes. The discontinuous modes clamp one phase to the positive 
+   or negative DC rail, the zero sequence changes and the line voltages are 
+   the same as with continuous SVM. Clamp intervals are given for the 
+   positive phase sequence (a-b-c) */
+/* Continuous SVM, zero vector time split equally */
+#define DPWM_MODE_CONTINUOUS    0
+/* 60 degree clamp intervals leading the phase voltage peaks by 30 degrees */
+#define DPWM_MODE_DPWM0         1
+/* 60 degree clamp intervals centered on the phase voltage peaks */
+#define DPWM_MODE_DPWM1         2
+/* 60 degree clamp intervals lagging the phase voltage peaks by 30 degrees */
+#define DPWM_MODE_DPWM2         3
+/* 120 degree clamp to the negative DC rail */
+#define DPWM_MODE_DPWMMIN       4
+/* 120 degree clamp to the positive DC rail */
+#define DPWM_MODE_DPWMMAX       5
+
+/* Clamped rail */
+#define DPWM_CLAMP_LOW          -1
+#define DPWM_CLAMP_NONE         0
+#define DPWM_CLAMP_HIGH         1
+
+/* Discontinuous PWM Parameter data type
+
+  Description:
+    This structure will host parameters related to the discontinuous PWM.
+ */
+typedef struct
+{
+    /* Modulation mode DPWM_MODE_xxx, can be changed at run time */
+    uint16_t mode;
+    /* Set when the modulation index is above the threshold and the 
+       discontinuous mode is in use */
+    uint16_t active;
+    /* Thresholds on the squared voltage vector amplitude, with hysteresis */
+    int16_t qModulationOn;
+    int16_t qModulationOff;
+    /* Rail the phase was clamped to in the last cycle, DPWM_CLAMP_xxx */
+    int16_t clamp;
+} DPWM_PARM_T;
+
+void DpwmInitialize(DPWM_PARM_T *);
+void DpwmUpdateModulation(DPWM_PARM_T *,const MC_DQ_T *);
+int16_t DpwmSelectClamp(const DPWM_PARM_T *,uint16_t,uint16_t,int16_t,
+                        int16_t);
+void DpwmApply(DPWM_PARM_T *,MC_DUTYCYCLEOUT_T *,uint16_t);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DPWM_H */
@@ -38,16 +38,11 @@
 #include "userparms.h"
 #include "estim.h"
 #include "control.h"
+#include "pwm.h"
 
 #define DECIMATE_NOMINAL_SPEED    NOMINAL_SPEED_RPM*NOPOLESPAIRS/10
 #define NOMINAL_ELECTRICAL_SPEED  NOMINAL_SPEED_RPM*NOPOLESPAIRS
 
-/** Variables */
-ESTIM_PARM_T estimator;
-MOTOR_ESTIM_PARM_T motorParm;
-MC_ALPHABETA_T bemfAlphaBeta;
-MC_DQ_T bemfdq;
-MC_SINCOS_T sincosThetaEstimator;
 
 // *****************************************************************************
 
@@ -65,7 +60,12 @@ MC_SINCOS_T sincosThetaEstimator;
     None.
 
   Parameters:
-    None
+    pEstim         - Estimator data of the axis
+    pMotor         - Motor parameters of the axis
+    pIAlphaBeta    - Measured alpha-beta current
+    pVAlphaBeta    - Alpha-beta voltage applied in the last cycle, shifted 
+                     right by VOLTAGE_SCALE_SHIFT
+    pBemfAlphaBeta - Output - alpha-beta BEMF/2
 
   Returns:
     None.
@@ -73,99 +73,104 @@ MC_SINCOS_T sincosThetaEstimator;
   Remarks:
     None.
  */
-void Estim(void) 
+void Estim(ESTIM_PARM_T *pEstim,MOTOR_ESTIM_PARM_T *pMotor,
+           const MC_ALPHABETA_T *pIAlphaBeta,const MC_ALPHABETA_T *pVAlphaBeta,
+           MC_ALPHABETA_T *pBemfAlphaBeta) 
 {
+    MC_DQ_T bemfdq;
+    MC_SINCOS_T sincosThetaEstimator;
     int32_t tempint;
-    uint16_t index = (estimator.qDiCounter - 7)&0x0007;
+    uint16_t index = (pEstim->qDiCounter - 7)&0x0007;
 
     /* dIalpha = Ialpha-oldIalpha,  dIbeta  = Ibeta-oldIbeta
        For lower speed the granularity of difference is higher - the
        difference is made between 2 sampled values @ 8 ADC ISR cycles */
-    if (_Q15abs(estimator.qVelEstim) < NOMINAL_ELECTRICAL_SPEED) 
+    if (_Q15abs(pEstim->qVelEstim) < NOMINAL_ELECTRICAL_SPEED) 
     {
 
-        estimator.qDIalpha = (ialphabeta.alpha -
-                estimator.qLastIalphaHS[index]);
+        pEstim->qDIalpha = (pIAlphaBeta->alpha -
+                pEstim->qLastIalphaHS[index]);
         /* The current difference can exceed the maximum value per 8 ADC ISR
            cycle .The following limitation assures a limitation per low speed -
            up to the nominal speed */
-        if (estimator.qDIalpha > estimator.qDIlimitLS) 
+        if (pEstim->qDIalpha > pEstim->qDIlimitLS) 
         {
-            estimator.qDIalpha = estimator.qDIlimitLS;
+            pEstim->qDIalpha = pEstim->qDIlimitLS;
         }
-        if (estimator.qDIalpha < -estimator.qDIlimitLS) 
+        if (pEstim->qDIalpha < -pEstim->qDIlimitLS) 
         {
-            estimator.qDIalpha = -estimator.qDIlimitLS;
+            pEstim->qDIalpha = -pEstim->qDIlimitLS;
         }
-        estimator.qVIndalpha = (int16_t) (__builtin_mulss(motorParm.qLsDt,
-                estimator.qDIalpha) >> 10);
+        pEstim->qVIndalpha = (int16_t) (__builtin_mulss(pMotor->qLsDt,
+                pEstim->qDIalpha) >> 10);
 
-        estimator.qDIbeta = (ialphabeta.beta - estimator.qLastIbetaHS[index]);
+        pEstim->qDIbeta = (pIAlphaBeta->beta - pEstim->qLastIbetaHS[index]);
         /* The current difference can exceed the maximum value per 8 ADC ISR cycle
            the following limitation assures a limitation per low speed - up to
            the nominal speed */
-        if (estimator.qDIbeta > estimator.qDIlimitLS) 
+        if (pEstim->qDIbeta > pEstim->qDIlimitLS) 
         {
-            estimator.qDIbeta = estimator.qDIlimitLS;
+            pEstim->qDIbeta = pEstim->qDIlimitLS;
         }
-        if (estimator.qDIbeta < -estimator.qDIlimitLS) 
+        if (pEstim->qDIbeta < -pEstim->qDIlimitLS) 
         {
-            estimator.qDIbeta = -estimator.qDIlimitLS;
+            pEstim->qDIbeta = -pEstim->qDIlimitLS;
         }
-        estimator.qVIndbeta = (int16_t) (__builtin_mulss(motorParm.qLsDt,
-                estimator.qDIbeta) >> 10);
+        pEstim->qVIndbeta = (int16_t) (__builtin_mulss(pMotor->qLsDt,
+                pEstim->qDIbeta) >> 10);
 
     } 
     else 
     {
 
-        estimator.qDIalpha = (ialphabeta.alpha -
-                estimator.qLastIalphaHS[(estimator.qDiCounter)]);
+        pEstim->qDIalpha = (pIAlphaBeta->alpha -
+                pEstim->qLastIalphaHS[(pEstim->qDiCounter)]);
         /* The current difference can exceed the maximum value per 1 ADC ISR cycle
            the following limitation assures a limitation per high speed - up to
            the maximum speed */
-        if (estimator.qDIalpha > estimator.qDIlimitHS) 
+        if (pEstim->qDIalpha > pEstim->qDIlimitHS) 
         {
-            estimator.qDIalpha = estimator.qDIlimitHS;
+            pEstim->qDIalpha = pEstim->qDIlimitHS;
         }
-        if (estimator.qDIalpha < -estimator.qDIlimitHS) 
+        if (pEstim->qDIalpha < -pEstim->qDIlimitHS) 
         {
-            estimator.qDIalpha = -estimator.qDIlimitHS;
+            pEstim->qDIalpha = -pEstim->qDIlimitHS;
         }
-        estimator.qVIndalpha = (int16_t) (__builtin_mulss(motorParm.qLsDt,
-                estimator.qDIalpha) >> 7);
+        pEstim->qVIndalpha = (int16_t) (__builtin_mulss(pMotor->qLsDt,
+                pEstim->qDIalpha) >> 7);
 
-        estimator.qDIbeta = (ialphabeta.beta -
-                estimator.qLastIbetaHS[(estimator.qDiCounter)]);
+        pEstim->qDIbeta = (pIAlphaBeta->beta -
+                pEstim->qLastIbetaHS[(pEstim->qDiCounter)]);
 
         /* The current difference can exceed the maximum value per 1 ADC ISR cycle
            the following limitation assures a limitation per high speed - up to
            the maximum speed */
-        if (estimator.qDIbeta > estimator.qDIlimitHS) 
+        if (pEstim->qDIbeta > pEstim->qDIlimitHS) 
         {
-            estimator.qDIbeta = estimator.qDIlimitHS;
+            pEstim->qDIbeta = pEstim->qDIlimitHS;
         }
-        if (estimator.qDIbeta < -estimator.qDIlimitHS) 
+        if (pEstim->qDIbeta < -pEstim->qDIlimitHS) 
         {
-            estimator.qDIbeta = -estimator.qDIlimitHS;
+            pEstim->qDIbeta = -pEstim->qDIlimitHS;
         }
-        estimator.qVIndbeta = (int16_t) (__builtin_mulss(motorParm.qLsDt,
-                estimator.qDIbeta) >> 7);
+        pEstim->qVIndbeta = (int16_t) (__builtin_mulss(pMotor->qLsDt,
+                pEstim->qDIbeta) >> 7);
     }
 
     /* Update  LastIalpha and LastIbeta */
-    estimator.qDiCounter = (estimator.qDiCounter + 1) & 0x0007;
-    estimator.qLastIalphaHS[estimator.qDiCounter] = ialphabeta.alpha;
-    estimator.qLastIbetaHS[estimator.qDiCounter] = ialphabeta.beta;
+    pEstim->qDiCounter = (pEstim->qDiCounter + 1) & 0x0007;
+    pEstim->qLastIalphaHS[pEstim->qDiCounter] = pIAlphaBeta->alpha;
+    pEstim->qLastIbetaHS[pEstim->qDiCounter] = pIAlphaBeta->beta;
 
     /* Stator voltage equations
      Ualpha = Rs * Ialpha + Ls dIalpha/dt + BEMF
      BEMF = Ualpha - Rs Ialpha - Ls dIalpha/dt */
 
-    bemfAlphaBeta.alpha =  (valphabeta.alpha >>1) -
-                        (int16_t) (__builtin_mulss(motorParm.qRs, 
-                                  ialphabeta.alpha) >> 12) -
-                        (estimator.qVIndalpha>>1);
+    pBemfAlphaBeta->alpha =  
+                        (pVAlphaBeta->alpha >> (1 - VOLTAGE_SCALE_SHIFT)) -
+                        (int16_t) (__builtin_mulss(pMotor->qRs, 
+                                  pIAlphaBeta->alpha) >> 12) -
+                        (pEstim->qVIndalpha>>1);
 
     /* The multiplication between the Rs and Ialpha was shifted by 14 instead
        of 15 because the Rs value normalized exceeded Q15 range, so it was
@@ -173,61 +178,62 @@ void Estim(void)
 
     /* Ubeta = Rs * Ibeta + Ls dIbeta/dt + BEMF
        BEMF = Ubeta - Rs Ibeta - Ls dIbeta/dt */
-    bemfAlphaBeta.beta =   (valphabeta.beta >>1)-
-                        (int16_t) (__builtin_mulss(motorParm.qRs,
-                                 ialphabeta.beta) >> 12) -
-                        (estimator.qVIndbeta>>1);
+    pBemfAlphaBeta->beta =   
+                        (pVAlphaBeta->beta >> (1 - VOLTAGE_SCALE_SHIFT)) -
+                        (int16_t) (__builtin_mulss(pMotor->qRs,
+                                 pIAlphaBeta->beta) >> 12) -
+                        (pEstim->qVIndbeta>>1);
 
     /* The multiplication between the Rs and Ibeta was shifted by 14 instead of 15
      because the Rs value normalized exceeded Q15 range, so it was divided by 2
      immediately after the normalization - in userparms.h */
-    MC_CalculateSineCosine_Assembly_Ram((estimator.qRho + estimator.qRhoOffset),
+    MC_CalculateSineCosine_Assembly_Ram((pEstim->qRho + pEstim->qRhoOffset),
                                         &sincosThetaEstimator);
 
     /*  Park_BEMF.d =  Clark_BEMF.alpha*cos(Angle) + Clark_BEMF.beta*sin(Rho)
        Park_BEMF.q = -Clark_BEMF.alpha*sin(Angle) + Clark_BEMF.beta*cos(Rho)*/
-    MC_TransformPark_Assembly(&bemfAlphaBeta, &sincosThetaEstimator, &bemfdq);
+    MC_TransformPark_Assembly(pBemfAlphaBeta, &sincosThetaEstimator, &bemfdq);
 
     /* Filter first order for Esd and Esq
        EsdFilter = 1/TFilterd * Integral{ (Esd-EsdFilter).dt } */
-    tempint = (int16_t) (bemfdq.d - estimator.qEsdf);
-    estimator.qEsdStateVar += __builtin_mulss(tempint, estimator.qKfilterEsdq);
-    estimator.qEsdf = (int16_t) (estimator.qEsdStateVar >> 15);
+    tempint = (int16_t) (bemfdq.d - pEstim->qEsdf);
+    pEstim->qEsdStateVar += __builtin_mulss(tempint, pEstim->qKfilterEsdq);
+    pEstim->qEsdf = (int16_t) (pEstim->qEsdStateVar >> 15);
 
-    tempint = (int16_t) (bemfdq.q - estimator.qEsqf);
-    estimator.qEsqStateVar += __builtin_mulss(tempint, estimator.qKfilterEsdq);
-    estimator.qEsqf = (int16_t) (estimator.qEsqStateVar >> 15);
+    tempint = (int16_t) (bemfdq.q - pEstim->qEsqf);
+    pEstim->qEsqStateVar += __builtin_mulss(tempint, pEstim->qKfilterEsdq);
+    pEstim->qEsqf = (int16_t) (pEstim->qEsqStateVar >> 15);
 
     /* OmegaMr= InvKfi * (Esqf -sgn(Esqf) * Esdf)
        For stability the condition for low speed */
-    if (_Q15abs(estimator.qVelEstim) > DECIMATE_NOMINAL_SPEED) 
+    if (_Q15abs(pEstim->qVelEstim) > DECIMATE_NOMINAL_SPEED) 
     {
-        if (estimator.qEsqf > 0) 
+        if (pEstim->qEsqf > 0) 
         {
-            tempint = (int16_t) (estimator.qEsqf - estimator.qEsdf);
-            estimator.qOmegaMr =  (int16_t) (__builtin_mulss(motorParm.qInvKFi,
+            tempint = (int16_t) (pEstim->qEsqf - pEstim->qEsdf);
+            pEstim->qOmegaMr =  (int16_t) (__builtin_mulss(pMotor->qInvKFi,
                                     tempint) >> 15);
         } 
         else 
         {
-            tempint = (int16_t) (estimator.qEsqf + estimator.qEsdf);
-            estimator.qOmegaMr = (int16_t) (__builtin_mulss(motorParm.qInvKFi,
+            tempint = (int16_t) (pEstim->qEsqf + pEstim->qEsdf);
+            pEstim->qOmegaMr = (int16_t) (__builtin_mulss(pMotor->qInvKFi,
                                     tempint) >> 15);
         }
     }        
     /* if estimator speed<10% => condition VelRef<>0 */
     else 
     {
-        if (estimator.qVelEstim > 0) 
+        if (pEstim->qVelEstim > 0) 
         {
-            tempint = (int16_t) (estimator.qEsqf - estimator.qEsdf);
-            estimator.qOmegaMr = (int16_t) (__builtin_mulss(motorParm.qInvKFi,
+            tempint = (int16_t) (pEstim->qEsqf - pEstim->qEsdf);
+            pEstim->qOmegaMr = (int16_t) (__builtin_mulss(pMotor->qInvKFi,
                                     tempint) >> 15);
         } 
         else 
         {
-            tempint = (int16_t) (estimator.qEsqf + estimator.qEsdf);
-            estimator.qOmegaMr = (int16_t) (__builtin_mulss(motorParm.qInvKFi,
+            tempint = (int16_t) (pEstim->qEsqf + pEstim->qEsdf);
+            pEstim->qOmegaMr = (int16_t) (__builtin_mulss(pMotor->qInvKFi,
                                     tempint) >> 15);
         }
     }
@@ -235,21 +241,21 @@ void Estim(void)
        initial value of InvKfi was shifted by 2 after normalizing -
        assuring that extended range of the variable is possible in the
        lookup table the initial value of InvKfi is defined in userparms.h */
-    estimator.qOmegaMr = estimator.qOmegaMr << 2;
+    pEstim->qOmegaMr = pEstim->qOmegaMr << 2;
     
     /* the integral of the angle is the estimated angle */
-    estimator.qRhoStateVar += __builtin_mulss(estimator.qOmegaMr,
-                                estimator.qDeltaT);
-    estimator.qRho = (int16_t) (estimator.qRhoStateVar >> 15);
+    pEstim->qRhoStateVar += __builtin_mulss(pEstim->qOmegaMr,
+                                pEstim->qDeltaT);
+    pEstim->qRho = (int16_t) (pEstim->qRhoStateVar >> 15);
 
 
     /* The estimated speed is a filter value of the above calculated OmegaMr.
        The filter implementation is the same as for BEMF d-q components
        filtering */
-    tempint = (int16_t) (estimator.qOmegaMr - estimator.qVelEstim);
-    estimator.qVelEstimStateVar += __builtin_mulss(tempint,
-                                    estimator.qVelEstimFilterK);
-    estimator.qVelEstim = (int16_t) (estimator.qVelEstimStateVar >> 15);
+    tempint = (int16_t) (pEstim->qOmegaMr - pEstim->qVelEstim);
+    pEstim->qVelEstimStateVar += __builtin_mulss(tempint,
+                                    pEstim->qVelEstimFilterK);
+    pEstim->qVelEstim = (int16_t) (pEstim->qVelEstimStateVar >> 15);
 
 }
 // *****************************************************************************
@@ -267,7 +273,8 @@ void Estim(void)
     None.
 
   Parameters:
-    None
+    pEstim - Estimator data of the axis
+    pMotor - Motor parameters of the axis
 
   Returns:
     None.
@@ -275,30 +282,31 @@ void Estim(void)
   Remarks:
     None.
  */
-void InitEstimParm(void) 
+void InitEstimParm(ESTIM_PARM_T *pEstim,MOTOR_ESTIM_PARM_T *pMotor) 
 {
-    /* Constants are defined in usreparms.h */
+    /* Constants are defined in usreparms.h for the default loop time,
+       they are scaled to the run time loop time (pwmTiming) */
 
-    motorParm.qLsDtBase = NORM_LSDTBASE;
-    motorParm.qLsDt = motorParm.qLsDtBase;
-    motorParm.qRs = NORM_RS;
+    pMotor->qLsDtBase = PWMScaleLoopFrequency(NORM_LSDTBASE);
+    pMotor->qLsDt = pMotor->qLsDtBase;
+    pMotor->qRs = NORM_RS;
 
-    motorParm.qInvKFiBase = NORM_INVKFIBASE;
-    motorParm.qInvKFi = motorParm.qInvKFiBase;
+    pMotor->qInvKFiBase = NORM_INVKFIBASE;
+    pMotor->qInvKFi = pMotor->qInvKFiBase;
 
-    estimator.qRhoStateVar = 0;
-    estimator.qOmegaMr = 0;
-    estimator.qDiCounter = 0;
-    estimator.qEsdStateVar = 0;
-    estimator.qEsqStateVar = 0;
+    pEstim->qRhoStateVar = 0;
+    pEstim->qOmegaMr = 0;
+    pEstim->qDiCounter = 0;
+    pEstim->qEsdStateVar = 0;
+    pEstim->qEsqStateVar = 0;
 
-    estimator.qDIlimitHS = D_ILIMIT_HS;
-    estimator.qDIlimitLS = D_ILIMIT_LS;
+    pEstim->qDIlimitHS = PWMScaleLoopTime(D_ILIMIT_HS);
+    pEstim->qDIlimitLS = PWMScaleLoopTime(D_ILIMIT_LS);
 
-    estimator.qKfilterEsdq = KFILTER_ESDQ;
-    estimator.qVelEstimFilterK = KFILTER_VELESTIM;
+    pEstim->qKfilterEsdq = PWMScaleLoopTime(KFILTER_ESDQ);
+    pEstim->qVelEstimFilterK = PWMScaleLoopTime(KFILTER_VELESTIM);
 
-    estimator.qDeltaT = NORM_DELTAT;
-    estimator.qRhoOffset = INITOFFSET_TRANS_OPEN_CLSD;
+    pEstim->qDeltaT = PWMScaleLoopTime(NORM_DELTAT);
+    pEstim->qRhoOffset = INITOFFSET_TRANS_OPEN_CLSD;
 
 }
@@ -131,11 +131,9 @@ typedef struct
     int16_t qInvKFiBase;            
 } MOTOR_ESTIM_PARM_T;
 
-extern ESTIM_PARM_T estimator;
-extern MOTOR_ESTIM_PARM_T motorParm;
-
-void Estim(void);
-void InitEstimParm(void);
+void Estim(ESTIM_PARM_T *,MOTOR_ESTIM_PARM_T *,const MC_ALPHABETA_T *,
+           const MC_ALPHABETA_T *,MC_ALPHABETA_T *);
+void InitEstimParm(ESTIM_PARM_T *,MOTOR_ESTIM_PARM_T *);
 
 
 #ifdef __cplusplus
@@ -37,8 +37,7 @@
 #include "estim.h"
 #include "userparms.h"
 #include "general.h"
-
-FDWEAK_PARM_T fdWeakParm;
+#include "pwm.h"
 
 #define FWONSPEED NOMINAL_SPEED_RPM*NOPOLESPAIRS
 // *****************************************************************************
@@ -56,7 +55,7 @@ FDWEAK_PARM_T fdWeakParm;
     None.
 
   Parameters:
-    None
+    pFdWeak - Field weakening data of the axis
 
   Returns:
     None.
@@ -64,74 +63,77 @@ FDWEAK_PARM_T fdWeakParm;
   Remarks:
     None.
  */
-void InitFWParams(void) 
+void InitFWParams(FDWEAK_PARM_T *pFdWeak) 
 {
     /* Field Weakening constant for constant torque range */
     /* Flux reference value */
-    fdWeakParm.qIdRef = IDREF_BASESPEED;
+    pFdWeak->qIdRef = IDREF_BASESPEED;
     /* Start speed for Field weakening  */
-    fdWeakParm.qFwOnSpeed = FWONSPEED ;
+    pFdWeak->qFwOnSpeed = FWONSPEED ;
+    /* BEMF filter constants for the run time loop time */
+    pFdWeak->qKfilterEsdq = PWMScaleLoopTime(KFILTER_ESDQ);
+    pFdWeak->qKfilterEsdqFw = PWMScaleLoopTime(KFILTER_ESDQ_FW);
 
     /* Initialize magnetizing curve values */
-    fdWeakParm.qFwCurve[0] = IDREF_SPEED0;
-    fdWeakParm.qFwCurve[1] = IDREF_SPEED1;
-    fdWeakParm.qFwCurve[2] = IDREF_SPEED2;
-    fdWeakParm.qFwCurve[3] = IDREF_SPEED3;
-    fdWeakParm.qFwCurve[4] = IDREF_SPEED4;
-    fdWeakParm.qFwCurve[5] = IDREF_SPEED5;
-    fdWeakParm.qFwCurve[6] = IDREF_SPEED6;
-    fdWeakParm.qFwCurve[7] = IDREF_SPEED7;
-    fdWeakParm.qFwCurve[8] = IDREF_SPEED8;
-    fdWeakParm.qFwCurve[9] = IDREF_SPEED9;
-    fdWeakParm.qFwCurve[10] = IDREF_SPEED10;
-    fdWeakParm.qFwCurve[11] = IDREF_SPEED11;
-    fdWeakParm.qFwCurve[12] = IDREF_SPEED12;
-    fdWeakParm.qFwCurve[13] = IDREF_SPEED13;
-    fdWeakParm.qFwCurve[14] = IDREF_SPEED14;
-    fdWeakParm.qFwCurve[15] = IDREF_SPEED15;
-    fdWeakParm.qFwCurve[16] = IDREF_SPEED16;
-    fdWeakParm.qFwCurve[17] = IDREF_SPEED17;
+    pFdWeak->qFwCurve[0] = IDREF_SPEED0;
+    pFdWeak->qFwCurve[1] = IDREF_SPEED1;
+    pFdWeak->qFwCurve[2] = IDREF_SPEED2;
+    pFdWeak->qFwCurve[3] = IDREF_SPEED3;
+    pFdWeak->qFwCurve[4] = IDREF_SPEED4;
+    pFdWeak->qFwCurve[5] = IDREF_SPEED5;
+    pFdWeak->qFwCurve[6] = IDREF_SPEED6;
+    pFdWeak->qFwCurve[7] = IDREF_SPEED7;
+    pFdWeak->qFwCurve[8] = IDREF_SPEED8;
+    pFdWeak->qFwCurve[9] = IDREF_SPEED9;
+    pFdWeak->qFwCurve[10] = IDREF_SPEED10;
+    pFdWeak->qFwCurve[11] = IDREF_SPEED11;
+    pFdWeak->qFwCurve[12] = IDREF_SPEED12;
+    pFdWeak->qFwCurve[13] = IDREF_SPEED13;
+    pFdWeak->qFwCurve[14] = IDREF_SPEED14;
+    pFdWeak->qFwCurve[15] = IDREF_SPEED15;
+    pFdWeak->qFwCurve[16] = IDREF_SPEED16;
+    pFdWeak->qFwCurve[17] = IDREF_SPEED17;
 
 
     /* Initialize inverse Kfi curve values */
-    fdWeakParm.qInvKFiCurve[0] = INVKFI_SPEED0;
-    fdWeakParm.qInvKFiCurve[1] = INVKFI_SPEED1;
-    fdWeakParm.qInvKFiCurve[2] = INVKFI_SPEED2;
-    fdWeakParm.qInvKFiCurve[3] = INVKFI_SPEED3;
-    fdWeakParm.qInvKFiCurve[4] = INVKFI_SPEED4;
-    fdWeakParm.qInvKFiCurve[5] = INVKFI_SPEED5;
-    fdWeakParm.qInvKFiCurve[6] = INVKFI_SPEED6;
-    fdWeakParm.qInvKFiCurve[7] = INVKFI_SPEED7;
-    fdWeakParm.qInvKFiCurve[8] = INVKFI_SPEED8;
-    fdWeakParm.qInvKFiCurve[9] = INVKFI_SPEED9;
-    fdWeakParm.qInvKFiCurve[10] = INVKFI_SPEED10;
-    fdWeakParm.qInvKFiCurve[11] = INVKFI_SPEED11;
-    fdWeakParm.qInvKFiCurve[12] = INVKFI_SPEED12;
-    fdWeakParm.qInvKFiCurve[13] = INVKFI_SPEED13;
-    fdWeakParm.qInvKFiCurve[14] = INVKFI_SPEED14;
-    fdWeakParm.qInvKFiCurve[15] = INVKFI_SPEED15;
-    fdWeakParm.qInvKFiCurve[16] = INVKFI_SPEED16;
-    fdWeakParm.qInvKFiCurve[17] = INVKFI_SPEED17;
+    pFdWeak->qInvKFiCurve[0] = INVKFI_SPEED0;
+    pFdWeak->qInvKFiCurve[1] = INVKFI_SPEED1;
+    pFdWeak->qInvKFiCurve[2] = INVKFI_SPEED2;
+    pFdWeak->qInvKFiCurve[3] = INVKFI_SPEED3;
+    pFdWeak->qInvKFiCurve[4] = INVKFI_SPEED4;
+    pFdWeak->qInvKFiCurve[5] = INVKFI_SPEED5;
+    pFdWeak->qInvKFiCurve[6] = INVKFI_SPEED6;
+    pFdWeak->qInvKFiCurve[7] = INVKFI_SPEED7;
+    pFdWeak->qInvKFiCurve[8] = INVKFI_SPEED8;
+    pFdWeak->qInvKFiCurve[9] = INVKFI_SPEED9;
+    pFdWeak->qInvKFiCurve[10] = INVKFI_SPEED10;
+    pFdWeak->qInvKFiCurve[11] = INVKFI_SPEED11;
+    pFdWeak->qInvKFiCurve[12] = INVKFI_SPEED12;
+    pFdWeak->qInvKFiCurve[13] = INVKFI_SPEED13;
+    pFdWeak->qInvKFiCurve[14] = INVKFI_SPEED14;
+    pFdWeak->qInvKFiCurve[15] = INVKFI_SPEED15;
+    pFdWeak->qInvKFiCurve[16] = INVKFI_SPEED16;
+    pFdWeak->qInvKFiCurve[17] = INVKFI_SPEED17;
 
     /* Initialize Ls variation curve */
-    fdWeakParm.qLsCurve[0] = LS_OVER2LS0_SPEED0;
-    fdWeakParm.qLsCurve[1] = LS_OVER2LS0_SPEED1;
-    fdWeakParm.qLsCurve[2] = LS_OVER2LS0_SPEED2;
-    fdWeakParm.qLsCurve[3] = LS_OVER2LS0_SPEED3;
-    fdWeakParm.qLsCurve[4] = LS_OVER2LS0_SPEED4;
-    fdWeakParm.qLsCurve[5] = LS_OVER2LS0_SPEED5;
-    fdWeakParm.qLsCurve[6] = LS_OVER2LS0_SPEED6;
-    fdWeakParm.qLsCurve[7] = LS_OVER2LS0_SPEED7;
-    fdWeakParm.qLsCurve[8] = LS_OVER2LS0_SPEED8;
-    fdWeakParm.qLsCurve[9] = LS_OVER2LS0_SPEED9;
-    fdWeakParm.qLsCurve[10] = LS_OVER2LS0_SPEED10;
-    fdWeakParm.qLsCurve[11] = LS_OVER2LS0_SPEED11;
-    fdWeakParm.qLsCurve[12] = LS_OVER2LS0_SPEED12;
-    fdWeakParm.qLsCurve[13] = LS_OVER2LS0_SPEED13;
-    fdWeakParm.qLsCurve[14] = LS_OVER2LS0_SPEED14;
-    fdWeakParm.qLsCurve[15] = LS_OVER2LS0_SPEED15;
-    fdWeakParm.qLsCurve[16] = LS_OVER2LS0_SPEED16;
-    fdWeakParm.qLsCurve[17] = LS_OVER2LS0_SPEED17;
+    pFdWeak->qLsCurve[0] = LS_OVER2LS0_SPEED0;
+    pFdWeak->qLsCurve[1] = LS_OVER2LS0_SPEED1;
+    pFdWeak->qLsCurve[2] = LS_OVER2LS0_SPEED2;
+    pFdWeak->qLsCurve[3] = LS_OVER2LS0_SPEED3;
+    pFdWeak->qLsCurve[4] = LS_OVER2LS0_SPEED4;
+    pFdWeak->qLsCurve[5] = LS_OVER2LS0_SPEED5;
+    pFdWeak->qLsCurve[6] = LS_OVER2LS0_SPEED6;
+    pFdWeak->qLsCurve[7] = LS_OVER2LS0_SPEED7;
+    pFdWeak->qLsCurve[8] = LS_OVER2LS0_SPEED8;
+    pFdWeak->qLsCurve[9] = LS_OVER2LS0_SPEED9;
+    pFdWeak->qLsCurve[10] = LS_OVER2LS0_SPEED10;
+    pFdWeak->qLsCurve[11] = LS_OVER2LS0_SPEED11;
+    pFdWeak->qLsCurve[12] = LS_OVER2LS0_SPEED12;
+    pFdWeak->qLsCurve[13] = LS_OVER2LS0_SPEED13;
+    pFdWeak->qLsCurve[14] = LS_OVER2LS0_SPEED14;
+    pFdWeak->qLsCurve[15] = LS_OVER2LS0_SPEED15;
+    pFdWeak->qLsCurve[16] = LS_OVER2LS0_SPEED16;
+    pFdWeak->qLsCurve[17] = LS_OVER2LS0_SPEED17;
 
 }
 // *****************************************************************************
@@ -149,7 +151,10 @@ void InitFWParams(void)
     None.
 
   Parameters:
-    Motor Speed
+    pFdWeak     - Field weakening data of the axis
+    pEstim      - Estimator data, the BEMF filter constant is adapted
+    pMotor      - Motor parameters, InvKFi and Ls/dt are adapted
+    qMotorSpeed - Motor Speed
 
   Returns:
     Id reference.
@@ -157,7 +162,8 @@ void InitFWParams(void)
   Remarks:
     None.
  */
-int16_t FieldWeakening(int16_t qMotorSpeed) 
+int16_t FieldWeakening(FDWEAK_PARM_T *pFdWeak,ESTIM_PARM_T *pEstim,
+                       MOTOR_ESTIM_PARM_T *pMotor,int16_t qMotorSpeed) 
 {
     int16_t iTempInt1, iTempInt2;
 
@@ -165,61 +171,61 @@ int16_t FieldWeakening(int16_t qMotorSpeed)
     int16_t qLsDt;
 
     /* LsDt value - for base speed */
-    qLsDt = motorParm.qLsDtBase;
+    qLsDt = pMotor->qLsDtBase;
 
     /* If the speed is less than one for activating the FW */
-    if (qMotorSpeed <= fdWeakParm.qFwOnSpeed) 
+    if (qMotorSpeed <= pFdWeak->qFwOnSpeed) 
     {
         /* Set Idref as first value in magnetizing curve */
-        fdWeakParm.qIdRef = fdWeakParm.qFwCurve[0];
+        pFdWeak->qIdRef = pFdWeak->qFwCurve[0];
 
         /* Adapt filter parameter */
-        estimator.qKfilterEsdq = KFILTER_ESDQ;
+        pEstim->qKfilterEsdq = pFdWeak->qKfilterEsdq;
 
         /* Inverse Kfi constant for base speed */
-        qInvKFi = motorParm.qInvKFiBase;
+        qInvKFi = pMotor->qInvKFiBase;
     } 
     else 
     {
         /* Get the index parameter */
         /* Index in FW-Table */
-        fdWeakParm.qIndex = (qMotorSpeed - fdWeakParm.qFwOnSpeed) >> SPEED_INDEX_CONST;
+        pFdWeak->qIndex = (qMotorSpeed - pFdWeak->qFwOnSpeed) >> SPEED_INDEX_CONST;
 
-        iTempInt1 = fdWeakParm.qFwCurve[fdWeakParm.qIndex] -
-                    fdWeakParm.qFwCurve[fdWeakParm.qIndex + 1];
-        iTempInt2 = (fdWeakParm.qIndex << SPEED_INDEX_CONST) +
-                    fdWeakParm.qFwOnSpeed;
+        iTempInt1 = pFdWeak->qFwCurve[pFdWeak->qIndex] -
+                    pFdWeak->qFwCurve[pFdWeak->qIndex + 1];
+        iTempInt2 = (pFdWeak->qIndex << SPEED_INDEX_CONST) +
+                    pFdWeak->qFwOnSpeed;
         iTempInt2 = qMotorSpeed - iTempInt2;
 
         /* Interpolation between two results from the Table */
-        fdWeakParm.qIdRef = fdWeakParm.qFwCurve[fdWeakParm.qIndex]-
+        pFdWeak->qIdRef = pFdWeak->qFwCurve[pFdWeak->qIndex]-
                 (int16_t) (__builtin_mulss(iTempInt1, iTempInt2) >> SPEED_INDEX_CONST);
 
         /* Adapt filer parameter */
-        estimator.qKfilterEsdq = KFILTER_ESDQ_FW;
+        pEstim->qKfilterEsdq = pFdWeak->qKfilterEsdqFw;
 
         /* Interpolation between two results from the Table */
-        iTempInt1 = fdWeakParm.qInvKFiCurve[fdWeakParm.qIndex] -
-                    fdWeakParm.qInvKFiCurve[fdWeakParm.qIndex + 1];
+        iTempInt1 = pFdWeak->qInvKFiCurve[pFdWeak->qIndex] -
+                    pFdWeak->qInvKFiCurve[pFdWeak->qIndex + 1];
 
-        qInvKFi = fdWeakParm.qInvKFiCurve[fdWeakParm.qIndex] -
+        qInvKFi = pFdWeak->qInvKFiCurve[pFdWeak->qIndex] -
                   (int16_t) (__builtin_mulss(iTempInt1, iTempInt2) >> SPEED_INDEX_CONST);
 
 
         /* Interpolation between two results from the Table */
-        iTempInt1 = fdWeakParm.qLsCurve[fdWeakParm.qIndex] -
-                    fdWeakParm.qLsCurve[fdWeakParm.qIndex + 1];
+        iTempInt1 = pFdWeak->qLsCurve[pFdWeak->qIndex] -
+                    pFdWeak->qLsCurve[pFdWeak->qIndex + 1];
 
-        iTempInt1 = fdWeakParm.qLsCurve[fdWeakParm.qIndex] -
+        iTempInt1 = pFdWeak->qLsCurve[pFdWeak->qIndex] -
                     (int16_t) (__builtin_mulss(iTempInt1, iTempInt2) >> SPEED_INDEX_CONST);
 
         /* Lsdt = Lsdt0*Ls/Ls0 */
         qLsDt = (int16_t) (__builtin_mulss(qLsDt, iTempInt1) >> 14);
     }
 
-    motorParm.qInvKFi = qInvKFi;
-    motorParm.qLsDt = qLsDt;
+    pMotor->qInvKFi = qInvKFi;
+    pMotor->qLsDt = qLsDt;
     
-    return fdWeakParm.qIdRef;
+    return pFdWeak->qIdRef;
 }
 
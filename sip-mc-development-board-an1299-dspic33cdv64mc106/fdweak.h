@@ -40,6 +40,7 @@ extern "C" {
 #endif
 
 #include <stdint.h>
+#include "estim.h"
     
 /* Field weakening Parameter data type
 
@@ -60,12 +61,14 @@ typedef struct
     int16_t qInvKFiCurve[18];
     /* Curve for Ls variation with speed */
     int16_t qLsCurve[18];    
+    /* BEMF filter constant below and above flux weakening on speed */
+    int16_t qKfilterEsdq;
+    int16_t qKfilterEsdqFw;
 } FDWEAK_PARM_T;
 
-extern FDWEAK_PARM_T fdWeakParm;
-
-void InitFWParams();
-int16_t FieldWeakening( int16_t qMotorSpeed );
+void InitFWParams(FDWEAK_PARM_T *);
+int16_t FieldWeakening(FDWEAK_PARM_T *,ESTIM_PARM_T *,MOTOR_ESTIM_PARM_T *,
+                       int16_t);
 
 #ifdef __cplusplus
 }
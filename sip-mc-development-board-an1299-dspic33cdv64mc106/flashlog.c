@@ -0,0 +1,464 @@
+/*******************************************************************************
+ * Copyright (c) 2017 released Microchip Technology Inc.  All rights reserved.
+ *
+ * SOFTWARE LICENSE AGREEMENT:
+ *
+ * Microchip Technology Incorporated ("Microchip") retains all ownership and
+ * intellectual property rights in the code accompanying this message and in all
+ * derivatives hereto.  You may use this code, and any derivatives created by
+ * any person or entity by or on your behalf, exclusively with Microchip's
+ * proprietary products.  Your acceptance and/or use of this code constitutes
+ * agreement to the terms and conditions of this notice.
+ *
+ * CODE ACCOMPANYING THIS MESSAGE IS SUPPLIED BY MICROCHIP "AS IS".  NO
+ * WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
+ * TO, IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE APPLY TO THIS CODE, ITS INTERACTION WITH MICROCHIP'S
+ * PRODUCTS, COMBINATION WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION.
+ *
+ * YOU ACKNOWLEDGE AND AGREE THAT, IN NO EVENT, SHALL MICROCHIP BE LIABLE,
+ * WHETHER IN CONTRACT, WARRANTY, TORT (INCLUDING NEGLIGENCE OR BREACH OF
+ * STATUTORY DUTY),STRICT LIABILITY, INDEMNITY, CONTRIBUTION, OR OTHERWISE,
+ * FOR ANY INDIRECT, SPECIAL,PUNITIVE, EXEMPLARY, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, FOR COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE CODE,
+ * HOWSOEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE POSSIBILITY OR
+ * THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT ALLOWABLE BY LAW,
+ * MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY RELATED TO THIS CODE,
+ * SHALL NOT EXCEED THE PRICE YOU PAID DIRECTLY TO MICROCHIP SPECIFICALLY TO
+ * HAVE THIS CODE DEVELOPED.
+ *
+ * You agree that you are solely responsible for testing the code and
+ * determining its suitability.  Microchip has no obligation to modify, test,
+ * certify, or support the code.
+ *
+ *******************************************************************************/
+#include <stdint.h>
+#include "flashlog.h"
+#include "flash.h"
+#include "pwm.h"
+
+/* Program flash reserved for the log, not loaded by the programmer */
+static const uint16_t flashLogArea[FLASHLOG_PAGES*FLASH_PAGE_INSTRUCTIONS]
+    __attribute__((space(prog),aligned(FLASH_PAGE_SIZE),noload));
+
+static uint16_t FlashLog_RecordRead(FLASHLOG_T *,uint16_t,FLASHLOG_RECORD_T *);
+static void FlashLog_RecordWrite(FLASHLOG_T *);
+static uint16_t FlashLog_Checksum(const uint16_t *);
+
+// *****************************************************************************
+/* Function:
+    FlashLogInitialize()
+
+  Summary:
+    Restores the log from the program flash
+
+  Description:
+    The valid record with the latest sequence number is searched, its 
+    statistics are restored and the next record is written after it.
+
+  Precondition:
+    None.
+
+  Parameters:
+    pLog - Flash log data
+
+  Returns:
+    None.
+
+  Remarks:
+    Called at power up.
+ */
+void FlashLogInitialize(FLASHLOG_T *pLog)
+{
+    FLASHLOG_RECORD_T record;
+    uint16_t latest = FLASHLOG_RECORDS;
+    uint16_t i;
+    
+    pLog->address = __builtin_tbladdress(flashLogArea);
+    for (i = 0; i < FLASHLOG_RECORDS; i++)
+    {
+        if (FlashLog_RecordRead(pLog,i,&record))
+        {
+            if ((latest == FLASHLOG_RECORDS) || 
+                ((int16_t)(record.sequence - pLog->record.sequence) > 0))
+            {
+                pLog->record = record;
+                latest = i;
+            }
+        }
+    }
+    if (latest == FLASHLOG_RECORDS)
+    {
+        /* Empty log, the first record is sequence 0 */
+        pLog->record.sequence = FLASHLOG_SEQUENCE_ERASED;
+        pLog->record.event = FLASHLOG_EVENT_NONE;
+        pLog->record.gateDriverStatus = 0;
+        pLog->record.startCount = 0;
+        pLog->record.runSeconds = 0;
+        pLog->record.peakTemperature = FLASHLOG_TEMPERATURE_NONE;
+        pLog->nextRecord = 0;
+    }
+    else
+    {
+        pLog->nextRecord = latest + 1;
+        if (pLog->nextRecord >= FLASHLOG_RECORDS)
+        {
+            pLog->nextRecord = 0;
+        }
+    }
+    for (i = 0; i < FLASHLOG_EVENTS; i++)
+    {
+        pLog->eventCount[i] = 0;
+        pLog->eventLogged[i] = 0;
+    }
+    pLog->changed = 0;
+    pLog->running = 0;
+    pLog->runCycles = 0;
+}
+// *****************************************************************************
+/* Function:
+    FlashLogEvent()
+
+  Summary:
+    Counts a fault event
+
+  Description:
+    The event is written to the log by FlashLogService() once the motor is
+    stopped.
+
+  Precondition:
+    None.
+
+  Parameters:
+    pLog  - Flash log data
+    event - FLASHLOG_EVENT_xxx
+
+  Returns:
+    None.
+
+  Remarks:
+    Called from the interrupts, repeated events of a kind are written as 
+    one record each.
+ */
+void FlashLogEvent(FLASHLOG_T *pLog,uint16_t event)
+{
+    pLog->eventCount[event]++;
+}
+// *****************************************************************************
+/* Function:
+    FlashLogRunStep()
+
+  Summary:
+    Counts the run time of the motor
+
+  Description:
+    The control cycles are counted up to one second of the present PWM 
+    frequency.
+
+  Precondition:
+    None.
+
+  Parameters:
+    pLog - Flash log data
+
+  Returns:
+    None.
+
+  Remarks:
+    Called every control cycle while the motor runs.
+ */
+void FlashLogRunStep(FLASHLOG_T *pLog)
+{
+    pLog->runCycles++;
+    if (pLog->runCycles >= pwmTiming.frequency)
+    {
+        pLog->runCycles = 0;
+        pLog->record.runSeconds++;
+    }
+}
+// *****************************************************************************
+/* Function:
+    FlashLogStart()
+
+  Summary:
+    Counts a start of the motor
+
+  Description:
+    None.
+
+  Precondition:
+    None.
+
+  Parameters:
+    pLog - Flash log data
+
+  Returns:
+    None.
+
+  Remarks:
+    Called from the main loop when the motor is started.
+ */
+void FlashLogStart(FLASHLOG_T *pLog)
+{
+    pLog->record.startCount++;
+    pLog->changed = 1;
+}
+// *****************************************************************************
+/* Function:
+    FlashLogTemperature()
+
+  Summary:
+    Updates the peak temperature
+
+  Description:
+    None.
+
+  Precondition:
+    None.
+
+  Parameters:
+    pLog        - Flash log data
+    temperature - MOSFET temperature in degC
+
+  Returns:
+    None.
+
+  Remarks:
+    Called from the main loop, the peak is written with the next record.
+ */
+void FlashLogTemperature(FLASHLOG_T *pLog,int16_t temperature)
+{
+    if (temperature > pLog->record.peakTemperature)
+    {
+        pLog->record.peakTemperature = temperature;
+    }
+}
+// *****************************************************************************
+/* Function:
+    FlashLogService()
+
+  Summary:
+    Writes the pending records to the log
+
+  Description:
+    While the motor is stopped one record is written per call: the oldest
+    kind of event not yet written, or the statistics when the motor has 
+    stopped or was started since the last record.
+
+  Precondition:
+    FlashLogInitialize() is called.
+
+  Parameters:
+    pLog             - Flash log data
+    running          - 1 when the motor runs
+    gateDriverStatus - Last gate driver status0Data (high byte) and 
+                       status1Data (low byte)
+
+  Returns:
+    None.
+
+  Remarks:
+    Called from the main loop. Nothing is written while the motor runs, the
+    CPU and the control interrupt stall while the flash is programmed.
+ */
+void FlashLogService(FLASHLOG_T *pLog,uint16_t running,
+                     uint16_t gateDriverStatus)
+{
+    uint16_t event;
+    
+    if (running)
+    {
+        pLog->running = 1;
+        return;
+    }
+    if (pLog->running)
+    {
+        pLog->running = 0;
+        pLog->changed = 1;
+    }
+    for (event = FLASHLOG_EVENT_NONE + 1; event < FLASHLOG_EVENTS; event++)
+    {
+        if (pLog->eventLogged[event] != pLog->eventCount[event])
+        {
+            pLog->eventLogged[event]++;
+            break;
+        }
+    }
+    if (event == FLASHLOG_EVENTS)
+    {
+        if (pLog->changed == 0)
+        {
+            return;
+        }
+        event = FLASHLOG_EVENT_NONE;
+    }
+    pLog->record.sequence++;
+    if (pLog->record.sequence == FLASHLOG_SEQUENCE_ERASED)
+    {
+        pLog->record.sequence = 0;
+    }
+    pLog->record.event = event;
+    pLog->record.gateDriverStatus = gateDriverStatus;
+    FlashLog_RecordWrite(pLog);
+    pLog->changed = 0;
+}
+// *****************************************************************************
+/* Function:
+    FlashLog_RecordRead()
+
+  Summary:
+    Reads a record from the log
+
+  Description:
+    A record is valid if its checksum matches, erased records and records 
+    interrupted by a reset are invalid.
+
+  Precondition:
+    None.
+
+  Parameters:
+    pLog    - Flash log data
+    index   - Record, 0 to FLASHLOG_RECORDS-1
+    pRecord - Record read
+
+  Returns:
+    1 if the record is valid, 0 otherwise.
+
+  Remarks:
+    None.
+ */
+static uint16_t FlashLog_RecordRead(FLASHLOG_T *pLog,uint16_t index,
+                                    FLASHLOG_RECORD_T *pRecord)
+{
+    uint16_t word[FLASHLOG_RECORD_WORDS];
+    uint32_t address = pLog->address + 
+                       (uint32_t)index*(FLASHLOG_RECORD_WORDS*2);
+    uint16_t i;
+    
+    for (i = 0; i < FLASHLOG_RECORD_WORDS; i++)
+    {
+        word[i] = FLASH_WordRead(address + i*2);
+    }
+    if ((word[0] == FLASHLOG_SEQUENCE_ERASED) || 
+        (word[FLASHLOG_RECORD_WORDS-1] != FlashLog_Checksum(word)))
+    {
+        return 0;
+    }
+    pRecord->sequence = word[0];
+    pRecord->event = word[1];
+    pRecord->gateDriverStatus = word[2];
+    pRecord->startCount = word[3];
+    pRecord->runSeconds = ((uint32_t)word[5] << 16) | word[4];
+    pRecord->peakTemperature = (int16_t)word[6];
+    return 1;
+}
+// *****************************************************************************
+/* Function:
+    FlashLog_RecordWrite()
+
+  Summary:
+    Writes the record in RAM to the log
+
+  Description:
+    The records are written in sequence through the pages, a page is 
+    erased when its first record is written, so the wear is spread over 
+    all pages and the previous page holds the older records. Records left
+    programmed by a reset during a write are skipped.
+
+  Precondition:
+    None.
+
+  Parameters:
+    pLog - Flash log data
+
+  Returns:
+    None.
+
+  Remarks:
+    The CPU stalls during the page erase and programming.
+ */
+static void FlashLog_RecordWrite(FLASHLOG_T *pLog)
+{
+    uint16_t word[FLASHLOG_RECORD_WORDS];
+    uint32_t address;
+    uint16_t i;
+    
+    while (1)
+    {
+        address = pLog->address + 
+                  (uint32_t)pLog->nextRecord*(FLASHLOG_RECORD_WORDS*2);
+        if ((pLog->nextRecord % FLASHLOG_PAGE_RECORDS) == 0)
+        {
+            FLASH_PageErase(address);
+            break;
+        }
+        for (i = 0; i < FLASHLOG_RECORD_WORDS; i++)
+        {
+            if (FLASH_WordRead(address + i*2) != 0xFFFF)
+            {
+                break;
+            }
+        }
+        if (i == FLASHLOG_RECORD_WORDS)
+        {
+            break;
+        }
+        pLog->nextRecord++;
+        if (pLog->nextRecord >= FLASHLOG_RECORDS)
+        {
+            pLog->nextRecord = 0;
+        }
+    }
+    
+    word[0] = pLog->record.sequence;
+    word[1] = pLog->record.event;
+    word[2] = pLog->record.gateDriverStatus;
+    word[3] = pLog->record.startCount;
+    word[4] = (uint16_t)pLog->record.runSeconds;
+    word[5] = (uint16_t)(pLog->record.runSeconds >> 16);
+    word[6] = (uint16_t)pLog->record.peakTemperature;
+    word[7] = FlashLog_Checksum(word);
+    for (i = 0; i < FLASHLOG_RECORD_WORDS; i += 2)
+    {
+        FLASH_DoubleWordWrite(address + i*2,word[i],word[i+1]);
+    }
+    
+    pLog->nextRecord++;
+    if (pLog->nextRecord >= FLASHLOG_RECORDS)
+    {
+        pLog->nextRecord = 0;
+    }
+}
+// *****************************************************************************
+/* Function:
+    FlashLog_Checksum()
+
+  Summary:
+    Checksum of a record
+
+  Description:
+    Complement of the sum of the data words, the last word of the record.
+
+  Precondition:
+    None.
+
+  Parameters:
+    pWord - Words of the record
+
+  Returns:
+    Checksum.
+
+  Remarks:
+    None.
+ */
+static uint16_t FlashLog_Checksum(const uint16_t *pWord)
+{
+    uint16_t sum = 0;
+    uint16_t i;
+    
+    for (i = 0; i < FLASHLOG_RECORD_WORDS - 1; i++)
+    {
+        sum += pWord[i];
+    }
+    return ~sum;
+}
@@ -0,0 +1,128 @@
+/*******************************************************************************
+* Copyright (c) 2017 released Microchip Technology Inc.  All rights reserved.
+*
+* SOFTWARE LICENSE AGREEMENT:
+* 
+* Microchip Technology Incorporated ("Microchip") retains all ownership and
+* intellectual property rights in the code accompanying this message and in all
+* derivatives hereto.  You may use this code, and any derivatives created by
+* any person or entity by or on your behalf, exclusively with Microchip's
+* proprietary products.  Your acceptance and/or use of this code constitutes
+* agreement to the terms and conditions of this notice.
+*
+* CODE ACCOMPANYING THIS MESSAGE IS SUPPLIED BY MICROCHIP "AS IS".  NO
+* WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
+* TO, IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE APPLY TO THIS CODE, ITS INTERACTION WITH MICROCHIP'S
+* PRODUCTS, COMBINATION WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION.
+*
+* YOU ACKNOWLEDGE AND AGREE THAT, IN NO EVENT, SHALL MICROCHIP BE LIABLE,
+* WHETHER IN CONTRACT, WARRANTY, TORT (INCLUDING NEGLIGENCE OR BREACH OF
+* STATUTORY DUTY),STRICT LIABILITY, INDEMNITY, CONTRIBUTION, OR OTHERWISE,
+* FOR ANY INDIRECT, SPECIAL,PUNITIVE, EXEMPLARY, INCIDENTAL OR CONSEQUENTIAL
+* LOSS, DAMAGE, FOR COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE CODE,
+* HOWSOEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE POSSIBILITY OR
+* THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT ALLOWABLE BY LAW,
+* MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY RELATED TO THIS CODE,
+* SHALL NOT EXCEED THE PRICE YOU PAID DIRECTLY TO MICROCHIP SPECIFICALLY TO
+* HAVE THIS CODE DEVELOPED.
+*
+* You agree that you are solely responsible for testing the code and
+* determining its suitability.  Microchip has no obligation to modify, test,
+* certify, or support the code.
+*
+*******************************************************************************/
+#ifndef __FLASHLOG_H
+#define __FLASHLOG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "flash.h"
+
+/* Pages of program flash used alternately by the log */
+#define FLASHLOG_PAGES              2
+/* Record of 8 instruction words (16 bit data each), 128 records per page */
+#define FLASHLOG_RECORD_WORDS       8
+#define FLASHLOG_PAGE_RECORDS       (FLASH_PAGE_INSTRUCTIONS/ \
+                                     FLASHLOG_RECORD_WORDS)
+#define FLASHLOG_RECORDS            (FLASHLOG_PAGES*FLASHLOG_PAGE_RECORDS)
+/* Sequence number of an erased record */
+#define FLASHLOG_SEQUENCE_ERASED    0xFFFF
+
+/* Events. A record without event saves the statistics after the motor 
+   stops */
+#define FLASHLOG_EVENT_NONE         0
+#define FLASHLOG_EVENT_PWM_FAULT    1
+#define FLASHLOG_EVENT_GATE_DRIVER  2
+#define FLASHLOG_EVENT_STALL        3
+#define FLASHLOG_EVENTS             4
+
+/* Peak temperature without temperature measurement */
+#define FLASHLOG_TEMPERATURE_NONE   INT16_MIN
+
+/* Flash Log Record data type
+
+  Description:
+    This structure will host a record of the log. Every record holds the 
+    statistics at the time it was written, so only the last record is 
+    needed to restore them.
+ */
+typedef struct
+{
+    /* Incremented with every record written, FLASHLOG_SEQUENCE_ERASED is 
+       skipped */
+    uint16_t sequence;
+    /* FLASHLOG_EVENT_xxx */
+    uint16_t event;
+    /* Gate driver status0Data (high byte) and status1Data (low byte) */
+    uint16_t gateDriverStatus;
+    /* Motor starts */
+    uint16_t startCount;
+    /* Run time of the motor in seconds */
+    uint32_t runSeconds;
+    /* Highest MOSFET temperature in degC */
+    int16_t peakTemperature;
+} FLASHLOG_RECORD_T;
+
+/* Flash Log data type
+
+  Description:
+    This structure will host the log of the fault events and run time 
+    statistics in program flash. The events are set by the interrupts and
+    the records are written by the main loop while the motor is stopped, 
+    the CPU stalls while the flash is programmed.
+ */
+typedef struct
+{
+    /* Program memory address of the log */
+    uint32_t address;
+    /* Record to be written next */
+    uint16_t nextRecord;
+    /* Statistics and event of the last record, updated in RAM */
+    FLASHLOG_RECORD_T record;
+    /* Events since power up, counted by the interrupts, and events 
+       written to the log */
+    volatile uint16_t eventCount[FLASHLOG_EVENTS];
+    uint16_t eventLogged[FLASHLOG_EVENTS];
+    /* Statistics changed since the last record */
+    uint16_t changed;
+    uint16_t running;
+    /* Control cycles of the present second */
+    uint16_t runCycles;
+} FLASHLOG_T;
+
+void FlashLogInitialize(FLASHLOG_T *);
+void FlashLogEvent(FLASHLOG_T *,uint16_t);
+void FlashLogRunStep(FLASHLOG_T *);
+void FlashLogStart(FLASHLOG_T *);
+void FlashLogTemperature(FLASHLOG_T *,int16_t);
+void FlashLogService(FLASHLOG_T *,uint16_t,uint16_t);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FLASHLOG_H */
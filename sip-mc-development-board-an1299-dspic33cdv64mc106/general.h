@@ -45,6 +45,21 @@ extern "C" {
 ((Float_Value < 0.0) ? (int16_t)(32768 * (Float_Value) - 0.5) \
 : (int16_t)(32767 * (Float_Value) + 0.5))
 
+/* Limits a 32 bit value to the Q15 range -32767 to 32767, symmetric so the
+   result can be negated */
+inline static int16_t SaturateQ15(int32_t value)
+{
+    if (value > 32767)
+    {
+        return 32767;
+    }
+    else if (value < -32767)
+    {
+        return -32767;
+    }
+    return (int16_t)value;
+}
+
 #ifdef __cplusplus  // Provide C++ Compatibility
     }
 #endif
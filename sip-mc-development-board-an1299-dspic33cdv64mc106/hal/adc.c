@@ -63,6 +63,7 @@
 // *****************************************************************************
 // *****************************************************************************
 void InitializeADCs(void);
+void ADCConfigureCurrentSensing(uint16_t);
 // *****************************************************************************
 /* Function:
     void InitializeADCs (void)
@@ -158,6 +159,10 @@ void InitializeADCs (void)
     ADMOD0Lbits.SIGN0 = 1;
     ADMOD0Lbits.SIGN1 = 1;
     ADMOD0Lbits.SIGN4 = 1;
+#if defined(SINGLE_SHUNT_OVERSAMPLING) || defined(CURRENT_OFFSET_TRACKING)
+    /* AN7 converts the bus current, signed as AN1 */
+    ADMOD0Lbits.SIGN7 = 1;
+#endif
    
     /*ADMOD0H configures Output Data Sign for Analog inputs  AN8 to AN15 */
     ADMOD0H = 0;   
@@ -208,43 +213,109 @@ void InitializeADCs (void)
    
  
     
-#ifdef SINGLE_SHUNT    
+    /* Single shunt interrupt */
      _IE1        = 1 ;
     /* Clear ADC interrupt flag */
     _ADCAN1IF    = 0 ;  
     /* Set ADC interrupt priority IPL 7  */ 
     _ADCAN1IP   = 7 ;  
-    /* Disable the AN4 interrupt  */
+    /* Disable the AN1 interrupt  */
     _ADCAN1IE    = 0 ;
      
-#else         
+    /* Dual shunt interrupt */
     _IE15        = 1 ;
     /* Clear ADC interrupt flag */
     _ADCAN15IF    = 0 ;  
     /* Set ADC interrupt priority IPL 7  */ 
     _ADCAN15IP   = 7 ;  
-    /* Disable the AN1 interrupt  */
+    /* Disable the AN15 interrupt  */
     _ADCAN15IE    = 0 ; 
-#endif
     
     /* Trigger Source Selection for Corresponding Analog Inputs bits 
-     *  00101 = PMW1 Trigger 2
+     *  00111 = PMW2 Trigger 2
+        00101 = PMW1 Trigger 2
         00100 = PMW1 Trigger 1
         00001 = Common software trigger
         00000 = No trigger is enabled  */
     
 
-#ifdef SINGLE_SHUNT
-    /* Trigger Source for Analog Input #0  = 0b0101 */
-    ADTRIG0Lbits.TRGSRC1 = 0x5;
-#else
-      /* Trigger Source for Analog Input #1  = 0b0100 */
-    ADTRIG0Lbits.TRGSRC0 = 0x4;
-    /* Trigger Source for Analog Input #4  = 0b0100 */
-    ADTRIG1Lbits.TRGSRC4 = 0x4;  
-#endif
+    /* Current inputs are triggered as per the current sensing mode */
+    ADCConfigureCurrentSensing(CURRENT_SENSING_DEFAULT);
     ADTRIG3Lbits.TRGSRC12 = 0x4;
+#ifdef MOSFET_TEMPERATURE_DERATING
+    /* Trigger Source for Analog Input #3  = 0b0100 */
+    ADTRIG0Hbits.TRGSRC3 = 0x4;
+#endif
     /* Trigger Source for Analog Input #15  = 0b0100 */
     ADTRIG3Hbits.TRGSRC15 = 0x4;
    
 }
+// *****************************************************************************
+/* Function:
+    ADCConfigureCurrentSensing()
+
+  Summary:
+    Routine to select the trigger sources of the current inputs
+
+  Description:
+    Single shunt converts the bus current (AN1) on PWM1 Trigger 2, 
+    dual shunt converts the phase currents (AN0,AN4) on PWM1 Trigger 1.
+    With DOUBLE_UPDATE dual shunt also converts AN1 on PWM1 Trigger 2 at the
+    PWM peak, only its interrupt is used.
+    With CURRENT_OFFSET_TRACKING single shunt also converts AN7 on PWM1 
+    Trigger 1, in the zero vector at the PWM valley.
+    The inputs of the other mode are not triggered, so they do not 
+    occupy the shared core.
+
+  Precondition:
+    ADC interrupts are disabled (motor stopped).
+
+  Parameters:
+    mode - CURRENT_SENSING_SINGLE_SHUNT or CURRENT_SENSING_DUAL_SHUNT
+
+  Returns:
+    None.
+
+  Remarks:
+    None.
+ */
+void ADCConfigureCurrentSensing(uint16_t mode)
+{
+    if (mode == CURRENT_SENSING_SINGLE_SHUNT)
+    {
+        /* Trigger Source for Analog Input #0  = 0b0000 */
+        ADTRIG0Lbits.TRGSRC0 = 0x0;
+        /* Trigger Source for Analog Input #4  = 0b0000 */
+        ADTRIG1Lbits.TRGSRC4 = 0x0;  
+        /* Trigger Source for Analog Input #1  = 0b0101 */
+        ADTRIG0Lbits.TRGSRC1 = 0x5;
+#ifdef SINGLE_SHUNT_OVERSAMPLING
+        /* Trigger Source for Analog Input #7  = 0b0111 (PWM2 Trigger 2)
+           AN7 is converted ahead of AN1 in each window, so the AN1 interrupt 
+           finds both results ready */
+        ADTRIG1Hbits.TRGSRC7 = 0x7;
+#elif defined(CURRENT_OFFSET_TRACKING)
+        /* Trigger Source for Analog Input #7  = 0b0100 (PWM1 Trigger 1)
+           AN7 converts the bus current in the zero vector at the PWM valley
+           for the offset tracking */
+        ADTRIG1Hbits.TRGSRC7 = 0x4;
+#endif
+    }
+    else
+    {
+#ifdef DOUBLE_UPDATE
+        /* Trigger Source for Analog Input #1  = 0b0101, the conversion at
+           the PWM peak interrupts the second control step */
+        ADTRIG0Lbits.TRGSRC1 = 0x5;
+#else
+        /* Trigger Source for Analog Input #1  = 0b0000 */
+        ADTRIG0Lbits.TRGSRC1 = 0x0;
+#endif
+        /* Trigger Source for Analog Input #7  = 0b0000 */
+        ADTRIG1Hbits.TRGSRC7 = 0x0;
+        /* Trigger Source for Analog Input #0  = 0b0100 */
+        ADTRIG0Lbits.TRGSRC0 = 0x4;
+        /* Trigger Source for Analog Input #4  = 0b0100 */
+        ADTRIG1Lbits.TRGSRC4 = 0x4;  
+    }
+}
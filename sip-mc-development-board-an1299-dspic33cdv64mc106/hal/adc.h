@@ -69,29 +69,35 @@
 #define ADCBUF_INV_A_IPHASE1    (int16_t)(-ADCBUF0)
 #define ADCBUF_INV_A_IPHASE2    (int16_t)(-ADCBUF4)
 #define ADCBUF_INV_A_IBUS       (int16_t)(ADCBUF1)
+/* Second conversion of the bus current (AN7 shares the pin with AN1) */
+#define ADCBUF_INV_A_IBUS_OVS   (int16_t)(ADCBUF7)
         
 #define ADCBUF_SPEED_REF_A      ADCBUF15
 #define ADCBUF_VBUS_A           ADCBUF12
+/* MOSFET temperature sensor on RA3 (AN3), unsigned. ANSELA3 (port_config.c)
+   and TRGSRC3 (adc.c) select the same input, change them together */
+#define ADCBUF_MOSFET_TEMP_A    ADCBUF3
 
 
 /* This defines number of current offset samples for averaging 
  * If the 2^n samples are considered specify n(in this case 2^7(= 128)=> 7*/
 #define  CURRENT_OFFSET_SAMPLE_SCALER         7
-#ifdef SINGLE_SHUNT       
-#define EnableADCInterrupt()   _ADCAN1IE = 1
-#define DisableADCInterrupt()  _ADCAN1IE = 0
-#define ClearADCIF()           _ADCAN1IF = 0
-#define ClearADCIF_ReadADCBUF() ADCBUF1
+/* Single shunt : AN1 (bus current) interrupt, twice every PWM cycle */
+#define EnableADCInterruptSingleShunt()     _ADCAN1IE = 1
+#define ClearADCIFSingleShunt()             _ADCAN1IF = 0
+#define ClearADCIF_ReadADCBUFSingleShunt()  ADCBUF1
         
-#define _ADCInterrupt _ADCAN1Interrupt  
-#else
-#define EnableADCInterrupt()   _ADCAN15IE = 1
-#define DisableADCInterrupt()  _ADCAN15IE = 0
-#define ClearADCIF()           _ADCAN15IF = 0
-#define ClearADCIF_ReadADCBUF() ADCBUF15
+#define _ADCInterruptSingleShunt _ADCAN1Interrupt  
+
+/* Dual shunt : AN15 interrupt, once every PWM cycle */
+#define EnableADCInterruptDualShunt()       _ADCAN15IE = 1
+#define ClearADCIFDualShunt()               _ADCAN15IF = 0
+#define ClearADCIF_ReadADCBUFDualShunt()    ADCBUF15
         
-#define _ADCInterrupt _ADCAN15Interrupt  
-#endif
+#define _ADCInterruptDualShunt _ADCAN15Interrupt  
+
+/* Only the interrupt of the active current sensing mode is enabled */
+#define DisableADCInterrupt()  {_ADCAN1IE = 0; _ADCAN15IE = 0;}
         
 // *****************************************************************************
 // *****************************************************************************
@@ -99,6 +105,7 @@
 // *****************************************************************************
 // *****************************************************************************
 void InitializeADCs(void);
+void ADCConfigureCurrentSensing(uint16_t);
 
 #ifdef __cplusplus  // Provide C++ Compatibility
     }
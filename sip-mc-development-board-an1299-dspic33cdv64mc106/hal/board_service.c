@@ -61,6 +61,9 @@ bool IsPressed_Button2(void);
 void PWMDutyCycleSetDualEdge(MC_DUTYCYCLEOUT_T *,MC_DUTYCYCLEOUT_T *);
 void PWMDutyCycleSet(MC_DUTYCYCLEOUT_T *);
 void pwmDutyCycleLimitCheck(MC_DUTYCYCLEOUT_T *,uint16_t,uint16_t);
+#ifdef DISCONTINUOUS_PWM
+static uint16_t pwmDutyCycleLimitClamped(uint16_t,uint16_t,uint16_t);
+#endif
 
 static void ButtonGroupInitialize(void);
 static void ButtonScan(BUTTON_T * ,bool);
@@ -277,20 +280,30 @@ void ClearPWMPCIFaultInverterA(void)
 
 void PWMDutyCycleSet(MC_DUTYCYCLEOUT_T *pPwmDutycycle)
 {
-    pwmDutyCycleLimitCheck(pPwmDutycycle,(DEADTIME>>1),(LOOPTIME_TCY - (DEADTIME>>1)));  
+#ifdef DISCONTINUOUS_PWM
+    /* Phase clamped by the discontinuous PWM does not switch */
+    pPwmDutycycle->dutycycle1 = pwmDutyCycleLimitClamped(
+        pPwmDutycycle->dutycycle1,(DEADTIME>>1),(pwmTiming.loopTimeTcy - (DEADTIME>>1)));
+    pPwmDutycycle->dutycycle2 = pwmDutyCycleLimitClamped(
+        pPwmDutycycle->dutycycle2,(DEADTIME>>1),(pwmTiming.loopTimeTcy - (DEADTIME>>1)));
+    pPwmDutycycle->dutycycle3 = pwmDutyCycleLimitClamped(
+        pPwmDutycycle->dutycycle3,(DEADTIME>>1),(pwmTiming.loopTimeTcy - (DEADTIME>>1)));
+#else
+    pwmDutyCycleLimitCheck(pPwmDutycycle,(DEADTIME>>1),(pwmTiming.loopTimeTcy - (DEADTIME>>1)));  
+#endif
     INVERTERA_PWM_PDC3 = pPwmDutycycle->dutycycle3;
     INVERTERA_PWM_PDC2 = pPwmDutycycle->dutycycle2;
     INVERTERA_PWM_PDC1 = pPwmDutycycle->dutycycle1;
 }
 void PWMDutyCycleSetDualEdge(MC_DUTYCYCLEOUT_T *pPwmDutycycle1,MC_DUTYCYCLEOUT_T *pPwmDutycycle2)
 {
-    pwmDutyCycleLimitCheck(pPwmDutycycle1,(DEADTIME>>1),(LOOPTIME_TCY - (DEADTIME>>1)));
+    pwmDutyCycleLimitCheck(pPwmDutycycle1,(DEADTIME>>1),(pwmTiming.loopTimeTcy - (DEADTIME>>1)));
     
     INVERTERA_PWM_PHASE3 = pPwmDutycycle1->dutycycle3 + (DEADTIME>>1);
     INVERTERA_PWM_PHASE2 = pPwmDutycycle1->dutycycle2 + (DEADTIME>>1);
     INVERTERA_PWM_PHASE1 = pPwmDutycycle1->dutycycle1 + (DEADTIME>>1);
     
-    pwmDutyCycleLimitCheck(pPwmDutycycle2,(DEADTIME>>1),(LOOPTIME_TCY - (DEADTIME>>1)));
+    pwmDutyCycleLimitCheck(pPwmDutycycle2,(DEADTIME>>1),(pwmTiming.loopTimeTcy - (DEADTIME>>1)));
     
     INVERTERA_PWM_PDC3 = pPwmDutycycle2->dutycycle3 - (DEADTIME>>1);
     INVERTERA_PWM_PDC2 = pPwmDutycycle2->dutycycle2 - (DEADTIME>>1);
@@ -324,4 +337,28 @@ void pwmDutyCycleLimitCheck (MC_DUTYCYCLEOUT_T *pPwmDutycycle,uint16_t min,uint1
     {
         pPwmDutycycle->dutycycle3 = max;
     }
-}
\ No newline at end of file
+}
+#ifdef DISCONTINUOUS_PWM
+/* Limits the duty cycle to min - max except at the rails: 0 keeps the low 
+   side on and the period keeps the high side on for the whole PWM cycle */
+static uint16_t pwmDutyCycleLimitClamped(uint16_t duty,uint16_t min,uint16_t max)
+{
+    if (duty == 0)
+    {
+        return 0;
+    }
+    else if (duty >= pwmTiming.loopTimeTcy)
+    {
+        return pwmTiming.loopTimeTcy + 1;
+    }
+    else if (duty < min)
+    {
+        return min;
+    }
+    else if (duty > max)
+    {
+        return max;
+    }
+    return duty;
+}
+#endif
@@ -0,0 +1,159 @@
+// <editor-fold defaultstate="collapsed" desc="Description/Instruction ">
+/**
+ * flash.c
+ *
+ * This file includes subroutines for erasing, programming and reading the 
+ * program flash memory at run time (RTSP). Only the lower 16 bits of the 
+ * instruction words are used for data.
+ * 
+ * Definitions in this file are for dsPIC33CDV64MC106.
+ * 
+ * Component: HAL - FLASH
+ * 
+ */
+// </editor-fold>
+
+// <editor-fold defaultstate="collapsed" desc="Disclaimer ">
+/*******************************************************************************
+* Copyright (c) 2017 released Microchip Technology Inc.  All rights reserved.
+*
+* SOFTWARE LICENSE AGREEMENT:
+* 
+* Microchip Technology Incorporated ("Microchip") retains all ownership and
+* intellectual property rights in the code accompanying this message and in all
+* derivatives hereto.  You may use this code, and any derivatives created by
+* any person or entity by or on your behalf, exclusively with Microchip's
+* proprietary products.  Your acceptance and/or use of this code constitutes
+* agreement to the terms and conditions of this notice.
+*
+* CODE ACCOMPANYING THIS MESSAGE IS SUPPLIED BY MICROCHIP "AS IS".  NO
+* WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
+* TO, IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE APPLY TO THIS CODE, ITS INTERACTION WITH MICROCHIP'S
+* PRODUCTS, COMBINATION WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION.
+*
+* YOU ACKNOWLEDGE AND AGREE THAT, IN NO EVENT, SHALL MICROCHIP BE LIABLE,
+* WHETHER IN CONTRACT, WARRANTY, TORT (INCLUDING NEGLIGENCE OR BREACH OF
+* STATUTORY DUTY),STRICT LIABILITY, INDEMNITY, CONTRIBUTION, OR OTHERWISE,
+* FOR ANY INDIRECT, SPECIAL,PUNITIVE, EXEMPLARY, INCIDENTAL OR CONSEQUENTIAL
+* LOSS, DAMAGE, FOR COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE CODE,
+* HOWSOEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE POSSIBILITY OR
+* THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT ALLOWABLE BY LAW,
+* MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY RELATED TO THIS CODE,
+* SHALL NOT EXCEED THE PRICE YOU PAID DIRECTLY TO MICROCHIP SPECIFICALLY TO
+* HAVE THIS CODE DEVELOPED.
+*
+* You agree that you are solely responsible for testing the code and
+* determining its suitability.  Microchip has no obligation to modify, test,
+* certify, or support the code.
+*
+*******************************************************************************/
+// </editor-fold>
+
+// <editor-fold defaultstate="collapsed" desc="Header Files ">
+
+#ifdef __XC16__  // See comments at the top of this header file
+    #include <xc.h>
+#endif // __XC16__
+
+#include <stdint.h>
+#include "flash.h"
+
+// </editor-fold> 
+
+// <editor-fold defaultstate="collapsed" desc="DEFINITIONS ">
+
+/* NVMCON operations with WREN set */
+#define FLASH_NVMOP_DOUBLE_WORD     0x4001
+#define FLASH_NVMOP_PAGE_ERASE      0x4003
+/* Table page of the write latches */
+#define FLASH_WRITE_LATCH_PAGE      0xFA
+
+// </editor-fold> 
+
+// <editor-fold defaultstate="collapsed" desc="FUNCTION DECLARATIONS ">
+static void FLASH_OperationStart(uint16_t,uint32_t);
+
+// </editor-fold> 
+
+/**
+ * Function to erase a page of the program flash
+ * @param address Program memory address of the page, aligned to 
+ *        FLASH_PAGE_SIZE
+ * @return None.
+ * @example
+ * <code>
+ * FLASH_PageErase(address);
+ * </code>
+ */
+void FLASH_PageErase(uint32_t address)
+{
+    FLASH_OperationStart(FLASH_NVMOP_PAGE_ERASE,address);
+}
+/**
+ * Function to program two instruction words, the upper bytes are left 
+ * erased
+ * @param address Program memory address, aligned to FLASH_DOUBLE_WORD_SIZE
+ * @param data0 Lower 16 bits of the first instruction word
+ * @param data1 Lower 16 bits of the second instruction word
+ * @return None.
+ * @example
+ * <code>
+ * FLASH_DoubleWordWrite(address,data0,data1);
+ * </code>
+ */
+void FLASH_DoubleWordWrite(uint32_t address,uint16_t data0,uint16_t data1)
+{
+    uint16_t tblpag = TBLPAG;
+    
+    /** Load the write latches */
+    TBLPAG = FLASH_WRITE_LATCH_PAGE;
+    __builtin_tblwtl(0,data0);
+    __builtin_tblwth(0,0x00FF);
+    __builtin_tblwtl(2,data1);
+    __builtin_tblwth(2,0x00FF);
+    TBLPAG = tblpag;
+    
+    FLASH_OperationStart(FLASH_NVMOP_DOUBLE_WORD,address);
+}
+/**
+ * Function to read the lower 16 bits of an instruction word
+ * @param address Program memory address
+ * @return Lower 16 bits of the instruction word.
+ * @example
+ * <code>
+ * data = FLASH_WordRead(address);
+ * </code>
+ */
+uint16_t FLASH_WordRead(uint32_t address)
+{
+    uint16_t tblpag = TBLPAG;
+    uint16_t data;
+    
+    TBLPAG = (uint16_t)(address >> 16);
+    data = __builtin_tblrdl((uint16_t)address);
+    TBLPAG = tblpag;
+    return data;
+}
+/**
+ * Function to start a flash operation and wait for its end
+ * @param operation NVMCON value of the operation
+ * @param address Program memory address
+ * @return None.
+ * @example
+ * <code>
+ * FLASH_OperationStart(FLASH_NVMOP_PAGE_ERASE,address);
+ * </code>
+ */
+static void FLASH_OperationStart(uint16_t operation,uint32_t address)
+{
+    NVMCON = operation;
+    NVMADRU = (uint16_t)(address >> 16);
+    NVMADR = (uint16_t)address;
+    /** Unlock sequence and start, the CPU stalls until the operation ends */
+    __builtin_write_NVM();
+    while (NVMCONbits.WR)
+    {
+    }
+    NVMCON = 0;
+}
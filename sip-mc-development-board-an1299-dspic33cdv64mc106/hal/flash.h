@@ -0,0 +1,90 @@
+// <editor-fold defaultstate="collapsed" desc="Description/Instruction ">
+/**
+ * flash.h
+ *
+ * This header file lists interface functions - erasing, programming and 
+ * reading the program flash memory at run time (RTSP)
+ * 
+ * Definitions in this file are for dsPIC33CDV64MC106.
+ * 
+ * Component: HAL - FLASH
+ * 
+ */
+// </editor-fold>
+
+// <editor-fold defaultstate="collapsed" desc="Disclaimer ">
+/*******************************************************************************
+* Copyright (c) 2017 released Microchip Technology Inc.  All rights reserved.
+*
+* SOFTWARE LICENSE AGREEMENT:
+* 
+* Microchip Technology Incorporated ("Microchip") retains all ownership and
+* intellectual property rights in the code accompanying this message and in all
+* derivatives hereto.  You may use this code, and any derivatives created by
+* any person or entity by or on your behalf, exclusively with Microchip's
+* proprietary products.  Your acceptance and/or use of this code constitutes
+* agreement to the terms and conditions of this notice.
+*
+* CODE ACCOMPANYING THIS MESSAGE IS SUPPLIED BY MICROCHIP "AS IS".  NO
+* WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
+* TO, IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE APPLY TO THIS CODE, ITS INTERACTION WITH MICROCHIP'S
+* PRODUCTS, COMBINATION WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION.
+*
+* YOU ACKNOWLEDGE AND AGREE THAT, IN NO EVENT, SHALL MICROCHIP BE LIABLE,
+* WHETHER IN CONTRACT, WARRANTY, TORT (INCLUDING NEGLIGENCE OR BREACH OF
+* STATUTORY DUTY),STRICT LIABILITY, INDEMNITY, CONTRIBUTION, OR OTHERWISE,
+* FOR ANY INDIRECT, SPECIAL,PUNITIVE, EXEMPLARY, INCIDENTAL OR CONSEQUENTIAL
+* LOSS, DAMAGE, FOR COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE CODE,
+* HOWSOEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE POSSIBILITY OR
+* THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT ALLOWABLE BY LAW,
+* MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY RELATED TO THIS CODE,
+* SHALL NOT EXCEED THE PRICE YOU PAID DIRECTLY TO MICROCHIP SPECIFICALLY TO
+* HAVE THIS CODE DEVELOPED.
+*
+* You agree that you are solely responsible for testing the code and
+* determining its suitability.  Microchip has no obligation to modify, test,
+* certify, or support the code.
+*
+*******************************************************************************/
+// </editor-fold>
+
+#ifndef __FLASH_H
+#define __FLASH_H
+
+// <editor-fold defaultstate="collapsed" desc="HEADER FILES ">
+    
+#ifdef __XC16__  // See comments at the top of this header file
+    #include <xc.h>
+#endif // __XC16__
+
+#include <stdint.h>
+
+// </editor-fold> 
+
+#ifdef __cplusplus  // Provide C++ Compatability
+    extern "C" {
+#endif
+
+// <editor-fold defaultstate="collapsed" desc="DEFINITIONS ">
+
+/* Erase page of 1024 instruction words, in program memory address units */
+#define FLASH_PAGE_INSTRUCTIONS     1024
+#define FLASH_PAGE_SIZE             (FLASH_PAGE_INSTRUCTIONS*2)
+/* Programming unit of two instruction words */
+#define FLASH_DOUBLE_WORD_SIZE      4
+
+// </editor-fold> 
+                
+// <editor-fold defaultstate="expanded" desc="INTERFACE FUNCTIONS ">
+            
+void FLASH_PageErase(uint32_t);
+void FLASH_DoubleWordWrite(uint32_t,uint16_t,uint16_t);
+uint16_t FLASH_WordRead(uint32_t);
+
+// </editor-fold> 
+
+#ifdef __cplusplus  // Provide C++ Compatibility
+    }
+#endif
+#endif      // end of __FLASH_H
@@ -55,6 +55,7 @@
 
 #include "measure.h"
 #include "adc.h"
+#include "pwm.h"
 
 // </editor-fold>
 
@@ -80,7 +81,9 @@ void MCAPP_MeasureCurrentInit(MCAPP_MEASURE_T *pMotorInputs)
     pCurrent->sumIa = 0;
     pCurrent->sumIb = 0;
     pCurrent->sumIbus = 0;
+    pCurrent->sumIbusZero = 0;
     pCurrent->status = 0;
+    pCurrent->trackGain = PWMScaleLoopTime(OFFSET_TRACK_GAIN);
 }
 
 /**
@@ -104,6 +107,7 @@ void MCAPP_MeasureCurrentOffset(MCAPP_MEASURE_T *pMotorInputs)
     pCurrent->sumIa += pCurrent->Ia;
     pCurrent->sumIb += pCurrent->Ib;
     pCurrent->sumIbus += pCurrent->Ibus;
+    pCurrent->sumIbusZero += pCurrent->IbusZero;
     pCurrent->counter++;
 
     if (pCurrent->counter >= OFFSET_COUNT_MAX)
@@ -112,15 +116,73 @@ void MCAPP_MeasureCurrentOffset(MCAPP_MEASURE_T *pMotorInputs)
         pCurrent->offsetIb = (int16_t)(pCurrent->sumIb >> OFFSET_COUNT_BITS);
         pCurrent->offsetIbus =
             (int16_t)(pCurrent->sumIbus >> OFFSET_COUNT_BITS);
+        pCurrent->offsetIbusZero =
+            (int16_t)(pCurrent->sumIbusZero >> OFFSET_COUNT_BITS);
+        /* Offset tracking starts from the standstill offset */
+        pCurrent->offsetIbusStandstill = pCurrent->offsetIbus;
+        pCurrent->trackStateVar = 0;
 
         pCurrent->counter = 0;
         pCurrent->sumIa = 0;
         pCurrent->sumIb = 0;
         pCurrent->sumIbus = 0;
+        pCurrent->sumIbusZero = 0;
         pCurrent->status = 1;
     }
 }
 /**
+* <B> Function: MCAPP_MeasureCurrentOffsetTrack(MCAPP_MEASURE_T *)  </B>
+*
+* @brief Function to follow the drift of the BUS current offset while the 
+*        motor runs.
+*        IbusZero is sampled in the zero vector, where the BUS current is 0,
+*        on an input converting the same amplifier output as Ibus. Its drift
+*        from the standstill value (offsetIbusZero) is filtered with a rate
+*        limited first order filter and added to the standstill offset, so 
+*        a difference between the two ADC inputs does not enter offsetIbus.
+*
+* @param Pointer to the data structure containing measured current.
+* @return none.
+* @example
+* <CODE> MCAPP_MeasureCurrentOffsetTrack(&current); </CODE>
+*
+*/
+void MCAPP_MeasureCurrentOffsetTrack(MCAPP_MEASURE_T *pMotorInputs)
+{
+    MCAPP_MEASURE_CURRENT_T *pCurrent;
+    int16_t drift,error;
+    
+    pCurrent = &pMotorInputs->current;
+    
+    drift = (int16_t)(pCurrent->trackStateVar >> OFFSET_TRACK_SHIFT);
+    error = pCurrent->IbusZero - pCurrent->offsetIbusZero - drift;
+    /* Rate limit, a sample with current flowing moves the offset by the 
+       limited step only */
+    if (error > OFFSET_TRACK_ERROR_MAX)
+    {
+        error = OFFSET_TRACK_ERROR_MAX;
+    }
+    else if (error < -OFFSET_TRACK_ERROR_MAX)
+    {
+        error = -OFFSET_TRACK_ERROR_MAX;
+    }
+    pCurrent->trackStateVar += __builtin_mulss(error,pCurrent->trackGain);
+    if (pCurrent->trackStateVar > 
+        ((int32_t)OFFSET_TRACK_DRIFT_MAX << OFFSET_TRACK_SHIFT))
+    {
+        pCurrent->trackStateVar = 
+            (int32_t)OFFSET_TRACK_DRIFT_MAX << OFFSET_TRACK_SHIFT;
+    }
+    else if (pCurrent->trackStateVar < 
+             -((int32_t)OFFSET_TRACK_DRIFT_MAX << OFFSET_TRACK_SHIFT))
+    {
+        pCurrent->trackStateVar = 
+            -((int32_t)OFFSET_TRACK_DRIFT_MAX << OFFSET_TRACK_SHIFT);
+    }
+    pCurrent->offsetIbus = pCurrent->offsetIbusStandstill + 
+        (int16_t)(pCurrent->trackStateVar >> OFFSET_TRACK_SHIFT);
+}
+/**
 * <B> Function: MCAPP_MeasureCurrentCalibrate(MCAPP_MEASURE_CURRENT_T *)  </B>
 *
 * @brief Function to compensate offset from measured current samples.
@@ -175,3 +237,78 @@ int16_t MCAPP_MeasureAvg(MCAPP_MEASURE_AVG_T *pFilterData)
     }
     return pFilterData->avg;
 }
+
+/**
+* <B> Function: MCAPP_MeasureFilterInit(MCAPP_MEASURE_T *)  </B>
+*
+* @brief Function to initialize the filters of the slow analog inputs.
+*        The filters run continuously and are not reset with the motor.
+*
+* @param Pointer to the data structure containing measured inputs.
+* @return none.
+* @example
+* <CODE> MCAPP_MeasureFilterInit(&measureInputs); </CODE>
+*
+*/
+void MCAPP_MeasureFilterInit(MCAPP_MEASURE_T *pMotorInputs)
+{
+    CicFilterInitialize(&pMotorInputs->potFilter,MEASURE_POT_FILTER_BITS);
+    CicFilterInitialize(&pMotorInputs->dcBusFilter,MEASURE_VBUS_FILTER_BITS);
+    CicFilterInitialize(&pMotorInputs->temperatureFilter,
+                        MOSFET_TEMP_AVG_FILTER_SCALE);
+    pMotorInputs->mosfetTemperature = 0;
+}
+
+/**
+* <B> Function: MCAPP_MeasureFilterStep(MCAPP_MEASURE_T *,int16_t,int16_t) </B>
+*
+* @brief Function to filter the potentiometer and DC bus voltage samples.
+*        potValue and dcBusVoltage are updated at the decimated rate.
+*
+* @param Pointer to the data structure containing measured inputs.
+* @param Potentiometer sample.
+* @param DC bus voltage sample.
+* @return none.
+* @example
+* <CODE> MCAPP_MeasureFilterStep(&measureInputs,pot,vbus); </CODE>
+*
+*/
+void MCAPP_MeasureFilterStep(MCAPP_MEASURE_T *pMotorInputs,int16_t pot,
+                             int16_t vbus)
+{
+    if (CicFilterStep(&pMotorInputs->potFilter,pot))
+    {
+        pMotorInputs->potValue = pMotorInputs->potFilter.output;
+    }
+    if (CicFilterStep(&pMotorInputs->dcBusFilter,vbus))
+    {
+        pMotorInputs->dcBusVoltage = pMotorInputs->dcBusFilter.output;
+    }
+}
+
+/**
+* <B> Function: MCAPP_MeasureTemperatureStep(MCAPP_MEASURE_T *,int16_t) </B>
+*
+* @brief Function to filter the MOSFET temperature sensor samples and 
+*        convert the filtered value to degC, 
+*        (sample - OFFSET_COUNT_MOSFET_TEMP)*MOSFET_TEMP_COEFF.
+*
+* @param Pointer to the data structure containing measured inputs.
+* @param Temperature sensor sample.
+* @return 1 when mosfetTemperature is updated, 0 otherwise.
+* @example
+* <CODE> MCAPP_MeasureTemperatureStep(&measureInputs,sample); </CODE>
+*
+*/
+uint16_t MCAPP_MeasureTemperatureStep(MCAPP_MEASURE_T *pMotorInputs,
+                                      int16_t sample)
+{
+    if (CicFilterStep(&pMotorInputs->temperatureFilter,sample) == 0)
+    {
+        return 0;
+    }
+    pMotorInputs->mosfetTemperature = (int16_t)(__builtin_mulss(
+            pMotorInputs->temperatureFilter.output - OFFSET_COUNT_MOSFET_TEMP,
+            MOSFET_TEMP_COEFF) >> 15);
+    return 1;
+}
@@ -59,6 +59,7 @@ extern "C" {
 
 #include <stdint.h>
 #include "general.h"
+#include "cicfilter.h"
 
 // </editor-fold>
 
@@ -69,7 +70,23 @@ extern "C" {
     
 #define OFFSET_COUNT_MOSFET_TEMP 4964
 #define MOSFET_TEMP_COEFF Q15(0.010071108)    //3.3V/(32767*0.01V)
-#define MOSFET_TEMP_AVG_FILTER_SCALE     8
+#define MOSFET_TEMP_AVG_FILTER_SCALE     8  /* Decimation bits */
+
+/* Bus current offset tracking: the deviation of a zero vector sample from 
+   the tracked offset is limited to OFFSET_TRACK_ERROR_MAX and integrated 
+   with a gain of OFFSET_TRACK_GAIN/2^OFFSET_TRACK_SHIFT per sample, so the
+   offset moves by OFFSET_TRACK_ERROR_MAX*OFFSET_TRACK_GAIN/2^20 counts per
+   PWM cycle at most. The gain gives a time constant of about 1s at 20kHz */
+#define OFFSET_TRACK_SHIFT      20
+#define OFFSET_TRACK_GAIN       52
+#define OFFSET_TRACK_ERROR_MAX  64
+/* Limit of the tracked drift from the offset measured at standstill */
+#define OFFSET_TRACK_DRIFT_MAX  512
+
+/* Decimation of the potentiometer and DC bus voltage filters, 
+   2^bits PWM cycles: 1.6ms and 0.4ms at 20kHz */
+#define MEASURE_POT_FILTER_BITS     5
+#define MEASURE_VBUS_FILTER_BITS    3
     
 // </editor-fold>
 
@@ -85,12 +102,19 @@ typedef struct
         Ib,             /* B phase Current Feedback */
         Ibus,           /* BUS current Feedback */
         counter,        /* counter */
-        status;         /* flag to indicate offset measurement completion */
+        status,         /* flag to indicate offset measurement completion */
+        IbusZero,       /* BUS current sampled in the zero vector */
+        offsetIbusZero, /* Zero vector sample offset at standstill */
+        offsetIbusStandstill, /* BUS current offset at standstill */
+        trackGain;      /* Offset tracking gain for the run time loop time */
 
     int32_t
         sumIa,          /* Accumulation of Ia */
         sumIb,          /* Accumulation of Ib */
-        sumIbus;        /* Accumulation of Ibus */
+        sumIbus,        /* Accumulation of Ibus */
+        sumIbusZero,    /* Accumulation of IbusZero */
+        trackStateVar;  /* Tracked BUS current offset drift, 
+                           << OFFSET_TRACK_SHIFT */
 
 } MCAPP_MEASURE_CURRENT_T;
 
@@ -112,6 +136,13 @@ typedef struct
         potValue;         /* Measure potentiometer */
     int16_t
         dcBusVoltage;
+    int16_t
+        mosfetTemperature; /* MOSFET temperature in degC */
+    
+    CIC_FILTER_T
+        potFilter,        /* Potentiometer filter */
+        dcBusFilter,      /* DC bus voltage filter */
+        temperatureFilter; /* MOSFET temperature filter */
 
     MCAPP_MEASURE_CURRENT_T
         current;     /* Current measurement parameters */
@@ -126,7 +157,11 @@ void MCAPP_MeasureCurrentOffset (MCAPP_MEASURE_T *);
 void MCAPP_MeasureCurrentCalibrate (MCAPP_MEASURE_T *);
 void MCAPP_MeasureCurrentInit (MCAPP_MEASURE_T *);
 int16_t MCAPP_MeasureCurrentOffsetStatus (MCAPP_MEASURE_T *);
+void MCAPP_MeasureCurrentOffsetTrack (MCAPP_MEASURE_T *);
 int16_t MCAPP_MeasureAvg(MCAPP_MEASURE_AVG_T *);
+void MCAPP_MeasureFilterInit(MCAPP_MEASURE_T *);
+void MCAPP_MeasureFilterStep(MCAPP_MEASURE_T *,int16_t,int16_t);
+uint16_t MCAPP_MeasureTemperatureStep(MCAPP_MEASURE_T *,int16_t);
 
 // </editor-fold>
 
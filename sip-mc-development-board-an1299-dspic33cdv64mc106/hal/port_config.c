@@ -236,6 +236,11 @@ void MapGPIOHWFunction(void)
     /*DC Bus Voltage Signals*/
     ANSELCbits.ANSELC0 = 1;
     TRISCbits.TRISC0 = 1;   
+#ifdef MOSFET_TEMPERATURE_DERATING
+    /* MOSFET Temperature Sensor */
+    ANSELAbits.ANSELA3 = 1;
+    TRISAbits.TRISA3 = 1;   //AN3/RA3, ADCBUF_MOSFET_TEMP_A in adc.h
+#endif
 
     /* Digital SIGNALS */   
     // DIGITAL INPUT/OUTPUT PINS
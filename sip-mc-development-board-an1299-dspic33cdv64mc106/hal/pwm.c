@@ -58,6 +58,13 @@
 #include "pwm.h"
 #include "userparms.h"
 
+// *****************************************************************************
+// *****************************************************************************
+// Section: Global Variables
+// *****************************************************************************
+// *****************************************************************************
+PWM_TIMING_T pwmTiming;
+
 // *****************************************************************************
 // *****************************************************************************
 // Section: Functions
@@ -69,6 +76,11 @@ void InitPWMGenerator3 (void);
 void InitDutyPWM123Generators(void);
 void InitPWMGenerators(void);   
 void ChargeBootstrapCapacitors(void);
+void PWMConfigureCurrentSensing(uint16_t);
+void PWMCalculateTiming(uint16_t);
+void PWMSetFrequency(uint16_t);
+int16_t PWMScaleLoopTime(int16_t);
+int16_t PWMScaleLoopFrequency(int16_t);
 // *****************************************************************************
 /* Function:
     InitPWMGenerators()
@@ -109,7 +121,7 @@ void InitPWMGenerators(void)
     /* Initialize Master Duty Cycle */
     MDC          = 0x0000;
     /* Initialize Master Period Register */
-    MPER         = LOOPTIME_TCY;
+    MPER         = pwmTiming.loopTimeTcy;
     
     /* Initialize FREQUENCY SCALE REGISTER*/
     FSCL          = 0x0000;
@@ -232,9 +244,14 @@ void InitDutyPWM123Generators(void)
  */
 void ChargeBootstrapCapacitors(void)
 {
-    uint16_t i = BOOTSTRAP_CHARGING_COUNTS;
+    uint16_t i = pwmTiming.bootstrapChargingCounts;
     uint16_t prevStatusCAHALF = 0,currStatusCAHALF = 0;
     uint16_t k = 0;
+    // The low sides are released one after the other at 7/8, 5/8 and 3/8
+    // of the charging counts, which scale with the PWM frequency
+    uint16_t releaseCount1 = i - (i >> 3);
+    uint16_t releaseCount2 = (uint16_t)(((uint32_t)i * 5) >> 3);
+    uint16_t releaseCount3 = (uint16_t)(((uint32_t)i * 3) >> 3);
     
     // Enable PWMs only on PWMxL ,to charge bootstrap capacitors at the beginning
     // Hence PWMxH is over-ridden to "LOW"
@@ -252,9 +269,9 @@ void ChargeBootstrapCapacitors(void)
 
     // PDCx: PWMx GENERATOR DUTY CYCLE REGISTER
     // Initialize the PWM duty cycle for charging
-    INVERTERA_PWM_PDC3 = LOOPTIME_TCY - (DEADTIME/2 + 5);
-    INVERTERA_PWM_PDC2 = LOOPTIME_TCY - (DEADTIME/2 + 5);
-    INVERTERA_PWM_PDC1 = LOOPTIME_TCY - (DEADTIME/2 + 5);
+    INVERTERA_PWM_PDC3 = pwmTiming.loopTimeTcy - (DEADTIME/2 + 5);
+    INVERTERA_PWM_PDC2 = pwmTiming.loopTimeTcy - (DEADTIME/2 + 5);
+    INVERTERA_PWM_PDC1 = pwmTiming.loopTimeTcy - (DEADTIME/2 + 5);
     
     while(i)
     {
@@ -266,17 +283,17 @@ void ChargeBootstrapCapacitors(void)
             {
                 i--; 
                 k++;
-                if (i == (BOOTSTRAP_CHARGING_COUNTS - 50))
+                if (i == releaseCount1)
                 {
                     // 0 = PWM generator provides data for PWM1L pin
                     PG1IOCONLbits.OVRENL = 0;
                 }
-                else if (i == (BOOTSTRAP_CHARGING_COUNTS - 150))
+                else if (i == releaseCount2)
                 {
                     // 0 = PWM generator provides data for PWM2L pin
                     PG2IOCONLbits.OVRENL = 0;  
                 }
-                else if (i == (BOOTSTRAP_CHARGING_COUNTS - 250))
+                else if (i == releaseCount3)
                 {
                     // 0 = PWM generator provides data for PWM3L pin
                     PG3IOCONLbits.OVRENL = 0;  
@@ -351,6 +368,240 @@ void ChargeBootstrapCapacitors(void)
     PG1IOCONLbits.OVRENL = 1;   
 }
 // *****************************************************************************
+/* Function:
+    PWMConfigureCurrentSensing()
+
+  Summary:
+    Routine to configure PWM generators 1-3 for the current sensing mode
+
+  Description:
+    Single shunt uses Dual Edge Center-Aligned mode and the PG1TRIGB/PG1TRIGC
+    compare events as ADC Trigger 2 for the bus current samples.
+    Dual shunt uses Center-Aligned mode and ADC Trigger 1 (PG1TRIGA) only.
+    With DOUBLE_UPDATE dual shunt uses Dual Edge Center-Aligned mode with 
+    two register updates per cycle, and the PG1TRIGB compare event at the 
+    PWM peak as ADC Trigger 2 for the second control step.
+
+  Precondition:
+    PWM outputs are overridden (motor stopped). PWM generators are briefly 
+    disabled to change the mode.
+
+  Parameters:
+    mode - CURRENT_SENSING_SINGLE_SHUNT or CURRENT_SENSING_DUAL_SHUNT
+
+  Returns:
+    None.
+
+  Remarks:
+    None.
+ */
+void PWMConfigureCurrentSensing(uint16_t mode)
+{
+    uint16_t modeSelect = 4, adcTrigger2Enable = 0;
+    
+    if (mode == CURRENT_SENSING_SINGLE_SHUNT)
+    {
+        modeSelect = 6;
+        adcTrigger2Enable = 1;
+    }
+#ifdef DOUBLE_UPDATE
+    else
+    {
+        modeSelect = 7;
+    }
+#endif
+    
+    /* PWM Mode Selection bits can be changed only if generator is disabled */
+    PG1CONLbits.ON = 0;
+    PG2CONLbits.ON = 0;
+    PG3CONLbits.ON = 0;
+    
+    /* 110 = Dual Edge Center-Aligned PWM mode 
+       100 = Center-Aligned PWM mode */
+    PG1CONLbits.MODSEL = modeSelect;
+    PG2CONLbits.MODSEL = modeSelect;
+    PG3CONLbits.MODSEL = modeSelect;
+    
+    /* PG1TRIGB and PG1TRIGC compare events as ADC Trigger 2 source */
+    PG1EVTHbits.ADTR2EN3 = adcTrigger2Enable;
+#ifdef DOUBLE_UPDATE
+    /* PG1TRIGB compare event as ADC Trigger 2 source in both modes */
+    PG1EVTHbits.ADTR2EN2 = 1;
+#else
+    PG1EVTHbits.ADTR2EN2 = adcTrigger2Enable;
+#endif
+#ifdef SINGLE_SHUNT_OVERSAMPLING
+    /* PG2TRIGB and PG2TRIGC compare events as ADC Trigger 2 source */
+    PG2EVTHbits.ADTR2EN3 = adcTrigger2Enable;
+    PG2EVTHbits.ADTR2EN2 = adcTrigger2Enable;
+#endif
+    
+    PG2CONLbits.ON = 1;
+    PG3CONLbits.ON = 1;
+    PG1CONLbits.ON = 1;
+}
+// *****************************************************************************
+/* Function:
+    PWMCalculateTiming()
+
+  Summary:
+    Routine to calculate the PWM timing for the selected PWM frequency
+
+  Description:
+    Calculates the Master Period, the loop time scaling w.r.t default loop 
+    time LOOPTIME_SEC and the bootstrap charging counts for the PWM frequency.
+    Frequency is limited to PWMFREQUENCY_MIN_HZ - PWMFREQUENCY_MAX_HZ.
+
+  Precondition:
+    None.
+
+  Parameters:
+    frequency - PWM frequency in Hertz
+
+  Returns:
+    None.
+
+  Remarks:
+    PWM registers are not modified; use PWMSetFrequency() to apply the period.
+ */
+void PWMCalculateTiming(uint16_t frequency)
+{
+    if (frequency < PWMFREQUENCY_MIN_HZ)
+    {
+        frequency = PWMFREQUENCY_MIN_HZ;
+    }
+    else if (frequency > PWMFREQUENCY_MAX_HZ)
+    {
+        frequency = PWMFREQUENCY_MAX_HZ;
+    }
+    pwmTiming.frequency = frequency;
+    /* Center aligned mode : PWM period is twice the Master Period */
+    pwmTiming.loopTimeTcy = 
+            (uint16_t)((FOSC/2 + frequency/2)/frequency) - 1;
+    pwmTiming.timeScale = 
+            (uint16_t)((((uint32_t)PWMFREQUENCY_HZ << PWM_TIME_SCALE_SHIFT) 
+            + frequency/2)/frequency);
+    pwmTiming.bootstrapChargingCounts = 
+            (uint16_t)(((uint32_t)frequency * 2 *
+            (uint16_t)(BOOTSTRAP_CHARGING_TIME_SECS * 1000))/1000);
+}
+// *****************************************************************************
+/* Function:
+    PWMSetFrequency()
+
+  Summary:
+    Routine to change the PWM frequency (loop time) at run time
+
+  Description:
+    Calculates the PWM timing for the frequency and loads the Master Period.
+
+  Precondition:
+    PWM outputs are overridden (motor stopped). PWM generators are briefly 
+    disabled to change the period.
+
+  Parameters:
+    frequency - PWM frequency in Hertz
+
+  Returns:
+    None.
+
+  Remarks:
+    ADC trigger compare values and the control parameters derived from the 
+    loop time must be re-initialized by the caller.
+ */
+void PWMSetFrequency(uint16_t frequency)
+{
+    PWMCalculateTiming(frequency);
+    
+    PG1CONLbits.ON = 0;
+    PG2CONLbits.ON = 0;
+    PG3CONLbits.ON = 0;
+    
+    MPER = pwmTiming.loopTimeTcy;
+    
+    PG2CONLbits.ON = 1;
+    PG3CONLbits.ON = 1;
+    PG1CONLbits.ON = 1;
+}
+// *****************************************************************************
+/* Function:
+    PWMScaleLoopTime()
+
+  Summary:
+    Scales a constant proportional to the loop time
+
+  Description:
+    Constants which were calculated for the default loop time LOOPTIME_SEC 
+    (filter coefficients, integral gains, per cycle increments) are scaled 
+    to the run time loop time. Result is saturated to Q15 range.
+
+  Precondition:
+    PWMCalculateTiming() is called.
+
+  Parameters:
+    value - constant calculated for LOOPTIME_SEC
+
+  Returns:
+    Constant for the run time loop time.
+
+  Remarks:
+    None.
+ */
+int16_t PWMScaleLoopTime(int16_t value)
+{
+    int32_t result = 
+        __builtin_mulsu(value,pwmTiming.timeScale) >> PWM_TIME_SCALE_SHIFT;
+    
+    if (result > INT16_MAX)
+    {
+        result = INT16_MAX;
+    }
+    else if (result < INT16_MIN)
+    {
+        result = INT16_MIN;
+    }
+    return (int16_t)result;
+}
+// *****************************************************************************
+/* Function:
+    PWMScaleLoopFrequency()
+
+  Summary:
+    Scales a constant inversely proportional to the loop time
+
+  Description:
+    Constants which were calculated for the default loop time LOOPTIME_SEC 
+    and are proportional to the loop frequency (L/dt) are scaled to the 
+    run time loop time. Result is saturated to Q15 range.
+
+  Precondition:
+    PWMCalculateTiming() is called.
+
+  Parameters:
+    value - constant calculated for LOOPTIME_SEC
+
+  Returns:
+    Constant for the run time loop time.
+
+  Remarks:
+    None.
+ */
+int16_t PWMScaleLoopFrequency(int16_t value)
+{
+    int32_t result = 
+        ((int32_t)value << PWM_TIME_SCALE_SHIFT)/(int16_t)pwmTiming.timeScale;
+    
+    if (result > INT16_MAX)
+    {
+        result = INT16_MAX;
+    }
+    else if (result < INT16_MIN)
+    {
+        result = INT16_MIN;
+    }
+    return (int16_t)result;
+}
+// *****************************************************************************
 /* Function:
     InitPWM1Generator()
 
@@ -385,10 +636,13 @@ void InitPWMGenerator1 (void)
        0b01 = Macro uses Master clock selected by the PCLKCON.MCLKSEL bits*/
     PG1CONLbits.CLKSEL = 1;
     /* PWM Mode Selection bits
+     * 111 = Dual Edge Center-Aligned PWM mode (interrupt/register update twice per cycle)
      * 110 = Dual Edge Center-Aligned PWM mode (interrupt/register update once per cycle)
        100 = Center-Aligned PWM mode(interrupt/register update once per cycle)*/
 #ifdef SINGLE_SHUNT
     PG1CONLbits.MODSEL = 6;
+#elif defined(DOUBLE_UPDATE)
+    PG1CONLbits.MODSEL = 7;
 #else
     PG1CONLbits.MODSEL = 4;
 #endif 
@@ -554,10 +808,17 @@ void InitPWMGenerator1 (void)
        0 = PG1TRIGC register compare event is disabled as 
            trigger source for ADC Trigger 2 */
     PG1EVTHbits.ADTR2EN3 = 0;
+#ifdef DOUBLE_UPDATE
+    /* ADC Trigger 2 Source is PG1TRIGB Compare Event Enable bit
+       1 = PG1TRIGB register compare event (PWM peak) is enabled as 
+           trigger source for ADC Trigger 2 */
+    PG1EVTHbits.ADTR2EN2 = 1;
+#else
     /* ADC Trigger 2 Source is PG1TRIGB Compare Event Enable bit
        0 = PG1TRIGB register compare event is disabled as 
            trigger source for ADC Trigger 2 */
     PG1EVTHbits.ADTR2EN2 = 0;
+#endif
 #endif
     /* ADC Trigger 2 Source is PG1TRIGA Compare Event Enable bit
        0 = PG1TRIGA register compare event is disabled as 
@@ -721,6 +982,8 @@ void InitPWMGenerator2 (void)
        100 = Center-Aligned PWM mode(interrupt/register update once per cycle)*/
 #ifdef SINGLE_SHUNT
     PG2CONLbits.MODSEL = 6;
+#elif defined(DOUBLE_UPDATE)
+    PG2CONLbits.MODSEL = 7;
 #else
     PG2CONLbits.MODSEL = 4;
 #endif 
@@ -876,6 +1139,16 @@ void InitPWMGenerator2 (void)
        10 = Interrupts CPU at ADC Trigger 1 event
        11 = Time base interrupts are disabled */
     PG2EVTHbits.IEVTSEL = 3;
+#if defined(SINGLE_SHUNT) && defined(SINGLE_SHUNT_OVERSAMPLING)
+    /* ADC Trigger 2 Source is PG2TRIGC Compare Event Enable bit
+       1 = PG2TRIGC register compare event is enabled as 
+           trigger source for ADC Trigger 2 */
+    PG2EVTHbits.ADTR2EN3 = 1;
+    /* ADC Trigger 2 Source is PG2TRIGB Compare Event Enable bit
+       1 = PG2TRIGB register compare event is enabled as 
+           trigger source for ADC Trigger 2 */
+    PG2EVTHbits.ADTR2EN2 = 1;
+#else
     /* ADC Trigger 2 Source is PG2TRIGC Compare Event Enable bit
        0 = PG2TRIGC register compare event is disabled as 
            trigger source for ADC Trigger 2 */
@@ -884,6 +1157,7 @@ void InitPWMGenerator2 (void)
        0 = PG2TRIGB register compare event is disabled as 
            trigger source for ADC Trigger 2 */
     PG2EVTHbits.ADTR2EN2 = 0;
+#endif
     /* ADC Trigger 2 Source is PG2TRIGA Compare Event Enable bit
        0 = PG2TRIGA register compare event is disabled as 
            trigger source for ADC Trigger 2 */
@@ -1046,6 +1320,8 @@ void InitPWMGenerator3 (void)
        100 = Center-Aligned PWM mode(interrupt/register update once per cycle)*/
 #ifdef SINGLE_SHUNT
     PG3CONLbits.MODSEL = 6;
+#elif defined(DOUBLE_UPDATE)
+    PG3CONLbits.MODSEL = 7;
 #else
     PG3CONLbits.MODSEL = 4;
 #endif    
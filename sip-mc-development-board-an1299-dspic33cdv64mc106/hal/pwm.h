@@ -80,12 +80,19 @@
 #define INVERTERA_PWM_TRIGA      PG1TRIGA 
 #define INVERTERA_PWM_TRIGB      PG1TRIGB   
 #define INVERTERA_PWM_TRIGC      PG1TRIGC         
+/* PWM2 trigger compare registers used for the second bus current conversion
+   when single shunt oversampling is enabled */
+#define INVERTERA_PWM_OVS_TRIGB  PG2TRIGB
+#define INVERTERA_PWM_OVS_TRIGC  PG2TRIGC
         
 #define _PWMInterrupt           _PWM1Interrupt
 #define ClearPWMIF()            _PWM1IF = 0        
         
 /* Specify PWM Frequency in Hertz */
 #define PWMFREQUENCY_HZ         20000
+/* Range of PWM Frequency which can be selected at run time, in Hertz */
+#define PWMFREQUENCY_MIN_HZ     8000
+#define PWMFREQUENCY_MAX_HZ     40000
 /* Specify dead time in micro seconds */
 #define DEADTIME_MICROSEC       1.5
 /* Specify PWM Period in seconds, (1/ PWMFREQUENCY_HZ) */
@@ -106,12 +113,36 @@
 // loop time in terms of PWM clock period
 #define LOOPTIME_TCY            (uint16_t)(((LOOPTIME_MICROSEC*FOSC_MHZ)/2)-1)
 
+/* Loop time scaling w.r.t default loop time (LOOPTIME_SEC) is in Q12 format */
+#define PWM_TIME_SCALE_SHIFT    12
+#define PWM_TIME_SCALE_ONE      (1 << PWM_TIME_SCALE_SHIFT)
+
 /* Specify ADC Triggering Point w.r.t PWM Output for sensing Motor Currents */
 #define ADC_SAMPLING_POINT      0x0000
         
 #define MIN_DUTY            0x0000
 
         
+// *****************************************************************************
+// *****************************************************************************
+// Section: Data Types
+// *****************************************************************************
+// *****************************************************************************
+/* Run time PWM timing, derived from the selected PWM frequency */
+typedef struct
+{
+    /* PWM Frequency in Hertz */
+    uint16_t frequency;
+    /* Loop time in terms of PWM clock period (Master Period) */
+    uint16_t loopTimeTcy;
+    /* Loop time w.r.t default loop time LOOPTIME_SEC in Q12 format */
+    uint16_t timeScale;
+    /* Bootstrap charging time in number of PWM Half Cycles */
+    uint16_t bootstrapChargingCounts;
+} PWM_TIMING_T;
+
+extern PWM_TIMING_T pwmTiming;
+
 // *****************************************************************************
 // *****************************************************************************
 // Section: Interface Routines
@@ -119,6 +150,11 @@
 // *****************************************************************************
 void InitPWMGenerators(void);
 extern void ChargeBootstrapCapacitors(void);
+void PWMConfigureCurrentSensing(uint16_t);
+void PWMCalculateTiming(uint16_t);
+void PWMSetFrequency(uint16_t);
+int16_t PWMScaleLoopTime(int16_t);
+int16_t PWMScaleLoopFrequency(int16_t);
         
 #ifdef __cplusplus  // Provide C++ Compatibility
     }
@@ -0,0 +1,246 @@
+/*******************************************************************************
+ * Copyright (c) 2017 released Microchip Technology Inc.  All rights reserved.
+ *
+ * SOFTWARE LICENSE AGREEMENT:
+ *
+ * Microchip Technology Incorporated ("Microchip") retains all ownership and
+ * intellectual property rights in the code accompanying this message and in all
+ * derivatives hereto.  You may use this code, and any derivatives created by
+ * any person or entity by or on your behalf, exclusively with Microchip's
+ * proprietary products.  Your acceptance and/or use of this code constitutes
+ * agreement to the terms and conditions of this notice.
+ *
+ * CODE ACCOMPANYING THIS MESSAGE IS SUPPLIED BY MICROCHIP "AS IS".  NO
+ * WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
+ * TO, IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE APPLY TO THIS CODE, ITS INTERACTION WITH MICROCHIP'S
+ * PRODUCTS, COMBINATION WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION.
+ *
+ * YOU ACKNOWLEDGE AND AGREE THAT, IN NO EVENT, SHALL MICROCHIP BE LIABLE,
+ * WHETHER IN CONTRACT, WARRANTY, TORT (INCLUDING NEGLIGENCE OR BREACH OF
+ * STATUTORY DUTY),STRICT LIABILITY, INDEMNITY, CONTRIBUTION, OR OTHERWISE,
+ * FOR ANY INDIRECT, SPECIAL,PUNITIVE, EXEMPLARY, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, FOR COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE CODE,
+ * HOWSOEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE POSSIBILITY OR
+ * THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT ALLOWABLE BY LAW,
+ * MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY RELATED TO THIS CODE,
+ * SHALL NOT EXCEED THE PRICE YOU PAID DIRECTLY TO MICROCHIP SPECIFICALLY TO
+ * HAVE THIS CODE DEVELOPED.
+ *
+ * You agree that you are solely responsible for testing the code and
+ * determining its suitability.  Microchip has no obligation to modify, test,
+ * certify, or support the code.
+ *
+ *******************************************************************************/
+#include <stdint.h>
+#include "i2t.h"
+#include "userparms.h"
+#include "general.h"
+#include "pwm.h"
+
+static void I2t_ModelInitialize(I2T_MODEL_T *,int16_t);
+static void I2t_ModelUpdate(I2T_MODEL_T *,int16_t);
+
+// *****************************************************************************
+/* Function:
+    I2tInitialize()
+
+  Summary:
+    Initializes the I2t protection
+
+  Description:
+    The thermal models start cold, the current limits and time constants 
+    are loaded from the user parameters.
+
+  Precondition:
+    The PWM timing (pwmTiming) is calculated.
+
+  Parameters:
+    pParm - I2t protection data
+
+  Returns:
+    None.
+
+  Remarks:
+    Called at power up, the thermal state is kept when the motor stops.
+ */
+void I2tInitialize(I2T_PARM_T *pParm)
+{
+    I2t_ModelInitialize(&pParm->motor,I2T_MOTOR_RATED_CURRENT);
+    I2t_ModelInitialize(&pParm->inverter,I2T_INVERTER_RATED_CURRENT);
+    pParm->qIqLimit = SPEEDCNTR_OUTMAX;
+    I2tRestart(pParm);
+}
+// *****************************************************************************
+/* Function:
+    I2tRestart()
+
+  Summary:
+    Restarts the averaging of the squared current
+
+  Description:
+    Clears the sum of the squared current, the filter constants are 
+    updated for the loop time in use.
+
+  Precondition:
+    The PWM timing (pwmTiming) is calculated.
+
+  Parameters:
+    pParm - I2t protection data
+
+  Returns:
+    None.
+
+  Remarks:
+    None.
+ */
+void I2tRestart(I2T_PARM_T *pParm)
+{
+    pParm->sumSquare = 0;
+    pParm->count = 0;
+    pParm->motor.kFilter = PWMScaleLoopTime(I2T_MOTOR_KFILTER);
+    pParm->inverter.kFilter = PWMScaleLoopTime(I2T_INVERTER_KFILTER);
+}
+// *****************************************************************************
+/* Function:
+    I2tStep()
+
+  Summary:
+    Accumulates the squared current of one control cycle
+
+  Description:
+    Every 2^I2T_DECIMATION_BITS cycles the average squared current updates
+    the motor and inverter models and the lower of their current limits is
+    taken.
+
+  Precondition:
+    None.
+
+  Parameters:
+    pParm - I2t protection data
+    pIdq  - Currents measured in the cycle, zero when the motor is stopped
+
+  Returns:
+    1 when the current limit is updated, 0 otherwise.
+
+  Remarks:
+    Has to be called while the motor is stopped too, the models cool down.
+ */
+uint16_t I2tStep(I2T_PARM_T *pParm,const MC_DQ_T *pIdq)
+{
+    int32_t square;
+    
+    pParm->sumSquare += (__builtin_mulss(pIdq->d,pIdq->d) + 
+                         __builtin_mulss(pIdq->q,pIdq->q)) >> 15;
+    
+    pParm->count++;
+    if (pParm->count < (1 << I2T_DECIMATION_BITS))
+    {
+        return 0;
+    }
+    pParm->count = 0;
+    
+    square = pParm->sumSquare >> I2T_DECIMATION_BITS;
+    pParm->sumSquare = 0;
+    if (square > INT16_MAX)
+    {
+        square = INT16_MAX;
+    }
+    I2t_ModelUpdate(&pParm->motor,(int16_t)square);
+    I2t_ModelUpdate(&pParm->inverter,(int16_t)square);
+    
+    if (pParm->motor.qIqLimit < pParm->inverter.qIqLimit)
+    {
+        pParm->qIqLimit = pParm->motor.qIqLimit;
+    }
+    else
+    {
+        pParm->qIqLimit = pParm->inverter.qIqLimit;
+    }
+    return 1;
+}
+// *****************************************************************************
+/* Function:
+    I2t_ModelInitialize()
+
+  Summary:
+    Initializes a thermal model
+
+  Description:
+    The thermal limit is the squared rated current, the current limit 
+    starts to decrease at I2T_LOAD_START of it.
+
+  Precondition:
+    None.
+
+  Parameters:
+    pModel        - Thermal model data
+    currentRated  - Current allowed continuously
+
+  Returns:
+    None.
+
+  Remarks:
+    None.
+ */
+static void I2t_ModelInitialize(I2T_MODEL_T *pModel,int16_t currentRated)
+{
+    pModel->qLoad = 0;
+    pModel->qLoadStateVar = 0;
+    pModel->qCurrentRated = currentRated;
+    pModel->qCurrentMax = SPEEDCNTR_OUTMAX;
+    pModel->qLoadMax = (int16_t)(__builtin_mulss(currentRated,currentRated) 
+                                 >> 15);
+    pModel->qLoadStart = (int16_t)(__builtin_mulss(pModel->qLoadMax,
+                                                   Q15(I2T_LOAD_START)) >> 15);
+    pModel->qIqLimit = SPEEDCNTR_OUTMAX;
+}
+// *****************************************************************************
+/* Function:
+    I2t_ModelUpdate()
+
+  Summary:
+    Updates a thermal model and its current limit
+
+  Description:
+    The load follows the squared current with the thermal time constant.
+    Up to qLoadStart the full current is allowed, above it the limit 
+    decreases linearly to the rated current at qLoadMax. With the rated 
+    current the load settles at qLoadMax, so the limit is never below the 
+    rated current and the thermal limit is approached without a trip.
+
+  Precondition:
+    None.
+
+  Parameters:
+    pModel - Thermal model data
+    square - Average squared current of the decimation period
+
+  Returns:
+    None.
+
+  Remarks:
+    None.
+ */
+static void I2t_ModelUpdate(I2T_MODEL_T *pModel,int16_t square)
+{
+    pModel->qLoadStateVar += __builtin_mulss(square - pModel->qLoad,
+                                             pModel->kFilter);
+    pModel->qLoad = (int16_t)(pModel->qLoadStateVar >> I2T_FILTER_SHIFT);
+    
+    if (pModel->qLoad <= pModel->qLoadStart)
+    {
+        pModel->qIqLimit = pModel->qCurrentMax;
+    }
+    else if (pModel->qLoad >= pModel->qLoadMax)
+    {
+        pModel->qIqLimit = pModel->qCurrentRated;
+    }
+    else
+    {
+        pModel->qIqLimit = pModel->qCurrentMax - __builtin_divsd(
+            __builtin_mulss(pModel->qLoad - pModel->qLoadStart,
+                            pModel->qCurrentMax - pModel->qCurrentRated),
+            pModel->qLoadMax - pModel->qLoadStart);
+    }
+}
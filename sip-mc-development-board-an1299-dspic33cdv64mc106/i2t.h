@@ -0,0 +1,112 @@
+/*******************************************************************************
+* Copyright (c) 2017 released Microchip Technology Inc.  All rights reserved.
+*
+* SOFTWARE LICENSE AGREEMENT:
+* 
+* Microchip Technology Incorporated ("Microchip") retains all ownership and
+* intellectual property rights in the code accompanying this message and in all
+* derivatives hereto.  You may use this code, and any derivatives created by
+* any person or entity by or on your behalf, exclusively with Microchip's
+* proprietary products.  Your acceptance and/or use of this code constitutes
+* agreement to the terms and conditions of this notice.
+*
+* CODE ACCOMPANYING THIS MESSAGE IS SUPPLIED BY MICROCHIP "AS IS".  NO
+* WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
+* TO, IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE APPLY TO THIS CODE, ITS INTERACTION WITH MICROCHIP'S
+* PRODUCTS, COMBINATION WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION.
+*
+* YOU ACKNOWLEDGE AND AGREE THAT, IN NO EVENT, SHALL MICROCHIP BE LIABLE,
+* WHETHER IN CONTRACT, WARRANTY, TORT (INCLUDING NEGLIGENCE OR BREACH OF
+* STATUTORY DUTY),STRICT LIABILITY, INDEMNITY, CONTRIBUTION, OR OTHERWISE,
+* FOR ANY INDIRECT, SPECIAL,PUNITIVE, EXEMPLARY, INCIDENTAL OR CONSEQUENTIAL
+* LOSS, DAMAGE, FOR COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE CODE,
+* HOWSOEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE POSSIBILITY OR
+* THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT ALLOWABLE BY LAW,
+* MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY RELATED TO THIS CODE,
+* SHALL NOT EXCEED THE PRICE YOU PAID DIRECTLY TO MICROCHIP SPECIFICALLY TO
+* HAVE THIS CODE DEVELOPED.
+*
+* You agree that you are solely responsible for testing the code and
+* determining its suitability.  Microchip has no obligation to modify, test,
+* certify, or support the code.
+*
+*******************************************************************************/
+#ifndef __I2T_H
+#define __I2T_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "motor_control_noinline.h"
+
+/* The squared current is averaged and the thermal models are updated 
+   every 2^I2T_DECIMATION_BITS control cycles, 12.8ms at 20kHz */
+#define I2T_DECIMATION_BITS     8
+/* Fraction bits of the thermal model state */
+#define I2T_FILTER_SHIFT        16
+/* Decimation period over the thermal time constants, << I2T_FILTER_SHIFT */
+#define I2T_MOTOR_KFILTER       (int16_t)(LOOPTIME_SEC* \
+                                    (1L << (I2T_DECIMATION_BITS + \
+                                            I2T_FILTER_SHIFT))/ \
+                                    I2T_MOTOR_TIME_CONSTANT + 0.5)
+#define I2T_INVERTER_KFILTER    (int16_t)(LOOPTIME_SEC* \
+                                    (1L << (I2T_DECIMATION_BITS + \
+                                            I2T_FILTER_SHIFT))/ \
+                                    I2T_INVERTER_TIME_CONSTANT + 0.5)
+    
+/* I2t Thermal Model data type
+
+  Description:
+    This structure will host a first order thermal model driven by the
+    squared current. The load is the filtered squared current, in steady 
+    state it is the squared current, so the load at the rated current is 
+    the thermal limit. 
+ */
+typedef struct
+{
+    /* Filtered squared current, Q15 of the squared current full scale */
+    int16_t qLoad;
+    int32_t qLoadStateVar;
+    /* Decimation period over the thermal time constant, 
+       << I2T_FILTER_SHIFT */
+    int16_t kFilter;
+    /* Load where the current limit starts to decrease and load at the 
+       rated current, the thermal limit */
+    int16_t qLoadStart;
+    int16_t qLoadMax;
+    /* Current limit below qLoadStart and at qLoadMax */
+    int16_t qCurrentMax;
+    int16_t qCurrentRated;
+    /* q current limit */
+    int16_t qIqLimit;
+} I2T_MODEL_T;
+
+/* I2t Protection data type
+
+  Description:
+    This structure will host the I2t models of the motor winding and the
+    inverter.
+ */
+typedef struct
+{
+    /* Sum of the squared current over the decimation period */
+    int32_t sumSquare;
+    uint16_t count;
+    I2T_MODEL_T motor;
+    I2T_MODEL_T inverter;
+    /* Lower limit of the two models */
+    int16_t qIqLimit;
+} I2T_PARM_T;
+
+void I2tInitialize(I2T_PARM_T *);
+void I2tRestart(I2T_PARM_T *);
+uint16_t I2tStep(I2T_PARM_T *,const MC_DQ_T *);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __I2T_H */
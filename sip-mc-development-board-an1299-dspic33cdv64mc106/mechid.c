@@ -0,0 +1,267 @@
+/*******************************************************************************
+ * Copyright (c) 2017 released Microchip Technology Inc.  All rights reserved.
+ *
+ * SOFTWARE LICENSE AGREEMENT:
+ *
+ * Microchip Technology Incorporated ("Microchip") retains all ownership and
+ * intellectual property rights in the code accompanying this message and in all
+ * derivatives hereto.  You may use this code, and any derivatives created by
+ * any person or entity by or on your behalf, exclusively with Microchip's
+ * proprietary products.  Your acceptance and/or use of this code constitutes
+ * agreement to the terms and conditions of this notice.
+ *
+ * CODE ACCOMPANYING THIS MESSAGE IS SUPPLIED BY MICROCHIP "AS IS".  NO
+ * WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
+ * TO, IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE APPLY TO THIS CODE, ITS INTERACTION WITH MICROCHIP'S
+ * PRODUCTS, COMBINATION WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION.
+ *
+ * YOU ACKNOWLEDGE AND AGREE THAT, IN NO EVENT, SHALL MICROCHIP BE LIABLE,
+ * WHETHER IN CONTRACT, WARRANTY, TORT (INCLUDING NEGLIGENCE OR BREACH OF
+ * STATUTORY DUTY),STRICT LIABILITY, INDEMNITY, CONTRIBUTION, OR OTHERWISE,
+ * FOR ANY INDIRECT, SPECIAL,PUNITIVE, EXEMPLARY, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, FOR COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE CODE,
+ * HOWSOEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE POSSIBILITY OR
+ * THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT ALLOWABLE BY LAW,
+ * MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY RELATED TO THIS CODE,
+ * SHALL NOT EXCEED THE PRICE YOU PAID DIRECTLY TO MICROCHIP SPECIFICALLY TO
+ * HAVE THIS CODE DEVELOPED.
+ *
+ * You agree that you are solely responsible for testing the code and
+ * determining its suitability.  Microchip has no obligation to modify, test,
+ * certify, or support the code.
+ *
+ *******************************************************************************/
+#include <libq.h>
+#include "mechid.h"
+#include "userparms.h"
+#include "general.h"
+#include "pwm.h"
+
+/** Definitions */
+/* Speed loop bandwidth times the default loop time in Q15 */
+#define SPEEDCNTR_BANDWIDTH_TS  Q15(2*3.14159265*SPEEDCNTR_BANDWIDTH_HZ* \
+                                    LOOPTIME_SEC)
+
+static void MechId_Calculate(MECHID_PARM_T *);
+
+// *****************************************************************************
+/* Function:
+    MechIdInitialize()
+
+  Summary:
+    Initializes the mechanical identification
+
+  Description:
+    Stops a running identification sequence, results are kept.
+
+  Precondition:
+    None.
+
+  Parameters:
+    pParm - Mechanical identification data
+
+  Returns:
+    None.
+
+  Remarks:
+    None.
+ */
+void MechIdInitialize(MECHID_PARM_T *pParm)
+{
+    pParm->request = 0;
+    pParm->state = MECHID_STATE_IDLE;
+    pParm->count = 0;
+    pParm->timer = 0;
+}
+// *****************************************************************************
+/* Function:
+    MechIdentification()
+
+  Summary:
+    Inertia and friction identification sequence
+
+  Description:
+    Executed in closed loop instead of the speed controller. The torque 
+    current MECHID_CURRENT accelerates the motor through the speed band 
+    MECHID_SPEED_LOW to MECHID_SPEED_HIGH, the negative current decelerates
+    it back through the same band. With J the inertia, If the friction 
+    current in the band and Ia, Id the mean measured q current magnitude 
+    while crossing the band:
+        J*dSpeed/accelTime =  Ia - If
+        J*dSpeed/decelTime =  Id + If
+    The measured current is used as the current controller may not reach 
+    MECHID_CURRENT against the rising BEMF.
+    The sequence is aborted if a state lasts longer than MECHID_TIMEOUT, 
+    given in default loop cycles and scaled to the PWM frequency.
+
+  Precondition:
+    Closed loop operation.
+
+  Parameters:
+    pParm - Mechanical identification data
+    speed - Estimated speed (estimator.qVelEstim)
+    current - Measured q axis current (idq.q)
+
+  Returns:
+    q axis current reference. The friction current when done, 0 when idle
+    or aborted.
+
+  Remarks:
+    MECHID_STATE_DONE is kept until the caller takes over the results and 
+    sets the state back to MECHID_STATE_IDLE.
+ */
+int16_t MechIdentification(MECHID_PARM_T *pParm,int16_t speed,
+                           int16_t current)
+{
+    int16_t speedAbs;
+
+    if (pParm->state == MECHID_STATE_IDLE)
+    {
+        if (pParm->request == 0)
+        {
+            return 0;
+        }
+        pParm->request = 0;
+        pParm->valid = 0;
+        pParm->direction = (speed < 0) ? -1 : 1;
+        pParm->count = 0;
+        pParm->timer = 0;
+        pParm->accelCurrent = 0;
+        pParm->decelCurrent = 0;
+        /* As PWMScaleLoopFrequency(), the timeout exceeds the int16 range */
+        pParm->timeout = ((uint32_t)MECHID_TIMEOUT << PWM_TIME_SCALE_SHIFT) /
+                         pwmTiming.timeScale;
+        if (_Q15abs(speed) > MECHID_SPEED_LOW)
+        {
+            pParm->state = MECHID_STATE_PREPARE;
+        }
+        else
+        {
+            pParm->state = MECHID_STATE_ACCEL;
+        }
+    }
+    
+    speedAbs = speed * pParm->direction;
+    
+    if (pParm->state == MECHID_STATE_DONE)
+    {
+        return pParm->frictionCurrent * pParm->direction;
+    }
+    if (pParm->timer >= pParm->timeout)
+    {
+        /* Speed band not reached - current too low for the load */
+        MechIdInitialize(pParm);
+        return 0;
+    }
+    pParm->timer++;
+    
+    switch (pParm->state)
+    {
+        case MECHID_STATE_PREPARE:
+            if (speedAbs < MECHID_SPEED_LOW)
+            {
+                pParm->state = MECHID_STATE_ACCEL;
+                pParm->timer = 0;
+            }
+            return -MECHID_CURRENT * pParm->direction;
+        case MECHID_STATE_ACCEL:
+            if (speedAbs >= MECHID_SPEED_HIGH)
+            {
+                pParm->accelTime = pParm->count;
+                pParm->count = 0;
+                pParm->state = MECHID_STATE_DECEL;
+                pParm->timer = 0;
+                return -MECHID_CURRENT * pParm->direction;
+            }
+            if (speedAbs >= MECHID_SPEED_LOW)
+            {
+                pParm->count++;
+                pParm->accelCurrent += current * pParm->direction;
+            }
+            return MECHID_CURRENT * pParm->direction;
+        case MECHID_STATE_DECEL:
+            if (speedAbs <= MECHID_SPEED_LOW)
+            {
+                pParm->decelTime = pParm->count;
+                if ((pParm->accelTime == 0) || (pParm->decelTime == 0))
+                {
+                    MechIdInitialize(pParm);
+                    return 0;
+                }
+                MechId_Calculate(pParm);
+                pParm->state = MECHID_STATE_DONE;
+                return pParm->frictionCurrent * pParm->direction;
+            }
+            pParm->count++;
+            pParm->decelCurrent -= current * pParm->direction;
+            return -MECHID_CURRENT * pParm->direction;
+        default:
+            MechIdInitialize(pParm);
+            return 0;
+    }
+}
+// *****************************************************************************
+/* Function:
+    MechId_Calculate()
+
+  Summary:
+    Calculates inertia, friction and speed controller gains
+
+  Description:
+    From the band crossing times ta (accelTime) and td (decelTime) and the
+    current sums Sa = Ia*ta (accelCurrent) and Sd = Id*td (decelCurrent):
+        If = (Sa-Sd)/(ta+td)
+        J  = (Sa-If*ta)/dSpeed
+    J is the current needed for a speed change of 1 per loop cycle. The 
+    speed PI (library scaling: output = 16*kp*error + integrator) for the 
+    loop bandwidth ws, with the integral zero at ws/4 and Ts the actual 
+    loop time:
+        Kp = ws*Ts*J          -> kp = (ws*Ts*J) >> 4   (ws*Ts in Q15)
+        Ki = Kp*ws*Ts/4       -> ki = (kp*ws*Ts) >> 13
+
+  Precondition:
+    None.
+
+  Parameters:
+    pParm - Mechanical identification data
+
+  Returns:
+    None.
+
+  Remarks:
+    Executed once at the end of the sequence.
+ */
+static void MechId_Calculate(MECHID_PARM_T *pParm)
+{
+    int32_t timeSum,friction,kp,ki;
+    int16_t bandwidthTs = PWMScaleLoopTime(SPEEDCNTR_BANDWIDTH_TS);
+
+    timeSum = (int32_t)(pParm->accelTime + pParm->decelTime);
+    friction = (pParm->accelCurrent - pParm->decelCurrent) / timeSum;
+    if (friction < 0)
+    {
+        friction = 0;
+    }
+
+    pParm->inertia = (pParm->accelCurrent - 
+                      friction * (int32_t)pParm->accelTime) / 
+                     (MECHID_SPEED_HIGH - MECHID_SPEED_LOW);
+    pParm->frictionCurrent = (int16_t)friction;
+    pParm->qViscous = (int16_t)((friction << 15) / 
+                        ((MECHID_SPEED_HIGH + MECHID_SPEED_LOW) / 2));
+
+    kp = (bandwidthTs * pParm->inertia) >> 4;
+    if (kp > 32767)
+    {
+        kp = 32767;
+    }
+    ki = (kp * bandwidthTs) >> 13;
+    if (ki < 1)
+    {
+        ki = 1;
+    }
+    pParm->qSpeedKp = (int16_t)kp;
+    pParm->qSpeedKi = (int16_t)ki;
+    pParm->valid = 1;
+}
@@ -0,0 +1,102 @@
+/*******************************************************************************
+* Copyright (c) 2017 released Microchip Technology Inc.  All rights reserved.
+*
+* SOFTWARE LICENSE AGREEMENT:
+* 
+* Microchip Technology Incorporated ("Microchip") retains all ownership and
+* intellectual property rights in the code accompanying this message and in all
+* derivatives hereto.  You may use this code, and any derivatives created by
+* any person or entity by or on your behalf, exclusively with Microchip's
+* proprietary products.  Your acceptance and/or use of this code constitutes
+* agreement to the terms and conditions of this notice.
+*
+* CODE ACCOMPANYING THIS MESSAGE IS SUPPLIED BY MICROCHIP "AS IS".  NO
+* WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
+* TO, IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE APPLY TO THIS CODE, ITS INTERACTION WITH MICROCHIP'S
+* PRODUCTS, COMBINATION WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION.
+*
+* YOU ACKNOWLEDGE AND AGREE THAT, IN NO EVENT, SHALL MICROCHIP BE LIABLE,
+* WHETHER IN CONTRACT, WARRANTY, TORT (INCLUDING NEGLIGENCE OR BREACH OF
+* STATUTORY DUTY),STRICT LIABILITY, INDEMNITY, CONTRIBUTION, OR OTHERWISE,
+* FOR ANY INDIRECT, SPECIAL,PUNITIVE, EXEMPLARY, INCIDENTAL OR CONSEQUENTIAL
+* LOSS, DAMAGE, FOR COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE CODE,
+* HOWSOEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE POSSIBILITY OR
+* THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT ALLOWABLE BY LAW,
+* MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY RELATED TO THIS CODE,
+* SHALL NOT EXCEED THE PRICE YOU PAID DIRECTLY TO MICROCHIP SPECIFICALLY TO
+* HAVE THIS CODE DEVELOPED.
+*
+* You agree that you are solely responsible for testing the code and
+* determining its suitability.  Microchip has no obligation to modify, test,
+* certify, or support the code.
+*
+*******************************************************************************/
+#ifndef __MECHID_H
+#define __MECHID_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/* Identification sequence states */
+#define MECHID_STATE_IDLE       0
+/* Decelerate below the speed band when started above it */
+#define MECHID_STATE_PREPARE    1
+/* Positive torque step through the speed band */
+#define MECHID_STATE_ACCEL      2
+/* Negative torque step back through the speed band */
+#define MECHID_STATE_DECEL      3
+/* Results available, speed controller to be updated */
+#define MECHID_STATE_DONE       4
+
+/* Mechanical Identification Parameter data type
+
+  Description:
+    This structure will host parameters related to the inertia and friction
+    identification. Speeds are electrical RPM (estimator.qVelEstim), 
+    currents are normalized as ctrlParm.qVqRef, times are loop cycles.
+ */
+typedef struct
+{
+    /* Set to start the identification, cleared when started */
+    uint16_t request;
+    /* MECHID_STATE_xxx */
+    uint16_t state;
+    /* Rotation direction of the sequence, 1 or -1 */
+    int16_t direction;
+    /* Loop cycles spent in the speed band, up to timeout */
+    uint32_t count;
+    /* Loop cycles spent in the present state */
+    uint32_t timer;
+    /* MECHID_TIMEOUT at the PWM frequency of the sequence */
+    uint32_t timeout;
+    /* Speed band crossing times with positive and negative torque */
+    uint32_t accelTime;
+    uint32_t decelTime;
+    /* Measured q current magnitude summed over the band crossings */
+    int32_t accelCurrent;
+    int32_t decelCurrent;
+    /* Inertia - current needed for a speed change of 1 per loop cycle */
+    int32_t inertia;
+    /* Friction current at the middle of the speed band */
+    int16_t frictionCurrent;
+    /* Viscous friction - current per speed, Q15 */
+    int16_t qViscous;
+    /* Speed controller gains for SPEEDCNTR_BANDWIDTH_HZ */
+    int16_t qSpeedKp;
+    int16_t qSpeedKi;
+    /* Set when the last sequence completed */
+    uint16_t valid;
+} MECHID_PARM_T;
+
+void MechIdInitialize(MECHID_PARM_T *);
+int16_t MechIdentification(MECHID_PARM_T *,int16_t,int16_t);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MECHID_H */
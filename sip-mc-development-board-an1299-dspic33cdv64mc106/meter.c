@@ -0,0 +1,191 @@
+/*******************************************************************************
+ * Copyright (c) 2017 released Microchip Technology Inc.  All rights reserved.
+ *
+ * SOFTWARE LICENSE AGREEMENT:
+ *
+ * Microchip Technology Incorporated ("Microchip") retains all ownership and
+ * intellectual property rights in the code accompanying this message and in all
+ * derivatives hereto.  You may use this code, and any derivatives created by
+ * any person or entity by or on your behalf, exclusively with Microchip's
+ * proprietary products.  Your acceptance and/or use of this code constitutes
+ * agreement to the terms and conditions of this notice.
+ *
+ * CODE ACCOMPANYING THIS MESSAGE IS SUPPLIED BY MICROCHIP "AS IS".  NO
+ * WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
+ * TO, IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE APPLY TO THIS CODE, ITS INTERACTION WITH MICROCHIP'S
+ * PRODUCTS, COMBINATION WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION.
+ *
+ * YOU ACKNOWLEDGE AND AGREE THAT, IN NO EVENT, SHALL MICROCHIP BE LIABLE,
+ * WHETHER IN CONTRACT, WARRANTY, TORT (INCLUDING NEGLIGENCE OR BREACH OF
+ * STATUTORY DUTY),STRICT LIABILITY, INDEMNITY, CONTRIBUTION, OR OTHERWISE,
+ * FOR ANY INDIRECT, SPECIAL,PUNITIVE, EXEMPLARY, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, FOR COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE CODE,
+ * HOWSOEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE POSSIBILITY OR
+ * THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT ALLOWABLE BY LAW,
+ * MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY RELATED TO THIS CODE,
+ * SHALL NOT EXCEED THE PRICE YOU PAID DIRECTLY TO MICROCHIP SPECIFICALLY TO
+ * HAVE THIS CODE DEVELOPED.
+ *
+ * You agree that you are solely responsible for testing the code and
+ * determining its suitability.  Microchip has no obligation to modify, test,
+ * certify, or support the code.
+ *
+ *******************************************************************************/
+#include <stdint.h>
+#include "meter.h"
+#include "userparms.h"
+#include "general.h"
+#include "pwm.h"
+
+// *****************************************************************************
+/* Function:
+    MeterInitialize()
+
+  Summary:
+    Clears the energy counters
+
+  Description:
+    Clears the energy counters and restarts the averaging.
+
+  Precondition:
+    The PWM timing (pwmTiming) is calculated.
+
+  Parameters:
+    pMeter - Power meter data
+
+  Returns:
+    None.
+
+  Remarks:
+    Called at power up, the counters are kept when the motor stops.
+ */
+void MeterInitialize(METER_T *pMeter)
+{
+    pMeter->acEnergy = 0;
+    pMeter->shaftEnergy = 0;
+    pMeter->dcEnergy = 0;
+    MeterRestart(pMeter);
+}
+// *****************************************************************************
+/* Function:
+    MeterRestart()
+
+  Summary:
+    Restarts the averaging
+
+  Description:
+    Clears the sums and the average powers, the energy scale is updated 
+    for the loop time in use.
+
+  Precondition:
+    The PWM timing (pwmTiming) is calculated.
+
+  Parameters:
+    pMeter - Power meter data
+
+  Returns:
+    None.
+
+  Remarks:
+    None.
+ */
+void MeterRestart(METER_T *pMeter)
+{
+    pMeter->sumAcPower = 0;
+    pMeter->sumShaftPower = 0;
+    pMeter->sumDcCurrent = 0;
+    pMeter->count = 0;
+    pMeter->qAcPower = 0;
+    pMeter->qShaftPower = 0;
+    pMeter->qDcPower = 0;
+    pMeter->qDcCurrent = 0;
+    pMeter->qEfficiency = 0;
+    pMeter->energyScale = PWMScaleLoopTime(METER_ENERGY_SCALE);
+}
+// *****************************************************************************
+/* Function:
+    MeterStep()
+
+  Summary:
+    Accumulates the powers of one control cycle
+
+  Description:
+    Every cycle the products vd*id + vq*iq (electrical power) and 
+    Esd*id + Esq*iq (air gap power, the estimated torque times the speed) 
+    and the DC bus current are added to the sums. Every 
+    2^METER_DECIMATION_BITS cycles the averages are scaled by the voltage
+    base: with SVM a d-q voltage of 1 is a phase voltage amplitude of 
+    Vbus/sqrt(3), so P = 3/2*v*i = sqrt(3)/2*Vbus*(vd*id + vq*iq). The 
+    energy counters are updated with the averages.
+
+  Precondition:
+    None.
+
+  Parameters:
+    pMeter - Power meter data
+    pVdq   - Voltage applied in the cycle, shifted right by 
+             VOLTAGE_SCALE_SHIFT
+    pIdq   - Currents measured in the cycle
+    pEstim - Estimator data, BEMF/2 in qEsdf and qEsqf
+    idc    - DC bus current of the cycle
+    vbus   - Measured DC bus voltage
+    vbase  - DC bus voltage the voltage commands are normalized to
+
+  Returns:
+    None.
+
+  Remarks:
+    The shaft power does not include the friction and iron losses.
+ */
+void MeterStep(METER_T *pMeter,const MC_DQ_T *pVdq,const MC_DQ_T *pIdq,
+               const ESTIM_PARM_T *pEstim,int16_t idc,int16_t vbus,
+               int16_t vbase)
+{
+    int16_t average;
+    
+    pMeter->sumAcPower += (__builtin_mulss(pVdq->d,pIdq->d) + 
+                           __builtin_mulss(pVdq->q,pIdq->q)) >> 
+                                            (15 - VOLTAGE_SCALE_SHIFT);
+    pMeter->sumShaftPower += (__builtin_mulss(pEstim->qEsdf,pIdq->d) + 
+                              __builtin_mulss(pEstim->qEsqf,pIdq->q)) >> 14;
+    pMeter->sumDcCurrent += idc;
+    
+    pMeter->count++;
+    if (pMeter->count < (1 << METER_DECIMATION_BITS))
+    {
+        return;
+    }
+    pMeter->count = 0;
+    
+    /* sqrt(3)/2*Vbus is applied as (Vbus*Q15(sqrt(3)/4)) << 1 */
+    vbase = (int16_t)(__builtin_mulss(vbase,Q15(0.4330127)) >> 14);
+    average = SaturateQ15(pMeter->sumAcPower >> METER_DECIMATION_BITS);
+    pMeter->qAcPower = (int16_t)(__builtin_mulss(average,vbase) >> 15);
+    average = SaturateQ15(pMeter->sumShaftPower >> METER_DECIMATION_BITS);
+    pMeter->qShaftPower = (int16_t)(__builtin_mulss(average,vbase) >> 15);
+    pMeter->qDcCurrent = SaturateQ15(pMeter->sumDcCurrent >> 
+                                     METER_DECIMATION_BITS);
+    pMeter->qDcPower = (int16_t)(__builtin_mulss(pMeter->qDcCurrent,vbus) 
+                                 >> 15);
+    pMeter->sumAcPower = 0;
+    pMeter->sumShaftPower = 0;
+    pMeter->sumDcCurrent = 0;
+    
+    if ((pMeter->qDcPower > METER_EFFICIENCY_POWER_MIN) && 
+        (pMeter->qShaftPower > 0) && 
+        (pMeter->qShaftPower < pMeter->qDcPower))
+    {
+        pMeter->qEfficiency = __builtin_divsd(
+                (int32_t)pMeter->qShaftPower << 15,pMeter->qDcPower);
+    }
+    else
+    {
+        pMeter->qEfficiency = 0;
+    }
+    
+    pMeter->acEnergy += __builtin_mulss(pMeter->qAcPower,pMeter->energyScale);
+    pMeter->shaftEnergy += __builtin_mulss(pMeter->qShaftPower,
+                                           pMeter->energyScale);
+    pMeter->dcEnergy += __builtin_mulss(pMeter->qDcPower,pMeter->energyScale);
+}
@@ -0,0 +1,101 @@
+/*******************************************************************************
+* Copyright (c) 2017 released Microchip Technology Inc.  All rights reserved.
+*
+* SOFTWARE LICENSE AGREEMENT:
+* 
+* Microchip Technology Incorporated ("Microchip") retains all ownership and
+* intellectual property rights in the code accompanying this message and in all
+* derivatives hereto.  You may use this code, and any derivatives created by
+* any person or entity by or on your behalf, exclusively with Microchip's
+* proprietary products.  Your acceptance and/or use of this code constitutes
+* agreement to the terms and conditions of this notice.
+*
+* CODE ACCOMPANYING THIS MESSAGE IS SUPPLIED BY MICROCHIP "AS IS".  NO
+* WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
+* TO, IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE APPLY TO THIS CODE, ITS INTERACTION WITH MICROCHIP'S
+* PRODUCTS, COMBINATION WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION.
+*
+* YOU ACKNOWLEDGE AND AGREE THAT, IN NO EVENT, SHALL MICROCHIP BE LIABLE,
+* WHETHER IN CONTRACT, WARRANTY, TORT (INCLUDING NEGLIGENCE OR BREACH OF
+* STATUTORY DUTY),STRICT LIABILITY, INDEMNITY, CONTRIBUTION, OR OTHERWISE,
+* FOR ANY INDIRECT, SPECIAL,PUNITIVE, EXEMPLARY, INCIDENTAL OR CONSEQUENTIAL
+* LOSS, DAMAGE, FOR COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE CODE,
+* HOWSOEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE POSSIBILITY OR
+* THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT ALLOWABLE BY LAW,
+* MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY RELATED TO THIS CODE,
+* SHALL NOT EXCEED THE PRICE YOU PAID DIRECTLY TO MICROCHIP SPECIFICALLY TO
+* HAVE THIS CODE DEVELOPED.
+*
+* You agree that you are solely responsible for testing the code and
+* determining its suitability.  Microchip has no obligation to modify, test,
+* certify, or support the code.
+*
+*******************************************************************************/
+#ifndef __METER_H
+#define __METER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "motor_control_noinline.h"
+#include "estim.h"
+
+/* The powers are averaged and the energies accumulated every 
+   2^METER_DECIMATION_BITS control cycles, 12.8ms at 20kHz */
+#define METER_DECIMATION_BITS   8
+/* Energy added per decimation period at full scale power, scaled to the 
+   loop time */
+#define METER_ENERGY_SCALE      1024
+/* Power base (Q15 full scale) in W: DC bus voltage and current at the ADC
+   full scale */
+#define METER_POWER_BASE_WATTS  (DC_BUS_FULL_SCALE_VOLTS*NORM_CURRENT_CONST* \
+                                 32768.0)
+/* Energy counter unit in Ws */
+#define METER_ENERGY_UNIT_WS    (METER_POWER_BASE_WATTS/32768.0* \
+                                 LOOPTIME_SEC*(1 << METER_DECIMATION_BITS)/ \
+                                 METER_ENERGY_SCALE)
+/* DC input power below which the efficiency is not calculated */
+#define METER_EFFICIENCY_POWER_MIN  Q15(0.005)
+    
+/* Power Meter data type
+
+  Description:
+    This structure will host the power and energy metering of an axis. The
+    powers are in Q15 of METER_POWER_BASE_WATTS, positive when motoring.
+ */
+typedef struct
+{
+    /* Sums over the decimation period */
+    int32_t sumAcPower;
+    int32_t sumShaftPower;
+    int32_t sumDcCurrent;
+    uint16_t count;
+    /* Average powers of the last decimation period */
+    int16_t qAcPower;
+    int16_t qShaftPower;
+    int16_t qDcPower;
+    /* Average DC bus current, Q15 of the current full scale */
+    int16_t qDcCurrent;
+    /* Shaft over DC input power in Q15, motor and inverter efficiency */
+    int16_t qEfficiency;
+    /* Energy added per decimation period at full scale power */
+    int16_t energyScale;
+    /* Energy counters in METER_ENERGY_UNIT_WS */
+    int64_t acEnergy;
+    int64_t shaftEnergy;
+    int64_t dcEnergy;
+} METER_T;
+
+void MeterInitialize(METER_T *);
+void MeterRestart(METER_T *);
+void MeterStep(METER_T *,const MC_DQ_T *,const MC_DQ_T *,
+               const ESTIM_PARM_T *,int16_t,int16_t,int16_t);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __METER_H */
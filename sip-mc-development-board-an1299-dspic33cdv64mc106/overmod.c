@@ -0,0 +1,208 @@
+/*******************************************************************************
+ * Copyright (c) 2017 released Microchip Technology Inc.  All rights reserved.
+ *
+ * SOFTWARE LICENSE AGREEMENT:
+ *
+ * Microchip Technology Incorporated ("Microchip") retains all ownership and
+ * intellectual property rights in the code accompanying this message and in all
+ * derivatives hereto.  You may use this code, and any derivatives created by
+ * any person or entity by or on your behalf, exclusively with Microchip's
+ * proprietary products.  Your acceptance and/or use of this code constitutes
+ * agreement to the terms and conditions of this notice.
+ *
+ * CODE ACCOMPANYING THIS MESSAGE IS SUPPLIED BY MICROCHIP "AS IS".  NO
+ * WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
+ * TO, IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE APPLY TO THIS CODE, ITS INTERACTION WITH MICROCHIP'S
+ * PRODUCTS, COMBINATION WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION.
+ *
+ * YOU ACKNOWLEDGE AND AGREE THAT, IN NO EVENT, SHALL MICROCHIP BE LIABLE,
+ * WHETHER IN CONTRACT, WARRANTY, TORT (INCLUDING NEGLIGENCE OR BREACH OF
+ * STATUTORY DUTY),STRICT LIABILITY, INDEMNITY, CONTRIBUTION, OR OTHERWISE,
+ * FOR ANY INDIRECT, SPECIAL,PUNITIVE, EXEMPLARY, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, FOR COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE CODE,
+ * HOWSOEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE POSSIBILITY OR
+ * THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT ALLOWABLE BY LAW,
+ * MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY RELATED TO THIS CODE,
+ * SHALL NOT EXCEED THE PRICE YOU PAID DIRECTLY TO MICROCHIP SPECIFICALLY TO
+ * HAVE THIS CODE DEVELOPED.
+ *
+ * You agree that you are solely responsible for testing the code and
+ * determining its suitability.  Microchip has no obligation to modify, test,
+ * certify, or support the code.
+ *
+ *******************************************************************************/
+#include <libq.h>
+#include "overmod.h"
+#include "userparms.h"
+#include "general.h"
+
+// *****************************************************************************
+/* Function:
+    Overmodulation()
+
+  Summary:
+    Voltage vector generation with overmodulation up to six step
+
+  Description:
+    Replaces the inverse Park and inverse Clarke transforms ahead of the 
+    space vector modulation. vdq and the alpha-beta voltage are at half 
+    scale, so amplitudes above the linear range (inscribed circle) up to 
+    six step are not lost.
+    Region I : the phase references are scaled to the hexagon boundary, 
+               keeping the angle of the voltage vector.
+    Region II: the vector on the hexagon boundary is moved towards the 
+               nearest hexagon vertex, reaching six step at OVM_SIXSTEP.
+    The resulting Va,Vb,Vc are within the hexagon and full scale, so they
+    can be used with both the dual shunt and single shunt SVM functions.
+
+  Precondition:
+    None.
+
+  Parameters:
+    pOvermod    - Overmodulation data of the axis
+    pVdq        - d-q voltage reference, half scale
+    pSinCos     - sine and cosine of the angle
+    pVAlphaBeta - Output - applied alpha-beta voltage, half scale 
+                  (used by the estimator)
+    pVabc       - Output - phase references for SVM 
+                  (swapped input inverse Clarke)
+
+  Returns:
+    None.
+
+  Remarks:
+    None.
+ */
+void Overmodulation(OVERMOD_PARM_T *pOvermod,const MC_DQ_T *pVdq,
+                    const MC_SINCOS_T *pSinCos,MC_ALPHABETA_T *pVAlphaBeta,
+                    MC_ABC_T *pVabc)
+{
+    MC_ABC_T vabcHalf;
+    int16_t vabc[3];
+    int16_t peak,gain,small,large;
+    uint16_t i,iMax;
+
+    pOvermod->qMagnitude = _Q15sqrt((int16_t)((__builtin_mulss(pVdq->d,
+                        pVdq->d) + __builtin_mulss(pVdq->q,pVdq->q)) >> 15));
+    
+    MC_TransformParkInverse_Assembly(pVdq,pSinCos,pVAlphaBeta);
+    MC_TransformClarkeInverseSwappedInput_Assembly(pVAlphaBeta,&vabcHalf);
+    
+    vabc[0] = vabcHalf.a;
+    vabc[1] = vabcHalf.b;
+    vabc[2] = vabcHalf.c;
+    
+    /* The phase with the highest magnitude sets T1+T2 of the SVM */
+    iMax = 0;
+    peak = _Q15abs(vabc[0]);
+    for (i = 1; i < 3; i++)
+    {
+        if (_Q15abs(vabc[i]) > peak)
+        {
+            peak = _Q15abs(vabc[i]);
+            iMax = i;
+        }
+    }
+    pOvermod->qPeak = peak;
+    
+    if (peak < Q15(0.5))
+    {
+        /* Linear range */
+        for (i = 0; i < 3; i++)
+        {
+            vabc[i] = vabc[i] << 1;
+        }
+        pOvermod->qSixStep = 0;
+    }
+    else
+    {
+        /* Region I - scale to the hexagon boundary, peak becomes full scale */
+        gain = (int16_t)__builtin_divsd((int32_t)16383 << 15,peak);
+        for (i = 0; i < 3; i++)
+        {
+            vabc[i] = (int16_t)(__builtin_mulss(vabc[i],gain) >> 14);
+        }
+        
+        /* Region II - the two other phases have opposite sign to the peak
+           phase, the smaller one is reduced to move towards the vertex */
+        if (pOvermod->qMagnitude > Q15(OVM_REGION2_START/2))
+        {
+            if (pOvermod->qMagnitude >= Q15(OVM_SIXSTEP/2))
+            {
+                pOvermod->qSixStep = Q15(0.99997);
+            }
+            else
+            {
+                pOvermod->qSixStep = (int16_t)__builtin_divsd(
+                    (int32_t)(pOvermod->qMagnitude - 
+                              Q15(OVM_REGION2_START/2)) << 15,
+                    Q15(OVM_SIXSTEP/2) - Q15(OVM_REGION2_START/2));
+            }
+            small = vabc[(iMax + 1) % 3];
+            large = vabc[(iMax + 2) % 3];
+            if (_Q15abs(small) > _Q15abs(large))
+            {
+                small = large;
+                i = (iMax + 1) % 3;
+            }
+            else
+            {
+                i = (iMax + 2) % 3;
+            }
+            small = small - (int16_t)(__builtin_mulss(small,
+                                            pOvermod->qSixStep) >> 15);
+            /* Va + Vb + Vc = 0 */
+            vabc[i] = -vabc[iMax] - small;
+            vabc[3 - iMax - i] = small;
+        }
+        else
+        {
+            pOvermod->qSixStep = 0;
+        }
+        
+        /* Applied alpha-beta voltage at half scale : 
+           alpha = (Vb - Vc)/sqrt(3), beta = Va */
+        pVAlphaBeta->beta = vabc[0] >> 1;
+        pVAlphaBeta->alpha = (int16_t)(__builtin_mulss(
+                    (vabc[1] >> 1) - (vabc[2] >> 1),Q15(0.57735027)) >> 15);
+    }
+    
+    pVabc->a = vabc[0];
+    pVabc->b = vabc[1];
+    pVabc->c = vabc[2];
+}
+// *****************************************************************************
+/* Function:
+    OvermodulationVqLimit()
+
+  Summary:
+    q axis voltage limit with d axis priority in the overmodulation range
+
+  Description:
+    vq = sqrt(vs^2 - vd^2) with vs^2 = OVM_MAX_VOLTAGE_VECTOR, vd and vq 
+    are at half scale as vs exceeds the Q15 range
+
+  Precondition:
+    None.
+
+  Parameters:
+    vd - d axis voltage, half scale
+
+  Returns:
+    q axis voltage limit, half scale.
+
+  Remarks:
+    None.
+ */
+int16_t OvermodulationVqLimit(int16_t vd)
+{
+    int16_t temp;
+    
+    temp = (int16_t)(__builtin_mulss(vd,vd) >> 15);
+    if (temp >= Q15(OVM_MAX_VOLTAGE_VECTOR/4))
+    {
+        return 0;
+    }
+    return _Q15sqrt(Q15(OVM_MAX_VOLTAGE_VECTOR/4) - temp);
+}
@@ -0,0 +1,80 @@
+/*******************************************************************************
+* Copyright (c) 2017 released Microchip Technology Inc.  All rights reserved.
+*
+* SOFTWARE LICENSE AGREEMENT:
+* 
+* Microchip Technology Incorporated ("Microchip") retains all ownership and
+* intellectual property rights in the code accompanying this message and in all
+* derivatives hereto.  You may use this code, and any derivatives created by
+* any person or entity by or on your behalf, exclusively with Microchip's
+* proprietary products.  Your acceptance and/or use of this code constitutes
+* agreement to the terms and conditions of this notice.
+*
+* CODE ACCOMPANYING THIS MESSAGE IS SUPPLIED BY MICROCHIP "AS IS".  NO
+* WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
+* TO, IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE APPLY TO THIS CODE, ITS INTERACTION WITH MICROCHIP'S
+* PRODUCTS, COMBINATION WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION.
+*
+* YOU ACKNOWLEDGE AND AGREE THAT, IN NO EVENT, SHALL MICROCHIP BE LIABLE,
+* WHETHER IN CONTRACT, WARRANTY, TORT (INCLUDING NEGLIGENCE OR BREACH OF
+* STATUTORY DUTY),STRICT LIABILITY, INDEMNITY, CONTRIBUTION, OR OTHERWISE,
+* FOR ANY INDIRECT, SPECIAL,PUNITIVE, EXEMPLARY, INCIDENTAL OR CONSEQUENTIAL
+* LOSS, DAMAGE, FOR COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE CODE,
+* HOWSOEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE POSSIBILITY OR
+* THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT ALLOWABLE BY LAW,
+* MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY RELATED TO THIS CODE,
+* SHALL NOT EXCEED THE PRICE YOU PAID DIRECTLY TO MICROCHIP SPECIFICALLY TO
+* HAVE THIS CODE DEVELOPED.
+*
+* You agree that you are solely responsible for testing the code and
+* determining its suitability.  Microchip has no obligation to modify, test,
+* certify, or support the code.
+*
+*******************************************************************************/
+#ifndef __OVERMOD_H
+#define __OVERMOD_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "motor_control_noinline.h"
+    
+/* Voltage amplitudes relative to the radius of the circle inscribed in the 
+   SVM hexagon. With OVERMODULATION vdq is at half scale, the inscribed 
+   circle is Q15(0.5) (VOLTAGE_SCALE_SHIFT in userparms.h) */
+/* Maximum voltage vector (squared amplitude) with overmodulation - six step 
+   fundamental amplitude is 2*sqrt(3)/pi = 1.1027 */
+#define OVM_MAX_VOLTAGE_VECTOR      1.216
+/* End of overmodulation region I and start of region II */
+#define OVM_REGION2_START           1.0494
+/* Six step operation */
+#define OVM_SIXSTEP                 1.1027
+
+/* Overmodulation Parameter data type
+
+  Description:
+    This structure will host parameters related to overmodulation function.
+ */
+typedef struct
+{
+    /* Voltage vector amplitude, half scale */
+    int16_t qMagnitude;
+    /* Highest phase reference before the hexagon limit, half scale. 
+       Over 0.5 the reference is out of the linear range */
+    int16_t qPeak;
+    /* Region II factor, 0 = hexagon boundary, Q15(1) = six step */
+    int16_t qSixStep;
+} OVERMOD_PARM_T;
+
+void Overmodulation(OVERMOD_PARM_T *,const MC_DQ_T *,const MC_SINCOS_T *,
+                    MC_ALPHABETA_T *,MC_ABC_T *);
+int16_t OvermodulationVqLimit(int16_t vd);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __OVERMOD_H */
@@ -43,8 +43,7 @@
 #include "userparms.h"
 
 #include "control.h"   
-#include "estim.h"
-#include "fdweak.h"
+#include "axis.h"
 
 #include "clock.h"
 #include "pwm.h"
@@ -56,31 +55,12 @@
 #include "hal/uart2.h"
 #include "singleshunt.h"
 #include "measure.h"
+#include "predict.h"
 #include "hardware_access_functions.h"
 
-volatile UGF_T uGF;
-
-CTRL_PARM_T ctrlParm;
-MOTOR_STARTUP_DATA_T motorStartUpData;
-
-volatile int16_t thetaElectrical = 0,thetaElectricalOpenLoop = 0;
-uint16_t pwmPeriod;
-
-MC_ALPHABETA_T valphabeta,ialphabeta;
-MC_SINCOS_T sincosTheta;
-MC_DQ_T vdq,idq;
-MC_DUTYCYCLEOUT_T pwmDutycycle;
-MC_ABC_T   vabc,iabc;
-
-MC_PIPARMIN_T piInputIq;
-MC_PIPARMOUT_T piOutputIq;
-MC_PIPARMIN_T piInputId;
-MC_PIPARMOUT_T piOutputId;
-MC_PIPARMIN_T piInputOmega;
-MC_PIPARMOUT_T piOutputOmega;
+MOTOR_AXIS_T axisA;
 
 volatile uint16_t adcDataBuffer;
-MCAPP_MEASURE_T measureInputs;
 
 /** Definitions */
 /* Open loop angle scaling Constant - This corresponds to 1024(2^10)
@@ -89,11 +69,61 @@ MCAPP_MEASURE_T measureInputs;
 /* Fraction of dc link voltage(expressed as a squared amplitude) to set 
  * the limit for current controllers PI Output */
 #define MAX_VOLTAGE_VECTOR                      0.92
+#if defined(VOLTAGE_FEED_FORWARD) || defined(DEADBEAT_CURRENT_CONTROL) || \
+    defined(DOUBLE_UPDATE)
+/* Electrical speed (estimator.qVelEstim) to omega*Ts scaling in Q15, the 
+   constant is 2^12 times larger to keep resolution: 2*pi/60*Ts*2^(15+12) */
+#define OMEGA_TS_SCALE              (int16_t)(2*3.14159265*LOOPTIME_SEC/60.0 \
+                                                *134217728.0 + 0.5)
+#define OMEGA_TS_SCALE_SHIFT        12
+#endif
+#ifdef MOSFET_TEMPERATURE_DERATING
+/* Reduction of the q current limit per degC */
+#define MOSFET_TEMP_DERATE_SLOPE    ((SPEEDCNTR_OUTMAX - \
+                                      MOSFET_TEMP_DERATE_CURRENT) / \
+                                     (MOSFET_TEMP_DERATE_END - \
+                                      MOSFET_TEMP_DERATE_START))
+#endif
+#ifdef CURRCNTR_GAIN_CALCULATION
+/* Current loop bandwidth times the loop time in Q15 */
+#define CURRCNTR_BANDWIDTH_TS   Q15(2*3.14159265*CURRCNTR_BANDWIDTH_HZ* \
+                                    LOOPTIME_SEC)
+#endif
 
-void InitControlParameters(void);
-void DoControl( void );
-void CalculateParkAngle(void);
+void InitControlParameters(MOTOR_AXIS_T *);
+void InitAxisParameters(MOTOR_AXIS_T *);
+void DoControl(MOTOR_AXIS_T *);
+void CalculateParkAngle(MOTOR_AXIS_T *);
+void AxisControlStep(MOTOR_AXIS_T *);
+void CalculateModulation(MOTOR_AXIS_T *);
+int16_t CalculateVqLimit(MOTOR_AXIS_T *,int16_t);
+#ifdef MOSFET_TEMPERATURE_DERATING
+void CalculateThermalDerating(MOTOR_AXIS_T *);
+#endif
+#ifdef IQ_LIMIT_DERATING
+void CalculateIqLimit(MOTOR_AXIS_T *);
+#endif
+#ifdef STALL_DETECTION
+void StallSupervisor(MOTOR_AXIS_T *);
+#endif
+#ifdef FAULT_SNAPSHOT
+void RecordSnapshot(MOTOR_AXIS_T *);
+#endif
+#ifdef POWER_METERING
+int16_t CalculateDcCurrent(MOTOR_AXIS_T *);
+#endif
 void ResetParmeters(void);
+void ApplyConfigurationRequest(void);
+inline static void ADCInterruptStep(MOTOR_AXIS_T *);
+#ifdef CURRCNTR_GAIN_CALCULATION
+void CalculateCurrentControlGains(MOTOR_AXIS_T *,int16_t,int16_t,int16_t);
+#endif
+#ifdef VOLTAGE_FEED_FORWARD
+void CalculateVoltageFeedForward(MOTOR_AXIS_T *);
+#endif
+#ifdef DOUBLE_UPDATE
+void DoubleUpdatePeakStep(MOTOR_AXIS_T *);
+#endif
 
 // *****************************************************************************
 /* Function:
@@ -122,6 +152,28 @@ void ResetParmeters(void);
 int main ( void )
 {
     InitOscillator();
+    /* Peripherals are initialized for the default current sensing mode */
+    axisA.ctrlParm.currentSensing = CURRENT_SENSING_DEFAULT;
+    axisA.ctrlParm.currentSensingRequest = CURRENT_SENSING_DEFAULT;
+    /* Peripherals are initialized for the default PWM frequency */
+    PWMCalculateTiming(PWMFREQUENCY_HZ);
+    axisA.ctrlParm.pwmFrequencyRequest = pwmTiming.frequency;
+#ifdef DISCONTINUOUS_PWM
+    DpwmInitialize(&axisA.dpwmParm);
+#endif
+    MCAPP_MeasureFilterInit(&axisA.measureInputs);
+#ifdef POWER_METERING
+    MeterInitialize(&axisA.meter);
+#endif
+#ifdef I2T_PROTECTION
+    I2tInitialize(&axisA.i2tParm);
+#endif
+#ifdef FAULT_SNAPSHOT
+    SnapshotInitialize(&axisA.snapshot);
+#endif
+#ifdef FLASH_FAULT_LOG
+    FlashLogInitialize(&axisA.flashLog);
+#endif
     /* Reset parameters used for running motor through Inverter A*/
     ResetParmeters();
     SetupGPIOPorts();
@@ -147,10 +199,31 @@ int main ( void )
         {
             DiagnosticsStepMain();
             BoardService();
+#ifdef FLASH_FAULT_LOG
+#ifdef MOSFET_TEMPERATURE_DERATING
+            FlashLogTemperature(&axisA.flashLog,
+                                axisA.measureInputs.mosfetTemperature);
+#endif
+            /* The log is written while the motor is stopped */
+            FlashLogService(&axisA.flashLog,axisA.uGF.bits.RunMotor,
+                ((uint16_t)inverterGateDriver[BSP_GATE_DRIVER_A_INDEX].
+                                            status0Data.byte << 8) |
+                inverterGateDriver[BSP_GATE_DRIVER_A_INDEX].status1Data.byte);
+#endif
+            
+            /* Change of current sensing mode and PWM frequency is applied 
+               while stopped */
+            if ((axisA.uGF.bits.RunMotor == 0) && 
+                ((axisA.ctrlParm.currentSensingRequest != 
+                  axisA.ctrlParm.currentSensing) ||
+                 (axisA.ctrlParm.pwmFrequencyRequest != pwmTiming.frequency)))
+            {
+                ApplyConfigurationRequest();
+            }
   
             if (IsPressed_Button1())
             {
-                if  (uGF.bits.RunMotor == 1)
+                if  (axisA.uGF.bits.RunMotor == 1)
                 {
                     ResetParmeters();
                     LED2 = 0;
@@ -161,7 +234,10 @@ int main ( void )
                     ChargeBootstrapCapacitors();
                     
                     EnablePWMOutputsInverterA();
-                    uGF.bits.RunMotor = 1;
+#ifdef FLASH_FAULT_LOG
+                    FlashLogStart(&axisA.flashLog);
+#endif
+                    axisA.uGF.bits.RunMotor = 1;
                     LED2 = 1;
                 }
 
@@ -169,9 +245,10 @@ int main ( void )
             // Monitoring for Button 2 press
             if (IsPressed_Button2())
             {
-                if ((uGF.bits.RunMotor == 1) && (uGF.bits.OpenLoop == 0))
+                if ((axisA.uGF.bits.RunMotor == 1) && 
+                    (axisA.uGF.bits.OpenLoop == 0))
                 {
-                    uGF.bits.ChangeSpeed = !uGF.bits.ChangeSpeed;
+                    axisA.uGF.bits.ChangeSpeed = !axisA.uGF.bits.ChangeSpeed;
                 }
             }
 
@@ -182,6 +259,54 @@ int main ( void )
     while(1){}
 }
 // *****************************************************************************
+/* Function:
+    ApplyConfigurationRequest()
+
+  Summary:
+    Applies the requested current sensing mode and PWM frequency
+
+  Description:
+    With the ADC interrupt and the PWM outputs disabled the PWM and ADC are
+    configured for the requested current sensing mode and PWM frequency, 
+    then the parameters of Inverter A are reset for them.
+
+  Precondition:
+    The motor is stopped.
+
+  Parameters:
+    None
+
+  Returns:
+    None.
+
+  Remarks:
+    Called from the main loop only, the fault and stop paths reset the 
+    parameters without changing the configuration.
+ */
+void ApplyConfigurationRequest(void)
+{
+    MOTOR_AXIS_T *pAxis = &axisA;
+    
+	DisableADCInterrupt();
+    DisablePWMOutputsInverterA();
+    
+    if (pAxis->ctrlParm.currentSensingRequest != pAxis->ctrlParm.currentSensing)
+    {
+        pAxis->ctrlParm.currentSensing = pAxis->ctrlParm.currentSensingRequest;
+        PWMConfigureCurrentSensing(pAxis->ctrlParm.currentSensing);
+        ADCConfigureCurrentSensing(pAxis->ctrlParm.currentSensing);
+    }
+    /* The loop time dependent parameters are derived from the frequency by
+       ResetParmeters() */
+    if (pAxis->ctrlParm.pwmFrequencyRequest != pwmTiming.frequency)
+    {
+        PWMSetFrequency(pAxis->ctrlParm.pwmFrequencyRequest);
+        /* Out of range request is limited by PWMSetFrequency */
+        pAxis->ctrlParm.pwmFrequencyRequest = pwmTiming.frequency;
+    }
+    ResetParmeters();
+}
+// *****************************************************************************
 /* Function:
     ResetParmsA()
 
@@ -205,21 +330,31 @@ int main ( void )
  */
 void ResetParmeters(void)
 {
+    MOTOR_AXIS_T *pAxis = &axisA;
+    
     /* Make sure ADC does not generate interrupt while initializing parameters*/
 	DisableADCInterrupt();
     
-#ifdef SINGLE_SHUNT
-    /* Initialize Single Shunt Related parameters */
-    SingleShunt_InitializeParameters(&singleShuntParam);
     INVERTERA_PWM_TRIGA = ADC_SAMPLING_POINT;
-    INVERTERA_PWM_TRIGB = LOOPTIME_TCY>>1;
-    INVERTERA_PWM_TRIGC = LOOPTIME_TCY-1;
+    if (pAxis->ctrlParm.currentSensing == CURRENT_SENSING_SINGLE_SHUNT)
+    {
+        INVERTERA_PWM_TRIGB = pwmTiming.loopTimeTcy>>1;
+        INVERTERA_PWM_TRIGC = pwmTiming.loopTimeTcy-1;
+#ifdef SINGLE_SHUNT_OVERSAMPLING
+        INVERTERA_PWM_OVS_TRIGB = (pwmTiming.loopTimeTcy>>1) - SS_OVERSAMPLE_SPACING;
+        INVERTERA_PWM_OVS_TRIGC = (pwmTiming.loopTimeTcy-1) - SS_OVERSAMPLE_SPACING;
+#endif
+    }
+#ifdef DOUBLE_UPDATE
+    else
+    {
+        /* Second control step at the PWM peak */
+        INVERTERA_PWM_TRIGB = pwmTiming.loopTimeTcy-1;
+    }
+#endif
     INVERTERA_PWM_PHASE3 = MIN_DUTY;
     INVERTERA_PWM_PHASE2 = MIN_DUTY;
     INVERTERA_PWM_PHASE1 = MIN_DUTY;
-#else
-    INVERTERA_PWM_TRIGA = ADC_SAMPLING_POINT;
-#endif
     /* Re initialize the duty cycle to minimum value */
     INVERTERA_PWM_PDC3 = MIN_DUTY;
     INVERTERA_PWM_PDC2 = MIN_DUTY;
@@ -227,30 +362,112 @@ void ResetParmeters(void)
     
     DisablePWMOutputsInverterA();
     
+    /* Stop the motor and reinitialize the control of Inverter A */
+    InitAxisParameters(pAxis);
+
+    /* Enable ADC interrupt and begin main loop timing */
+    if (pAxis->ctrlParm.currentSensing == CURRENT_SENSING_SINGLE_SHUNT)
+    {
+        ClearADCIFSingleShunt();
+        adcDataBuffer = ClearADCIF_ReadADCBUFSingleShunt();
+        EnableADCInterruptSingleShunt();
+    }
+    else
+    {
+        ClearADCIFDualShunt();
+        adcDataBuffer = ClearADCIF_ReadADCBUFDualShunt();
+        EnableADCInterruptDualShunt();
+#ifdef DOUBLE_UPDATE
+        /* AN1 interrupt at the PWM peak */
+        ClearADCIFSingleShunt();
+        adcDataBuffer = ClearADCIF_ReadADCBUFSingleShunt();
+        EnableADCInterruptSingleShunt();
+#endif
+    }
+}
+// *****************************************************************************
+/* Function:
+    InitAxisParameters()
+
+  Summary:
+    Resets the control state of a motor axis
+
+  Description:
+    Stops the motor and reinitializes the estimator, controllers, field 
+    weakening and measurement of the axis for a restart in open loop.
+    The PWM and ADC of the inverter are not accessed.
+
+  Precondition:
+    The loop time (pwmTiming) is set.
+
+  Parameters:
+    pAxis - Motor axis
+
+  Returns:
+    None.
+
+  Remarks:
+    None.
+ */
+void InitAxisParameters(MOTOR_AXIS_T *pAxis)
+{
     /* Stop the motor   */
-    uGF.bits.RunMotor = 0;        
+    pAxis->uGF.bits.RunMotor = 0;        
     /* Set the reference speed value to 0 */
-    ctrlParm.qVelRef = 0;
+    pAxis->ctrlParm.qVelRef = 0;
     /* Restart in open loop */
-    uGF.bits.OpenLoop = 1;
+    pAxis->uGF.bits.OpenLoop = 1;
     /* Change speed */
-    uGF.bits.ChangeSpeed = 0;
+    pAxis->uGF.bits.ChangeSpeed = 0;
     /* Change mode */
-    uGF.bits.ChangeMode = 1;
+    pAxis->uGF.bits.ChangeMode = 1;
     
-    /* Initialize PI control parameters */
-    InitControlParameters();        
+    /* Initialize Single Shunt Related parameters */
+    SingleShunt_InitializeParameters(&pAxis->singleShuntParam);
+#ifdef DISCONTINUOUS_PWM
+    pAxis->singleShuntParam.pDpwm = &pAxis->dpwmParm;
+#endif
+#ifdef DOUBLE_UPDATE
+#ifdef DEADBEAT_CURRENT_CONTROL
+    /* The deadbeat controller compensates the delay of one PWM cycle */
+    pAxis->doubleUpdate.active = 0;
+#else
+    pAxis->doubleUpdate.active = 1;
+#endif
+    pAxis->doubleUpdate.overrunCount = 0;
+    pAxis->doubleUpdate.qVdPeak = 0;
+    pAxis->doubleUpdate.qVqPeak = 0;
+#endif
     /* Initialize estimator parameters */
-    InitEstimParm();
+    InitEstimParm(&pAxis->estimator,&pAxis->motorParm);
+    /* Initialize PI control parameters */
+    InitControlParameters(pAxis);        
     /* Initialize flux weakening parameters */
-    InitFWParams();
+    InitFWParams(&pAxis->fdWeakParm);
     /* Initialize measurement parameters */
-    MCAPP_MeasureCurrentInit(&measureInputs);
-
-    /* Enable ADC interrupt and begin main loop timing */
-    ClearADCIF();
-    adcDataBuffer = ClearADCIF_ReadADCBUF();
-    EnableADCInterrupt();
+    MCAPP_MeasureCurrentInit(&pAxis->measureInputs);
+#ifdef DC_BUS_COMPENSATION
+    DcBusCompInitialize(&pAxis->dcBusComp);
+#endif
+#ifdef POWER_METERING
+    /* The energy counters are kept */
+    MeterRestart(&pAxis->meter);
+#endif
+#ifdef I2T_PROTECTION
+    /* The thermal state is kept */
+    I2tRestart(&pAxis->i2tParm);
+#endif
+#ifdef STALL_DETECTION
+    StallInitialize(&pAxis->stallParm);
+#endif
+#ifdef MECHANICAL_IDENTIFICATION
+    /* Stop the identification sequence */
+    MechIdInitialize(&pAxis->mechIdParm);
+#endif
+#ifdef COGGING_COMPENSATION
+    /* The learned table is kept */
+    CoggingInitialize(&pAxis->coggingParm);
+#endif
 }
 // *****************************************************************************
 /* Function:
@@ -267,7 +484,7 @@ void ResetParmeters(void)
     None.
 
   Parameters:
-    None
+    pAxis - Motor axis
 
   Returns:
     None.
@@ -275,77 +492,80 @@ void ResetParmeters(void)
   Remarks:
     None.
  */
-void DoControl( void )
+void DoControl(MOTOR_AXIS_T *pAxis)
 {
+#ifdef DEADBEAT_CURRENT_CONTROL
     /* Temporary variables for sqrt calculation of q reference */
     volatile int16_t temp_qref_pow_q15;
+    MC_DQ_T idqRef,bemfdq;
+    int16_t omegaTs,omegaLs;
+#endif
     
-    if  (uGF.bits.OpenLoop)
+    if  (pAxis->uGF.bits.OpenLoop)
     {
         /* OPENLOOP:  force rotating angle,Vd and Vq */
-        if  (uGF.bits.ChangeMode)
+        if  (pAxis->uGF.bits.ChangeMode)
         {
             /* Just changed to open loop */
-            uGF.bits.ChangeMode = 0;
+            pAxis->uGF.bits.ChangeMode = 0;
 
             /* Synchronize angles */
             /* VqRef & VdRef not used */
-            ctrlParm.qVqRef = 0;
-            ctrlParm.qVdRef = 0;
+            pAxis->ctrlParm.qVqRef = 0;
+            pAxis->ctrlParm.qVdRef = 0;
 
             /* Reinitialize variables for initial speed ramp */
-            motorStartUpData.startupLock = 0;
-            motorStartUpData.startupRamp = 0;
+            pAxis->motorStartUpData.startupLock = 0;
+            pAxis->motorStartUpData.startupRamp = 0;
             #ifdef TUNING
-                motorStartUpData.tuningAddRampup = 0;
-                motorStartUpData.tuningDelayRampup = 0;
+                pAxis->motorStartUpData.tuningAddRampup = 0;
+                pAxis->motorStartUpData.tuningDelayRampup = 0;
             #endif
         }
 
         /* PI control for D */
-        piInputId.inMeasure = idq.d;
-        piInputId.inReference  = ctrlParm.qVdRef;
-        MC_ControllerPIUpdate_Assembly(piInputId.inReference,
-                                       piInputId.inMeasure,
-                                       &piInputId.piState,
-                                       &piOutputId.out);
-        vdq.d = piOutputId.out;
+        pAxis->piInputId.inMeasure = pAxis->idq.d;
+        pAxis->piInputId.inReference  = pAxis->ctrlParm.qVdRef;
+        MC_ControllerPIUpdate_Assembly(pAxis->piInputId.inReference,
+                                       pAxis->piInputId.inMeasure,
+                                       &pAxis->piInputId.piState,
+                                       &pAxis->piOutputId.out);
+        pAxis->vdq.d = pAxis->piOutputId.out;
          /* Dynamic d-q adjustment
          with d component priority 
          vq=sqrt (vs^2 - vd^2) 
         limit vq maximum to the one resulting from the calculation above */
-        temp_qref_pow_q15 = (int16_t)(__builtin_mulss(piOutputId.out ,
-                                                      piOutputId.out) >> 15);
-        temp_qref_pow_q15 = Q15(MAX_VOLTAGE_VECTOR) - temp_qref_pow_q15;
-        piInputIq.piState.outMax = _Q15sqrt (temp_qref_pow_q15);
-        piInputIq.piState.outMin = - piInputIq.piState.outMax;    
+        pAxis->piInputIq.piState.outMax = CalculateVqLimit(pAxis,
+                                                           pAxis->vdq.d);
+        pAxis->piInputIq.piState.outMin = - pAxis->piInputIq.piState.outMax;    
         /* PI control for Q */
         /* Speed reference */
-        ctrlParm.qVelRef = Q_CURRENT_REF_OPENLOOP;
+        pAxis->ctrlParm.qVelRef = Q_CURRENT_REF_OPENLOOP;
         /* q current reference is equal to the velocity reference 
          while d current reference is equal to 0
         for maximum startup torque, set the q current to maximum acceptable 
         value represents the maximum peak value */
-        ctrlParm.qVqRef = ctrlParm.qVelRef;
-        piInputIq.inMeasure = idq.q;
-        piInputIq.inReference = ctrlParm.qVqRef;
-        MC_ControllerPIUpdate_Assembly(piInputIq.inReference,
-                                       piInputIq.inMeasure,
-                                       &piInputIq.piState,
-                                       &piOutputIq.out);
-        vdq.q = piOutputIq.out;
+        pAxis->ctrlParm.qVqRef = pAxis->ctrlParm.qVelRef;
+        pAxis->piInputIq.inMeasure = pAxis->idq.q;
+        pAxis->piInputIq.inReference = pAxis->ctrlParm.qVqRef;
+        MC_ControllerPIUpdate_Assembly(pAxis->piInputIq.inReference,
+                                       pAxis->piInputIq.inMeasure,
+                                       &pAxis->piInputIq.piState,
+                                       &pAxis->piOutputIq.out);
+        pAxis->vdq.q = pAxis->piOutputIq.out;
 
     }
     else
     /* Closed Loop Vector Control */
     {
         /* if change speed indication, double the speed */
-        if (uGF.bits.ChangeSpeed)
+        if (pAxis->uGF.bits.ChangeSpeed)
         {
             
             /* Potentiometer value is scaled between NOMINALSPEED_ELECTR and 
              * MAXIMUMSPEED_ELECTR to set the speed reference*/
-            ctrlParm.targetSpeed = (__builtin_mulss(measureInputs.potValue,
+            pAxis->ctrlParm.targetSpeed = (__builtin_mulss(
+                    pAxis->measureInputs.potValue,
                     MAXIMUMSPEED_ELECTR-NOMINALSPEED_ELECTR)>>15)+
                     NOMINALSPEED_ELECTR;  
         }
@@ -355,129 +575,503 @@ void DoControl( void )
             /* Potentiometer value is scaled between ENDSPEED_ELECTR 
              * and NOMINALSPEED_ELECTR to set the speed reference*/
             
-            ctrlParm.targetSpeed = (__builtin_mulss(measureInputs.potValue,
+            pAxis->ctrlParm.targetSpeed = (__builtin_mulss(
+                    pAxis->measureInputs.potValue,
                     NOMINALSPEED_ELECTR-ENDSPEED_ELECTR)>>15) +
                     ENDSPEED_ELECTR;  
             
         }
-        if  (ctrlParm.speedRampCount < SPEEDREFRAMP_COUNT)
+        if  (pAxis->ctrlParm.speedRampCount < 
+             pAxis->ctrlParm.speedRampCountLimit)
         {
-           ctrlParm.speedRampCount++; 
+           pAxis->ctrlParm.speedRampCount++; 
         }
         else
         {
+#ifdef SPEED_PROFILE_SCURVE
+            /* Jerk limited speed reference */
+            pAxis->ctrlParm.qVelRef = SpeedProfile(&pAxis->speedProfile,
+                                            pAxis->ctrlParm.targetSpeed);
+#else
             /* Ramp generator to limit the change of the speed reference
               the rate of change is defined by CtrlParm.qRefRamp */
-            ctrlParm.qDiff = ctrlParm.qVelRef - ctrlParm.targetSpeed;
+            pAxis->ctrlParm.qDiff = pAxis->ctrlParm.qVelRef - 
+                                    pAxis->ctrlParm.targetSpeed;
             /* Speed Ref Ramp */
-            if (ctrlParm.qDiff < 0)
+            if (pAxis->ctrlParm.qDiff < 0)
             {
                 /* Set this cycle reference as the sum of
                 previously calculated one plus the reference ramp value */
-                ctrlParm.qVelRef = ctrlParm.qVelRef+ctrlParm.qRefRamp;
+                pAxis->ctrlParm.qVelRef = pAxis->ctrlParm.qVelRef +
+                                          pAxis->ctrlParm.qRefRamp;
             }
             else
             {
                 /* Same as above for speed decrease */
-                ctrlParm.qVelRef = ctrlParm.qVelRef-ctrlParm.qRefRamp;
+                pAxis->ctrlParm.qVelRef = pAxis->ctrlParm.qVelRef -
+                                          pAxis->ctrlParm.qRefRamp;
             }
             /* If difference less than half of ref ramp, set reference
             directly from the pot */
-            if (_Q15abs(ctrlParm.qDiff) < (ctrlParm.qRefRamp << 1))
+            if (_Q15abs(pAxis->ctrlParm.qDiff) < 
+                (pAxis->ctrlParm.qRefRamp << 1))
             {
-                ctrlParm.qVelRef = ctrlParm.targetSpeed;
+                pAxis->ctrlParm.qVelRef = pAxis->ctrlParm.targetSpeed;
             }
-            ctrlParm.speedRampCount = 0;
+#endif
+            pAxis->ctrlParm.speedRampCount = 0;
         }
         /* Tuning is generating a software ramp
         with sufficiently slow ramp defined by 
         TUNING_DELAY_RAMPUP constant */
         #ifdef TUNING
             /* if delay is not completed */
-            if (motorStartUpData.tuningDelayRampup > TUNING_DELAY_RAMPUP)
+            if (pAxis->motorStartUpData.tuningDelayRampup > TUNING_DELAY_RAMPUP)
             {
-                motorStartUpData.tuningDelayRampup = 0;
+                pAxis->motorStartUpData.tuningDelayRampup = 0;
             }
             /* While speed less than maximum and delay is complete */
-            if ((motorStartUpData.tuningAddRampup < (MAXIMUMSPEED_ELECTR - ENDSPEED_ELECTR)) &&
-                                                  (motorStartUpData.tuningDelayRampup == 0) )
+            if ((pAxis->motorStartUpData.tuningAddRampup < 
+                            (MAXIMUMSPEED_ELECTR - ENDSPEED_ELECTR)) &&
+                (pAxis->motorStartUpData.tuningDelayRampup == 0) )
             {
                 /* Increment ramp add */
-                motorStartUpData.tuningAddRampup++;
+                pAxis->motorStartUpData.tuningAddRampup++;
             }
-            motorStartUpData.tuningDelayRampup++;
+            pAxis->motorStartUpData.tuningDelayRampup++;
             /* The reference is continued from the open loop speed up ramp */
-            ctrlParm.qVelRef = ENDSPEED_ELECTR +  motorStartUpData.tuningAddRampup;
+            pAxis->ctrlParm.qVelRef = ENDSPEED_ELECTR + 
+                                      pAxis->motorStartUpData.tuningAddRampup;
         #endif
 
-        if (uGF.bits.ChangeMode)
+        if (pAxis->uGF.bits.ChangeMode)
         {
             /* Just changed from open loop */
-            uGF.bits.ChangeMode = 0;
-            piInputOmega.piState.integrator = (int32_t)ctrlParm.qVqRef << 13;
-            ctrlParm.qVelRef = ENDSPEED_ELECTR;
+            pAxis->uGF.bits.ChangeMode = 0;
+            pAxis->piInputOmega.piState.integrator = 
+                                        (int32_t)pAxis->ctrlParm.qVqRef << 13;
+            pAxis->ctrlParm.qVelRef = ENDSPEED_ELECTR;
+#ifdef SPEED_PROFILE_SCURVE
+            SpeedProfileInitialize(&pAxis->speedProfile,ENDSPEED_ELECTR);
+#endif
+#ifdef STALL_DETECTION
+            /* The estimator settles before the checks start */
+            StallBlank(&pAxis->stallParm);
+#endif
+#ifdef VOLTAGE_FEED_FORWARD
+            /* Bumpless transfer - the feed forward takes over its part of 
+               the current PI integrators */
+            CalculateVoltageFeedForward(pAxis);
+            pAxis->piInputId.piState.integrator = (int32_t)SaturateQ15(
+                    (pAxis->piInputId.piState.integrator >> 16) - 
+                    pAxis->vdqFeedForward.d) << 16;
+            pAxis->piInputIq.piState.integrator = (int32_t)SaturateQ15(
+                    (pAxis->piInputIq.piState.integrator >> 16) - 
+                    pAxis->vdqFeedForward.q) << 16;
+#endif
+#ifdef DEADBEAT_CURRENT_CONTROL
+            /* The deadbeat controller continues from the open loop voltage */
+            DeadbeatInitialize(&pAxis->deadbeatParm,&pAxis->vdq);
+#endif
         }
 
         /* If TORQUE MODE skip the speed controller */
         #ifndef	TORQUE_MODE
             /* Execute the velocity control loop */
-            piInputOmega.inMeasure = estimator.qVelEstim;
-            piInputOmega.inReference = ctrlParm.qVelRef;
-            MC_ControllerPIUpdate_Assembly(piInputOmega.inReference,
-                                           piInputOmega.inMeasure,
-                                           &piInputOmega.piState,
-                                           &piOutputOmega.out);
-            ctrlParm.qVqRef = piOutputOmega.out;
+            pAxis->piInputOmega.inMeasure = pAxis->estimator.qVelEstim;
+            pAxis->piInputOmega.inReference = pAxis->ctrlParm.qVelRef;
+#ifdef SPEED_PROFILE_SCURVE
+            /* The PI output limits are shifted by the acceleration feed 
+               forward, so the sum stays within the q current limit */
+            pAxis->piInputOmega.piState.outMax = pAxis->ctrlParm.qIqLimit - 
+                                          pAxis->speedProfile.qAccelFeedForward;
+            pAxis->piInputOmega.piState.outMin = -pAxis->ctrlParm.qIqLimit - 
+                                          pAxis->speedProfile.qAccelFeedForward;
+#elif defined(IQ_LIMIT_DERATING)
+            pAxis->piInputOmega.piState.outMax = pAxis->ctrlParm.qIqLimit;
+            pAxis->piInputOmega.piState.outMin = -pAxis->ctrlParm.qIqLimit;
+#endif
+            MC_ControllerPIUpdate_Assembly(pAxis->piInputOmega.inReference,
+                                           pAxis->piInputOmega.inMeasure,
+                                           &pAxis->piInputOmega.piState,
+                                           &pAxis->piOutputOmega.out);
+#ifdef SPEED_PROFILE_SCURVE
+            pAxis->ctrlParm.qVqRef = pAxis->piOutputOmega.out + 
+                              pAxis->speedProfile.qAccelFeedForward;
+#else
+            pAxis->ctrlParm.qVqRef = pAxis->piOutputOmega.out;
+#endif
+#ifdef COGGING_COMPENSATION
+            if (_Q15abs(pAxis->estimator.qVelEstim) < COGGING_SPEED_MAX)
+            {
+                CoggingLearn(&pAxis->coggingParm,pAxis->estimator.qRho,
+                             pAxis->estimator.qVelEstim);
+                pAxis->ctrlParm.qVqRef = CoggingCompensation(
+                                            &pAxis->coggingParm,
+                                            pAxis->estimator.qRho,
+                                            pAxis->ctrlParm.qVqRef);
+            }
+            else
+            {
+                /* Restart the learning when back below COGGING_SPEED_MAX */
+                pAxis->coggingParm.learnCount = 0;
+            }
+#endif
         #else
-            ctrlParm.qVqRef = ctrlParm.qVelRef;
+            pAxis->ctrlParm.qVqRef = pAxis->ctrlParm.qVelRef;
         #endif
+#ifdef MECHANICAL_IDENTIFICATION
+        /* Identification sequence replaces the speed controller output */
+        if ((pAxis->mechIdParm.request != 0) || 
+            (pAxis->mechIdParm.state != MECHID_STATE_IDLE))
+        {
+            pAxis->ctrlParm.qVqRef = MechIdentification(&pAxis->mechIdParm,
+                                                 pAxis->estimator.qVelEstim,
+                                                 pAxis->idq.q);
+            if (pAxis->mechIdParm.state == MECHID_STATE_DONE)
+            {
+                pAxis->piInputOmega.piState.kp = pAxis->mechIdParm.qSpeedKp;
+                pAxis->piInputOmega.piState.ki = pAxis->mechIdParm.qSpeedKi;
+#ifdef SPEED_PROFILE_SCURVE
+                pAxis->speedProfile.inertia = pAxis->mechIdParm.inertia;
+#endif
+                pAxis->mechIdParm.state = MECHID_STATE_IDLE;
+            }
+            if (pAxis->mechIdParm.state == MECHID_STATE_IDLE)
+            {
+                /* Done or aborted - speed control continues from the 
+                   present speed and current */
+                pAxis->piInputOmega.piState.integrator = 
+                                        (int32_t)pAxis->ctrlParm.qVqRef << 16;
+                pAxis->ctrlParm.qVelRef = pAxis->estimator.qVelEstim;
+#ifdef SPEED_PROFILE_SCURVE
+                SpeedProfileInitialize(&pAxis->speedProfile,
+                                       pAxis->estimator.qVelEstim);
+#endif
+            }
+        }
+#endif
+#ifdef IQ_LIMIT_DERATING
+        /* Thermal derating of the q current reference */
+        if (pAxis->ctrlParm.qVqRef > pAxis->ctrlParm.qIqLimit)
+        {
+            pAxis->ctrlParm.qVqRef = pAxis->ctrlParm.qIqLimit;
+        }
+        else if (pAxis->ctrlParm.qVqRef < -pAxis->ctrlParm.qIqLimit)
+        {
+            pAxis->ctrlParm.qVqRef = -pAxis->ctrlParm.qIqLimit;
+        }
+#endif
+#ifdef STALL_DETECTION
+        if (pAxis->stallParm.state == STALL_STATE_CATCH)
+        {
+            /* Catch spin - no torque while the estimator tracks the 
+               coasting rotor, the field weakening follows the estimated 
+               speed */
+            pAxis->ctrlParm.qVqRef = 0;
+            pAxis->ctrlParm.qVelRef = pAxis->estimator.qVelEstim;
+            pAxis->piInputOmega.piState.integrator = 0;
+        }
+#endif
         
         /* Flux weakening control - the actual speed is replaced 
         with the reference speed for stability 
         reference for d current component 
         adapt the estimator parameters in concordance with the speed */
-        ctrlParm.qVdRef=FieldWeakening(_Q15abs(ctrlParm.qVelRef));
-
+        pAxis->ctrlParm.qVdRef = FieldWeakening(&pAxis->fdWeakParm,
+                                            &pAxis->estimator,
+                                            &pAxis->motorParm,
+                                            _Q15abs(pAxis->ctrlParm.qVelRef));
+
+#ifdef DEADBEAT_CURRENT_CONTROL
+        /* Deadbeat current control instead of the d and q PI controllers,
+           pAxis->vdq is the voltage applied in the present cycle */
+        idqRef.d = pAxis->ctrlParm.qVdRef;
+        idqRef.q = pAxis->ctrlParm.qVqRef;
+        /* BEMF/2 as calculated by the estimator */
+        bemfdq.d = pAxis->estimator.qEsdf;
+        bemfdq.q = pAxis->estimator.qEsqf;
+        /* omega*Ts in Q15 and omega*Ls (omega*Ts*qLsDt) */
+        omegaTs = (int16_t)(__builtin_mulss(pAxis->estimator.qVelEstim,
+                                            pAxis->omegaTsScale) 
+                                            >> OMEGA_TS_SCALE_SHIFT);
+        omegaLs = (int16_t)(__builtin_mulss(omegaTs,pAxis->motorParm.qLsDt) 
+                                            >> 15);
+        DeadbeatCurrentControl(&pAxis->deadbeatParm,&pAxis->idq,&idqRef,&bemfdq,
+                               pAxis->motorParm.qRs,pAxis->motorParm.qLsDt,
+                               omegaLs,&pAxis->vdq);
+
+        /* Dynamic d-q adjustment with d component priority, 
+           vq=sqrt (vs^2 - vd^2) */
+        temp_qref_pow_q15 = CalculateVqLimit(pAxis,pAxis->vdq.d);
+        if (pAxis->vdq.q > temp_qref_pow_q15)
+        {
+            pAxis->vdq.q = temp_qref_pow_q15;
+        }
+        else if (pAxis->vdq.q < -temp_qref_pow_q15)
+        {
+            pAxis->vdq.q = -temp_qref_pow_q15;
+        }
+#else
+#ifdef VOLTAGE_FEED_FORWARD
+        CalculateVoltageFeedForward(pAxis);
+        /* The PI output limits are shifted by the feed forward voltage, so
+           the sum is limited and the PI anti windup remains effective */
+        pAxis->piInputId.piState.outMax = SaturateQ15(
+                    (int32_t)(D_CURRCNTR_OUTMAX >> VOLTAGE_SCALE_SHIFT) - 
+                    pAxis->vdqFeedForward.d);
+        pAxis->piInputId.piState.outMin = SaturateQ15(
+                    -(int32_t)(D_CURRCNTR_OUTMAX >> VOLTAGE_SCALE_SHIFT) - 
+                    pAxis->vdqFeedForward.d);
+#endif
         /* PI control for D */
-        piInputId.inMeasure = idq.d;
-        piInputId.inReference  = ctrlParm.qVdRef;
-        MC_ControllerPIUpdate_Assembly(piInputId.inReference,
-                                       piInputId.inMeasure,
-                                       &piInputId.piState,
-                                       &piOutputId.out);
-        vdq.d    = piOutputId.out;
+        pAxis->piInputId.inMeasure = pAxis->idq.d;
+        pAxis->piInputId.inReference  = pAxis->ctrlParm.qVdRef;
+        MC_ControllerPIUpdate_Assembly(pAxis->piInputId.inReference,
+                                       pAxis->piInputId.inMeasure,
+                                       &pAxis->piInputId.piState,
+                                       &pAxis->piOutputId.out);
+#ifdef VOLTAGE_FEED_FORWARD
+        pAxis->vdq.d    = SaturateQ15((int32_t)pAxis->piOutputId.out + 
+                                      pAxis->vdqFeedForward.d);
+#else
+        pAxis->vdq.d    = pAxis->piOutputId.out;
+#endif
 
         /* Dynamic d-q adjustment
          with d component priority 
          vq=sqrt (vs^2 - vd^2) 
         limit vq maximum to the one resulting from the calculation above */
-        temp_qref_pow_q15 = (int16_t)(__builtin_mulss(piOutputId.out ,
-                                                      piOutputId.out) >> 15);
-        temp_qref_pow_q15 = Q15(MAX_VOLTAGE_VECTOR) - temp_qref_pow_q15;
-        piInputIq.piState.outMax = _Q15sqrt (temp_qref_pow_q15);
-        piInputIq.piState.outMin = - piInputIq.piState.outMax;
+        pAxis->piInputIq.piState.outMax = CalculateVqLimit(pAxis,
+                                                           pAxis->vdq.d);
+        pAxis->piInputIq.piState.outMin = - pAxis->piInputIq.piState.outMax;
+#ifdef VOLTAGE_FEED_FORWARD
+        pAxis->piInputIq.piState.outMin = SaturateQ15(
+                    (int32_t)pAxis->piInputIq.piState.outMin - 
+                    pAxis->vdqFeedForward.q);
+        pAxis->piInputIq.piState.outMax = SaturateQ15(
+                    (int32_t)pAxis->piInputIq.piState.outMax - 
+                    pAxis->vdqFeedForward.q);
+#endif
         /* PI control for Q */
-        piInputIq.inMeasure  = idq.q;
-        piInputIq.inReference  = ctrlParm.qVqRef;
-        MC_ControllerPIUpdate_Assembly(piInputIq.inReference,
-                                       piInputIq.inMeasure,
-                                       &piInputIq.piState,
-                                       &piOutputIq.out);
-        vdq.q = piOutputIq.out;
+        pAxis->piInputIq.inMeasure  = pAxis->idq.q;
+        pAxis->piInputIq.inReference  = pAxis->ctrlParm.qVqRef;
+        MC_ControllerPIUpdate_Assembly(pAxis->piInputIq.inReference,
+                                       pAxis->piInputIq.inMeasure,
+                                       &pAxis->piInputIq.piState,
+                                       &pAxis->piOutputIq.out);
+#ifdef VOLTAGE_FEED_FORWARD
+        pAxis->vdq.q = SaturateQ15((int32_t)pAxis->piOutputIq.out + 
+                                   pAxis->vdqFeedForward.q);
+#else
+        pAxis->vdq.q = pAxis->piOutputIq.out;
+#endif
+#endif
     }
       
 }
+#ifdef VOLTAGE_FEED_FORWARD
 // *****************************************************************************
 /* Function:
-   _ADCInterrupt()
+    CalculateVoltageFeedForward()
 
   Summary:
-   _ADCInterrupt() ISR routine
+    Calculates the d-q voltage feed forward of the current controllers
 
   Description:
-    Does speed calculation and executes the vector update loop
-    The ADC sample and conversion is triggered by the PWM period.
-    The speed calculation assumes a fixed time interval between calculations.
+    Cross coupling decoupling (CURRENT_DECOUPLING): 
+        Vd_ff = -omega*Ls*Iq
+        Vq_ff =  omega*Ls*Id
+    omega*Ls is normalized as in the estimator, where the inductive voltage
+    is qLsDt*dI >> 7 for the current difference over one PWM cycle, 
+    so omega*Ls*I = (omega*Ts*qLsDt)*I >> 7.
+    BEMF and resistive voltage (BEMF_FEED_FORWARD):
+        Vd_ff += Rs*IdRef
+        Vq_ff += Rs*IqRef + BEMF
+    In the estimator omega = (qInvKFi*BEMF/2 >> 15) << 2, 
+    so BEMF = (omega << 14)/qInvKFi. Rs*I is qRs*I >> 11 (qRs is Rs/2).
+    The terms are calculated at the voltage scale of vdq, shifted right by
+    VOLTAGE_SCALE_SHIFT.
+
+  Precondition:
+    None.
+
+  Parameters:
+    pAxis - Motor axis
+
+  Returns:
+    None.
+
+  Remarks:
+    Closed loop only, as the speed is taken from the estimator.
+ */
+void CalculateVoltageFeedForward(MOTOR_AXIS_T *pAxis)
+{
+    int32_t vd = 0,vq = 0;
+#ifdef CURRENT_DECOUPLING
+    int16_t omegaTs,omegaLs;
+#endif
+#ifdef BEMF_FEED_FORWARD
+    int32_t omegaShifted,bemfLimit;
+#endif
+    
+#ifdef CURRENT_DECOUPLING
+    /* omega*Ts in Q15 */
+    omegaTs = (int16_t)(__builtin_mulss(pAxis->estimator.qVelEstim,
+                                            pAxis->omegaTsScale) 
+                                        >> OMEGA_TS_SCALE_SHIFT);
+    omegaLs = (int16_t)(__builtin_mulss(omegaTs,pAxis->motorParm.qLsDt) >> 15);
+    vd = -(__builtin_mulss(omegaLs,pAxis->idq.q) >> 
+                                                (7 + VOLTAGE_SCALE_SHIFT));
+    vq = __builtin_mulss(omegaLs,pAxis->idq.d) >> (7 + VOLTAGE_SCALE_SHIFT);
+#endif
+#ifdef BEMF_FEED_FORWARD
+    /* BEMF = (omega << 14)/InvKFi, limited to the Q15 range */
+    omegaShifted = (int32_t)pAxis->estimator.qVelEstim << 
+                                                (14 - VOLTAGE_SCALE_SHIFT);
+    bemfLimit = __builtin_mulss(pAxis->motorParm.qInvKFi,32767);
+    if (omegaShifted >= bemfLimit)
+    {
+        vq += 32767;
+    }
+    else if (omegaShifted <= -bemfLimit)
+    {
+        vq -= 32767;
+    }
+    else
+    {
+        vq += __builtin_divsd(omegaShifted,pAxis->motorParm.qInvKFi);
+    }
+    /* Resistive voltage drop from the current references */
+    vd += __builtin_mulss(pAxis->motorParm.qRs,pAxis->ctrlParm.qVdRef) >> 
+                                                (11 + VOLTAGE_SCALE_SHIFT);
+    vq += __builtin_mulss(pAxis->motorParm.qRs,pAxis->ctrlParm.qVqRef) >> 
+                                                (11 + VOLTAGE_SCALE_SHIFT);
+#endif
+    pAxis->vdqFeedForward.d = SaturateQ15(vd);
+    pAxis->vdqFeedForward.q = SaturateQ15(vq);
+}
+#endif
+#ifdef DOUBLE_UPDATE
+// *****************************************************************************
+/* Function:
+    DoubleUpdatePeakStep()
+
+  Summary:
+    Current control step at the PWM peak of the double update mode
+
+  Description:
+    The phase currents can not be measured at the PWM peak with the low 
+    side shunts. The d-q currents sampled at the valley are predicted over
+    half a cycle with the motor model, normalized as in Estim():
+        Ls/dt*di_d = v_d - Rs*i_d + omega*Ls*i_q - E_d
+        Ls/dt*di_q = v_q - Rs*i_q - omega*Ls*i_d - E_q
+    using the voltage applied in the first half cycle. The d and q current
+    PIs are executed with the predicted currents, the references, limits 
+    and feed forward of the valley step, and the voltage is modulated at 
+    the angle advanced by half a cycle. The integrators are only updated 
+    in the valley step, so the integral gains stay per PWM cycle.
+
+  Precondition:
+    Closed loop with the current PI controllers, otherwise the valley step 
+    voltage is kept for the next cycle.
+
+  Parameters:
+    pAxis - Motor axis driven by Inverter A
+
+  Returns:
+    None.
+
+  Remarks:
+    The duty cycles are applied from the next PWM valley.
+ */
+void DoubleUpdatePeakStep(MOTOR_AXIS_T *pAxis)
+{
+    MC_DQ_T idqPeak,vdqPeak;
+    MC_SINCOS_T sincosPeak;
+    MC_ALPHABETA_T valphabetaPeak;
+    MC_ABC_T vabcPeak;
+    MC_DUTYCYCLEOUT_T pwmDutycyclePeak;
+    int32_t integrator;
+    int16_t omegaTs,omegaLs;
+    
+    if ((pAxis->uGF.bits.RunMotor == 0) || (pAxis->uGF.bits.OpenLoop == 1) || 
+        (pAxis->doubleUpdate.active == 0))
+    {
+        /* Valley step voltage is applied in the first half cycle too */
+        pAxis->doubleUpdate.qVdPeak = pAxis->vdq.d;
+        pAxis->doubleUpdate.qVqPeak = pAxis->vdq.q;
+        return;
+    }
+    
+    /* Currents at the PWM peak, half a cycle after the sampling */
+    omegaTs = (int16_t)(__builtin_mulss(pAxis->estimator.qVelEstim,
+                                            pAxis->omegaTsScale) 
+                                        >> OMEGA_TS_SCALE_SHIFT);
+    omegaLs = (int16_t)(__builtin_mulss(omegaTs,pAxis->motorParm.qLsDt) >> 15);
+    idqPeak.d = PredictCurrent(pAxis->doubleUpdate.qVdPeak,pAxis->idq.d,
+                               pAxis->estimator.qEsdf,
+                               __builtin_mulss(omegaLs,pAxis->idq.q) >> 7,
+                               pAxis->motorParm.qRs,pAxis->motorParm.qLsDt,
+                               PREDICT_SHIFT_HALF_CYCLE);
+    idqPeak.q = PredictCurrent(pAxis->doubleUpdate.qVqPeak,pAxis->idq.q,
+                               pAxis->estimator.qEsqf,
+                               -(__builtin_mulss(omegaLs,pAxis->idq.d) >> 7),
+                               pAxis->motorParm.qRs,pAxis->motorParm.qLsDt,
+                               PREDICT_SHIFT_HALF_CYCLE);
+
+    /* PI control for D and Q, proportional part only */
+    integrator = pAxis->piInputId.piState.integrator;
+    MC_ControllerPIUpdate_Assembly(pAxis->ctrlParm.qVdRef,idqPeak.d,
+                                   &pAxis->piInputId.piState,&vdqPeak.d);
+    pAxis->piInputId.piState.integrator = integrator;
+    integrator = pAxis->piInputIq.piState.integrator;
+    MC_ControllerPIUpdate_Assembly(pAxis->ctrlParm.qVqRef,idqPeak.q,
+                                   &pAxis->piInputIq.piState,&vdqPeak.q);
+    pAxis->piInputIq.piState.integrator = integrator;
+#ifdef VOLTAGE_FEED_FORWARD
+    vdqPeak.d = SaturateQ15((int32_t)vdqPeak.d + pAxis->vdqFeedForward.d);
+    vdqPeak.q = SaturateQ15((int32_t)vdqPeak.q + pAxis->vdqFeedForward.q);
+#endif
+    pAxis->doubleUpdate.qVdPeak = vdqPeak.d;
+    pAxis->doubleUpdate.qVqPeak = vdqPeak.q;
+#ifdef DC_BUS_COMPENSATION
+    vdqPeak.d = DcBusCompScale(&pAxis->dcBusComp,vdqPeak.d);
+    vdqPeak.q = DcBusCompScale(&pAxis->dcBusComp,vdqPeak.q);
+#endif
+
+    /* Angle advanced by half a cycle of the estimator angle integration */
+    MC_CalculateSineCosine_Assembly_Ram(pAxis->thetaElectrical + (int16_t)
+        (__builtin_mulss(pAxis->estimator.qOmegaMr,
+                         pAxis->estimator.qDeltaT) >> 16),
+        &sincosPeak);
+#ifdef OVERMODULATION
+    Overmodulation(&pAxis->overmodParm,&vdqPeak,&sincosPeak,&valphabetaPeak,
+                   &vabcPeak);
+#else
+    MC_TransformParkInverse_Assembly(&vdqPeak,&sincosPeak,&valphabetaPeak);
+    MC_TransformClarkeInverseSwappedInput_Assembly(&valphabetaPeak,
+                                                   &vabcPeak);
+#endif
+    MC_CalculateSpaceVectorPhaseShifted_Assembly(&vabcPeak,pAxis->pwmPeriod,
+                                                 &pwmDutycyclePeak);
+#ifdef DISCONTINUOUS_PWM
+    DpwmUpdateModulation(&pAxis->dpwmParm,&vdqPeak);
+    DpwmApply(&pAxis->dpwmParm,&pwmDutycyclePeak,pAxis->pwmPeriod);
+#endif
+    PWMDutyCycleSetDualEdge(&pwmDutycyclePeak,&pwmDutycyclePeak);
+}
+#endif
+// *****************************************************************************
+/* Function:
+   _ADCInterruptSingleShunt()
+
+  Summary:
+   _ADCInterruptSingleShunt() ISR routine
+
+  Description:
+    Single shunt current sensing: the bus current is sampled twice every PWM
+    period, the vector update loop is executed after the second sample.
 
   Precondition:
     None.
@@ -491,150 +1085,515 @@ void DoControl( void )
   Remarks:
     None.
  */
-void __attribute__((__interrupt__,no_auto_psv)) _ADCInterrupt()
+void __attribute__((__interrupt__,no_auto_psv)) _ADCInterruptSingleShunt()
 {  
-#ifdef SINGLE_SHUNT 
+    MOTOR_AXIS_T *pAxis = &axisA;
+    
+#ifdef DOUBLE_UPDATE
+    if (pAxis->ctrlParm.currentSensing == CURRENT_SENSING_DUAL_SHUNT)
+    {
+        /* Dual shunt double update - AN1 is converted at the PWM peak */
+        DoubleUpdatePeakStep(pAxis);
+        /* The peak step has to complete in the second half cycle */
+        if (PG1STATbits.CAHALF == 0)
+        {
+            pAxis->doubleUpdate.overrunCount++;
+        }
+        adcDataBuffer = ClearADCIF_ReadADCBUFSingleShunt();
+        ClearADCIFSingleShunt();
+        return;
+    }
+#endif
     if (IFS4bits.PWM1IF ==1)
     {
-        singleShuntParam.adcSamplePoint = 0;
+        pAxis->singleShuntParam.adcSamplePoint = 0;
         IFS4bits.PWM1IF = 0;
     }    
     /* If single shunt algorithm is enabled, two ADC interrupts will be
      serviced every PWM period in order to sample current twice and
      be able to reconstruct the three phases */
 
-    switch(singleShuntParam.adcSamplePoint)
+    switch(pAxis->singleShuntParam.adcSamplePoint)
     {
         case SS_SAMPLE_BUS1:
             /*Set Trigger to measure BusCurrent Second sample during PWM 
               Timer is counting up*/
-            singleShuntParam.adcSamplePoint = 1;  
+            pAxis->singleShuntParam.adcSamplePoint = 1;  
             /* Ibus is measured and offset removed from measurement*/
-            singleShuntParam.Ibus1 = (int16_t)(ADCBUF_INV_A_IBUS) - 
-                                            measureInputs.current.offsetIbus;                        
+#ifdef SINGLE_SHUNT_OVERSAMPLING
+            /* Average of the two conversions taken inside the window */
+            pAxis->singleShuntParam.Ibus1 = (int16_t)(((int32_t)ADCBUF_INV_A_IBUS +
+                                     ADCBUF_INV_A_IBUS_OVS) >> 1) -
+                    pAxis->measureInputs.current.offsetIbus;
+#else
+            pAxis->singleShuntParam.Ibus1 = (int16_t)(ADCBUF_INV_A_IBUS) - 
+                    pAxis->measureInputs.current.offsetIbus;
+#endif
         break;
 
         case SS_SAMPLE_BUS2:
             /*Set Trigger to measure BusCurrent first sample during PWM 
               Timer is counting up*/
             INVERTERA_PWM_TRIGA = ADC_SAMPLING_POINT;
-            singleShuntParam.adcSamplePoint = 0;
+            pAxis->singleShuntParam.adcSamplePoint = 0;
             /* this interrupt corresponds to the second trigger and 
                 save second current measured*/
             /* Ibus is measured and offset removed from measurement*/
-            singleShuntParam.Ibus2 = (int16_t)(ADCBUF_INV_A_IBUS) - 
-                                            measureInputs.current.offsetIbus;
+#ifdef SINGLE_SHUNT_OVERSAMPLING
+            /* Average of the two conversions taken inside the window */
+            pAxis->singleShuntParam.Ibus2 = (int16_t)(((int32_t)ADCBUF_INV_A_IBUS +
+                                     ADCBUF_INV_A_IBUS_OVS) >> 1) -
+                    pAxis->measureInputs.current.offsetIbus;
+#else
+            pAxis->singleShuntParam.Ibus2 = (int16_t)(ADCBUF_INV_A_IBUS) - 
+                    pAxis->measureInputs.current.offsetIbus;
+#endif
         //    ADCON3Lbits.SWCTRG = 1;
         break;
 
         default:
         break;  
     }
-#endif
-    if (uGF.bits.RunMotor)
-    {
+    
+    ADCInterruptStep(pAxis);
+    
+    /* Read ADC Buffet to Clear Flag */
+	adcDataBuffer = ClearADCIF_ReadADCBUFSingleShunt();
+    ClearADCIFSingleShunt();   
+}
+// *****************************************************************************
+/* Function:
+   _ADCInterruptDualShunt()
 
-        if (singleShuntParam.adcSamplePoint == 0)
-        {
-             
-#ifdef SINGLE_SHUNT
-                
-            /* Reconstruct Phase currents from Bus Current*/                
-            SingleShunt_PhaseCurrentReconstruction(&singleShuntParam);
-            iabc.a = singleShuntParam.Ia;
-            iabc.b = singleShuntParam.Ib;
-#else
-            measureInputs.current.Ia = ADCBUF_INV_A_IPHASE1;
-            measureInputs.current.Ib = ADCBUF_INV_A_IPHASE2;
-            MCAPP_MeasureCurrentCalibrate(&measureInputs);
-            iabc.a = measureInputs.current.Ia;
-            iabc.b = measureInputs.current.Ib;
-#endif
-            /* Calculate qId,qIq from qSin,qCos,qIa,qIb */
-            MC_TransformClarke_Assembly(&iabc,&ialphabeta);
-            MC_TransformPark_Assembly(&ialphabeta,&sincosTheta,&idq);
-
-            /* Speed and field angle estimation */
-            Estim();
-            /* Calculate control values */
-            DoControl();
-            /* Calculate qAngle */
-            CalculateParkAngle();
-            /* if open loop */
-            if (uGF.bits.OpenLoop == 1)
-            {
-                /* the angle is given by park parameter */
-                thetaElectrical = thetaElectricalOpenLoop;
-            }
-            else
-            {
-                /* if closed loop, angle generated by estimator */
-                thetaElectrical = estimator.qRho;
-            }
-            MC_CalculateSineCosine_Assembly_Ram(thetaElectrical,&sincosTheta);
-            MC_TransformParkInverse_Assembly(&vdq,&sincosTheta,&valphabeta);
+  Summary:
+   _ADCInterruptDualShunt() ISR routine
 
-            MC_TransformClarkeInverseSwappedInput_Assembly(&valphabeta,&vabc);
-                
-#ifdef  SINGLE_SHUNT
-            SingleShunt_CalculateSpaceVectorPhaseShifted(&vabc,pwmPeriod,&singleShuntParam);
+  Description:
+    Dual shunt current sensing: the phase currents are sampled once every 
+    PWM period, followed by the vector update loop.
 
-            PWMDutyCycleSetDualEdge(&singleShuntParam.pwmDutycycle1,&singleShuntParam.pwmDutycycle2);
-#else
-            MC_CalculateSpaceVectorPhaseShifted_Assembly(&vabc,pwmPeriod,
-                                                        &pwmDutycycle);
-            PWMDutyCycleSet(&pwmDutycycle);
-#endif
-                
-        }
-    }
-    else
-    {
-        INVERTERA_PWM_TRIGA = ADC_SAMPLING_POINT;
-#ifdef SINGLE_SHUNT
-        INVERTERA_PWM_TRIGB = LOOPTIME_TCY>>1;
-        INVERTERA_PWM_TRIGC = LOOPTIME_TCY-1;
-        singleShuntParam.pwmDutycycle1.dutycycle3 = MIN_DUTY;
-        singleShuntParam.pwmDutycycle1.dutycycle2 = MIN_DUTY;
-        singleShuntParam.pwmDutycycle1.dutycycle1 = MIN_DUTY;
-        singleShuntParam.pwmDutycycle2.dutycycle3 = MIN_DUTY;
-        singleShuntParam.pwmDutycycle2.dutycycle2 = MIN_DUTY;
-        singleShuntParam.pwmDutycycle2.dutycycle1 = MIN_DUTY;
-        PWMDutyCycleSetDualEdge(&singleShuntParam.pwmDutycycle1,
-                &singleShuntParam.pwmDutycycle2);
+  Precondition:
+    None.
+
+  Parameters:
+    None
+
+  Returns:
+    None.
+
+  Remarks:
+    None.
+ */
+void __attribute__((__interrupt__,no_auto_psv)) _ADCInterruptDualShunt()
+{  
+    MOTOR_AXIS_T *pAxis = &axisA;
+    
+    ADCInterruptStep(pAxis);
+#ifdef DOUBLE_UPDATE
+    /* The valley step has to complete in the first half cycle, before the 
+       peak step */
+    if (PG1STATbits.CAHALF != 0)
+    {
+        pAxis->doubleUpdate.overrunCount++;
+    }
+    if (pAxis->doubleUpdate.overrunCount >= DOUBLE_UPDATE_OVERRUN_LIMIT)
+    {
+        /* Not enough headroom - one update per cycle */
+        pAxis->doubleUpdate.active = 0;
+    }
+#endif
+    
+    /* Read ADC Buffet to Clear Flag */
+	adcDataBuffer = ClearADCIF_ReadADCBUFDualShunt();
+    ClearADCIFDualShunt();   
+}
+// *****************************************************************************
+/* Function:
+   ADCInterruptStep()
+
+  Summary:
+   Common part of the ADC interrupt service routines
+
+  Description:
+    Does speed calculation and executes the vector update loop
+    The ADC sample and conversion is triggered by the PWM period.
+    The speed calculation assumes a fixed time interval between calculations.
+
+  Precondition:
+    None.
+
+  Parameters:
+    pAxis - Motor axis driven by Inverter A
+
+  Returns:
+    None.
+
+  Remarks:
+    Phase currents and PWM update are as per ctrlParm.currentSensing.
+    In dual shunt mode singleShuntParam.adcSamplePoint remains 0.
+ */
+inline static void ADCInterruptStep(MOTOR_AXIS_T *pAxis)
+{
+    if (pAxis->uGF.bits.RunMotor)
+    {
+
+        if (pAxis->singleShuntParam.adcSamplePoint == 0)
+        {
+            if (pAxis->ctrlParm.currentSensing == CURRENT_SENSING_SINGLE_SHUNT)
+            {
+#ifdef SINGLE_SHUNT_CURRENT_PREDICTION
+                /* Predict the phase currents if one bus current sample of 
+                   the applied pattern is missing */
+                SingleShunt_PhaseCurrentPrediction(&pAxis->singleShuntParam,
+                                &pAxis->valphabeta,&pAxis->ialphabeta,
+                                &pAxis->bemfAlphaBeta,
+                                pAxis->motorParm.qRs,pAxis->motorParm.qLsDt);
+#endif
+                /* Reconstruct Phase currents from Bus Current*/                
+                SingleShunt_PhaseCurrentReconstruction(&pAxis->singleShuntParam);
+                pAxis->iabc.a = pAxis->singleShuntParam.Ia;
+                pAxis->iabc.b = pAxis->singleShuntParam.Ib;
+#ifdef CURRENT_OFFSET_TRACKING
+                /* The bus current is zero in the zero vector of the last
+                   pattern at the PWM valley */
+                if (pAxis->singleShuntParam.zeroVectorValid)
+                {
+                    pAxis->measureInputs.current.IbusZero = 
+                                                    ADCBUF_INV_A_IBUS_OVS;
+                    MCAPP_MeasureCurrentOffsetTrack(&pAxis->measureInputs);
+                }
+#endif
+            }
+            else
+            {
+                pAxis->measureInputs.current.Ia = ADCBUF_INV_A_IPHASE1;
+                pAxis->measureInputs.current.Ib = ADCBUF_INV_A_IPHASE2;
+                MCAPP_MeasureCurrentCalibrate(&pAxis->measureInputs);
+                pAxis->iabc.a = pAxis->measureInputs.current.Ia;
+                pAxis->iabc.b = pAxis->measureInputs.current.Ib;
+            }
+            /* Estimation, control and modulation of the axis */
+            AxisControlStep(pAxis);
+                
+            if (pAxis->ctrlParm.currentSensing == CURRENT_SENSING_SINGLE_SHUNT)
+            {
+                PWMDutyCycleSetDualEdge(&pAxis->singleShuntParam.pwmDutycycle1,
+                                        &pAxis->singleShuntParam.pwmDutycycle2);
+                SingleShunt_SetTriggersInverterA(&pAxis->singleShuntParam);
+            }
+            else
+            {
+#ifdef DOUBLE_UPDATE
+                /* Applied from the PWM peak, and in the next cycle unless 
+                   the peak step updates it */
+                PWMDutyCycleSetDualEdge(&pAxis->pwmDutycycle,
+                                        &pAxis->pwmDutycycle);
 #else
-        pwmDutycycle.dutycycle3 = MIN_DUTY;
-        pwmDutycycle.dutycycle2 = MIN_DUTY;
-        pwmDutycycle.dutycycle1 = MIN_DUTY;
-        PWMDutyCycleSet(&pwmDutycycle);
+                PWMDutyCycleSet(&pAxis->pwmDutycycle);
+#endif
+            }
+                
+        }
+    }
+    else
+    {
+        INVERTERA_PWM_TRIGA = ADC_SAMPLING_POINT;
+        if (pAxis->ctrlParm.currentSensing == CURRENT_SENSING_SINGLE_SHUNT)
+        {
+            INVERTERA_PWM_TRIGB = pwmTiming.loopTimeTcy>>1;
+            INVERTERA_PWM_TRIGC = pwmTiming.loopTimeTcy-1;
+#ifdef SINGLE_SHUNT_OVERSAMPLING
+            INVERTERA_PWM_OVS_TRIGB = (pwmTiming.loopTimeTcy>>1) - SS_OVERSAMPLE_SPACING;
+            INVERTERA_PWM_OVS_TRIGC = (pwmTiming.loopTimeTcy-1) - SS_OVERSAMPLE_SPACING;
 #endif
+            pAxis->singleShuntParam.pwmDutycycle1.dutycycle3 = MIN_DUTY;
+            pAxis->singleShuntParam.pwmDutycycle1.dutycycle2 = MIN_DUTY;
+            pAxis->singleShuntParam.pwmDutycycle1.dutycycle1 = MIN_DUTY;
+            pAxis->singleShuntParam.pwmDutycycle2.dutycycle3 = MIN_DUTY;
+            pAxis->singleShuntParam.pwmDutycycle2.dutycycle2 = MIN_DUTY;
+            pAxis->singleShuntParam.pwmDutycycle2.dutycycle1 = MIN_DUTY;
+            PWMDutyCycleSetDualEdge(&pAxis->singleShuntParam.pwmDutycycle1,
+                    &pAxis->singleShuntParam.pwmDutycycle2);
+        }
+        else
+        {
+#ifdef DOUBLE_UPDATE
+            INVERTERA_PWM_TRIGB = pwmTiming.loopTimeTcy-1;
+#endif
+            pAxis->pwmDutycycle.dutycycle3 = MIN_DUTY;
+            pAxis->pwmDutycycle.dutycycle2 = MIN_DUTY;
+            pAxis->pwmDutycycle.dutycycle1 = MIN_DUTY;
+#ifdef DOUBLE_UPDATE
+            PWMDutyCycleSetDualEdge(&pAxis->pwmDutycycle,&pAxis->pwmDutycycle);
+#else
+            PWMDutyCycleSet(&pAxis->pwmDutycycle);
+#endif
+        }
 
     } 
     
-    if (singleShuntParam.adcSamplePoint == 0)
+    if (pAxis->singleShuntParam.adcSamplePoint == 0)
     {
-        if (uGF.bits.RunMotor == 0)
+        if (pAxis->uGF.bits.RunMotor == 0)
         {
-            measureInputs.current.Ia = ADCBUF_INV_A_IPHASE1;
-            measureInputs.current.Ib = ADCBUF_INV_A_IPHASE2; 
-            measureInputs.current.Ibus = ADCBUF_INV_A_IBUS; 
+            pAxis->measureInputs.current.Ia = ADCBUF_INV_A_IPHASE1;
+            pAxis->measureInputs.current.Ib = ADCBUF_INV_A_IPHASE2; 
+            pAxis->measureInputs.current.Ibus = ADCBUF_INV_A_IBUS; 
+#ifdef CURRENT_OFFSET_TRACKING
+            pAxis->measureInputs.current.IbusZero = ADCBUF_INV_A_IBUS_OVS;
+#endif
         }
-        if (MCAPP_MeasureCurrentOffsetStatus(&measureInputs) == 0)
+        if (MCAPP_MeasureCurrentOffsetStatus(&pAxis->measureInputs) == 0)
         {
-            MCAPP_MeasureCurrentOffset(&measureInputs);
+            MCAPP_MeasureCurrentOffset(&pAxis->measureInputs);
         }
         else
         {
             BoardServiceStepIsr(); 
         }
-        measureInputs.potValue = (int16_t)( ADCBUF_SPEED_REF_A>>1);
-        measureInputs.dcBusVoltage = (int16_t)( ADCBUF_VBUS_A>>1);
+        MCAPP_MeasureFilterStep(&pAxis->measureInputs,
+                                (int16_t)( ADCBUF_SPEED_REF_A>>1),
+                                (int16_t)( ADCBUF_VBUS_A>>1));
+#ifdef MOSFET_TEMPERATURE_DERATING
+        if (MCAPP_MeasureTemperatureStep(&pAxis->measureInputs,
+                                         (int16_t)( ADCBUF_MOSFET_TEMP_A>>1)))
+        {
+            CalculateThermalDerating(pAxis);
+            CalculateIqLimit(pAxis);
+        }
+#endif
+#ifdef I2T_PROTECTION
+        {
+            /* The thermal models cool down while the motor is stopped, 
+               the last measured idq is kept */
+            const MC_DQ_T idqStopped = {0,0};
+
+            if (I2tStep(&pAxis->i2tParm,(pAxis->uGF.bits.RunMotor == 0) ?
+                                        &idqStopped : &pAxis->idq))
+            {
+                CalculateIqLimit(pAxis);
+            }
+        }
+#endif
+#ifdef DC_BUS_COMPENSATION
+        DcBusCompUpdate(&pAxis->dcBusComp,pAxis->measureInputs.dcBusVoltage);
+#endif
+#ifdef FAULT_SNAPSHOT
+        RecordSnapshot(pAxis);
+#endif
+#ifdef FLASH_FAULT_LOG
+        if (pAxis->uGF.bits.RunMotor)
+        {
+            FlashLogRunStep(&pAxis->flashLog);
+        }
+#endif
+#ifdef STALL_DETECTION
+        /* The restarts did not recover the rotor */
+        if (pAxis->stallParm.state == STALL_STATE_STOP)
+        {
+#ifdef FAULT_SNAPSHOT
+            SnapshotFreeze(&pAxis->snapshot,SNAPSHOT_SOURCE_STALL);
+#endif
+#ifdef FLASH_FAULT_LOG
+            FlashLogEvent(&pAxis->flashLog,FLASHLOG_EVENT_STALL);
+#endif
+            ResetParmeters();
+            LED2 = 0;
+        }
+#endif
         
         DiagnosticsStepIsr();
     }
-    /* Read ADC Buffet to Clear Flag */
-	adcDataBuffer = ClearADCIF_ReadADCBUF();
-    ClearADCIF();   
+}
+// *****************************************************************************
+/* Function:
+    AxisControlStep()
+
+  Summary:
+    Executes the vector update loop of a motor axis
+
+  Description:
+    From the phase currents in iabc: Clarke and Park transforms, speed and 
+    angle estimation, the speed and current controllers, the open loop 
+    angle and the modulation of the voltage for the next PWM cycle.
+
+  Precondition:
+    iabc is updated with the phase currents of this cycle.
+
+  Parameters:
+    pAxis - Motor axis
+
+  Returns:
+    None.
+
+  Remarks:
+    The inverter is not accessed, the caller applies the duty cycles 
+    (pwmDutycycle, or singleShuntParam with single shunt current sensing).
+ */
+void AxisControlStep(MOTOR_AXIS_T *pAxis)
+{
+    /* Calculate qId,qIq from qSin,qCos,qIa,qIb */
+    MC_TransformClarke_Assembly(&pAxis->iabc,&pAxis->ialphabeta);
+    MC_TransformPark_Assembly(&pAxis->ialphabeta,&pAxis->sincosTheta,
+                              &pAxis->idq);
+#ifdef POWER_METERING
+    /* vdq and the duty cycles are still the ones applied in this cycle */
+#ifdef DC_BUS_COMPENSATION
+    MeterStep(&pAxis->meter,&pAxis->vdq,&pAxis->idq,&pAxis->estimator,
+              CalculateDcCurrent(pAxis),pAxis->measureInputs.dcBusVoltage,
+              DCBUS_NOMINAL);
+#else
+    MeterStep(&pAxis->meter,&pAxis->vdq,&pAxis->idq,&pAxis->estimator,
+              CalculateDcCurrent(pAxis),pAxis->measureInputs.dcBusVoltage,
+              pAxis->measureInputs.dcBusVoltage);
+#endif
+#endif
+
+    /* Speed and field angle estimation */
+    Estim(&pAxis->estimator,&pAxis->motorParm,&pAxis->ialphabeta,
+          &pAxis->valphabeta,&pAxis->bemfAlphaBeta);
+#ifdef STALL_DETECTION
+    if (pAxis->uGF.bits.OpenLoop == 0)
+    {
+        StallSupervisor(pAxis);
+    }
+#endif
+    /* Calculate control values */
+    DoControl(pAxis);
+    /* Calculate qAngle */
+    CalculateParkAngle(pAxis);
+    /* if open loop */
+    if (pAxis->uGF.bits.OpenLoop == 1)
+    {
+        /* the angle is given by park parameter */
+        pAxis->thetaElectrical = pAxis->thetaElectricalOpenLoop;
+    }
+    else
+    {
+        /* if closed loop, angle generated by estimator */
+        pAxis->thetaElectrical = pAxis->estimator.qRho;
+    }
+    CalculateModulation(pAxis);
+}
+// *****************************************************************************
+/* Function:
+    CalculateModulation()
+
+  Summary:
+    Space vector modulation of the d-q voltage of a motor axis
+
+  Description:
+    Inverse Park and Clarke transforms of vdq at thetaElectrical and the 
+    space vector modulation for the current sensing mode in use.
+
+  Precondition:
+    None.
+
+  Parameters:
+    pAxis - Motor axis
+
+  Returns:
+    None.
+
+  Remarks:
+    With single shunt current sensing the duty cycles and ADC triggers are
+    calculated in singleShuntParam, otherwise in pwmDutycycle.
+ */
+void CalculateModulation(MOTOR_AXIS_T *pAxis)
+{
+    const MC_DQ_T *pVdq = &pAxis->vdq;
+#ifdef DC_BUS_COMPENSATION
+    MC_DQ_T vdqModulation;
+
+    /* Modulation at the measured DC bus voltage */
+    vdqModulation.d = DcBusCompScale(&pAxis->dcBusComp,pAxis->vdq.d);
+    vdqModulation.q = DcBusCompScale(&pAxis->dcBusComp,pAxis->vdq.q);
+    pVdq = &vdqModulation;
+#endif
+    MC_CalculateSineCosine_Assembly_Ram(pAxis->thetaElectrical,
+                                        &pAxis->sincosTheta);
+#ifdef OVERMODULATION
+    /* Inverse Park and Clarke with overmodulation up to six step */
+    Overmodulation(&pAxis->overmodParm,pVdq,&pAxis->sincosTheta,
+                   &pAxis->valphabeta,&pAxis->vabc);
+#else
+    MC_TransformParkInverse_Assembly(pVdq,&pAxis->sincosTheta,
+                                     &pAxis->valphabeta);
+
+    MC_TransformClarkeInverseSwappedInput_Assembly(&pAxis->valphabeta,
+                                                   &pAxis->vabc);
+#endif
+#ifdef DC_BUS_COMPENSATION
+    /* The estimator uses the applied voltage at nominal DC bus voltage */
+    pAxis->valphabeta.alpha = DcBusCompUnscale(&pAxis->dcBusComp,
+                                               pAxis->valphabeta.alpha);
+    pAxis->valphabeta.beta = DcBusCompUnscale(&pAxis->dcBusComp,
+                                              pAxis->valphabeta.beta);
+#endif
+#ifdef DISCONTINUOUS_PWM
+    /* Discontinuous modulation above the modulation index threshold */
+    DpwmUpdateModulation(&pAxis->dpwmParm,pVdq);
+#endif
+
+    if (pAxis->ctrlParm.currentSensing == CURRENT_SENSING_SINGLE_SHUNT)
+    {
+        SingleShunt_CalculateSpaceVectorPhaseShifted(&pAxis->vabc,
+                                                     pAxis->pwmPeriod,
+                                                     &pAxis->singleShuntParam);
+    }
+    else
+    {
+        MC_CalculateSpaceVectorPhaseShifted_Assembly(&pAxis->vabc,
+                                                     pAxis->pwmPeriod,
+                                                     &pAxis->pwmDutycycle);
+#ifdef DISCONTINUOUS_PWM
+        DpwmApply(&pAxis->dpwmParm,&pAxis->pwmDutycycle,pAxis->pwmPeriod);
+#endif
+    }
+}
+// *****************************************************************************
+/* Function:
+    CalculateVqLimit()
+
+  Summary:
+    q axis voltage limit of the current controllers
+
+  Description:
+    Dynamic d-q adjustment with d component priority, vq=sqrt (vs^2 - vd^2).
+    With DC bus compensation vs is the voltage available at the measured 
+    DC bus voltage: the limit is calculated on the modulation and converted
+    to the voltage normalized to the nominal DC bus voltage.
+
+  Precondition:
+    None.
+
+  Parameters:
+    pAxis - Motor axis
+    vd    - d axis voltage
+
+  Returns:
+    q axis voltage limit.
+
+  Remarks:
+    None.
+ */
+int16_t CalculateVqLimit(MOTOR_AXIS_T *pAxis,int16_t vd)
+{
+    int16_t vqLimit;
+    
+#ifdef DC_BUS_COMPENSATION
+    vd = DcBusCompScale(&pAxis->dcBusComp,vd);
+#endif
+#ifdef OVERMODULATION
+    vqLimit = OvermodulationVqLimit(vd);
+#else
+    vqLimit = (int16_t)(__builtin_mulss(vd,vd) >> 15);
+    vqLimit = _Q15sqrt(Q15(MAX_VOLTAGE_VECTOR) - vqLimit);
+#endif
+#ifdef DC_BUS_COMPENSATION
+    vqLimit = DcBusCompUnscale(&pAxis->dcBusComp,vqLimit);
+#endif
+    return vqLimit;
 }
 // *****************************************************************************
 /* Function:
@@ -651,7 +1610,7 @@ void __attribute__((__interrupt__,no_auto_psv)) _ADCInterrupt()
     None.
 
   Parameters:
-    None
+    pAxis - Motor axis
 
   Returns:
     None.
@@ -659,41 +1618,45 @@ void __attribute__((__interrupt__,no_auto_psv)) _ADCInterrupt()
   Remarks:
     None.
  */
-void CalculateParkAngle(void)
+void CalculateParkAngle(MOTOR_AXIS_T *pAxis)
 {
     /* if open loop */
-    if (uGF.bits.OpenLoop)
+    if (pAxis->uGF.bits.OpenLoop)
     {
         /* begin with the lock sequence, for field alignment */
-        if (motorStartUpData.startupLock < LOCK_TIME)
+        if (pAxis->motorStartUpData.startupLock < 
+            pAxis->motorStartUpData.lockTime)
         {
-            motorStartUpData.startupLock += 1;
+            pAxis->motorStartUpData.startupLock += 1;
         }
         /* Then ramp up till the end speed */
-        else if (motorStartUpData.startupRamp < END_SPEED)
+        else if (pAxis->motorStartUpData.startupRamp < 
+                 pAxis->motorStartUpData.endSpeed)
         {
-            motorStartUpData.startupRamp += OPENLOOP_RAMPSPEED_INCREASERATE;
+            pAxis->motorStartUpData.startupRamp += 
+                                    pAxis->motorStartUpData.rampIncreaseRate;
         }
         /* Switch to closed loop */
         else 
         {
             #ifndef OPEN_LOOP_FUNCTIONING
-                uGF.bits.ChangeMode = 1;
-                uGF.bits.OpenLoop = 0;
+                pAxis->uGF.bits.ChangeMode = 1;
+                pAxis->uGF.bits.OpenLoop = 0;
             #endif
         }
         /* The angle set depends on startup ramp */
-        thetaElectricalOpenLoop += (int16_t)(motorStartUpData.startupRamp >> 
-                                            STARTUPRAMP_THETA_OPENLOOP_SCALER);
+        pAxis->thetaElectricalOpenLoop += (int16_t)
+                                    (pAxis->motorStartUpData.startupRamp >> 
+                                     STARTUPRAMP_THETA_OPENLOOP_SCALER);
 
     }
     /* Switched to closed loop */
     else 
     {
         /* In closed loop slowly decrease the offset add to the estimated angle */
-        if (estimator.qRhoOffset > 0)
+        if (pAxis->estimator.qRhoOffset > 0)
         {
-            estimator.qRhoOffset--;
+            pAxis->estimator.qRhoOffset--;
         }
     }
 }
@@ -711,7 +1674,7 @@ void CalculateParkAngle(void)
     None.
 
   Parameters:
-    None
+    pAxis - Motor axis
 
   Returns:
     None.
@@ -719,44 +1682,420 @@ void CalculateParkAngle(void)
   Remarks:
     None.
  */
-void InitControlParameters(void)
+void InitControlParameters(MOTOR_AXIS_T *pAxis)
 {
     
-    ctrlParm.qRefRamp = SPEEDREFRAMP;
-    ctrlParm.speedRampCount = SPEEDREFRAMP_COUNT;
+    pAxis->ctrlParm.qRefRamp = SPEEDREFRAMP;
+    /* Keep the speed reference update period of SPEEDREFRAMP_COUNT+1 
+       default loop times */
+    pAxis->ctrlParm.speedRampCountLimit = 
+        PWMScaleLoopFrequency(SPEEDREFRAMP_COUNT + 1) - 1;
+    if (pAxis->ctrlParm.speedRampCountLimit < 0)
+    {
+        pAxis->ctrlParm.speedRampCountLimit = 0;
+    }
+    pAxis->ctrlParm.speedRampCount = pAxis->ctrlParm.speedRampCountLimit;
     /* Set PWM period to Loop Time */
-    pwmPeriod = LOOPTIME_TCY;
+    pAxis->pwmPeriod = pwmTiming.loopTimeTcy;
+    
+    /* Open loop start up for the run time loop time: lock time in loop 
+       counts, end speed in angle increment per loop and speed increment per 
+       loop squared */
+    pAxis->motorStartUpData.lockTime = PWMScaleLoopFrequency(LOCK_TIME);
+    pAxis->motorStartUpData.endSpeed = 
+        ((uint32_t)END_SPEED * pwmTiming.timeScale) >> PWM_TIME_SCALE_SHIFT;
+    /* Speed change per loop cycle squared, scaled in one step and rounded -
+       the timeScale product is below 2^31 over the PWM frequency range */
+    pAxis->motorStartUpData.rampIncreaseRate = (uint16_t)
+        (((int32_t)OPENLOOP_RAMPSPEED_INCREASERATE * pwmTiming.timeScale *
+          pwmTiming.timeScale + (1L << (2*PWM_TIME_SCALE_SHIFT - 1))) >>
+         (2*PWM_TIME_SCALE_SHIFT));
+    if (pAxis->motorStartUpData.rampIncreaseRate == 0)
+    {
+        pAxis->motorStartUpData.rampIncreaseRate = 1;
+    }
+#if defined(VOLTAGE_FEED_FORWARD) || defined(DEADBEAT_CURRENT_CONTROL) || \
+    defined(DOUBLE_UPDATE)
+    pAxis->omegaTsScale = PWMScaleLoopTime(OMEGA_TS_SCALE);
+#endif
  
     /* PI - Id Current Control */
-    piInputId.piState.kp = D_CURRCNTR_PTERM;
-    piInputId.piState.ki = D_CURRCNTR_ITERM;
-    piInputId.piState.kc = D_CURRCNTR_CTERM;
-    piInputId.piState.outMax = D_CURRCNTR_OUTMAX;
-    piInputId.piState.outMin = -piInputId.piState.outMax;
-    piInputId.piState.integrator = 0;
-    piOutputId.out = 0;
+    pAxis->piInputId.piState.kp = D_CURRCNTR_PTERM >> VOLTAGE_SCALE_SHIFT;
+    pAxis->piInputId.piState.ki = 
+        PWMScaleLoopTime(D_CURRCNTR_ITERM) >> VOLTAGE_SCALE_SHIFT;
+    pAxis->piInputId.piState.kc = D_CURRCNTR_CTERM;
+    pAxis->piInputId.piState.outMax = 
+        D_CURRCNTR_OUTMAX >> VOLTAGE_SCALE_SHIFT;
+    pAxis->piInputId.piState.outMin = -pAxis->piInputId.piState.outMax;
+    pAxis->piInputId.piState.integrator = 0;
+    pAxis->piOutputId.out = 0;
 
     /* PI - Iq Current Control */
-    piInputIq.piState.kp = Q_CURRCNTR_PTERM;
-    piInputIq.piState.ki = Q_CURRCNTR_ITERM;
-    piInputIq.piState.kc = Q_CURRCNTR_CTERM;
-    piInputIq.piState.outMax = Q_CURRCNTR_OUTMAX;
-    piInputIq.piState.outMin = -piInputIq.piState.outMax;
-    piInputIq.piState.integrator = 0;
-    piOutputIq.out = 0;
+    pAxis->piInputIq.piState.kp = Q_CURRCNTR_PTERM >> VOLTAGE_SCALE_SHIFT;
+    pAxis->piInputIq.piState.ki = 
+        PWMScaleLoopTime(Q_CURRCNTR_ITERM) >> VOLTAGE_SCALE_SHIFT;
+    pAxis->piInputIq.piState.kc = Q_CURRCNTR_CTERM;
+    pAxis->piInputIq.piState.outMax = 
+        Q_CURRCNTR_OUTMAX >> VOLTAGE_SCALE_SHIFT;
+    pAxis->piInputIq.piState.outMin = -pAxis->piInputIq.piState.outMax;
+    pAxis->piInputIq.piState.integrator = 0;
+    pAxis->piOutputIq.out = 0;
+#ifdef CURRCNTR_GAIN_CALCULATION
+    /* Gains from the motor parameters (InitEstimParm) */
+    CalculateCurrentControlGains(pAxis,pAxis->motorParm.qRs,
+                                 pAxis->motorParm.qLsDtBase,
+                                 PWMScaleLoopTime(CURRCNTR_BANDWIDTH_TS));
+#endif
 
     /* PI - Speed Control */
-    piInputOmega.piState.kp = SPEEDCNTR_PTERM;
-    piInputOmega.piState.ki = SPEEDCNTR_ITERM;
-    piInputOmega.piState.kc = SPEEDCNTR_CTERM;
-    piInputOmega.piState.outMax = SPEEDCNTR_OUTMAX;
-    piInputOmega.piState.outMin = -piInputOmega.piState.outMax;
-    piInputOmega.piState.integrator = 0;
-    piOutputOmega.out = 0;
+    pAxis->piInputOmega.piState.kp = SPEEDCNTR_PTERM;
+    pAxis->piInputOmega.piState.ki = PWMScaleLoopTime(SPEEDCNTR_ITERM);
+    pAxis->piInputOmega.piState.kc = SPEEDCNTR_CTERM;
+    pAxis->piInputOmega.piState.outMax = SPEEDCNTR_OUTMAX;
+    pAxis->piInputOmega.piState.outMin = -pAxis->piInputOmega.piState.outMax;
+    pAxis->ctrlParm.qIqLimit = SPEEDCNTR_OUTMAX;
+#ifdef MOSFET_TEMPERATURE_DERATING
+    /* The power stage may still be hot */
+    CalculateThermalDerating(pAxis);
+#endif
+#ifdef IQ_LIMIT_DERATING
+    CalculateIqLimit(pAxis);
+#endif
+    pAxis->piInputOmega.piState.integrator = 0;
+    pAxis->piOutputOmega.out = 0;
+#ifdef SPEED_PROFILE_SCURVE
+    pAxis->speedProfile.inertia = SPEED_PROFILE_INERTIA;
+    pAxis->speedProfile.stepCycles = pAxis->ctrlParm.speedRampCountLimit + 1;
+#endif
+}
+#ifdef MOSFET_TEMPERATURE_DERATING
+// *****************************************************************************
+/* Function:
+    CalculateThermalDerating()
+
+  Summary:
+    q current limit from the MOSFET temperature
+
+  Description:
+    The limit is SPEEDCNTR_OUTMAX up to MOSFET_TEMP_DERATE_START and 
+    decreases linearly to MOSFET_TEMP_DERATE_CURRENT at 
+    MOSFET_TEMP_DERATE_END.
+
+  Precondition:
+    None.
+
+  Parameters:
+    pAxis - Motor axis
+
+  Returns:
+    None.
+
+  Remarks:
+    Called when the filtered temperature is updated, every 
+    2^MOSFET_TEMP_AVG_FILTER_SCALE PWM cycles.
+ */
+void CalculateThermalDerating(MOTOR_AXIS_T *pAxis)
+{
+    int16_t temperature = pAxis->measureInputs.mosfetTemperature;
+    
+    if (temperature <= MOSFET_TEMP_DERATE_START)
+    {
+        pAxis->ctrlParm.qIqLimitTemperature = SPEEDCNTR_OUTMAX;
+    }
+    else if (temperature >= MOSFET_TEMP_DERATE_END)
+    {
+        pAxis->ctrlParm.qIqLimitTemperature = MOSFET_TEMP_DERATE_CURRENT;
+    }
+    else
+    {
+        pAxis->ctrlParm.qIqLimitTemperature = SPEEDCNTR_OUTMAX - 
+            (int16_t)((temperature - MOSFET_TEMP_DERATE_START) * 
+                      MOSFET_TEMP_DERATE_SLOPE);
+    }
+}
+#endif
+#ifdef IQ_LIMIT_DERATING
+// *****************************************************************************
+/* Function:
+    CalculateIqLimit()
+
+  Summary:
+    q current limit from the thermal protections
+
+  Description:
+    The lowest of SPEEDCNTR_OUTMAX, the MOSFET temperature derating limit 
+    and the I2t protection limit.
+
+  Precondition:
+    None.
+
+  Parameters:
+    pAxis - Motor axis
+
+  Returns:
+    None.
+
+  Remarks:
+    Called when one of the limits is updated.
+ */
+void CalculateIqLimit(MOTOR_AXIS_T *pAxis)
+{
+    int16_t limit = SPEEDCNTR_OUTMAX;
+    
+#ifdef MOSFET_TEMPERATURE_DERATING
+    if (pAxis->ctrlParm.qIqLimitTemperature < limit)
+    {
+        limit = pAxis->ctrlParm.qIqLimitTemperature;
+    }
+#endif
+#ifdef I2T_PROTECTION
+    if (pAxis->i2tParm.qIqLimit < limit)
+    {
+        limit = pAxis->i2tParm.qIqLimit;
+    }
+#endif
+    pAxis->ctrlParm.qIqLimit = limit;
+}
+#endif
+#ifdef STALL_DETECTION
+// *****************************************************************************
+/* Function:
+    StallSupervisor()
+
+  Summary:
+    Supervises the sensorless estimator in closed loop
+
+  Description:
+    While monitoring, a loss of the rotor (StallDetect) starts the catch 
+    spin: the q current reference is zero in DoControl and the estimator 
+    tracks the coasting rotor. At the end of the catch time closed loop is 
+    resumed from the estimated speed with zero torque, if the estimator is 
+    consistent and the speed is above ENDSPEED_ELECTR. Otherwise the motor 
+    is restarted from open loop.
+
+  Precondition:
+    The estimator is updated in this cycle.
+
+  Parameters:
+    pAxis - Motor axis
+
+  Returns:
+    None.
+
+  Remarks:
+    Called in closed loop. After STALL_RESTART_MAX restarts the state is 
+    STALL_STATE_STOP and the caller stops the motor.
+ */
+void StallSupervisor(MOTOR_AXIS_T *pAxis)
+{
+    if (pAxis->stallParm.state == STALL_STATE_MONITOR)
+    {
+        if (StallDetect(&pAxis->stallParm,&pAxis->estimator,&pAxis->idq))
+        {
+            StallCatchStart(&pAxis->stallParm);
+#ifdef MECHANICAL_IDENTIFICATION
+            /* Stop the identification sequence */
+            MechIdInitialize(&pAxis->mechIdParm);
+#endif
+        }
+    }
+    else if (pAxis->stallParm.state == STALL_STATE_CATCH)
+    {
+        if (StallCatchStep(&pAxis->stallParm))
+        {
+            if ((pAxis->estimator.qVelEstim >= ENDSPEED_ELECTR) &&
+                (StallCheck(&pAxis->estimator,&pAxis->idq) == 0))
+            {
+                /* Catch spin - closed loop continues from the estimated 
+                   speed and zero torque */
+                pAxis->ctrlParm.qVelRef = pAxis->estimator.qVelEstim;
+                pAxis->piInputOmega.piState.integrator = 0;
+#ifdef SPEED_PROFILE_SCURVE
+                SpeedProfileInitialize(&pAxis->speedProfile,
+                                       pAxis->estimator.qVelEstim);
+#endif
+            }
+            else
+            {
+                /* Restart from open loop, the current offsets are kept */
+                pAxis->uGF.bits.OpenLoop = 1;
+                pAxis->uGF.bits.ChangeMode = 1;
+                InitEstimParm(&pAxis->estimator,&pAxis->motorParm);
+                InitControlParameters(pAxis);
+            }
+        }
+    }
+}
+#endif
+#ifdef FAULT_SNAPSHOT
+// *****************************************************************************
+/* Function:
+    RecordSnapshot()
+
+  Summary:
+    Records the signals of the control cycle in the fault snapshot
+
+  Description:
+    The measured d-q currents, the d-q voltages for the next PWM cycle, 
+    the angle, the estimated speed, the DC bus voltage and, with single 
+    shunt current sensing, the bus current samples.
+
+  Precondition:
+    The control step and the DC bus voltage measurement of the cycle are 
+    done.
+
+  Parameters:
+    pAxis - Motor axis
+
+  Returns:
+    None.
+
+  Remarks:
+    Called every control cycle, also while the motor is stopped.
+ */
+void RecordSnapshot(MOTOR_AXIS_T *pAxis)
+{
+    SNAPSHOT_SAMPLE_T sample;
+    
+    sample.idq = pAxis->idq;
+    sample.vdq = pAxis->vdq;
+    sample.qRho = pAxis->estimator.qRho;
+    sample.qVelEstim = pAxis->estimator.qVelEstim;
+    sample.dcBusVoltage = pAxis->measureInputs.dcBusVoltage;
+    if (pAxis->ctrlParm.currentSensing == CURRENT_SENSING_SINGLE_SHUNT)
+    {
+        sample.Ibus1 = pAxis->singleShuntParam.Ibus1;
+        sample.Ibus2 = pAxis->singleShuntParam.Ibus2;
+    }
+    else
+    {
+        sample.Ibus1 = 0;
+        sample.Ibus2 = 0;
+    }
+    SnapshotRecord(&pAxis->snapshot,&sample);
 }
+#endif
+#ifdef POWER_METERING
+// *****************************************************************************
+/* Function:
+    CalculateDcCurrent()
+
+  Summary:
+    DC bus current from the phase currents and the duty cycles
+
+  Description:
+    Each phase carries its current from the DC bus while its high side 
+    switch is on, idc = (da*ia + db*ib + dc*ic)/period. With single shunt 
+    the duty cycles of the two half cycle patterns are averaged.
+
+  Precondition:
+    iabc holds the phase currents and the duty cycles of the cycle are not
+    yet updated.
+
+  Parameters:
+    pAxis - Motor axis
+
+  Returns:
+    DC bus current in the scale of the phase currents.
+
+  Remarks:
+    Dead time and switching transients are not included.
+ */
+int16_t CalculateDcCurrent(MOTOR_AXIS_T *pAxis)
+{
+    const MC_DUTYCYCLEOUT_T *pDuty1 = &pAxis->pwmDutycycle;
+    const MC_DUTYCYCLEOUT_T *pDuty2 = &pAxis->pwmDutycycle;
+    int16_t ic;
+    int32_t sum,limit;
+    
+    if (pAxis->ctrlParm.currentSensing == CURRENT_SENSING_SINGLE_SHUNT)
+    {
+        pDuty1 = &pAxis->singleShuntParam.pwmDutycycle1;
+        pDuty2 = &pAxis->singleShuntParam.pwmDutycycle2;
+    }
+    ic = -(pAxis->iabc.a + pAxis->iabc.b);
+    sum = (__builtin_mulsu(pAxis->iabc.a,
+                           pDuty1->dutycycle1 + pDuty2->dutycycle1) + 
+           __builtin_mulsu(pAxis->iabc.b,
+                           pDuty1->dutycycle2 + pDuty2->dutycycle2) + 
+           __builtin_mulsu(ic,pDuty1->dutycycle3 + pDuty2->dutycycle3)) >> 1;
+    limit = __builtin_mulsu(INT16_MAX,pAxis->pwmPeriod);
+    if (sum >= limit)
+    {
+        return INT16_MAX;
+    }
+    else if (sum <= -limit)
+    {
+        return -INT16_MAX;
+    }
+    return __builtin_divsd(sum,pAxis->pwmPeriod);
+}
+#endif
+#ifdef CURRCNTR_GAIN_CALCULATION
+// *****************************************************************************
+/* Function:
+    CalculateCurrentControlGains()
+
+  Summary:
+    Calculates the d and q current PI gains from the motor parameters
+
+  Description:
+    The PI zero cancels the Ls/Rs pole of the motor, the open loop gain 
+    crosses 1 at the bandwidth wc:
+        Kp = wc*Ls, Ki = wc*Rs (integral per second)
+    In the estimator normalization Ls/dt*di = qLsDt*di >> 7 and 
+    Rs*i = qRs*i >> 11. The PI output is 16*kp*error + integrator, and
+    ki*error is added to the integrator every cycle, so:
+        kp = wc*Ts*qLsDt/128 * 2048 = (wc*Ts*qLsDt) >> 11 (wc*Ts in Q15)
+        ki = wc*Ts*qRs/2048 * 32768 = (wc*Ts*qRs) >> 11
+    With VOLTAGE_SCALE_SHIFT the PI output is at half scale and both gains
+    are halved. Gains exceeding the Q15 range are limited.
+
+  Precondition:
+    None.
+
+  Parameters:
+    pAxis       - Motor axis
+    rs          - normalized Rs (motorParm.qRs)
+    lsDt        - normalized Ls/dt (motorParm.qLsDtBase)
+    bandwidthTs - current loop bandwidth times the loop time, Q15
+
+  Returns:
+    None.
+
+  Remarks:
+    Can be called again when identified values of Rs and Ls are available.
+ */
+void CalculateCurrentControlGains(MOTOR_AXIS_T *pAxis,int16_t rs,int16_t lsDt,
+                                  int16_t bandwidthTs)
+{
+    int32_t kp,ki;
+
+    kp = __builtin_mulss(bandwidthTs,lsDt) >> (11 + VOLTAGE_SCALE_SHIFT);
+    ki = __builtin_mulss(bandwidthTs,rs) >> (11 + VOLTAGE_SCALE_SHIFT);
+    if (kp > 32767)
+    {
+        kp = 32767;
+    }
+    if (ki > 32767)
+    {
+        ki = 32767;
+    }
+    pAxis->piInputId.piState.kp = (int16_t)kp;
+    pAxis->piInputId.piState.ki = (int16_t)ki;
+    pAxis->piInputIq.piState.kp = (int16_t)kp;
+    pAxis->piInputIq.piState.ki = (int16_t)ki;
+}
+#endif
 
 void __attribute__((__interrupt__,no_auto_psv)) _PWMInterrupt()
 {
+#ifdef FAULT_SNAPSHOT
+    SnapshotFreeze(&axisA.snapshot,SNAPSHOT_SOURCE_PWM_FAULT);
+#endif
+#ifdef FLASH_FAULT_LOG
+    FlashLogEvent(&axisA.flashLog,FLASHLOG_EVENT_PWM_FAULT);
+#endif
     ResetParmeters();
     ClearPWMPCIFaultInverterA();
     LED1 = 0;
@@ -766,6 +2105,12 @@ void __attribute__ ((interrupt, no_auto_psv)) _CNDInterrupt(void)
 {
     if(BSP_LATCH_GATE_DRIVER_A_FAULT == true)
     {
+#ifdef FAULT_SNAPSHOT
+        SnapshotFreeze(&axisA.snapshot,SNAPSHOT_SOURCE_GATE_DRIVER);
+#endif
+#ifdef FLASH_FAULT_LOG
+        FlashLogEvent(&axisA.flashLog,FLASHLOG_EVENT_GATE_DRIVER);
+#endif
         LED1 = 0;
         HAL_Board_FaultClear();
     }
@@ -0,0 +1,114 @@
+/*******************************************************************************
+* Copyright (c) 2017 released Microchip Technology Inc.  All rights reserved.
+*
+* SOFTWARE LICENSE AGREEMENT:
+* 
+* Microchip Technology Incorporated ("Microchip") retains all ownership and
+* intellectual property rights in the code accompanying this message and in all
+* derivatives hereto.  You may use this code, and any derivatives created by
+* any person or entity by or on your behalf, exclusively with Microchip's
+* proprietary products.  Your acceptance and/or use of this code constitutes
+* agreement to the terms and conditions of this notice.
+*
+* CODE ACCOMPANYING THIS MESSAGE IS SUPPLIED BY MICROCHIP "AS IS".  NO
+* WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
+* TO, IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE APPLY TO THIS CODE, ITS INTERACTION WITH MICROCHIP'S
+* PRODUCTS, COMBINATION WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION.
+*
+* YOU ACKNOWLEDGE AND AGREE THAT, IN NO EVENT, SHALL MICROCHIP BE LIABLE,
+* WHETHER IN CONTRACT, WARRANTY, TORT (INCLUDING NEGLIGENCE OR BREACH OF
+* STATUTORY DUTY),STRICT LIABILITY, INDEMNITY, CONTRIBUTION, OR OTHERWISE,
+* FOR ANY INDIRECT, SPECIAL,PUNITIVE, EXEMPLARY, INCIDENTAL OR CONSEQUENTIAL
+* LOSS, DAMAGE, FOR COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE CODE,
+* HOWSOEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE POSSIBILITY OR
+* THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT ALLOWABLE BY LAW,
+* MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY RELATED TO THIS CODE,
+* SHALL NOT EXCEED THE PRICE YOU PAID DIRECTLY TO MICROCHIP SPECIFICALLY TO
+* HAVE THIS CODE DEVELOPED.
+*
+* You agree that you are solely responsible for testing the code and
+* determining its suitability.  Microchip has no obligation to modify, test,
+* certify, or support the code.
+*
+*******************************************************************************/
+#ifndef __PREDICT_H
+#define __PREDICT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "userparms.h"
+#include "general.h"
+
+/* Shift of the inductive voltage for the current change over one loop 
+   time, Ls/dt*di = qLsDt*di >> 7, and over half a loop time */
+#define PREDICT_SHIFT_CYCLE         7
+#define PREDICT_SHIFT_HALF_CYCLE    6
+
+// *****************************************************************************
+/* Function:
+    PredictCurrent()
+
+  Summary:
+    One step current prediction for one axis of the motor model
+
+  Description:
+    Ls*di/dt = v - Rs*i - BEMF. Estim() calculates the BEMF as
+    BEMF/2 = v/2 - (Rs*i >> 12) - (Ls/dt*di >> 8), so the inductive voltage
+    is v - (Rs*i >> 11) - 2*BEMF/2, plus the omega*Ls cross coupling term 
+    in the rotor frame, and di = (inductive voltage << shift) / (Ls/dt).
+
+  Precondition:
+    None.
+
+  Parameters:
+    v         - Voltage applied over the step, shifted right by 
+                VOLTAGE_SCALE_SHIFT
+    i         - Current at the start of the step
+    bemf      - BEMF/2 as calculated by the estimator
+    vCoupling - Cross coupling voltage, 0 in the stationary frame
+    rs        - normalized Rs (motorParm.qRs)
+    lsDt      - normalized Ls/dt (motorParm.qLsDt)
+    shift     - PREDICT_SHIFT_CYCLE or PREDICT_SHIFT_HALF_CYCLE
+
+  Returns:
+    Predicted current, limited to the Q15 range.
+
+  Remarks:
+    The inductive voltage reaches twice the Q15 range when the applied 
+    voltage opposes the BEMF. Below the limit of the current change the 
+    shifted voltage fits in 32 bits.
+ */
+inline static int16_t PredictCurrent(int16_t v,int16_t i,int16_t bemf,
+                                     int32_t vCoupling,int16_t rs,
+                                     int16_t lsDt,uint16_t shift)
+{
+    int32_t vInductance,limit,di;
+
+    vInductance = ((int32_t)v << VOLTAGE_SCALE_SHIFT) - 
+                  (__builtin_mulss(rs,i) >> 11) - 
+                  ((int32_t)bemf << 1) + vCoupling;
+    limit = __builtin_mulss(lsDt,32767) >> shift;
+    if (vInductance >= limit)
+    {
+        di = 32767;
+    }
+    else if (vInductance <= -limit)
+    {
+        di = -32767;
+    }
+    else
+    {
+        di = __builtin_divsd(vInductance << shift,lsDt);
+    }
+    return SaturateQ15((int32_t)i + di);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PREDICT_H */
@@ -0,0 +1,220 @@
+/*******************************************************************************
+ * Copyright (c) 2017 released Microchip Technology Inc.  All rights reserved.
+ *
+ * SOFTWARE LICENSE AGREEMENT:
+ *
+ * Microchip Technology Incorporated ("Microchip") retains all ownership and
+ * intellectual property rights in the code accompanying this message and in all
+ * derivatives hereto.  You may use this code, and any derivatives created by
+ * any person or entity by or on your behalf, exclusively with Microchip's
+ * proprietary products.  Your acceptance and/or use of this code constitutes
+ * agreement to the terms and conditions of this notice.
+ *
+ * CODE ACCOMPANYING THIS MESSAGE IS SUPPLIED BY MICROCHIP "AS IS".  NO
+ * WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
+ * TO, IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE APPLY TO THIS CODE, ITS INTERACTION WITH MICROCHIP'S
+ * PRODUCTS, COMBINATION WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION.
+ *
+ * YOU ACKNOWLEDGE AND AGREE THAT, IN NO EVENT, SHALL MICROCHIP BE LIABLE,
+ * WHETHER IN CONTRACT, WARRANTY, TORT (INCLUDING NEGLIGENCE OR BREACH OF
+ * STATUTORY DUTY),STRICT LIABILITY, INDEMNITY, CONTRIBUTION, OR OTHERWISE,
+ * FOR ANY INDIRECT, SPECIAL,PUNITIVE, EXEMPLARY, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, FOR COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE CODE,
+ * HOWSOEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE POSSIBILITY OR
+ * THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT ALLOWABLE BY LAW,
+ * MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY RELATED TO THIS CODE,
+ * SHALL NOT EXCEED THE PRICE YOU PAID DIRECTLY TO MICROCHIP SPECIFICALLY TO
+ * HAVE THIS CODE DEVELOPED.
+ *
+ * You agree that you are solely responsible for testing the code and
+ * determining its suitability.  Microchip has no obligation to modify, test,
+ * certify, or support the code.
+ *
+ *******************************************************************************/
+#include "profile.h"
+#include "userparms.h"
+#include "pwm.h"
+
+/** Definitions */
+/* Profile step in seconds at the default PWM frequency */
+#define SPEED_PROFILE_STEP_SEC  ((SPEEDREFRAMP_COUNT + 1)*LOOPTIME_SEC)
+/* Limits in electrical RPM per step (squared), 16.16 fixed point */
+#define SPEED_PROFILE_ACCEL_STEP (int32_t)(SPEED_PROFILE_ACCEL* \
+                                    SPEED_PROFILE_STEP_SEC*65536.0)
+#define SPEED_PROFILE_JERK_STEP  (int32_t)(SPEED_PROFILE_JERK* \
+                                    SPEED_PROFILE_STEP_SEC* \
+                                    SPEED_PROFILE_STEP_SEC*65536.0 + 0.5)
+
+static int32_t SpeedProfile_StopChange(int32_t,int32_t);
+
+// *****************************************************************************
+/* Function:
+    SpeedProfileInitialize()
+
+  Summary:
+    Initializes the speed profile
+
+  Description:
+    Loads the limits and starts the profile at the given speed, with no
+    acceleration. The inertia for the feed forward is kept. The limits are
+    scaled by the actual over the default profile step time, from 
+    stepCycles and the PWM frequency.
+
+  Precondition:
+    stepCycles is set.
+
+  Parameters:
+    pProfile - Speed profile data
+    speed    - Initial speed, electrical RPM
+
+  Returns:
+    None.
+
+  Remarks:
+    None.
+ */
+void SpeedProfileInitialize(SPEED_PROFILE_T *pProfile,int16_t speed)
+{
+    int32_t stepScale;
+    
+    pProfile->speed = (int32_t)speed << 16;
+    pProfile->accel = 0;
+    /* Profile step time relative to SPEED_PROFILE_STEP_SEC, 
+       PWM_TIME_SCALE_SHIFT fractional bits */
+    stepScale = ((int32_t)pProfile->stepCycles * pwmTiming.timeScale) / 
+                (SPEEDREFRAMP_COUNT + 1);
+    pProfile->accelMax = (int32_t)(((int64_t)SPEED_PROFILE_ACCEL_STEP * 
+                                    stepScale) >> PWM_TIME_SCALE_SHIFT);
+    pProfile->jerk = (int32_t)(((int64_t)SPEED_PROFILE_JERK_STEP * 
+                                stepScale * stepScale) >> 
+                               (2*PWM_TIME_SCALE_SHIFT));
+    if (pProfile->jerk < 1)
+    {
+        pProfile->jerk = 1;
+    }
+    pProfile->qAccelFeedForward = 0;
+}
+// *****************************************************************************
+/* Function:
+    SpeedProfile()
+
+  Summary:
+    Jerk limited speed profile step
+
+  Description:
+    Every step the acceleration is increased, kept or decreased by the jerk
+    limit. The largest change is selected for which the speed still reaches
+    the target without overshoot when the acceleration is brought back to 
+    zero at the jerk limit. The acceleration is limited to accelMax.
+    The q axis current feed forward is inertia * acceleration, with the 
+    acceleration per loop cycle (per step over stepCycles), limited to 
+    SPEEDCNTR_OUTMAX.
+
+  Precondition:
+    None.
+
+  Parameters:
+    pProfile - Speed profile data
+    target   - Target speed, electrical RPM
+
+  Returns:
+    Speed reference, electrical RPM.
+
+  Remarks:
+    Called every stepCycles loop cycles.
+ */
+int16_t SpeedProfile(SPEED_PROFILE_T *pProfile,int16_t target)
+{
+    int32_t error,accel,accelNext,feedForward;
+    int16_t i,direction;
+
+    error = ((int32_t)target << 16) - pProfile->speed;
+    /* Work on positive values, direction of the speed change */
+    direction = (error < 0) ? -1 : 1;
+    error = error * direction;
+    accel = pProfile->accel * direction;
+
+    if ((error <= pProfile->jerk) && (accel <= pProfile->jerk) && 
+        (accel >= -pProfile->jerk))
+    {
+        /* Target reached */
+        pProfile->speed = (int32_t)target << 16;
+        pProfile->accel = 0;
+    }
+    else
+    {
+        /* Increase, keep or decrease the acceleration */
+        accelNext = accel - pProfile->jerk;
+        for (i = 1; i >= 0; i--)
+        {
+            if ((accel + i*pProfile->jerk) > pProfile->accelMax)
+            {
+                continue;
+            }
+            if ((accel + i*pProfile->jerk + 
+                SpeedProfile_StopChange(accel + i*pProfile->jerk,
+                                        pProfile->jerk)) <= error)
+            {
+                accelNext = accel + i*pProfile->jerk;
+                break;
+            }
+        }
+        if (accelNext < -pProfile->accelMax)
+        {
+            accelNext = -pProfile->accelMax;
+        }
+        pProfile->accel = accelNext * direction;
+        pProfile->speed += pProfile->accel;
+    }
+
+    /* Acceleration per loop cycle times the inertia */
+    feedForward = (pProfile->inertia * (pProfile->accel >> 8)) / 
+                  ((int32_t)pProfile->stepCycles << 8);
+    if (feedForward > SPEEDCNTR_OUTMAX)
+    {
+        feedForward = SPEEDCNTR_OUTMAX;
+    }
+    else if (feedForward < -SPEEDCNTR_OUTMAX)
+    {
+        feedForward = -SPEEDCNTR_OUTMAX;
+    }
+    pProfile->qAccelFeedForward = (int16_t)feedForward;
+    
+    return (int16_t)(pProfile->speed >> 16);
+}
+// *****************************************************************************
+/* Function:
+    SpeedProfile_StopChange()
+
+  Summary:
+    Speed change while the acceleration is brought to zero
+
+  Description:
+    With n = accel/jerk steps: n*accel - jerk*n*(n+1)/2
+
+  Precondition:
+    None.
+
+  Parameters:
+    accel - Acceleration
+    jerk  - Jerk limit
+
+  Returns:
+    Speed change, same sign as the acceleration.
+
+  Remarks:
+    None.
+ */
+static int32_t SpeedProfile_StopChange(int32_t accel,int32_t jerk)
+{
+    int32_t n,change;
+
+    if (accel < 0)
+    {
+        return -SpeedProfile_StopChange(-accel,jerk);
+    }
+    n = accel / jerk;
+    change = n*accel - ((jerk*n*(n + 1)) >> 1);
+    return change;
+}
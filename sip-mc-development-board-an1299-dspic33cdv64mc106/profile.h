@@ -0,0 +1,79 @@
+/*******************************************************************************
+* Copyright (c) 2017 released Microchip Technology Inc.  All rights reserved.
+*
+* SOFTWARE LICENSE AGREEMENT:
+* 
+* Microchip Technology Incorporated ("Microchip") retains all ownership and
+* intellectual property rights in the code accompanying this message and in all
+* derivatives hereto.  You may use this code, and any derivatives created by
+* any person or entity by or on your behalf, exclusively with Microchip's
+* proprietary products.  Your acceptance and/or use of this code constitutes
+* agreement to the terms and conditions of this notice.
+*
+* CODE ACCOMPANYING THIS MESSAGE IS SUPPLIED BY MICROCHIP "AS IS".  NO
+* WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
+* TO, IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE APPLY TO THIS CODE, ITS INTERACTION WITH MICROCHIP'S
+* PRODUCTS, COMBINATION WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION.
+*
+* YOU ACKNOWLEDGE AND AGREE THAT, IN NO EVENT, SHALL MICROCHIP BE LIABLE,
+* WHETHER IN CONTRACT, WARRANTY, TORT (INCLUDING NEGLIGENCE OR BREACH OF
+* STATUTORY DUTY),STRICT LIABILITY, INDEMNITY, CONTRIBUTION, OR OTHERWISE,
+* FOR ANY INDIRECT, SPECIAL,PUNITIVE, EXEMPLARY, INCIDENTAL OR CONSEQUENTIAL
+* LOSS, DAMAGE, FOR COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE CODE,
+* HOWSOEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE POSSIBILITY OR
+* THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT ALLOWABLE BY LAW,
+* MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY RELATED TO THIS CODE,
+* SHALL NOT EXCEED THE PRICE YOU PAID DIRECTLY TO MICROCHIP SPECIFICALLY TO
+* HAVE THIS CODE DEVELOPED.
+*
+* You agree that you are solely responsible for testing the code and
+* determining its suitability.  Microchip has no obligation to modify, test,
+* certify, or support the code.
+*
+*******************************************************************************/
+#ifndef __PROFILE_H
+#define __PROFILE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/* Speed Profile Parameter data type
+
+  Description:
+    This structure will host parameters related to the jerk limited 
+    (S-curve) speed profile. Speed, acceleration and jerk are electrical RPM,
+    per profile step and per profile step squared, in 16.16 fixed point. 
+    The profile step is stepCycles loop cycles, SPEEDREFRAMP_COUNT+1 at 
+    the default PWM frequency.
+ */
+typedef struct
+{
+    /* Speed reference */
+    int32_t speed;
+    /* Acceleration */
+    int32_t accel;
+    /* Acceleration limit */
+    int32_t accelMax;
+    /* Jerk limit - acceleration change per step */
+    int32_t jerk;
+    /* Inertia - q axis current for a speed change of 1 electrical RPM per 
+       loop cycle (mechIdParm.inertia), 0 = no feed forward */
+    int32_t inertia;
+    /* Loop cycles per profile step (ctrlParm.speedRampCountLimit+1) */
+    uint16_t stepCycles;
+    /* q axis current feed forward for the acceleration */
+    int16_t qAccelFeedForward;
+} SPEED_PROFILE_T;
+
+void SpeedProfileInitialize(SPEED_PROFILE_T *,int16_t);
+int16_t SpeedProfile(SPEED_PROFILE_T *,int16_t);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PROFILE_H */
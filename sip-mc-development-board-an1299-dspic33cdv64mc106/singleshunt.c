@@ -36,11 +36,30 @@
 #include <libq.h>
 #include "userparms.h"
 #include "singleshunt.h"
+#include "dpwm.h"
+#include "predict.h"
 
 
-SINGLE_SHUNT_PARM_T singleShuntParam;
 inline static void SingleShunt_CalculateSwitchingTime(SINGLE_SHUNT_PARM_T *,uint16_t );
 
+/* Sector table shared by the space vector modulation and the phase current
+   reconstruction. It is indexed by the sign bits of Va, Vb and Vc:
+   index = (Va >= 0) + 2*(Vb >= 0) + 4*(Vc >= 0). Phases are 0 = a, 1 = b, 
+   2 = c. Indices 0 and 7 are not valid SVM sectors (they only occur due to
+   rounding) and are handled as sectors 4 and 3 respectively */
+static const SS_SECTOR_T ssSectorTable[8] =
+{
+    /* sector, T1, T2, negate, Ibus1 (Ta), mid (Tb), Ibus2 (Tc) */
+    {4, 1, 0, -1, 2, 1, 0},         /* (0,0,0) treated as sector 4 */
+    {1, 2, 1, -1, 1, 0, 2},         /* (0,0,1)  60-120 degrees */
+    {2, 0, 2, -1, 0, 2, 1},         /* (0,1,0) 300-0   degrees */
+    {3, 0, 1,  0, 0, 1, 2},         /* (0,1,1)   0-60  degrees */
+    {4, 1, 0, -1, 2, 1, 0},         /* (1,0,0) 180-240 degrees */
+    {5, 2, 0,  0, 1, 2, 0},         /* (1,0,1) 120-180 degrees */
+    {6, 1, 2,  0, 2, 0, 1},         /* (1,1,0) 240-300 degrees */
+    {3, 0, 1,  0, 0, 1, 2}          /* (1,1,1) treated as sector 3 */
+};
+
 // *****************************************************************************
 
 /* Function:
@@ -77,6 +96,17 @@ void SingleShunt_InitializeParameters(SINGLE_SHUNT_PARM_T *pSingleShunt)
     pSingleShunt->Ibus1 = 0;
     pSingleShunt->Ibus2 = 0;
     pSingleShunt->adcSamplePoint = 0;
+    /* Start from the sector 3 entry of the sector table */
+    pSingleShunt->sectorIndex = 3;
+    pSingleShunt->sectorSVM = 3;
+    /* Both samples are valid until a pattern is calculated */
+    pSingleShunt->bus1Valid = 1;
+    pSingleShunt->bus2Valid = 1;
+    pSingleShunt->iabcPredict.a = 0;
+    pSingleShunt->iabcPredict.b = 0;
+    pSingleShunt->iabcPredict.c = 0;
+    pSingleShunt->dpwmClamp = DPWM_CLAMP_NONE;
+    pSingleShunt->zeroVectorValid = 0;
 }
 // *****************************************************************************
 
@@ -110,110 +140,59 @@ uint16_t SingleShunt_CalculateSpaceVectorPhaseShifted(MC_ABC_T *abc,
     
     MC_DUTYCYCLEOUT_T *pdcout1 = &pSingleShunt->pwmDutycycle1;
     MC_DUTYCYCLEOUT_T *pdcout2 = &pSingleShunt->pwmDutycycle2;   
-    if (abc->a >= 0)
-    {
-        // (xx1)
-        if (abc->b >= 0)
-        {
-            // (x11)
-            // Must be Sector 3 since Sector 7 not allowed
-            // Sector 3: (0,1,1)  0-60 degrees
-            pSingleShunt->sectorSVM  = 3; 
-            pSingleShunt->T1 = abc->a;
-            pSingleShunt->T2 = abc->b;
-            SingleShunt_CalculateSwitchingTime(&singleShuntParam,iPwmPeriod);
-            pdcout1->dutycycle1 = pSingleShunt->Ta1;
-            pdcout1->dutycycle2 = pSingleShunt->Tb1;
-            pdcout1->dutycycle3 = pSingleShunt->Tc1;
-            pdcout2->dutycycle1 = pSingleShunt->Ta2;
-            pdcout2->dutycycle2 = pSingleShunt->Tb2;
-            pdcout2->dutycycle3 = pSingleShunt->Tc2;
-        }
-        else
-        {
-            // (x01)
-            if (abc->c >= 0)
-            {
-                // Sector 5: (1,0,1)  120-180 degrees
-                pSingleShunt->sectorSVM  = 5;
-                pSingleShunt->T1 = abc->c;
-                pSingleShunt->T2 = abc->a;
-                SingleShunt_CalculateSwitchingTime(&singleShuntParam,iPwmPeriod);
-                pdcout1->dutycycle1 = pSingleShunt->Tc1;
-                pdcout1->dutycycle2 = pSingleShunt->Ta1;
-                pdcout1->dutycycle3 = pSingleShunt->Tb1;
-                pdcout2->dutycycle1 = pSingleShunt->Tc2;
-                pdcout2->dutycycle2 = pSingleShunt->Ta2;
-                pdcout2->dutycycle3 = pSingleShunt->Tb2;
-            }
-            else
-            {
-                // Sector 1: (0,0,1)  60-120 degrees
-                pSingleShunt->sectorSVM  = 1;
-                pSingleShunt->T1 = -abc->c;
-                pSingleShunt->T2 = -abc->b;
-                SingleShunt_CalculateSwitchingTime(&singleShuntParam,iPwmPeriod);
-                pdcout1->dutycycle1 = pSingleShunt->Tb1;
-                pdcout1->dutycycle2 = pSingleShunt->Ta1;
-                pdcout1->dutycycle3 = pSingleShunt->Tc1;
-                pdcout2->dutycycle1 = pSingleShunt->Tb2;
-                pdcout2->dutycycle2 = pSingleShunt->Ta2;
-                pdcout2->dutycycle3 = pSingleShunt->Tc2;
-            }
-        }
-    }
-    else
-    {
-        // (xx0)
-        if (abc->b >= 0)
-        {
-            // (x10)
-            if (abc->c >= 0)
-            {
-                // Sector 6: (1,1,0)  240-300 degrees
-                pSingleShunt->sectorSVM  = 6;
-                pSingleShunt->T1 = abc->b;
-                pSingleShunt->T2 = abc->c;
-                SingleShunt_CalculateSwitchingTime(&singleShuntParam,iPwmPeriod);
-                pdcout1->dutycycle1 = pSingleShunt->Tb1;
-                pdcout1->dutycycle2 = pSingleShunt->Tc1;
-                pdcout1->dutycycle3 = pSingleShunt->Ta1;
-                pdcout2->dutycycle1 = pSingleShunt->Tb2;
-                pdcout2->dutycycle2 = pSingleShunt->Tc2;
-                pdcout2->dutycycle3 = pSingleShunt->Ta2;
-            }
-            else
-            {
-                // Sector 2: (0,1,0)  300-0 degrees
-                pSingleShunt->sectorSVM  = 2;
-                pSingleShunt->T1 = -abc->a;
-                pSingleShunt->T2 = -abc->c;
-                SingleShunt_CalculateSwitchingTime(&singleShuntParam,iPwmPeriod);
-                pdcout1->dutycycle1 = pSingleShunt->Ta1;
-                pdcout1->dutycycle2 = pSingleShunt->Tc1;
-                pdcout1->dutycycle3 = pSingleShunt->Tb1;
-                pdcout2->dutycycle1 = pSingleShunt->Ta2;
-                pdcout2->dutycycle2 = pSingleShunt->Tc2;
-                pdcout2->dutycycle3 = pSingleShunt->Tb2;
-            }
-        }
-        else
-        {
-            // (x00)
-            // Must be Sector 4 since Sector 0 not allowed
-            // Sector 4: (1,0,0)  180-240 degrees
-            pSingleShunt->sectorSVM  = 4;
-            pSingleShunt->T1 = -abc->b;
-            pSingleShunt->T2 = -abc->a;
-            SingleShunt_CalculateSwitchingTime(&singleShuntParam,iPwmPeriod);
-            pdcout1->dutycycle1 = pSingleShunt->Tc1;
-            pdcout1->dutycycle2 = pSingleShunt->Tb1;
-            pdcout1->dutycycle3 = pSingleShunt->Ta1;
-            pdcout2->dutycycle1 = pSingleShunt->Tc2;
-            pdcout2->dutycycle2 = pSingleShunt->Tb2;
-            pdcout2->dutycycle3 = pSingleShunt->Ta2;
-        }
-    }
+    const SS_SECTOR_T *pSector;
+    int16_t vabc[3];
+    uint16_t duty1[3],duty2[3];
+    uint16_t index;
+
+    vabc[0] = abc->a;
+    vabc[1] = abc->b;
+    vabc[2] = abc->c;
+
+    /* Sector table index from the sign bits of Va, Vb and Vc */
+    index = ((uint16_t)~abc->a >> 15) | 
+            (((uint16_t)~abc->b >> 15) << 1) |
+            (((uint16_t)~abc->c >> 15) << 2);
+    pSector = &ssSectorTable[index];
+    pSingleShunt->sectorIndex = index;
+    pSingleShunt->sectorSVM = pSector->sector;
+
+    /* T1 and T2 are the two phase voltages of the sector, negated in the
+       sectors where only one phase voltage is positive */
+    pSingleShunt->T1 = (vabc[pSector->phaseT1] ^ pSector->negate) - 
+                        pSector->negate;
+    pSingleShunt->T2 = (vabc[pSector->phaseT2] ^ pSector->negate) - 
+                        pSector->negate;
+#ifdef DISCONTINUOUS_PWM
+    /* Ta phase has the longest duty, Tb = Tc + T1 and Ta = Tb + T2 */
+    pSingleShunt->dpwmClamp = DpwmSelectClamp(pSingleShunt->pDpwm,pSector->phaseIbus1,
+                                              pSector->phaseIbus2,
+                                              pSingleShunt->T2,
+                                              pSingleShunt->T1);
+#endif
+    SingleShunt_CalculateSwitchingTime(pSingleShunt,iPwmPeriod);
+    /* All phases are low around the PWM valley for the time left after the
+       longest duty, this zero vector can be used to sample the bus current 
+       offset */
+    pSingleShunt->zeroVectorValid = 
+        (((int16_t)iPwmPeriod - pSingleShunt->Ta1) > pSingleShunt->tcrit) &&
+        (((int16_t)iPwmPeriod - pSingleShunt->Ta2) > pSingleShunt->tcrit);
+
+    /* The phase measured by Ibus1 gets Ta, the one measured by Ibus2 gets Tc */
+    duty1[pSector->phaseIbus1] = pSingleShunt->Ta1;
+    duty1[pSector->phaseMid] = pSingleShunt->Tb1;
+    duty1[pSector->phaseIbus2] = pSingleShunt->Tc1;
+    duty2[pSector->phaseIbus1] = pSingleShunt->Ta2;
+    duty2[pSector->phaseMid] = pSingleShunt->Tb2;
+    duty2[pSector->phaseIbus2] = pSingleShunt->Tc2;
+
+    pdcout1->dutycycle1 = duty1[0];
+    pdcout1->dutycycle2 = duty1[1];
+    pdcout1->dutycycle3 = duty1[2];
+    pdcout2->dutycycle1 = duty2[0];
+    pdcout2->dutycycle2 = duty2[1];
+    pdcout2->dutycycle3 = duty2[2];
+
     /* Calculate two triggers for the ADC that will fall in between PWM
         so a valid measurement is done using a single shunt resistor.
         tDelaySample is added as a delay so no erroneous measurement is taken*/
@@ -222,8 +201,6 @@ uint16_t SingleShunt_CalculateSpaceVectorPhaseShifted(MC_ABC_T *abc,
     pSingleShunt->trigger1 = pSingleShunt->trigger1 - ((pSingleShunt->Ta1 + pSingleShunt->Tb1) >> 1) ;
     pSingleShunt->trigger2 = (iPwmPeriod +  pSingleShunt->tDelaySample);
     pSingleShunt->trigger2 = pSingleShunt->trigger2 - ((pSingleShunt->Tb1 + pSingleShunt->Tc1) >> 1) ;
-	INVERTERA_PWM_TRIGB = singleShuntParam.trigger1;
-    INVERTERA_PWM_TRIGC = singleShuntParam.trigger2;
     CORCON = mcCorconSave;
     return(1);
 }
@@ -260,6 +237,48 @@ inline static void SingleShunt_CalculateSwitchingTime(SINGLE_SHUNT_PARM_T *pSing
     pSingleShunt->T1 = (int16_t) (__builtin_mulss(iPwmPeriod,pSingleShunt->T1) >> 15);
     pSingleShunt->T2 = (int16_t) (__builtin_mulss(iPwmPeriod,pSingleShunt->T2) >> 15);
     pSingleShunt->T7 = (iPwmPeriod-pSingleShunt->T1-pSingleShunt->T2)>>1;
+#ifdef DISCONTINUOUS_PWM
+    /* Discontinuous PWM moves all of the zero vector time to one side, the 
+       shortest duty (Tc) becomes 0 or the longest (Ta) becomes the period.
+       The pattern distortion below needs zero vector time on both sides, so
+       the clamp is applied only if both measurement windows are long enough
+       and the continuous pattern is used otherwise */
+    if ((pSingleShunt->T1 <= pSingleShunt->tcrit) || 
+        (pSingleShunt->T2 <= pSingleShunt->tcrit))
+    {
+        pSingleShunt->dpwmClamp = DPWM_CLAMP_NONE;
+    }
+    else if (pSingleShunt->dpwmClamp == DPWM_CLAMP_HIGH)
+    {
+        pSingleShunt->T7 = iPwmPeriod-pSingleShunt->T1-pSingleShunt->T2;
+    }
+    else if (pSingleShunt->dpwmClamp == DPWM_CLAMP_LOW)
+    {
+        pSingleShunt->T7 = 0;
+    }
+#endif
+
+#ifdef SINGLE_SHUNT_CURRENT_PREDICTION
+    /* Ibus1 is sampled in the T2 window and Ibus2 in the T1 window */
+    pSingleShunt->bus1Valid = (pSingleShunt->T2 > pSingleShunt->tcrit);
+    pSingleShunt->bus2Valid = (pSingleShunt->T1 > pSingleShunt->tcrit);
+    /* If only one window is too short, its bus current is predicted in the
+       next cycle, so the pattern is applied without distortion */
+    if (pSingleShunt->bus1Valid != pSingleShunt->bus2Valid)
+    {
+        pSingleShunt->Tc1 = pSingleShunt->T7;
+        pSingleShunt->Tc2 = pSingleShunt->T7;
+        pSingleShunt->Tb1 = pSingleShunt->T7 + pSingleShunt->T1;
+        pSingleShunt->Tb2 = pSingleShunt->Tb1;
+        pSingleShunt->Ta1 = pSingleShunt->Tb1 + pSingleShunt->T2;
+        pSingleShunt->Ta2 = pSingleShunt->Ta1;
+        return;
+    }
+    /* Otherwise any short window is stretched to tcrit below and both 
+       samples are valid */
+    pSingleShunt->bus1Valid = 1;
+    pSingleShunt->bus2Valid = 1;
+#endif
 
 	/* If PWM counter is already counting down, in which case any modification to 
         duty cycles will take effect until PWM counter starts counting up again. 
@@ -312,6 +331,46 @@ inline static void SingleShunt_CalculateSwitchingTime(SINGLE_SHUNT_PARM_T *pSing
 	
 }    
 // *****************************************************************************
+/* Function:
+    SingleShunt_SetTriggersInverterA()
+
+  Summary:
+    Sets the bus current ADC triggers of Inverter A
+
+  Description:
+    Writes the two bus current sample points calculated by 
+    SingleShunt_CalculateSpaceVectorPhaseShifted() to the PWM trigger 
+    registers of Inverter A.
+
+  Precondition:
+    None.
+
+  Parameters:
+    pSingleShunt - Single shunt data of the axis driven by Inverter A
+
+  Returns:
+    None.
+
+  Remarks:
+    Called with the duty cycle update, the pattern calculation itself does 
+    not access the PWM registers.
+ */
+void SingleShunt_SetTriggersInverterA(const SINGLE_SHUNT_PARM_T *pSingleShunt)
+{
+#ifdef SINGLE_SHUNT_OVERSAMPLING
+    /* Two conversions per window, centered on the nominal sample point.
+       The PWM2 triggers (AN7) come first so the AN1 interrupt is serviced
+       once both samples of the window are converted */
+    INVERTERA_PWM_OVS_TRIGB = pSingleShunt->trigger1 - (SS_OVERSAMPLE_SPACING >> 1);
+    INVERTERA_PWM_OVS_TRIGC = pSingleShunt->trigger2 - (SS_OVERSAMPLE_SPACING >> 1);
+    INVERTERA_PWM_TRIGB = pSingleShunt->trigger1 + (SS_OVERSAMPLE_SPACING >> 1);
+    INVERTERA_PWM_TRIGC = pSingleShunt->trigger2 + (SS_OVERSAMPLE_SPACING >> 1);
+#else
+    INVERTERA_PWM_TRIGB = pSingleShunt->trigger1;
+    INVERTERA_PWM_TRIGC = pSingleShunt->trigger2;
+#endif
+}
+// *****************************************************************************
 
 /* Function:
     PhaseCurrent_Reconstruction ()
@@ -336,37 +395,99 @@ inline static void SingleShunt_CalculateSwitchingTime(SINGLE_SHUNT_PARM_T *pSing
  */
 void SingleShunt_PhaseCurrentReconstruction(SINGLE_SHUNT_PARM_T *pSingleShunt)
 {
-    switch(pSingleShunt->sectorSVM)
+    const SS_SECTOR_T *pSector = &ssSectorTable[pSingleShunt->sectorIndex];
+    int16_t iabc[3];
+#ifdef SINGLE_SHUNT_CURRENT_PREDICTION
+    int16_t iPredict[3];
+    int16_t error;
+
+    iPredict[0] = pSingleShunt->iabcPredict.a;
+    iPredict[1] = pSingleShunt->iabcPredict.b;
+    iPredict[2] = pSingleShunt->iabcPredict.c;
+
+    /* The missing sample is replaced by the predicted current, corrected by
+       half of the prediction error seen on the measured phase. The third
+       phase then absorbs the other half, which is the least squares fit of
+       the prediction to the measurement with Ia + Ib + Ic = 0 */
+    if (pSingleShunt->bus1Valid == 0)
     {
-        case 1:
-            pSingleShunt->Ib = pSingleShunt->Ibus1;
-            pSingleShunt->Ic = -pSingleShunt->Ibus2;
-            pSingleShunt->Ia = -pSingleShunt->Ic - pSingleShunt->Ib;
-        break;
-        case 2:
-            pSingleShunt->Ia = pSingleShunt->Ibus1;
-            pSingleShunt->Ib = -pSingleShunt->Ibus2;
-            pSingleShunt->Ic = -pSingleShunt->Ia - pSingleShunt->Ib;
-        break;
-        case 3:
-            pSingleShunt->Ia = pSingleShunt->Ibus1; 
-            pSingleShunt->Ic = -pSingleShunt->Ibus2;
-            pSingleShunt->Ib = -pSingleShunt->Ia - pSingleShunt->Ic;
-        break;
-        case 4:
-            pSingleShunt->Ic = pSingleShunt->Ibus1; 
-            pSingleShunt->Ia = -pSingleShunt->Ibus2; 
-            pSingleShunt->Ib = -pSingleShunt->Ia - pSingleShunt->Ic;
-        break;
-        case 5:
-            pSingleShunt->Ib = pSingleShunt->Ibus1; 
-            pSingleShunt->Ia = -pSingleShunt->Ibus2; 
-            pSingleShunt->Ic = -pSingleShunt->Ia - pSingleShunt->Ib;
-        break;
-        case 6:
-            pSingleShunt->Ic = pSingleShunt->Ibus1; 
-            pSingleShunt->Ib = -pSingleShunt->Ibus2;
-            pSingleShunt->Ia = -pSingleShunt->Ic - pSingleShunt->Ib;
-        break;   
-    }  
-}
\ No newline at end of file
+        error = -pSingleShunt->Ibus2 - iPredict[pSector->phaseIbus2];
+        pSingleShunt->Ibus1 = iPredict[pSector->phaseIbus1] - (error >> 1);
+    }
+    else if (pSingleShunt->bus2Valid == 0)
+    {
+        error = pSingleShunt->Ibus1 - iPredict[pSector->phaseIbus1];
+        pSingleShunt->Ibus2 = -(iPredict[pSector->phaseIbus2] - (error >> 1));
+    }
+#endif
+    /* Ibus1 is the current of the phase with the longest duty, Ibus2 is the 
+       negated current of the phase with the shortest duty, the third phase
+       current is obtained from Ia + Ib + Ic = 0 */
+    iabc[pSector->phaseIbus1] = pSingleShunt->Ibus1;
+    iabc[pSector->phaseIbus2] = -pSingleShunt->Ibus2;
+    iabc[pSector->phaseMid] = pSingleShunt->Ibus2 - pSingleShunt->Ibus1;
+
+    pSingleShunt->Ia = iabc[0];
+    pSingleShunt->Ib = iabc[1];
+    pSingleShunt->Ic = iabc[2];
+}
+#ifdef SINGLE_SHUNT_CURRENT_PREDICTION
+// *****************************************************************************
+
+/* Function:
+    SingleShunt_PhaseCurrentPrediction ()
+
+  Summary:
+    Predicts the phase currents at the present sampling instant
+
+  Description:
+    One step prediction of the stator currents from the currents of the 
+    previous cycle, the voltage applied over the cycle and the motor model:
+    i(k) = i(k-1) + (v - Rs*i(k-1) - BEMF) * dt/Ls
+    Scaling of Rs, Ls/dt and BEMF is the same as in Estim().
+    The prediction is only calculated when one of the bus current samples of
+    the applied pattern is missing.
+
+  Precondition:
+    None.
+
+  Parameters:
+    pVAlphaBeta    - Voltage applied during the last cycle
+    pIAlphaBeta    - Currents of the previous cycle
+    pBemfAlphaBeta - BEMF estimated in the previous cycle
+    rs             - normalized Rs (motorParm.qRs)
+    lsDt           - normalized Ls/dt (motorParm.qLsDt)
+
+  Returns:
+    None.
+
+  Remarks:
+    None.
+ */
+void SingleShunt_PhaseCurrentPrediction(SINGLE_SHUNT_PARM_T *pSingleShunt,
+                                        const MC_ALPHABETA_T *pVAlphaBeta,
+                                        const MC_ALPHABETA_T *pIAlphaBeta,
+                                        const MC_ALPHABETA_T *pBemfAlphaBeta,
+                                        int16_t rs, int16_t lsDt)
+{
+    int16_t iAlpha,iBeta;
+
+    if ((pSingleShunt->bus1Valid != 0) && (pSingleShunt->bus2Valid != 0))
+    {
+        return;
+    }
+    iAlpha = PredictCurrent(pVAlphaBeta->alpha,pIAlphaBeta->alpha,
+                            pBemfAlphaBeta->alpha,0,rs,lsDt,
+                            PREDICT_SHIFT_CYCLE);
+    iBeta = PredictCurrent(pVAlphaBeta->beta,pIAlphaBeta->beta,
+                           pBemfAlphaBeta->beta,0,rs,lsDt,
+                           PREDICT_SHIFT_CYCLE);
+
+    /* Inverse Clarke: Ia = Ialpha, Ib = -Ialpha/2 + sqrt(3)/2*Ibeta */
+    pSingleShunt->iabcPredict.a = iAlpha;
+    pSingleShunt->iabcPredict.b = -(iAlpha >> 1) +
+                        (int16_t)(__builtin_mulss(iBeta,Q15(0.8660254)) >> 15);
+    pSingleShunt->iabcPredict.c = -pSingleShunt->iabcPredict.a -
+                                   pSingleShunt->iabcPredict.b;
+}
+#endif
@@ -40,16 +40,51 @@ extern "C" {
 #include "general.h"
 #include "userparms.h"    
 #include "motor_control_noinline.h" 
+#include "dpwm.h"
       
 /* Scaling factor for current Bus Current */
 #define KCURRBUS        Q15(-0.5) 
-/*  Critical Minimum window in seconds to measure current through single shunt*/  
-#define SSTCRITINSEC	3.5E-6	
+/* Critical Minimum window in seconds to measure current through single shunt.
+   The same window is used with SINGLE_SHUNT_OVERSAMPLING: averaging the two
+   conversions halves the variance of the uncorrelated noise 
+   (test_sensing_oversampling), but does not shorten the ringing after the
+   switching edges, and the first conversion is taken half of 
+   SS_OVERSAMPLE_SPACING_SEC closer to the edge. The window has to hold 
+   SS_SAMPLE_DELAY plus half of SS_OVERSAMPLE_SPACING_SEC on each side of 
+   its center */
+#define SSTCRITINSEC    3.5E-6
 /* Single shunt algorithm defines *2 because is same resolution as PDCx registers */    							
 #define SSTCRIT         (uint16_t)(SSTCRITINSEC*FCY*2)  
 /* Single shunt algorithm defines *2 because is same resolution as PDCx registers */    							
 #define SS_SAMPLE_DELAY  100  
+/* Time in seconds between the two bus current conversions taken in the same
+   window when SINGLE_SHUNT_OVERSAMPLING is defined. It should not be shorter
+   than one shared ADC core conversion so the two triggers do not queue, and 
+   SS_SAMPLE_DELAY plus half of it must fit in half of SSTCRITINSEC.
+   Two conversions are taken because the bus current amplifier is connected
+   to two ADC inputs, AN1 (dedicated core) and AN7 (shared core), each 
+   triggered by its own PWM generator. A third conversion, or the digital 
+   filter in oversampling mode, would convert one of the inputs again after
+   its conversion time, which lengthens the window instead of shortening 
+   SSTCRITINSEC */
+#define SS_OVERSAMPLE_SPACING_SEC   0.7E-6
+/* Oversampling spacing, *2 because is same resolution as PDCx registers */
+#define SS_OVERSAMPLE_SPACING  (uint16_t)(SS_OVERSAMPLE_SPACING_SEC*FCY*2)
     
+ /* Description:
+    Sector table entry, phases are 0 = a, 1 = b, 2 = c
+ */
+typedef struct
+{
+    int16_t sector;         /* SVM sector number, 1 to 6 */
+    uint16_t phaseT1;       /* Phase voltage used as T1 */
+    uint16_t phaseT2;       /* Phase voltage used as T2 */
+    int16_t negate;         /* -1 when T1 and T2 are the negated voltages */
+    uint16_t phaseIbus1;    /* Phase with longest duty, measured by Ibus1 */
+    uint16_t phaseMid;      /* Phase with the middle duty */
+    uint16_t phaseIbus2;    /* Phase with shortest duty, measured by -Ibus2 */
+} SS_SECTOR_T;
+
  /* Description:
     This structure will host parameters related to measured currents
  */
@@ -68,6 +103,8 @@ typedef struct
                                 // vector modulation is in. The Sector value is used to
                                 // identify which duty cycle registers to be modified
                                 // in order to measure current through single shunt
+    uint16_t sectorIndex;   /* Index of the active entry in the sector table,
+                               formed from the sign bits of Va, Vb and Vc */
     int16_t tcrit;			// variable used to create minimum window to measure
                                 // current through single shunt resistor when enabled
                                 // Define minimum window in UserParms.h, SSTCRITINSEC
@@ -91,6 +128,19 @@ typedef struct
     int16_t adcSamplePoint;
     MC_DUTYCYCLEOUT_T pwmDutycycle1;
     MC_DUTYCYCLEOUT_T pwmDutycycle2;
+    int16_t bus1Valid;      /* Ibus1 window of the applied pattern is at least
+                               tcrit long */
+    int16_t bus2Valid;      /* Ibus2 window of the applied pattern is at least
+                               tcrit long */
+    MC_ABC_T iabcPredict;   /* Phase currents predicted from the motor model,
+                               used in place of a missing bus current sample */
+    int16_t dpwmClamp;      /* Rail the pattern is clamped to with the 
+                               discontinuous PWM, DPWM_CLAMP_xxx (dpwm.h) */
+    int16_t zeroVectorValid; /* The zero vector at the PWM valley of the 
+                               pattern is longer than tcrit */
+    const DPWM_PARM_T *pDpwm; /* Discontinuous PWM data of the axis, set by
+                               the application when DISCONTINUOUS_PWM is 
+                               defined */
     
 } SINGLE_SHUNT_PARM_T;
 
@@ -101,12 +151,17 @@ typedef enum tagSSADCSAMPLE_STATE
      
 }SSADCSAMPLE_STATE;
 			
-extern SINGLE_SHUNT_PARM_T singleShuntParam;
 uint16_t SingleShunt_CalculateSpaceVectorPhaseShifted(MC_ABC_T *pABC,
                                                      uint16_t iPwmPeriod,
                                                      SINGLE_SHUNT_PARM_T *);
+void SingleShunt_SetTriggersInverterA(const SINGLE_SHUNT_PARM_T *);
 void SingleShunt_PhaseCurrentReconstruction(SINGLE_SHUNT_PARM_T *);
 void SingleShunt_InitializeParameters(SINGLE_SHUNT_PARM_T *);
+void SingleShunt_PhaseCurrentPrediction(SINGLE_SHUNT_PARM_T *,
+                                        const MC_ALPHABETA_T *pVAlphaBeta,
+                                        const MC_ALPHABETA_T *pIAlphaBeta,
+                                        const MC_ALPHABETA_T *pBemfAlphaBeta,
+                                        int16_t rs, int16_t lsDt);
 
 #ifdef	__cplusplus
 }
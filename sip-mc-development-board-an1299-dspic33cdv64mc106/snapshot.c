@@ -0,0 +1,148 @@
+/*******************************************************************************
+ * Copyright (c) 2017 released Microchip Technology Inc.  All rights reserved.
+ *
+ * SOFTWARE LICENSE AGREEMENT:
+ *
+ * Microchip Technology Incorporated ("Microchip") retains all ownership and
+ * intellectual property rights in the code accompanying this message and in all
+ * derivatives hereto.  You may use this code, and any derivatives created by
+ * any person or entity by or on your behalf, exclusively with Microchip's
+ * proprietary products.  Your acceptance and/or use of this code constitutes
+ * agreement to the terms and conditions of this notice.
+ *
+ * CODE ACCOMPANYING THIS MESSAGE IS SUPPLIED BY MICROCHIP "AS IS".  NO
+ * WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
+ * TO, IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE APPLY TO THIS CODE, ITS INTERACTION WITH MICROCHIP'S
+ * PRODUCTS, COMBINATION WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION.
+ *
+ * YOU ACKNOWLEDGE AND AGREE THAT, IN NO EVENT, SHALL MICROCHIP BE LIABLE,
+ * WHETHER IN CONTRACT, WARRANTY, TORT (INCLUDING NEGLIGENCE OR BREACH OF
+ * STATUTORY DUTY),STRICT LIABILITY, INDEMNITY, CONTRIBUTION, OR OTHERWISE,
+ * FOR ANY INDIRECT, SPECIAL,PUNITIVE, EXEMPLARY, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, FOR COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE CODE,
+ * HOWSOEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE POSSIBILITY OR
+ * THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT ALLOWABLE BY LAW,
+ * MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY RELATED TO THIS CODE,
+ * SHALL NOT EXCEED THE PRICE YOU PAID DIRECTLY TO MICROCHIP SPECIFICALLY TO
+ * HAVE THIS CODE DEVELOPED.
+ *
+ * You agree that you are solely responsible for testing the code and
+ * determining its suitability.  Microchip has no obligation to modify, test,
+ * certify, or support the code.
+ *
+ *******************************************************************************/
+#include <stdint.h>
+#include "snapshot.h"
+
+// *****************************************************************************
+/* Function:
+    SnapshotInitialize()
+
+  Summary:
+    Initializes the fault snapshot
+
+  Description:
+    Clears the buffer and starts recording.
+
+  Precondition:
+    None.
+
+  Parameters:
+    pSnapshot - Fault snapshot data
+
+  Returns:
+    None.
+
+  Remarks:
+    Called at power up, the buffer is kept when the motor stops.
+ */
+void SnapshotInitialize(SNAPSHOT_T *pSnapshot)
+{
+    uint16_t i;
+    
+    for (i = 0; i < SNAPSHOT_LENGTH; i++)
+    {
+        pSnapshot->sample[i].idq.d = 0;
+        pSnapshot->sample[i].idq.q = 0;
+        pSnapshot->sample[i].vdq.d = 0;
+        pSnapshot->sample[i].vdq.q = 0;
+        pSnapshot->sample[i].qRho = 0;
+        pSnapshot->sample[i].qVelEstim = 0;
+        pSnapshot->sample[i].dcBusVoltage = 0;
+        pSnapshot->sample[i].Ibus1 = 0;
+        pSnapshot->sample[i].Ibus2 = 0;
+    }
+    pSnapshot->index = 0;
+    pSnapshot->source = SNAPSHOT_SOURCE_NONE;
+    pSnapshot->faultCount = 0;
+}
+// *****************************************************************************
+/* Function:
+    SnapshotRecord()
+
+  Summary:
+    Records the signals of one control cycle
+
+  Description:
+    The sample overwrites the oldest one of the ring buffer, nothing is 
+    recorded while the buffer is frozen.
+
+  Precondition:
+    None.
+
+  Parameters:
+    pSnapshot - Fault snapshot data
+    pSample   - Signals of the cycle
+
+  Returns:
+    None.
+
+  Remarks:
+    Called every control cycle.
+ */
+void SnapshotRecord(SNAPSHOT_T *pSnapshot,const SNAPSHOT_SAMPLE_T *pSample)
+{
+    if (pSnapshot->source != SNAPSHOT_SOURCE_NONE)
+    {
+        return;
+    }
+    pSnapshot->sample[pSnapshot->index] = *pSample;
+    pSnapshot->index++;
+    if (pSnapshot->index >= SNAPSHOT_LENGTH)
+    {
+        pSnapshot->index = 0;
+    }
+}
+// *****************************************************************************
+/* Function:
+    SnapshotFreeze()
+
+  Summary:
+    Freezes the buffer on a fault
+
+  Description:
+    The first fault freezes the buffer and saves its source, the following
+    faults are only counted until the buffer is released.
+
+  Precondition:
+    None.
+
+  Parameters:
+    pSnapshot - Fault snapshot data
+    source    - Fault source, SNAPSHOT_SOURCE_xxx
+
+  Returns:
+    None.
+
+  Remarks:
+    Called from the fault interrupts.
+ */
+void SnapshotFreeze(SNAPSHOT_T *pSnapshot,uint16_t source)
+{
+    pSnapshot->faultCount++;
+    if (pSnapshot->source == SNAPSHOT_SOURCE_NONE)
+    {
+        pSnapshot->source = source;
+    }
+}
@@ -0,0 +1,101 @@
+/*******************************************************************************
+* Copyright (c) 2017 released Microchip Technology Inc.  All rights reserved.
+*
+* SOFTWARE LICENSE AGREEMENT:
+* 
+* Microchip Technology Incorporated ("Microchip") retains all ownership and
+* intellectual property rights in the code accompanying this message and in all
+* derivatives hereto.  You may use this code, and any derivatives created by
+* any person or entity by or on your behalf, exclusively with Microchip's
+* proprietary products.  Your acceptance and/or use of this code constitutes
+* agreement to the terms and conditions of this notice.
+*
+* CODE ACCOMPANYING THIS MESSAGE IS SUPPLIED BY MICROCHIP "AS IS".  NO
+* WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
+* TO, IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE APPLY TO THIS CODE, ITS INTERACTION WITH MICROCHIP'S
+* PRODUCTS, COMBINATION WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION.
+*
+* YOU ACKNOWLEDGE AND AGREE THAT, IN NO EVENT, SHALL MICROCHIP BE LIABLE,
+* WHETHER IN CONTRACT, WARRANTY, TORT (INCLUDING NEGLIGENCE OR BREACH OF
+* STATUTORY DUTY),STRICT LIABILITY, INDEMNITY, CONTRIBUTION, OR OTHERWISE,
+* FOR ANY INDIRECT, SPECIAL,PUNITIVE, EXEMPLARY, INCIDENTAL OR CONSEQUENTIAL
+* LOSS, DAMAGE, FOR COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE CODE,
+* HOWSOEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE POSSIBILITY OR
+* THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT ALLOWABLE BY LAW,
+* MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY RELATED TO THIS CODE,
+* SHALL NOT EXCEED THE PRICE YOU PAID DIRECTLY TO MICROCHIP SPECIFICALLY TO
+* HAVE THIS CODE DEVELOPED.
+*
+* You agree that you are solely responsible for testing the code and
+* determining its suitability.  Microchip has no obligation to modify, test,
+* certify, or support the code.
+*
+*******************************************************************************/
+#ifndef __SNAPSHOT_H
+#define __SNAPSHOT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "motor_control_noinline.h"
+
+/* Number of control cycles recorded before the fault */
+#define SNAPSHOT_LENGTH         32
+
+/* Fault sources */
+#define SNAPSHOT_SOURCE_NONE            0
+#define SNAPSHOT_SOURCE_PWM_FAULT       1
+#define SNAPSHOT_SOURCE_GATE_DRIVER     2
+#define SNAPSHOT_SOURCE_STALL           3
+
+/* Snapshot sample data type
+
+  Description:
+    Signals of one control cycle.
+ */
+typedef struct
+{
+    MC_DQ_T idq;
+    /* Shifted right by VOLTAGE_SCALE_SHIFT */
+    MC_DQ_T vdq;
+    int16_t qRho;
+    int16_t qVelEstim;
+    int16_t dcBusVoltage;
+    /* Single shunt bus current samples */
+    int16_t Ibus1;
+    int16_t Ibus2;
+} SNAPSHOT_SAMPLE_T;
+
+/* Fault Snapshot data type
+
+  Description:
+    This structure will host a ring buffer of the last SNAPSHOT_LENGTH 
+    control cycles. The recording is frozen by the first fault, so the 
+    buffer holds the cycles before the fault until it is released. When 
+    frozen, sample[index] is the oldest and sample[index-1] the last cycle
+    before the fault.
+ */
+typedef struct
+{
+    SNAPSHOT_SAMPLE_T sample[SNAPSHOT_LENGTH];
+    /* Next sample to be written */
+    uint16_t index;
+    /* Source of the fault which froze the buffer, SNAPSHOT_SOURCE_NONE 
+       while recording. Write SNAPSHOT_SOURCE_NONE to release the buffer */
+    uint16_t source;
+    /* Faults since power up */
+    uint16_t faultCount;
+} SNAPSHOT_T;
+
+void SnapshotInitialize(SNAPSHOT_T *);
+void SnapshotRecord(SNAPSHOT_T *,const SNAPSHOT_SAMPLE_T *);
+void SnapshotFreeze(SNAPSHOT_T *,uint16_t);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SNAPSHOT_H */
@@ -0,0 +1,300 @@
+/*******************************************************************************
+ * Copyright (c) 2017 released Microchip Technology Inc.  All rights reserved.
+ *
+ * SOFTWARE LICENSE AGREEMENT:
+ *
+ * Microchip Technology Incorporated ("Microchip") retains all ownership and
+ * intellectual property rights in the code accompanying this message and in all
+ * derivatives hereto.  You may use this code, and any derivatives created by
+ * any person or entity by or on your behalf, exclusively with Microchip's
+ * proprietary products.  Your acceptance and/or use of this code constitutes
+ * agreement to the terms and conditions of this notice.
+ *
+ * CODE ACCOMPANYING THIS MESSAGE IS SUPPLIED BY MICROCHIP "AS IS".  NO
+ * WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
+ * TO, IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE APPLY TO THIS CODE, ITS INTERACTION WITH MICROCHIP'S
+ * PRODUCTS, COMBINATION WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION.
+ *
+ * YOU ACKNOWLEDGE AND AGREE THAT, IN NO EVENT, SHALL MICROCHIP BE LIABLE,
+ * WHETHER IN CONTRACT, WARRANTY, TORT (INCLUDING NEGLIGENCE OR BREACH OF
+ * STATUTORY DUTY),STRICT LIABILITY, INDEMNITY, CONTRIBUTION, OR OTHERWISE,
+ * FOR ANY INDIRECT, SPECIAL,PUNITIVE, EXEMPLARY, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, FOR COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE CODE,
+ * HOWSOEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE POSSIBILITY OR
+ * THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT ALLOWABLE BY LAW,
+ * MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY RELATED TO THIS CODE,
+ * SHALL NOT EXCEED THE PRICE YOU PAID DIRECTLY TO MICROCHIP SPECIFICALLY TO
+ * HAVE THIS CODE DEVELOPED.
+ *
+ * You agree that you are solely responsible for testing the code and
+ * determining its suitability.  Microchip has no obligation to modify, test,
+ * certify, or support the code.
+ *
+ *******************************************************************************/
+#include <stdint.h>
+#include <libq.h>
+#include "stall.h"
+#include "userparms.h"
+#include "general.h"
+#include "pwm.h"
+
+// *****************************************************************************
+/* Function:
+    StallInitialize()
+
+  Summary:
+    Initializes the stall detection
+
+  Description:
+    Starts monitoring with the checks blanked, the times are scaled to the 
+    loop time in use.
+
+  Precondition:
+    The PWM timing (pwmTiming) is calculated.
+
+  Parameters:
+    pParm - Stall detection data
+
+  Returns:
+    None.
+
+  Remarks:
+    Called when the motor is stopped, the source of the last detection is 
+    kept.
+ */
+void StallInitialize(STALL_PARM_T *pParm)
+{
+    pParm->state = STALL_STATE_MONITOR;
+    pParm->detectTime = PWMScaleLoopFrequency(STALL_DETECT_TIME);
+    pParm->blankTime = PWMScaleLoopFrequency(STALL_BLANKING_TIME);
+    pParm->catchTime = PWMScaleLoopFrequency(STALL_CATCH_TIME);
+    /* As PWMScaleLoopFrequency(), in the uint16 range */
+    pParm->stableTime = (uint16_t)(((uint32_t)STALL_STABLE_TIME << 
+                            PWM_TIME_SCALE_SHIFT) / pwmTiming.timeScale);
+    pParm->catchCount = 0;
+    pParm->restartCount = 0;
+    StallBlank(pParm);
+}
+// *****************************************************************************
+/* Function:
+    StallBlank()
+
+  Summary:
+    Blanks the estimator checks for the blanking time
+
+  Description:
+    The estimator settles after the transition to closed loop, only the 
+    locked rotor is checked. The detection counter and the stable time are
+    cleared.
+
+  Precondition:
+    None.
+
+  Parameters:
+    pParm - Stall detection data
+
+  Returns:
+    None.
+
+  Remarks:
+    None.
+ */
+void StallBlank(STALL_PARM_T *pParm)
+{
+    pParm->blankCount = pParm->blankTime;
+    pParm->count = 0;
+    pParm->stableCount = 0;
+}
+// *****************************************************************************
+/* Function:
+    StallCheck()
+
+  Summary:
+    Checks the consistency of the estimator in one control cycle
+
+  Description:
+    With the estimated angle locked to the rotor the BEMF is on the q axis,
+    so the d BEMF has to be small compared to the q BEMF. The unfiltered 
+    speed calculated from the BEMF (qOmegaMr) has to follow the filtered 
+    estimated speed. At low estimated speed the q current has to be low, 
+    a high current without speed is a locked rotor.
+
+  Precondition:
+    None.
+
+  Parameters:
+    pEstim - Estimator data
+    pIdq   - Currents measured in the cycle
+
+  Returns:
+    The failed checks, STALL_SOURCE_xxx bits, 0 when consistent.
+
+  Remarks:
+    None.
+ */
+uint16_t StallCheck(const ESTIM_PARM_T *pEstim,const MC_DQ_T *pIdq)
+{
+    uint16_t source = 0;
+    int16_t speed = _Q15abs(pEstim->qVelEstim);
+    int32_t speedError = (int32_t)pEstim->qOmegaMr - pEstim->qVelEstim;
+    
+    if (speed >= STALL_SPEED_MIN)
+    {
+        if (_Q15abs(pEstim->qEsdf) > (int16_t)(__builtin_mulss(
+                _Q15abs(pEstim->qEsqf),STALL_BEMF_RATIO) >> 15))
+        {
+            source |= STALL_SOURCE_BEMF;
+        }
+    }
+    else if (_Q15abs(pIdq->q) > STALL_CURRENT_MIN)
+    {
+        source |= STALL_SOURCE_CURRENT;
+    }
+    if ((speedError > STALL_SPEED_ERROR) || (speedError < -STALL_SPEED_ERROR))
+    {
+        source |= STALL_SOURCE_SPEED;
+    }
+    return source;
+}
+// *****************************************************************************
+/* Function:
+    StallDetect()
+
+  Summary:
+    Detects the loss of the rotor by the estimator
+
+  Description:
+    The checks of StallCheck() are made every cycle. During the blanking 
+    time only the locked rotor (q current without speed) is checked: the 
+    BEMF is not settled yet but the estimated speed is valid from open 
+    loop, and the speed controller would raise the current of a locked 
+    rotor to the overcurrent limit. A cycle with failed checks increments
+    the detection counter, a consistent cycle decrements it, so short 
+    disturbances and load steps are tolerated. The rotor is lost when the counter reaches detectTime.
+    After stableTime cycles without detection the restarts are cleared, so
+    only repeated detections in a short time stop the motor.
+
+  Precondition:
+    None.
+
+  Parameters:
+    pParm  - Stall detection data
+    pEstim - Estimator data
+    pIdq   - Currents measured in the cycle
+
+  Returns:
+    1 when the loss of the rotor is detected, 0 otherwise.
+
+  Remarks:
+    Called in closed loop while monitoring, the failed checks are saved in 
+    source.
+ */
+uint16_t StallDetect(STALL_PARM_T *pParm,const ESTIM_PARM_T *pEstim,
+                     const MC_DQ_T *pIdq)
+{
+    uint16_t source = StallCheck(pEstim,pIdq);
+    
+    if (pParm->blankCount > 0)
+    {
+        pParm->blankCount--;
+        source &= STALL_SOURCE_CURRENT;
+    }
+    else if (pParm->stableCount < pParm->stableTime)
+    {
+        pParm->stableCount++;
+    }
+    else
+    {
+        pParm->restartCount = 0;
+    }
+    if (source == 0)
+    {
+        if (pParm->count > 0)
+        {
+            pParm->count--;
+        }
+        return 0;
+    }
+    pParm->count++;
+    if (pParm->count < pParm->detectTime)
+    {
+        return 0;
+    }
+    pParm->source = source;
+    pParm->detectionCount++;
+    pParm->count = 0;
+    return 1;
+}
+// *****************************************************************************
+/* Function:
+    StallCatchStart()
+
+  Summary:
+    Starts the catch spin after a detection
+
+  Description:
+    Counts the restart, after STALL_RESTART_MAX restarts the motor has to 
+    be stopped (STALL_STATE_STOP), otherwise the torque is removed for the 
+    catch time (STALL_STATE_CATCH).
+
+  Precondition:
+    None.
+
+  Parameters:
+    pParm - Stall detection data
+
+  Returns:
+    None.
+
+  Remarks:
+    None.
+ */
+void StallCatchStart(STALL_PARM_T *pParm)
+{
+    pParm->restartCount++;
+    if (pParm->restartCount > STALL_RESTART_MAX)
+    {
+        pParm->state = STALL_STATE_STOP;
+    }
+    else
+    {
+        pParm->state = STALL_STATE_CATCH;
+        pParm->catchCount = pParm->catchTime;
+    }
+}
+// *****************************************************************************
+/* Function:
+    StallCatchStep()
+
+  Summary:
+    Counts the catch time
+
+  Description:
+    While the torque is removed the estimator tracks the BEMF of the 
+    coasting rotor. At the end of the catch time the supervisor returns to
+    monitoring with the checks blanked.
+
+  Precondition:
+    StallCatchStart() is called.
+
+  Parameters:
+    pParm - Stall detection data
+
+  Returns:
+    1 at the end of the catch time, 0 otherwise.
+
+  Remarks:
+    The caller resumes closed loop or restarts from open loop.
+ */
+uint16_t StallCatchStep(STALL_PARM_T *pParm)
+{
+    if (pParm->catchCount > 0)
+    {
+        pParm->catchCount--;
+        return 0;
+    }
+    pParm->state = STALL_STATE_MONITOR;
+    StallBlank(pParm);
+    return 1;
+}
@@ -0,0 +1,99 @@
+/*******************************************************************************
+* Copyright (c) 2017 released Microchip Technology Inc.  All rights reserved.
+*
+* SOFTWARE LICENSE AGREEMENT:
+* 
+* Microchip Technology Incorporated ("Microchip") retains all ownership and
+* intellectual property rights in the code accompanying this message and in all
+* derivatives hereto.  You may use this code, and any derivatives created by
+* any person or entity by or on your behalf, exclusively with Microchip's
+* proprietary products.  Your acceptance and/or use of this code constitutes
+* agreement to the terms and conditions of this notice.
+*
+* CODE ACCOMPANYING THIS MESSAGE IS SUPPLIED BY MICROCHIP "AS IS".  NO
+* WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
+* TO, IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE APPLY TO THIS CODE, ITS INTERACTION WITH MICROCHIP'S
+* PRODUCTS, COMBINATION WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION.
+*
+* YOU ACKNOWLEDGE AND AGREE THAT, IN NO EVENT, SHALL MICROCHIP BE LIABLE,
+* WHETHER IN CONTRACT, WARRANTY, TORT (INCLUDING NEGLIGENCE OR BREACH OF
+* STATUTORY DUTY),STRICT LIABILITY, INDEMNITY, CONTRIBUTION, OR OTHERWISE,
+* FOR ANY INDIRECT, SPECIAL,PUNITIVE, EXEMPLARY, INCIDENTAL OR CONSEQUENTIAL
+* LOSS, DAMAGE, FOR COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE CODE,
+* HOWSOEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE POSSIBILITY OR
+* THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT ALLOWABLE BY LAW,
+* MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY RELATED TO THIS CODE,
+* SHALL NOT EXCEED THE PRICE YOU PAID DIRECTLY TO MICROCHIP SPECIFICALLY TO
+* HAVE THIS CODE DEVELOPED.
+*
+* You agree that you are solely responsible for testing the code and
+* determining its suitability.  Microchip has no obligation to modify, test,
+* certify, or support the code.
+*
+*******************************************************************************/
+#ifndef __STALL_H
+#define __STALL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "motor_control_noinline.h"
+#include "estim.h"
+
+/* Supervisor states */
+#define STALL_STATE_MONITOR     0
+#define STALL_STATE_CATCH       1
+#define STALL_STATE_STOP        2
+
+/* Checks failed by the estimator (source of the detection) */
+#define STALL_SOURCE_BEMF       0x0001
+#define STALL_SOURCE_SPEED      0x0002
+#define STALL_SOURCE_CURRENT    0x0004
+    
+/* Stall Detection data type
+
+  Description:
+    This structure will host the state of the supervisor of the sensorless
+    estimator. A failed check increments the detection counter and a cycle
+    without failed checks decrements it, the rotor is lost when the counter
+    reaches detectTime.
+ */
+typedef struct
+{
+    uint16_t state;
+    /* Detection counter and its limit, in control cycles */
+    int16_t count;
+    int16_t detectTime;
+    /* The BEMF and speed checks are blanked after entering closed loop */
+    int16_t blankCount;
+    int16_t blankTime;
+    /* Zero torque time of the catch spin, in control cycles */
+    int16_t catchCount;
+    int16_t catchTime;
+    /* Restarts since the motor was started or the last stable period */
+    uint16_t restartCount;
+    /* Monitoring cycles after the blanking without detection, the restart
+       counter is cleared at stableTime */
+    uint16_t stableCount;
+    uint16_t stableTime;
+    /* Checks failed at the last detection, kept after the motor stops */
+    uint16_t source;
+    /* Number of detections since power up */
+    uint16_t detectionCount;
+} STALL_PARM_T;
+
+void StallInitialize(STALL_PARM_T *);
+void StallBlank(STALL_PARM_T *);
+uint16_t StallCheck(const ESTIM_PARM_T *,const MC_DQ_T *);
+uint16_t StallDetect(STALL_PARM_T *,const ESTIM_PARM_T *,const MC_DQ_T *);
+void StallCatchStart(STALL_PARM_T *);
+uint16_t StallCatchStep(STALL_PARM_T *);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __STALL_H */
@@ -0,0 +1,63 @@
+/*******************************************************************************
+* Copyright (c) 2017 released Microchip Technology Inc.  All rights reserved.
+*
+* SOFTWARE LICENSE AGREEMENT:
+* 
+* Microchip Technology Incorporated ("Microchip") retains all ownership and
+* intellectual property rights in the code accompanying this message and in all
+* derivatives hereto.  You may use this code, and any derivatives created by
+* any person or entity by or on your behalf, exclusively with Microchip's
+* proprietary products.  Your acceptance and/or use of this code constitutes
+* agreement to the terms and conditions of this notice.
+*
+* CODE ACCOMPANYING THIS MESSAGE IS SUPPLIED BY MICROCHIP "AS IS".  NO
+* WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
+* TO, IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE APPLY TO THIS CODE, ITS INTERACTION WITH MICROCHIP'S
+* PRODUCTS, COMBINATION WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION.
+*
+* YOU ACKNOWLEDGE AND AGREE THAT, IN NO EVENT, SHALL MICROCHIP BE LIABLE,
+* WHETHER IN CONTRACT, WARRANTY, TORT (INCLUDING NEGLIGENCE OR BREACH OF
+* STATUTORY DUTY),STRICT LIABILITY, INDEMNITY, CONTRIBUTION, OR OTHERWISE,
+* FOR ANY INDIRECT, SPECIAL,PUNITIVE, EXEMPLARY, INCIDENTAL OR CONSEQUENTIAL
+* LOSS, DAMAGE, FOR COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE CODE,
+* HOWSOEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE POSSIBILITY OR
+* THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT ALLOWABLE BY LAW,
+* MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY RELATED TO THIS CODE,
+* SHALL NOT EXCEED THE PRICE YOU PAID DIRECTLY TO MICROCHIP SPECIFICALLY TO
+* HAVE THIS CODE DEVELOPED.
+*
+* You agree that you are solely responsible for testing the code and
+* determining its suitability.  Microchip has no obligation to modify, test,
+* certify, or support the code.
+*
+*******************************************************************************/
+/* XC16 built-in functions used by the firmware, for the host compiler. It is
+   included ahead of every firmware source file (-include builtins.h). The
+   multiply and divide built-ins follow the integer mode of the device, the
+   table, NVM and oscillator built-ins have no effect */
+#ifndef __BUILTINS_H
+#define __BUILTINS_H
+
+#include <stdint.h>
+
+#define __builtin_mulss(a,b)    ((int32_t)(int16_t)(a)*(int16_t)(b))
+#define __builtin_mulsu(a,b)    ((int32_t)(int16_t)(a)*(int32_t)(uint16_t)(b))
+#define __builtin_muluu(a,b)    ((uint32_t)(uint16_t)(a)*(uint16_t)(b))
+#define __builtin_divsd(a,b)    ((int16_t)((int32_t)(a)/(int16_t)(b)))
+#define __builtin_divud(a,b)    ((uint16_t)((uint32_t)(a)/(uint16_t)(b)))
+
+#define __builtin_tbladdress(a)     (0ul)
+#define __builtin_tblrdl(a)         (0xFFFFu)
+#define __builtin_tblrdh(a)         (0xFFFFu)
+#define __builtin_tblwtl(a,b)       ((void)0)
+#define __builtin_tblwth(a,b)       ((void)0)
+#define __builtin_write_NVM()       ((void)0)
+#define __builtin_write_OSCCONH(x)  ((void)0)
+#define __builtin_write_OSCCONL(x)  ((void)0)
+#define __builtin_disi(x)           ((void)0)
+#define __builtin_nop()             ((void)0)
+#define Nop()                       ((void)0)
+#define ClrWdt()                    ((void)0)
+
+#endif /* __BUILTINS_H */
@@ -0,0 +1,282 @@
+/*******************************************************************************
+* Copyright (c) 2017 released Microchip Technology Inc.  All rights reserved.
+*
+* SOFTWARE LICENSE AGREEMENT:
+* 
+* Microchip Technology Incorporated ("Microchip") retains all ownership and
+* intellectual property rights in the code accompanying this message and in all
+* derivatives hereto.  You may use this code, and any derivatives created by
+* any person or entity by or on your behalf, exclusively with Microchip's
+* proprietary products.  Your acceptance and/or use of this code constitutes
+* agreement to the terms and conditions of this notice.
+*
+* CODE ACCOMPANYING THIS MESSAGE IS SUPPLIED BY MICROCHIP "AS IS".  NO
+* WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
+* TO, IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE APPLY TO THIS CODE, ITS INTERACTION WITH MICROCHIP'S
+* PRODUCTS, COMBINATION WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION.
+*
+* YOU ACKNOWLEDGE AND AGREE THAT, IN NO EVENT, SHALL MICROCHIP BE LIABLE,
+* WHETHER IN CONTRACT, WARRANTY, TORT (INCLUDING NEGLIGENCE OR BREACH OF
+* STATUTORY DUTY),STRICT LIABILITY, INDEMNITY, CONTRIBUTION, OR OTHERWISE,
+* FOR ANY INDIRECT, SPECIAL,PUNITIVE, EXEMPLARY, INCIDENTAL OR CONSEQUENTIAL
+* LOSS, DAMAGE, FOR COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE CODE,
+* HOWSOEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE POSSIBILITY OR
+* THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT ALLOWABLE BY LAW,
+* MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY RELATED TO THIS CODE,
+* SHALL NOT EXCEED THE PRICE YOU PAID DIRECTLY TO MICROCHIP SPECIFICALLY TO
+* HAVE THIS CODE DEVELOPED.
+*
+* You agree that you are solely responsible for testing the code and
+* determining its suitability.  Microchip has no obligation to modify, test,
+* certify, or support the code.
+*
+*******************************************************************************/
+/* Motor control library functions used by the firmware, modeled in C for 
+   the host tests after the inline reference implementation of the library
+   (motor_control_inline_dspic.h). The DSP accumulator is a 64 bit value in
+   1.31 format, saturated to 32 bits after every operation as with 
+   MC_CORECONTROL, and the multiplications are fractional */
+#include <stdint.h>
+#include <math.h>
+
+#include "motor_control_noinline.h"
+
+#define MC_SINE_TABLE_SIZE  128
+
+static int16_t sineTable[MC_SINE_TABLE_SIZE];
+static int16_t sineTableReady = 0;
+
+inline static int64_t Acc_Saturate(int64_t acc)
+{
+    if (acc > INT32_MAX)
+    {
+        return INT32_MAX;
+    }
+    else if (acc < INT32_MIN)
+    {
+        return INT32_MIN;
+    }
+    return acc;
+}
+
+/* Fractional multiply, __builtin_mpy and __builtin_mulus */
+inline static int64_t Acc_Multiply(int32_t a, int32_t b)
+{
+    return Acc_Saturate(((int64_t)a * b) << 1);
+}
+
+/* Rounded and saturated upper word, __builtin_sacr */
+inline static int16_t Acc_StoreRound(int64_t acc)
+{
+    acc = (acc + 0x8000) >> 16;
+    if (acc > INT16_MAX)
+    {
+        return INT16_MAX;
+    }
+    else if (acc < INT16_MIN)
+    {
+        return INT16_MIN;
+    }
+    return (int16_t)acc;
+}
+
+uint16_t MC_CalculateSineCosine_Assembly_Ram(int16_t angle,
+                                             MC_SINCOS_T *pSinCos)
+{
+    uint16_t index,remainder,i;
+    uint32_t result;
+    int16_t y0,y1;
+
+    if (sineTableReady == 0)
+    {
+        for (i = 0; i < MC_SINE_TABLE_SIZE; i++)
+        {
+            sineTable[i] = (int16_t)lround(32767.0 * 
+                                    sin(2.0 * M_PI * i / MC_SINE_TABLE_SIZE));
+        }
+        sineTableReady = 1;
+    }
+    /* Linear interpolation between the table entries */
+    result = (uint32_t)128 * (uint16_t)angle;
+    index = result >> 16;
+    remainder = (uint16_t)result;
+
+    y0 = sineTable[index];
+    y1 = sineTable[(index + 1) % MC_SINE_TABLE_SIZE];
+    pSinCos->sin = y0 + (int16_t)(((int32_t)remainder * (y1 - y0)) >> 16);
+    index = (index + 32) % MC_SINE_TABLE_SIZE;
+    y0 = sineTable[index];
+    y1 = sineTable[(index + 1) % MC_SINE_TABLE_SIZE];
+    pSinCos->cos = y0 + (int16_t)(((int32_t)remainder * (y1 - y0)) >> 16);
+    return (remainder == 0) ? 1 : 2;
+}
+
+uint16_t MC_TransformParkInverse_Assembly(const MC_DQ_T *pDQ,
+                                          const MC_SINCOS_T *pSinCos,
+                                          MC_ALPHABETA_T *pAlphaBeta)
+{
+    int64_t acc;
+
+    acc = Acc_Multiply(pDQ->d,pSinCos->cos);
+    acc = Acc_Saturate(acc - Acc_Multiply(pDQ->q,pSinCos->sin));
+    pAlphaBeta->alpha = Acc_StoreRound(acc);
+    acc = Acc_Multiply(pDQ->d,pSinCos->sin);
+    acc = Acc_Saturate(acc + Acc_Multiply(pDQ->q,pSinCos->cos));
+    pAlphaBeta->beta = Acc_StoreRound(acc);
+    return 1;
+}
+
+uint16_t MC_TransformClarkeInverseSwappedInput_Assembly(
+                                    const MC_ALPHABETA_T *pAlphaBeta,
+                                    MC_ABC_T *pABC)
+{
+    const int16_t sqrt3By2 = 28378;
+    const int16_t half = 0x4000;
+    int64_t acc;
+
+    pABC->a = pAlphaBeta->beta;
+    acc = -Acc_Multiply(pAlphaBeta->beta,half);
+    acc = Acc_Saturate(acc + Acc_Multiply(pAlphaBeta->alpha,sqrt3By2));
+    pABC->b = Acc_StoreRound(acc);
+    acc = -Acc_Multiply(pAlphaBeta->beta,half);
+    acc = Acc_Saturate(acc - Acc_Multiply(pAlphaBeta->alpha,sqrt3By2));
+    pABC->c = Acc_StoreRound(acc);
+    return 1;
+}
+
+uint16_t MC_CalculateSpaceVectorPhaseShifted_Assembly(const MC_ABC_T *pABC,
+                                            uint16_t iPwmPeriod,
+                                            MC_DUTYCYCLEOUT_T *pDutyCycleOut)
+{
+    int16_t T1,T2,Ta,Tb,Tc;
+    uint16_t *pTa,*pTb,*pTc;
+
+    /* Sector from the signs of the phase voltages, T1 and T2 are the 
+       phase voltages of the sector and the duties are assigned to the 
+       phases as in the library */
+    if (pABC->a >= 0)
+    {
+        if (pABC->b >= 0)
+        {
+            T1 = pABC->a; T2 = pABC->b;
+            pTa = &pDutyCycleOut->dutycycle1;
+            pTb = &pDutyCycleOut->dutycycle2;
+            pTc = &pDutyCycleOut->dutycycle3;
+        }
+        else if (pABC->c >= 0)
+        {
+            T1 = pABC->c; T2 = pABC->a;
+            pTa = &pDutyCycleOut->dutycycle2;
+            pTb = &pDutyCycleOut->dutycycle3;
+            pTc = &pDutyCycleOut->dutycycle1;
+        }
+        else
+        {
+            T1 = -pABC->c; T2 = -pABC->b;
+            pTa = &pDutyCycleOut->dutycycle2;
+            pTb = &pDutyCycleOut->dutycycle1;
+            pTc = &pDutyCycleOut->dutycycle3;
+        }
+    }
+    else
+    {
+        if (pABC->b < 0)
+        {
+            T1 = -pABC->b; T2 = -pABC->a;
+            pTa = &pDutyCycleOut->dutycycle3;
+            pTb = &pDutyCycleOut->dutycycle2;
+            pTc = &pDutyCycleOut->dutycycle1;
+        }
+        else if (pABC->c >= 0)
+        {
+            T1 = pABC->b; T2 = pABC->c;
+            pTa = &pDutyCycleOut->dutycycle3;
+            pTb = &pDutyCycleOut->dutycycle1;
+            pTc = &pDutyCycleOut->dutycycle2;
+        }
+        else
+        {
+            T1 = -pABC->a; T2 = -pABC->c;
+            pTa = &pDutyCycleOut->dutycycle1;
+            pTb = &pDutyCycleOut->dutycycle3;
+            pTc = &pDutyCycleOut->dutycycle2;
+        }
+    }
+    T1 = Acc_StoreRound(Acc_Multiply(iPwmPeriod,T1));
+    T2 = Acc_StoreRound(Acc_Multiply(iPwmPeriod,T2));
+    Tc = (int16_t)(iPwmPeriod - T1 - T2) >> 1;
+    Tb = Tc + T1;
+    Ta = Tb + T2;
+    *pTa = Ta;
+    *pTb = Tb;
+    *pTc = Tc;
+    return 1;
+}
+
+uint16_t MC_TransformClarke_Assembly(const MC_ABC_T *pABC,
+                                     MC_ALPHABETA_T *pAlphaBeta)
+{
+    const int16_t oneBySqrt3 = 18919;
+    int64_t acc;
+
+    pAlphaBeta->alpha = pABC->a;
+    acc = Acc_Multiply(pABC->a,oneBySqrt3);
+    acc = Acc_Saturate(acc + Acc_Multiply(oneBySqrt3,pABC->b));
+    acc = Acc_Saturate(acc + Acc_Multiply(oneBySqrt3,pABC->b));
+    pAlphaBeta->beta = Acc_StoreRound(acc);
+    return 1;
+}
+
+uint16_t MC_TransformPark_Assembly(const MC_ALPHABETA_T *pAlphaBeta,
+                                   const MC_SINCOS_T *pSinCos,
+                                   MC_DQ_T *pDQ)
+{
+    int64_t acc;
+
+    acc = Acc_Multiply(pAlphaBeta->alpha,pSinCos->cos);
+    acc = Acc_Saturate(acc + Acc_Multiply(pAlphaBeta->beta,pSinCos->sin));
+    pDQ->d = Acc_StoreRound(acc);
+    acc = Acc_Multiply(pAlphaBeta->beta,pSinCos->cos);
+    acc = Acc_Saturate(acc - Acc_Multiply(pAlphaBeta->alpha,pSinCos->sin));
+    pDQ->q = Acc_StoreRound(acc);
+    return 1;
+}
+
+uint16_t MC_ControllerPIUpdate_Assembly(int16_t inReference,
+                                        int16_t inMeasure,
+                                        MC_PISTATE_T *pPIState,
+                                        int16_t *pPIParmOutput)
+{
+    int64_t acc;
+    int16_t error,outBuffer,output;
+
+    error = Acc_StoreRound(((int64_t)inReference - inMeasure) << 16);
+
+    /* Kp*error*2^4 plus the integrator */
+    acc = Acc_Saturate(Acc_Multiply(error,pPIState->kp) << 4);
+    acc = Acc_Saturate(acc + pPIState->integrator);
+    outBuffer = Acc_StoreRound(acc);
+    if (outBuffer > pPIState->outMax)
+    {
+        output = pPIState->outMax;
+    }
+    else if (outBuffer < pPIState->outMin)
+    {
+        output = pPIState->outMin;
+    }
+    else
+    {
+        output = outBuffer;
+    }
+    *pPIParmOutput = output;
+
+    /* Integrator with the anti windup of the excess over the limits */
+    acc = Acc_Multiply(error,pPIState->ki);
+    acc = Acc_Saturate(acc - 
+                       Acc_Multiply((int16_t)(outBuffer - output),
+                                    pPIState->kc));
+    acc = Acc_Saturate(acc + pPIState->integrator);
+    pPIState->integrator = (int32_t)acc;
+    return 1;
+}
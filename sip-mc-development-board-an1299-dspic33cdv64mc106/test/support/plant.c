@@ -0,0 +1,160 @@
+/*******************************************************************************
+* Copyright (c) 2017 released Microchip Technology Inc.  All rights reserved.
+*
+* SOFTWARE LICENSE AGREEMENT:
+* 
+* Microchip Technology Incorporated ("Microchip") retains all ownership and
+* intellectual property rights in the code accompanying this message and in all
+* derivatives hereto.  You may use this code, and any derivatives created by
+* any person or entity by or on your behalf, exclusively with Microchip's
+* proprietary products.  Your acceptance and/or use of this code constitutes
+* agreement to the terms and conditions of this notice.
+*
+* CODE ACCOMPANYING THIS MESSAGE IS SUPPLIED BY MICROCHIP "AS IS".  NO
+* WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
+* TO, IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE APPLY TO THIS CODE, ITS INTERACTION WITH MICROCHIP'S
+* PRODUCTS, COMBINATION WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION.
+*
+* YOU ACKNOWLEDGE AND AGREE THAT, IN NO EVENT, SHALL MICROCHIP BE LIABLE,
+* WHETHER IN CONTRACT, WARRANTY, TORT (INCLUDING NEGLIGENCE OR BREACH OF
+* STATUTORY DUTY),STRICT LIABILITY, INDEMNITY, CONTRIBUTION, OR OTHERWISE,
+* FOR ANY INDIRECT, SPECIAL,PUNITIVE, EXEMPLARY, INCIDENTAL OR CONSEQUENTIAL
+* LOSS, DAMAGE, FOR COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE CODE,
+* HOWSOEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE POSSIBILITY OR
+* THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT ALLOWABLE BY LAW,
+* MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY RELATED TO THIS CODE,
+* SHALL NOT EXCEED THE PRICE YOU PAID DIRECTLY TO MICROCHIP SPECIFICALLY TO
+* HAVE THIS CODE DEVELOPED.
+*
+* You agree that you are solely responsible for testing the code and
+* determining its suitability.  Microchip has no obligation to modify, test,
+* certify, or support the code.
+*
+*******************************************************************************/
+/* Motor model of the host tests */
+#include <stdint.h>
+#include <math.h>
+
+#include <xc.h>
+#include "plant.h"
+#include "userparms.h"
+#include "axis.h"
+#include "pwm.h"
+#include "adc.h"
+
+void _ADCInterruptDualShunt(void);
+extern MOTOR_AXIS_T axisA;
+
+/* Integration steps per PWM cycle */
+#define PLANT_STEPS     32
+
+/* Initializes the model at rest with the nominal motor parameters of 
+   userparms.h: Ls/dt*di = qLsDt*di >> 7 at LOOPTIME_SEC, Rs*i = qRs*i >> 11
+   and BEMF = (speed << 14)/qInvKFi. The mechanical parameters are set by 
+   the test */
+void PlantInitialize(PLANT_T *pPlant)
+{
+    pPlant->ls = NORM_LSDTBASE / 128.0 * LOOPTIME_SEC;
+    pPlant->rs = NORM_RS / 2048.0;
+    pPlant->ke = 16384.0 / NORM_INVKFIBASE;
+    pPlant->inertia = 1.0;
+    pPlant->viscous = 0;
+    pPlant->load = 0;
+    pPlant->speedHold = 1;
+    pPlant->ialpha = 0;
+    pPlant->ibeta = 0;
+    pPlant->theta = 0;
+    pPlant->speed = 0;
+    pPlant->valpha = 0;
+    pPlant->vbeta = 0;
+}
+
+/* Advances the model by one PWM cycle of the present PWM frequency, the 
+   applied voltage is constant in the cycle */
+void PlantStep(PLANT_T *pPlant)
+{
+    double dt = 1.0 / pwmTiming.frequency / PLANT_STEPS;
+    double bemf,ealpha,ebeta,id,iq;
+    int k;
+
+    for (k = 0; k < PLANT_STEPS; k++)
+    {
+        bemf = PlantBemf(pPlant);
+        ealpha = -bemf * sin(pPlant->theta);
+        ebeta = bemf * cos(pPlant->theta);
+        pPlant->ialpha += (pPlant->valpha - pPlant->rs * pPlant->ialpha - 
+                           ealpha) * dt / pPlant->ls;
+        pPlant->ibeta += (pPlant->vbeta - pPlant->rs * pPlant->ibeta - 
+                          ebeta) * dt / pPlant->ls;
+        if (pPlant->speedHold == 0)
+        {
+            PlantDqCurrents(pPlant,&id,&iq);
+            pPlant->speed += (iq - pPlant->load - 
+                              pPlant->viscous * pPlant->speed) * dt / 
+                             pPlant->inertia;
+        }
+        pPlant->theta += pPlant->speed * 2 * M_PI / 60 * dt;
+    }
+    pPlant->theta = remainder(pPlant->theta,2 * M_PI);
+}
+
+/* Phase currents a and b */
+void PlantPhaseCurrents(const PLANT_T *pPlant,int16_t *pIa,int16_t *pIb)
+{
+    *pIa = (int16_t)lround(pPlant->ialpha);
+    *pIb = (int16_t)lround(-0.5 * pPlant->ialpha + 
+                           sqrt(3) / 2 * pPlant->ibeta);
+}
+
+/* Currents in the rotor frame */
+void PlantDqCurrents(const PLANT_T *pPlant,double *pId,double *pIq)
+{
+    double c = cos(pPlant->theta),s = sin(pPlant->theta);
+
+    *pId = pPlant->ialpha * c + pPlant->ibeta * s;
+    *pIq = -pPlant->ialpha * s + pPlant->ibeta * c;
+}
+
+/* Electrical angle in the format of thetaElectrical */
+int16_t PlantAngle(const PLANT_T *pPlant)
+{
+    return (int16_t)lround(remainder(pPlant->theta,2 * M_PI) * 32768 / M_PI);
+}
+
+/* BEMF amplitude, on the q axis */
+double PlantBemf(const PLANT_T *pPlant)
+{
+    return pPlant->ke * pPlant->speed;
+}
+
+/* One PWM cycle of the firmware on the model with dual shunt current 
+   sensing: the phase currents are converted at the start of the cycle and
+   the voltage modulated by the ADC interrupt is applied in the next cycle.
+   While the motor is stopped the inverter is off and no current flows */
+void PlantControlCycle(PLANT_T *pPlant)
+{
+    int16_t ia,ib;
+
+    /* The phase current amplifiers are inverting */
+    PlantPhaseCurrents(pPlant,&ia,&ib);
+    ADCBUF0 = (uint16_t)-ia;
+    ADCBUF4 = (uint16_t)-ib;
+    _ADCInterruptDualShunt();
+
+    PlantStep(pPlant);
+    if (axisA.uGF.bits.RunMotor)
+    {
+        pPlant->valpha = (double)axisA.valphabeta.alpha * 
+                                            (1 << VOLTAGE_SCALE_SHIFT);
+        pPlant->vbeta = (double)axisA.valphabeta.beta * 
+                                            (1 << VOLTAGE_SCALE_SHIFT);
+    }
+    else
+    {
+        pPlant->ialpha = 0;
+        pPlant->ibeta = 0;
+        pPlant->valpha = 0;
+        pPlant->vbeta = 0;
+    }
+}
@@ -0,0 +1,83 @@
+/*******************************************************************************
+* Copyright (c) 2017 released Microchip Technology Inc.  All rights reserved.
+*
+* SOFTWARE LICENSE AGREEMENT:
+* 
+* Microchip Technology Incorporated ("Microchip") retains all ownership and
+* intellectual property rights in the code accompanying this message and in all
+* derivatives hereto.  You may use this code, and any derivatives created by
+* any person or entity by or on your behalf, exclusively with Microchip's
+* proprietary products.  Your acceptance and/or use of this code constitutes
+* agreement to the terms and conditions of this notice.
+*
+* CODE ACCOMPANYING THIS MESSAGE IS SUPPLIED BY MICROCHIP "AS IS".  NO
+* WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
+* TO, IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE APPLY TO THIS CODE, ITS INTERACTION WITH MICROCHIP'S
+* PRODUCTS, COMBINATION WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION.
+*
+* YOU ACKNOWLEDGE AND AGREE THAT, IN NO EVENT, SHALL MICROCHIP BE LIABLE,
+* WHETHER IN CONTRACT, WARRANTY, TORT (INCLUDING NEGLIGENCE OR BREACH OF
+* STATUTORY DUTY),STRICT LIABILITY, INDEMNITY, CONTRIBUTION, OR OTHERWISE,
+* FOR ANY INDIRECT, SPECIAL,PUNITIVE, EXEMPLARY, INCIDENTAL OR CONSEQUENTIAL
+* LOSS, DAMAGE, FOR COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE CODE,
+* HOWSOEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE POSSIBILITY OR
+* THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT ALLOWABLE BY LAW,
+* MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY RELATED TO THIS CODE,
+* SHALL NOT EXCEED THE PRICE YOU PAID DIRECTLY TO MICROCHIP SPECIFICALLY TO
+* HAVE THIS CODE DEVELOPED.
+*
+* You agree that you are solely responsible for testing the code and
+* determining its suitability.  Microchip has no obligation to modify, test,
+* certify, or support the code.
+*
+*******************************************************************************/
+/* Motor model of the host tests: a surface PMSM driven by an ideal inverter
+   with the load on the shaft, normalized as the firmware (Estim()). 
+   Currents and voltages are Q15 values at full scale, the speed is the 
+   electrical speed in RPM as estimator.qVelEstim and the torque is given 
+   as the q current producing it. The parameters are at the nominal values
+   of userparms.h after PlantInitialize() and can be changed by the test 
+   to model a mismatch of the firmware parameters */
+#ifndef __PLANT_H
+#define __PLANT_H
+
+#include <stdint.h>
+
+typedef struct
+{
+    /* Inductance, voltage*s per current */
+    double ls;
+    /* Resistance, voltage per current */
+    double rs;
+    /* BEMF per speed */
+    double ke;
+    /* Inertia, current per speed change per s */
+    double inertia;
+    /* Viscous friction, current per speed */
+    double viscous;
+    /* Load torque, current */
+    double load;
+    /* Set when the speed is held by the load (dynamometer, locked rotor) */
+    int speedHold;
+    /* Phase currents alpha-beta */
+    double ialpha;
+    double ibeta;
+    /* Electrical angle, rad */
+    double theta;
+    /* Electrical speed */
+    double speed;
+    /* Voltage applied by the inverter, alpha-beta */
+    double valpha;
+    double vbeta;
+} PLANT_T;
+
+void PlantInitialize(PLANT_T *);
+void PlantStep(PLANT_T *);
+void PlantPhaseCurrents(const PLANT_T *,int16_t *,int16_t *);
+void PlantDqCurrents(const PLANT_T *,double *,double *);
+int16_t PlantAngle(const PLANT_T *);
+double PlantBemf(const PLANT_T *);
+void PlantControlCycle(PLANT_T *);
+
+#endif /* __PLANT_H */
@@ -0,0 +1,476 @@
+/*******************************************************************************
+* Copyright (c) 2017 released Microchip Technology Inc.  All rights reserved.
+*
+* SOFTWARE LICENSE AGREEMENT:
+* 
+* Microchip Technology Incorporated ("Microchip") retains all ownership and
+* intellectual property rights in the code accompanying this message and in all
+* derivatives hereto.  You may use this code, and any derivatives created by
+* any person or entity by or on your behalf, exclusively with Microchip's
+* proprietary products.  Your acceptance and/or use of this code constitutes
+* agreement to the terms and conditions of this notice.
+*
+* CODE ACCOMPANYING THIS MESSAGE IS SUPPLIED BY MICROCHIP "AS IS".  NO
+* WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
+* TO, IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE APPLY TO THIS CODE, ITS INTERACTION WITH MICROCHIP'S
+* PRODUCTS, COMBINATION WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION.
+*
+* YOU ACKNOWLEDGE AND AGREE THAT, IN NO EVENT, SHALL MICROCHIP BE LIABLE,
+* WHETHER IN CONTRACT, WARRANTY, TORT (INCLUDING NEGLIGENCE OR BREACH OF
+* STATUTORY DUTY),STRICT LIABILITY, INDEMNITY, CONTRIBUTION, OR OTHERWISE,
+* FOR ANY INDIRECT, SPECIAL,PUNITIVE, EXEMPLARY, INCIDENTAL OR CONSEQUENTIAL
+* LOSS, DAMAGE, FOR COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE CODE,
+* HOWSOEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE POSSIBILITY OR
+* THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT ALLOWABLE BY LAW,
+* MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY RELATED TO THIS CODE,
+* SHALL NOT EXCEED THE PRICE YOU PAID DIRECTLY TO MICROCHIP SPECIFICALLY TO
+* HAVE THIS CODE DEVELOPED.
+*
+* You agree that you are solely responsible for testing the code and
+* determining its suitability.  Microchip has no obligation to modify, test,
+* certify, or support the code.
+*
+*******************************************************************************/
+/* Device header for the host tests. Every special function register used by
+   the firmware is a 16 bit variable and every bit field structure has the 
+   fields referenced by the firmware, 16 bits wide, so the tests can set the
+   ADC results and read back the PWM registers. registers.c defines the 
+   variables by including this file with XC_REGISTER and XC_BITS defined */
+#ifndef __XC_H
+#define __XC_H
+
+#include <stdint.h>
+
+#ifndef XC_REGISTER
+#define XC_REGISTER(name)           extern volatile uint16_t name;
+#endif
+#ifndef XC_BITS
+#define XC_BITS(name,fields)        typedef struct { fields } name##BITS; \
+                                    extern volatile name##BITS name##bits;
+#endif
+
+XC_REGISTER(ADCBUF0)
+XC_REGISTER(ADCBUF1)
+XC_REGISTER(ADCBUF12)
+XC_REGISTER(ADCBUF15)
+XC_REGISTER(ADCBUF3)
+XC_REGISTER(ADCBUF4)
+XC_REGISTER(ADCBUF7)
+XC_REGISTER(ADCON1H)
+XC_REGISTER(ADCON1L)
+XC_REGISTER(ADCON2H)
+XC_REGISTER(ADCON2L)
+XC_REGISTER(ADCON3H)
+XC_REGISTER(ADCON3L)
+XC_REGISTER(ADCON5H)
+XC_REGISTER(ADCON5L)
+XC_REGISTER(ADEIEH)
+XC_REGISTER(ADEIEL)
+XC_REGISTER(ADEISTATH)
+XC_REGISTER(ADEISTATL)
+XC_REGISTER(ADIEH)
+XC_REGISTER(ADIEL)
+XC_REGISTER(ADMOD0H)
+XC_REGISTER(ADMOD0L)
+XC_REGISTER(ADMOD1L)
+XC_REGISTER(ADSTATH)
+XC_REGISTER(ADSTATL)
+XC_REGISTER(CMBTRIGH)
+XC_REGISTER(CMBTRIGL)
+XC_REGISTER(CNCOND)
+XC_REGISTER(CNEN0D)
+XC_REGISTER(CNEN1D)
+XC_REGISTER(CORCON)
+XC_REGISTER(DAC1CONH)
+XC_REGISTER(DAC1CONL)
+XC_REGISTER(DAC1DATH)
+XC_REGISTER(DAC1DATL)
+XC_REGISTER(DACCTRL1L)
+XC_REGISTER(DACCTRL2H)
+XC_REGISTER(DACCTRL2L)
+XC_REGISTER(FSCL)
+XC_REGISTER(FSMINPER)
+XC_REGISTER(LATC)
+XC_REGISTER(LFSR)
+XC_REGISTER(LOGCONA)
+XC_REGISTER(LOGCONB)
+XC_REGISTER(LOGCONC)
+XC_REGISTER(LOGCOND)
+XC_REGISTER(LOGCONE)
+XC_REGISTER(LOGCONF)
+XC_REGISTER(MDC)
+XC_REGISTER(MPER)
+XC_REGISTER(MPHASE)
+XC_REGISTER(NVMADR)
+XC_REGISTER(NVMADRU)
+XC_REGISTER(NVMCON)
+XC_REGISTER(OSCCON)
+XC_REGISTER(PCLKCON)
+XC_REGISTER(PG1CLPCIH)
+XC_REGISTER(PG1CLPCIL)
+XC_REGISTER(PG1CONH)
+XC_REGISTER(PG1CONL)
+XC_REGISTER(PG1DC)
+XC_REGISTER(PG1DCA)
+XC_REGISTER(PG1DTH)
+XC_REGISTER(PG1DTL)
+XC_REGISTER(PG1EVTH)
+XC_REGISTER(PG1EVTL)
+XC_REGISTER(PG1FFPCIH)
+XC_REGISTER(PG1FFPCIL)
+XC_REGISTER(PG1FPCIH)
+XC_REGISTER(PG1FPCIL)
+XC_REGISTER(PG1IOCONH)
+XC_REGISTER(PG1IOCONL)
+XC_REGISTER(PG1LEBH)
+XC_REGISTER(PG1LEBL)
+XC_REGISTER(PG1PER)
+XC_REGISTER(PG1PHASE)
+XC_REGISTER(PG1SPCIH)
+XC_REGISTER(PG1SPCIL)
+XC_REGISTER(PG1STAT)
+XC_REGISTER(PG1TRIGA)
+XC_REGISTER(PG1TRIGB)
+XC_REGISTER(PG1TRIGC)
+XC_REGISTER(PG2CLPCIH)
+XC_REGISTER(PG2CLPCIL)
+XC_REGISTER(PG2CONH)
+XC_REGISTER(PG2CONL)
+XC_REGISTER(PG2DC)
+XC_REGISTER(PG2DCA)
+XC_REGISTER(PG2DTH)
+XC_REGISTER(PG2DTL)
+XC_REGISTER(PG2EVTH)
+XC_REGISTER(PG2EVTL)
+XC_REGISTER(PG2FFPCIH)
+XC_REGISTER(PG2FFPCIL)
+XC_REGISTER(PG2FPCIH)
+XC_REGISTER(PG2FPCIL)
+XC_REGISTER(PG2IOCONH)
+XC_REGISTER(PG2IOCONL)
+XC_REGISTER(PG2LEBH)
+XC_REGISTER(PG2LEBL)
+XC_REGISTER(PG2PER)
+XC_REGISTER(PG2PHASE)
+XC_REGISTER(PG2SPCIH)
+XC_REGISTER(PG2SPCIL)
+XC_REGISTER(PG2STAT)
+XC_REGISTER(PG2TRIGA)
+XC_REGISTER(PG2TRIGB)
+XC_REGISTER(PG2TRIGC)
+XC_REGISTER(PG3CLPCIH)
+XC_REGISTER(PG3CLPCIL)
+XC_REGISTER(PG3CONH)
+XC_REGISTER(PG3CONL)
+XC_REGISTER(PG3DC)
+XC_REGISTER(PG3DCA)
+XC_REGISTER(PG3DTH)
+XC_REGISTER(PG3DTL)
+XC_REGISTER(PG3EVTH)
+XC_REGISTER(PG3EVTL)
+XC_REGISTER(PG3FFPCIH)
+XC_REGISTER(PG3FFPCIL)
+XC_REGISTER(PG3FPCIH)
+XC_REGISTER(PG3FPCIL)
+XC_REGISTER(PG3IOCONH)
+XC_REGISTER(PG3IOCONL)
+XC_REGISTER(PG3LEBH)
+XC_REGISTER(PG3LEBL)
+XC_REGISTER(PG3PER)
+XC_REGISTER(PG3PHASE)
+XC_REGISTER(PG3SPCIH)
+XC_REGISTER(PG3SPCIL)
+XC_REGISTER(PG3STAT)
+XC_REGISTER(PG3TRIGA)
+XC_REGISTER(PG3TRIGB)
+XC_REGISTER(PG3TRIGC)
+XC_REGISTER(PORTD)
+XC_REGISTER(PWMEVTA)
+XC_REGISTER(PWMEVTB)
+XC_REGISTER(PWMEVTC)
+XC_REGISTER(PWMEVTD)
+XC_REGISTER(PWMEVTE)
+XC_REGISTER(PWMEVTF)
+XC_REGISTER(SLP1CONH)
+XC_REGISTER(SLP1CONL)
+XC_REGISTER(SLP1DAT)
+XC_REGISTER(TBLPAG)
+XC_REGISTER(U1BRG)
+XC_REGISTER(U1BRGH)
+XC_REGISTER(U1INT)
+XC_REGISTER(U1MODE)
+XC_REGISTER(U1MODEH)
+XC_REGISTER(U1P1)
+XC_REGISTER(U1P2)
+XC_REGISTER(U1P3)
+XC_REGISTER(U1P3H)
+XC_REGISTER(U1RXCHK)
+XC_REGISTER(U1RXREG)
+XC_REGISTER(U1SCCON)
+XC_REGISTER(U1SCINT)
+XC_REGISTER(U1STA)
+XC_REGISTER(U1STAH)
+XC_REGISTER(U1TXCHK)
+XC_REGISTER(U1TXREG)
+XC_REGISTER(U2BRG)
+XC_REGISTER(U2BRGH)
+XC_REGISTER(U2INT)
+XC_REGISTER(U2MODE)
+XC_REGISTER(U2MODEH)
+XC_REGISTER(U2P1)
+XC_REGISTER(U2P2)
+XC_REGISTER(U2P3)
+XC_REGISTER(U2P3H)
+XC_REGISTER(U2RXCHK)
+XC_REGISTER(U2RXREG)
+XC_REGISTER(U2SCCON)
+XC_REGISTER(U2SCINT)
+XC_REGISTER(U2STA)
+XC_REGISTER(U2STAH)
+XC_REGISTER(U2TXCHK)
+XC_REGISTER(U2TXREG)
+XC_REGISTER(_ADCAN15IE)
+XC_REGISTER(_ADCAN15IF)
+XC_REGISTER(_ADCAN15IP)
+XC_REGISTER(_ADCAN1IE)
+XC_REGISTER(_ADCAN1IF)
+XC_REGISTER(_ADCAN1IP)
+XC_REGISTER(_CNDIE)
+XC_REGISTER(_CNDIF)
+XC_REGISTER(_CNDIP)
+XC_REGISTER(_CNPUC12)
+XC_REGISTER(_CNPUD1)
+XC_REGISTER(_IE1)
+XC_REGISTER(_IE15)
+XC_REGISTER(_PWM1IF)
+XC_REGISTER(_RP55R)
+XC_REGISTER(_RP60R)
+XC_REGISTER(_U1RXIE)
+XC_REGISTER(_U1RXIF)
+XC_REGISTER(_U1RXR)
+XC_REGISTER(_U1TXIE)
+XC_REGISTER(_U1TXIF)
+XC_REGISTER(_U2RXIE)
+XC_REGISTER(_U2RXIF)
+XC_REGISTER(_U2RXR)
+XC_REGISTER(_U2TXIE)
+XC_REGISTER(_U2TXIF)
+XC_BITS(ADCON1H, unsigned FORM:16; unsigned SHRRES:16;)
+XC_BITS(ADCON1L, unsigned ADON:16; unsigned ADSIDL:16;)
+XC_BITS(ADCON2H, unsigned SHRSAMC:16;)
+XC_BITS(ADCON2L, unsigned EIEN:16; unsigned SHRADCS:16;)
+XC_BITS(ADCON3H, unsigned CLKDIV:16; unsigned CLKSEL:16; unsigned SHREN:16;)
+XC_BITS(ADCON3L, unsigned REFSEL:16; unsigned SWCTRG:16;)
+XC_BITS(ADCON5H, unsigned SHRCIE:16; unsigned WARMTIME:16;)
+XC_BITS(ADCON5L, unsigned SHRPWR:16; unsigned SHRRDY:16;)
+XC_BITS(ADMOD0H, unsigned SIGN12:16; unsigned SIGN15:16;)
+XC_BITS(ADMOD0L, \
+    unsigned SIGN0:16; unsigned SIGN1:16; unsigned SIGN4:16; \
+    unsigned SIGN7:16;)
+XC_BITS(ADTRIG0H, unsigned TRGSRC3:16;)
+XC_BITS(ADTRIG0L, unsigned TRGSRC0:16; unsigned TRGSRC1:16;)
+XC_BITS(ADTRIG1H, unsigned TRGSRC7:16;)
+XC_BITS(ADTRIG1L, unsigned TRGSRC4:16;)
+XC_BITS(ADTRIG3H, unsigned TRGSRC15:16;)
+XC_BITS(ADTRIG3L, unsigned TRGSRC12:16;)
+XC_BITS(AMPCON1H, \
+    unsigned NCHDIS1:16; unsigned NCHDIS2:16; unsigned NCHDIS3:16;)
+XC_BITS(AMPCON1L, \
+    unsigned AMPEN1:16; unsigned AMPEN2:16; unsigned AMPEN3:16; \
+    unsigned AMPON:16;)
+XC_BITS(ANSELA, \
+    unsigned ANSELA0:16; unsigned ANSELA1:16; unsigned ANSELA2:16; \
+    unsigned ANSELA3:16; unsigned ANSELA4:16;)
+XC_BITS(ANSELB, unsigned ANSELB2:16; unsigned ANSELB3:16; unsigned ANSELB4:16;)
+XC_BITS(ANSELC, \
+    unsigned ANSELC0:16; unsigned ANSELC1:16; unsigned ANSELC2:16; \
+    unsigned ANSELC3:16;)
+XC_BITS(APLLDIV, unsigned VCODIV:16;)
+XC_BITS(CLKDIV, unsigned DOZEN:16; unsigned FRCDIV:16; unsigned PLLPRE:16;)
+XC_BITS(CNCOND, unsigned CNSTYLE:16; unsigned ON:16;)
+XC_BITS(CNEN0D, unsigned CNEN0D1:16;)
+XC_BITS(CNEN1D, unsigned CNEN1D1:16;)
+XC_BITS(CNFD, unsigned CNFD1:16;)
+XC_BITS(CORCON, unsigned SATA:16;)
+XC_BITS(DAC1CONH, unsigned TMCB:16;)
+XC_BITS(DAC1CONL, \
+    unsigned CBE:16; unsigned CMPPOL:16; unsigned CMPSTAT:16; \
+    unsigned DACEN:16; unsigned DACOEN:16; unsigned FLTREN:16; \
+    unsigned HYSPOL:16; unsigned HYSSEL:16; unsigned INSEL:16; \
+    unsigned IRQM:16;)
+XC_BITS(DACCTRL1L, \
+    unsigned CLKDIV:16; unsigned CLKSEL:16; unsigned DACON:16; \
+    unsigned DACSIDL:16; unsigned FCLKDIV:16;)
+XC_BITS(DACCTRL2H, unsigned SSTIME:16;)
+XC_BITS(DACCTRL2L, unsigned TMODTIME:16;)
+XC_BITS(IEC4, unsigned PWM1IE:16;)
+XC_BITS(IFS4, unsigned PWM1IF:16;)
+XC_BITS(IPC16, unsigned PWM1IP:16;)
+XC_BITS(LATB, unsigned LATB1:16;)
+XC_BITS(LATC, unsigned LATC13:16; unsigned LATC6:16;)
+XC_BITS(NVMCON, unsigned WR:16;)
+XC_BITS(OSCCON, unsigned LOCK:16; unsigned OSWEN:16;)
+XC_BITS(PCLKCON, unsigned DIVSEL:16; unsigned LOCK:16; unsigned MCLKSEL:16;)
+XC_BITS(PG1CONH, \
+    unsigned MDCSEL:16; unsigned MPERSEL:16; unsigned MPHSEL:16; \
+    unsigned MSTEN:16; unsigned SOCS:16; unsigned TRGMOD:16; \
+    unsigned UPDMOD:16;)
+XC_BITS(PG1CONL, \
+    unsigned CLKSEL:16; unsigned MODSEL:16; unsigned ON:16; \
+    unsigned TRGCNT:16;)
+XC_BITS(PG1EVTH, \
+    unsigned ADTR1OFS:16; unsigned ADTR2EN1:16; unsigned ADTR2EN2:16; \
+    unsigned ADTR2EN3:16; unsigned CLIEN:16; unsigned FFIEN:16; \
+    unsigned FLTIEN:16; unsigned IEVTSEL:16; unsigned SIEN:16;)
+XC_BITS(PG1EVTL, \
+    unsigned ADTR1EN1:16; unsigned ADTR1EN2:16; unsigned ADTR1EN3:16; \
+    unsigned ADTR1PS:16; unsigned PGTRGSEL:16; unsigned UPDTRG:16;)
+XC_BITS(PG1FPCIH, \
+    unsigned ACP:16; unsigned BPEN:16; unsigned BPSEL:16; unsigned PCIGT:16; \
+    unsigned TQPS:16; unsigned TQSS:16;)
+XC_BITS(PG1FPCIL, \
+    unsigned AQPS:16; unsigned AQSS:16; unsigned PPS:16; unsigned PSS:16; \
+    unsigned PSYNC:16; unsigned SWTERM:16; unsigned TERM:16; \
+    unsigned TSYNCDIS:16;)
+XC_BITS(PG1IOCONH, \
+    unsigned CAPSRC:16; unsigned DTCMPSEL:16; unsigned PENH:16; \
+    unsigned PENL:16; unsigned PMOD:16; unsigned POLH:16; unsigned POLL:16;)
+XC_BITS(PG1IOCONL, \
+    unsigned CLDAT:16; unsigned CLMOD:16; unsigned DBDAT:16; \
+    unsigned FFDAT:16; unsigned FLTDAT:16; unsigned OSYNC:16; \
+    unsigned OVRDAT:16; unsigned OVRENH:16; unsigned OVRENL:16; \
+    unsigned SWAP:16;)
+XC_BITS(PG1STAT, unsigned CAHALF:16;)
+XC_BITS(PG2CONH, \
+    unsigned MDCSEL:16; unsigned MPERSEL:16; unsigned MPHSEL:16; \
+    unsigned MSTEN:16; unsigned SOCS:16; unsigned TRGMOD:16; \
+    unsigned UPDMOD:16;)
+XC_BITS(PG2CONL, \
+    unsigned CLKSEL:16; unsigned MODSEL:16; unsigned ON:16; \
+    unsigned TRGCNT:16;)
+XC_BITS(PG2EVTH, \
+    unsigned ADTR1OFS:16; unsigned ADTR2EN1:16; unsigned ADTR2EN2:16; \
+    unsigned ADTR2EN3:16; unsigned CLIEN:16; unsigned FFIEN:16; \
+    unsigned FLTIEN:16; unsigned IEVTSEL:16; unsigned SIEN:16;)
+XC_BITS(PG2EVTL, \
+    unsigned ADTR1EN1:16; unsigned ADTR1EN2:16; unsigned ADTR1EN3:16; \
+    unsigned ADTR1PS:16; unsigned PGTRGSEL:16; unsigned UPDTRG:16;)
+XC_BITS(PG2FPCIH, \
+    unsigned ACP:16; unsigned BPEN:16; unsigned BPSEL:16; unsigned PCIGT:16; \
+    unsigned TQPS:16; unsigned TQSS:16;)
+XC_BITS(PG2FPCIL, \
+    unsigned AQPS:16; unsigned AQSS:16; unsigned PPS:16; unsigned PSS:16; \
+    unsigned PSYNC:16; unsigned SWTERM:16; unsigned TERM:16; \
+    unsigned TSYNCDIS:16;)
+XC_BITS(PG2IOCONH, \
+    unsigned CAPSRC:16; unsigned DTCMPSEL:16; unsigned PENH:16; \
+    unsigned PENL:16; unsigned PMOD:16; unsigned POLH:16; unsigned POLL:16;)
+XC_BITS(PG2IOCONL, \
+    unsigned CLDAT:16; unsigned CLMOD:16; unsigned DBDAT:16; \
+    unsigned FFDAT:16; unsigned FLTDAT:16; unsigned OSYNC:16; \
+    unsigned OVRDAT:16; unsigned OVRENH:16; unsigned OVRENL:16; \
+    unsigned SWAP:16;)
+XC_BITS(PG3CONH, \
+    unsigned MDCSEL:16; unsigned MPERSEL:16; unsigned MPHSEL:16; \
+    unsigned MSTEN:16; unsigned SOCS:16; unsigned TRGMOD:16; \
+    unsigned UPDMOD:16;)
+XC_BITS(PG3CONL, \
+    unsigned CLKSEL:16; unsigned MODSEL:16; unsigned ON:16; \
+    unsigned TRGCNT:16;)
+XC_BITS(PG3EVTH, \
+    unsigned ADTR1OFS:16; unsigned ADTR2EN1:16; unsigned ADTR2EN2:16; \
+    unsigned ADTR2EN3:16; unsigned CLIEN:16; unsigned FFIEN:16; \
+    unsigned FLTIEN:16; unsigned IEVTSEL:16; unsigned SIEN:16;)
+XC_BITS(PG3EVTL, \
+    unsigned ADTR1EN1:16; unsigned ADTR1EN2:16; unsigned ADTR1EN3:16; \
+    unsigned ADTR1PS:16; unsigned PGTRGSEL:16; unsigned UPDTRG:16;)
+XC_BITS(PG3FPCIH, \
+    unsigned ACP:16; unsigned BPEN:16; unsigned BPSEL:16; unsigned PCIGT:16; \
+    unsigned TQPS:16; unsigned TQSS:16;)
+XC_BITS(PG3FPCIL, \
+    unsigned AQPS:16; unsigned AQSS:16; unsigned PPS:16; unsigned PSS:16; \
+    unsigned PSYNC:16; unsigned SWTERM:16; unsigned TERM:16; \
+    unsigned TSYNCDIS:16;)
+XC_BITS(PG3IOCONH, \
+    unsigned CAPSRC:16; unsigned DTCMPSEL:16; unsigned PENH:16; \
+    unsigned PENL:16; unsigned PMOD:16; unsigned POLH:16; unsigned POLL:16;)
+XC_BITS(PG3IOCONL, \
+    unsigned CLDAT:16; unsigned CLMOD:16; unsigned DBDAT:16; \
+    unsigned FFDAT:16; unsigned FLTDAT:16; unsigned OSYNC:16; \
+    unsigned OVRDAT:16; unsigned OVRENH:16; unsigned OVRENL:16; \
+    unsigned SWAP:16;)
+XC_BITS(PLLDIV, unsigned POST1DIV:16; unsigned POST2DIV:16; unsigned VCODIV:16;)
+XC_BITS(PLLFBD, unsigned PLLFBDIV:16;)
+XC_BITS(PORTD, unsigned RD13:16; unsigned RD8:16;)
+XC_BITS(REFOCONH, unsigned RODIV:16;)
+XC_BITS(REFOCONL, \
+    unsigned ROACTIVE:16; unsigned ROEN:16; unsigned ROOUT:16; \
+    unsigned ROSEL:16; unsigned ROSIDL:16; unsigned ROSLP:16;)
+XC_BITS(SLP1CONH, \
+    unsigned HME:16; unsigned PSE:16; unsigned SLOPEN:16; unsigned TWME:16;)
+XC_BITS(SLP1CONL, \
+    unsigned HCFSEL:16; unsigned SLPSTOPA:16; unsigned SLPSTOPB:16; \
+    unsigned SLPSTRT:16;)
+XC_BITS(TRISA, \
+    unsigned TRISA0:16; unsigned TRISA1:16; unsigned TRISA2:16; \
+    unsigned TRISA3:16; unsigned TRISA4:16;)
+XC_BITS(TRISB, \
+    unsigned TRISB1:16; unsigned TRISB10:16; unsigned TRISB11:16; \
+    unsigned TRISB12:16; unsigned TRISB13:16; unsigned TRISB14:16; \
+    unsigned TRISB15:16; unsigned TRISB2:16; unsigned TRISB3:16; \
+    unsigned TRISB4:16;)
+XC_BITS(TRISC, \
+    unsigned TRISC0:16; unsigned TRISC1:16; unsigned TRISC13:16; \
+    unsigned TRISC2:16; unsigned TRISC3:16; unsigned TRISC6:16;)
+XC_BITS(TRISD, unsigned TRISD1:16; unsigned TRISD13:16; unsigned TRISD8:16;)
+XC_BITS(U1INT, unsigned ABDIE:16; unsigned ABDIF:16; unsigned WUIF:16;)
+XC_BITS(U1MODE, \
+    unsigned ABAUD:16; unsigned BRGH:16; unsigned BRKOVR:16; unsigned MOD:16; \
+    unsigned RXBIMD:16; unsigned UARTEN:16; unsigned URXEN:16; \
+    unsigned USIDL:16; unsigned UTXBRK:16; unsigned UTXEN:16; \
+    unsigned WAKE:16;)
+XC_BITS(U1MODEH, \
+    unsigned ACTIVE:16; unsigned BCLKSEL:16; unsigned C0EN:16; \
+    unsigned FLO:16; unsigned HALFDPLX:16; unsigned RUNOVF:16; \
+    unsigned SLPEN:16; unsigned STSEL:16; unsigned URXINV:16; \
+    unsigned UTXINV:16;)
+XC_BITS(U1RXREG, unsigned RXREG:16;)
+XC_BITS(U1STA, \
+    unsigned ABDOVE:16; unsigned ABDOVF:16; unsigned CERIE:16; \
+    unsigned CERIF:16; unsigned FERIE:16; unsigned FERR:16; \
+    unsigned OERIE:16; unsigned OERR:16; unsigned PERIE:16; unsigned PERR:16; \
+    unsigned RXBKIE:16; unsigned RXBKIF:16; unsigned TRMT:16; \
+    unsigned TXCIE:16; unsigned TXCIF:16; unsigned TXMTIE:16;)
+XC_BITS(U1STAH, \
+    unsigned RIDLE:16; unsigned STPMD:16; unsigned TXWRE:16; \
+    unsigned URXBE:16; unsigned URXBF:16; unsigned URXISEL:16; \
+    unsigned UTXBE:16; unsigned UTXBF:16; unsigned UTXISEL:16; \
+    unsigned XON:16;)
+XC_BITS(U1TXREG, unsigned LAST:16; unsigned TXREG:16;)
+XC_BITS(U2INT, unsigned ABDIE:16; unsigned ABDIF:16; unsigned WUIF:16;)
+XC_BITS(U2MODE, \
+    unsigned ABAUD:16; unsigned BRGH:16; unsigned BRKOVR:16; unsigned MOD:16; \
+    unsigned RXBIMD:16; unsigned UARTEN:16; unsigned URXEN:16; \
+    unsigned USIDL:16; unsigned UTXBRK:16; unsigned UTXEN:16; \
+    unsigned WAKE:16;)
+XC_BITS(U2MODEH, \
+    unsigned ACTIVE:16; unsigned BCLKSEL:16; unsigned C0EN:16; \
+    unsigned FLO:16; unsigned HALFDPLX:16; unsigned RUNOVF:16; \
+    unsigned SLPEN:16; unsigned STSEL:16; unsigned URXINV:16; \
+    unsigned UTXINV:16;)
+XC_BITS(U2RXREG, unsigned RXREG:16;)
+XC_BITS(U2STA, \
+    unsigned ABDOVE:16; unsigned ABDOVF:16; unsigned CERIE:16; \
+    unsigned CERIF:16; unsigned FERIE:16; unsigned FERR:16; \
+    unsigned OERIE:16; unsigned OERR:16; unsigned PERIE:16; unsigned PERR:16; \
+    unsigned RXBKIE:16; unsigned RXBKIF:16; unsigned TRMT:16; \
+    unsigned TXCIE:16; unsigned TXCIF:16; unsigned TXMTIE:16;)
+XC_BITS(U2STAH, \
+    unsigned RIDLE:16; unsigned STPMD:16; unsigned TXWRE:16; \
+    unsigned URXBE:16; unsigned URXBF:16; unsigned URXISEL:16; \
+    unsigned UTXBE:16; unsigned UTXBF:16; unsigned UTXISEL:16; \
+    unsigned XON:16;)
+XC_BITS(U2TXREG, unsigned LAST:16; unsigned TXREG:16;)
+
+#endif /* __XC_H */
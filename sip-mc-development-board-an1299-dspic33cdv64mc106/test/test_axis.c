@@ -0,0 +1,148 @@
+/*******************************************************************************
+* Copyright (c) 2017 released Microchip Technology Inc.  All rights reserved.
+*
+* SOFTWARE LICENSE AGREEMENT:
+* 
+* Microchip Technology Incorporated ("Microchip") retains all ownership and
+* intellectual property rights in the code accompanying this message and in all
+* derivatives hereto.  You may use this code, and any derivatives created by
+* any person or entity by or on your behalf, exclusively with Microchip's
+* proprietary products.  Your acceptance and/or use of this code constitutes
+* agreement to the terms and conditions of this notice.
+*
+* CODE ACCOMPANYING THIS MESSAGE IS SUPPLIED BY MICROCHIP "AS IS".  NO
+* WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
+* TO, IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE APPLY TO THIS CODE, ITS INTERACTION WITH MICROCHIP'S
+* PRODUCTS, COMBINATION WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION.
+*
+* YOU ACKNOWLEDGE AND AGREE THAT, IN NO EVENT, SHALL MICROCHIP BE LIABLE,
+* WHETHER IN CONTRACT, WARRANTY, TORT (INCLUDING NEGLIGENCE OR BREACH OF
+* STATUTORY DUTY),STRICT LIABILITY, INDEMNITY, CONTRIBUTION, OR OTHERWISE,
+* FOR ANY INDIRECT, SPECIAL,PUNITIVE, EXEMPLARY, INCIDENTAL OR CONSEQUENTIAL
+* LOSS, DAMAGE, FOR COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE CODE,
+* HOWSOEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE POSSIBILITY OR
+* THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT ALLOWABLE BY LAW,
+* MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY RELATED TO THIS CODE,
+* SHALL NOT EXCEED THE PRICE YOU PAID DIRECTLY TO MICROCHIP SPECIFICALLY TO
+* HAVE THIS CODE DEVELOPED.
+*
+* You agree that you are solely responsible for testing the code and
+* determining its suitability.  Microchip has no obligation to modify, test,
+* certify, or support the code.
+*
+*******************************************************************************/
+/* Two motor axes with different loop times and motor parameters. The 
+   control state of an axis is initialized and used through the axis it 
+   is passed, so the initialization of the second axis must not change the
+   first one: the current decoupling of each axis has to match its own 
+   loop time and inductance, whichever axis was initialized last */
+#include <stdint.h>
+#include <math.h>
+#include <stdio.h>
+
+#include <xc.h>
+#include "userparms.h"
+#include "axis.h"
+#include "pwm.h"
+#include "check.h"
+
+void InitAxisParameters(MOTOR_AXIS_T *);
+void CalculateVoltageFeedForward(MOTOR_AXIS_T *);
+
+/* Inductance of the second motor relative to the first one */
+#define LS_RATIO            1.5
+/* Deviation of the decoupling voltage, relative and in counts */
+#define VOLTAGE_ERROR_MAX   0.01
+#define VOLTAGE_ERROR_MIN   2
+
+static MOTOR_AXIS_T axis1,axis2;
+
+/* Axis state and the loop time it was initialized with */
+typedef struct
+{
+    const char *name;
+    MOTOR_AXIS_T *pAxis;
+    double loopTime;
+    uint16_t pwmPeriod;
+    int16_t qDeltaT;
+} AXIS_CASE_T;
+
+/* Initializes the axis at the PWM frequency, the inductance is scaled by
+   lsRatio */
+static void Initialize(AXIS_CASE_T *pCase,uint16_t frequency,double lsRatio)
+{
+    MOTOR_AXIS_T *pAxis = pCase->pAxis;
+
+    PWMCalculateTiming(frequency);
+    InitAxisParameters(pAxis);
+    pAxis->motorParm.qLsDtBase = (int16_t)(pAxis->motorParm.qLsDtBase * 
+                                           lsRatio);
+    pAxis->motorParm.qLsDt = pAxis->motorParm.qLsDtBase;
+    pCase->loopTime = 1.0 / pwmTiming.frequency;
+    pCase->pwmPeriod = pAxis->pwmPeriod;
+    pCase->qDeltaT = pAxis->estimator.qDeltaT;
+}
+
+/* Decoupling voltage omega*Ls*i of the axis at speed and current */
+static void CheckDecoupling(const AXIS_CASE_T *pCase,int16_t speed,
+                            int16_t id,int16_t iq)
+{
+    MOTOR_AXIS_T *pAxis = pCase->pAxis;
+    double omegaLs,vd,vq;
+
+    pAxis->estimator.qVelEstim = speed;
+    pAxis->idq.d = id;
+    pAxis->idq.q = iq;
+    CalculateVoltageFeedForward(pAxis);
+
+    /* omega*Ts*Ls/dt, Ls/dt*i is qLsDt*i >> 7 */
+    omegaLs = speed * 2 * M_PI / 60 * pCase->loopTime * 
+              pAxis->motorParm.qLsDt;
+    vd = -omegaLs * iq / 128 / (1 << VOLTAGE_SCALE_SHIFT);
+    vq = omegaLs * id / 128 / (1 << VOLTAGE_SCALE_SHIFT);
+    printf("%s: speed %d, vd %d, vq %d, expected %.1f, %.1f\n",pCase->name,
+           speed,pAxis->vdqFeedForward.d,pAxis->vdqFeedForward.q,vd,vq);
+    CHECK(fabs(pAxis->vdqFeedForward.d - vd) <= 
+          fmax(VOLTAGE_ERROR_MAX * fabs(vd),VOLTAGE_ERROR_MIN),
+          "%s: vd %d, expected %.1f",pCase->name,pAxis->vdqFeedForward.d,vd);
+    CHECK(fabs(pAxis->vdqFeedForward.q - vq) <= 
+          fmax(VOLTAGE_ERROR_MAX * fabs(vq),VOLTAGE_ERROR_MIN),
+          "%s: vq %d, expected %.1f",pCase->name,pAxis->vdqFeedForward.q,vq);
+}
+
+/* The loop time dependent parameters are the ones of the axis */
+static void CheckLoopTime(const AXIS_CASE_T *pCase)
+{
+    CHECK(pCase->pAxis->pwmPeriod == pCase->pwmPeriod,
+          "%s: PWM period %u, initialized %u",pCase->name,
+          pCase->pAxis->pwmPeriod,pCase->pwmPeriod);
+    CHECK(pCase->pAxis->estimator.qDeltaT == pCase->qDeltaT,
+          "%s: estimator delta T %d, initialized %d",pCase->name,
+          pCase->pAxis->estimator.qDeltaT,pCase->qDeltaT);
+}
+
+int main(void)
+{
+    AXIS_CASE_T case1 = {"axis 1",&axis1},case2 = {"axis 2",&axis2};
+
+    /* The second axis is initialized last, then the first one again */
+    Initialize(&case1,PWMFREQUENCY_HZ,1.0);
+    Initialize(&case2,PWMFREQUENCY_MAX_HZ,LS_RATIO);
+    CheckLoopTime(&case1);
+    CheckLoopTime(&case2);
+    CheckDecoupling(&case1,NOMINALSPEED_ELECTR,NORM_CURRENT(-0.5),
+                    NORM_CURRENT(1.0));
+    CheckDecoupling(&case2,NOMINALSPEED_ELECTR,NORM_CURRENT(-0.5),
+                    NORM_CURRENT(1.0));
+
+    Initialize(&case1,PWMFREQUENCY_HZ,1.0);
+    CheckLoopTime(&case1);
+    CheckLoopTime(&case2);
+    CheckDecoupling(&case2,-NOMINALSPEED_ELECTR / 2,NORM_CURRENT(-1.0),
+                    NORM_CURRENT(0.5));
+    CheckDecoupling(&case1,-NOMINALSPEED_ELECTR / 2,NORM_CURRENT(-1.0),
+                    NORM_CURRENT(0.5));
+
+    return CHECK_RESULT("test_axis");
+}
@@ -0,0 +1,431 @@
+/*******************************************************************************
+* Copyright (c) 2017 released Microchip Technology Inc.  All rights reserved.
+*
+* SOFTWARE LICENSE AGREEMENT:
+* 
+* Microchip Technology Incorporated ("Microchip") retains all ownership and
+* intellectual property rights in the code accompanying this message and in all
+* derivatives hereto.  You may use this code, and any derivatives created by
+* any person or entity by or on your behalf, exclusively with Microchip's
+* proprietary products.  Your acceptance and/or use of this code constitutes
+* agreement to the terms and conditions of this notice.
+*
+* CODE ACCOMPANYING THIS MESSAGE IS SUPPLIED BY MICROCHIP "AS IS".  NO
+* WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
+* TO, IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE APPLY TO THIS CODE, ITS INTERACTION WITH MICROCHIP'S
+* PRODUCTS, COMBINATION WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION.
+*
+* YOU ACKNOWLEDGE AND AGREE THAT, IN NO EVENT, SHALL MICROCHIP BE LIABLE,
+* WHETHER IN CONTRACT, WARRANTY, TORT (INCLUDING NEGLIGENCE OR BREACH OF
+* STATUTORY DUTY),STRICT LIABILITY, INDEMNITY, CONTRIBUTION, OR OTHERWISE,
+* FOR ANY INDIRECT, SPECIAL,PUNITIVE, EXEMPLARY, INCIDENTAL OR CONSEQUENTIAL
+* LOSS, DAMAGE, FOR COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE CODE,
+* HOWSOEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE POSSIBILITY OR
+* THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT ALLOWABLE BY LAW,
+* MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY RELATED TO THIS CODE,
+* SHALL NOT EXCEED THE PRICE YOU PAID DIRECTLY TO MICROCHIP SPECIFICALLY TO
+* HAVE THIS CODE DEVELOPED.
+*
+* You agree that you are solely responsible for testing the code and
+* determining its suitability.  Microchip has no obligation to modify, test,
+* certify, or support the code.
+*
+*******************************************************************************/
+/* Current loop benchmark: q current steps on the motor model held at 
+   speeds from standstill to the nominal speed. The estimator is replaced
+   by the model (speed, BEMF and the rotor angle at the sampling instant),
+   the measured currents are transformed and the voltage is modulated as 
+   in AxisControlStep(), and the voltage is applied by the model in the 
+   next PWM cycle. The step response is taken from the measured d-q 
+   currents (idq) the controllers work on. The test is built with the 
+   current PIs only and with CURRENT_DECOUPLING, both with the gains 
+   calculated for CURRCNTR_BANDWIDTH_HZ (CURRCNTR_GAIN_CALCULATION), and 
+   with DEADBEAT_CURRENT_CONTROL. The steps are repeated with the motor 
+   parameters of the model and the estimated BEMF off the values used by
+   the controllers */
+#include <stdint.h>
+#include <math.h>
+#include <stdio.h>
+
+#include "userparms.h"
+#include "axis.h"
+#include "pwm.h"
+#include "plant.h"
+#include "check.h"
+
+void DoControl(MOTOR_AXIS_T *);
+void CalculateModulation(MOTOR_AXIS_T *);
+void ResetParmeters(void);
+extern MOTOR_AXIS_T axisA;
+
+/* q current step */
+#define IQ_STEP             NORM_CURRENT(1.0)
+/* Cycles before the step and cycles recorded after it */
+#define SETTLE_CYCLES       2000
+#define STEP_CYCLES         2000
+/* Band around the reference for the settling time */
+#define SETTLE_BAND         0.02
+/* Steady state error */
+#define ERROR_MAX           0.01
+#if defined(CURRENT_DECOUPLING) || defined(DEADBEAT_CURRENT_CONTROL)
+/* Peak d current from the cross coupling */
+#define ID_PEAK_MAX         0.05
+#endif
+#ifdef DEADBEAT_CURRENT_CONTROL
+/* Settling time in cycles without the voltage limit: the voltage is 
+   applied one cycle after the step and DEADBEAT_GAIN leaves 4% after two
+   cycles */
+#define DEADBEAT_SETTLE_MAX     4
+/* Overshoot with the parameter mismatch */
+#define DEADBEAT_OVERSHOOT_MAX  0.25
+/* Error of the predicted currents: the resistive drop is taken at the 
+   start of the cycle, and the frame turns by omega*Ts in the cycle */
+#define PREDICT_ERROR_MAX       0.03
+/* Settling time with the resistance mismatch, from DEADBEAT_KI */
+#define DEADBEAT_KI_SETTLE_MAX  500
+#endif
+
+typedef struct
+{
+    /* Cycles to reach 90% of the step */
+    int rise;
+    /* Cycles until the q current stays within SETTLE_BAND */
+    int settle;
+    /* Overshoot and peak d current relative to the step */
+    double overshoot;
+    double idPeak;
+    /* Error at the end relative to the step */
+    double iqError;
+    double idError;
+    /* Peak error of the currents predicted by the deadbeat controller */
+    double predictError;
+    /* Cycles with the deadbeat voltage reduced to the voltage limit */
+    int limited;
+} STEP_RESULT_T;
+
+/* Parameter mismatch, model over controller */
+typedef struct
+{
+    const char *name;
+    double ls;
+    double rs;
+    double bemf;
+} MISMATCH_T;
+
+/* Speeds of the benchmark */
+static const int16_t speeds[] = 
+{
+    0, ENDSPEED_ELECTR, NOMINALSPEED_ELECTR/2, NOMINALSPEED_ELECTR, 
+    -NOMINALSPEED_ELECTR
+};
+#define SPEED_COUNT     (sizeof(speeds)/sizeof(speeds[0]))
+
+/* Mismatch cases, at MISMATCH_SPEED */
+static const MISMATCH_T mismatches[] = 
+{
+    {"Ls x0.6",     0.6,    1.0,    1.0},
+    {"Ls x0.8",     0.8,    1.0,    1.0},
+    {"Ls x1.25",    1.25,   1.0,    1.0},
+    {"Ls x1.5",     1.5,    1.0,    1.0},
+    {"Rs x0.5",     1.0,    0.5,    1.0},
+    {"Rs x1.5",     1.0,    1.5,    1.0},
+    {"BEMF x0.9",   1.0,    1.0,    0.9},
+    {"BEMF x1.1",   1.0,    1.0,    1.1}
+};
+#define MISMATCH_COUNT  (sizeof(mismatches)/sizeof(mismatches[0]))
+#define MISMATCH_SPEED  (NOMINALSPEED_ELECTR/2)
+
+#ifdef DEADBEAT_CURRENT_CONTROL
+/* Deadbeat gains and inductance mismatch of the gain comparison */
+static const int16_t gains[] = {Q15(0.6), DEADBEAT_GAIN, Q15(0.99)};
+#define GAIN_COUNT      (sizeof(gains)/sizeof(gains[0]))
+static const double gainLs[] = {0.6, 1.0, 1.5};
+#define GAIN_LS_COUNT   (sizeof(gainLs)/sizeof(gainLs[0]))
+#endif
+
+#if defined(DEADBEAT_CURRENT_CONTROL)
+#define TEST_NAME       "test_current_deadbeat"
+#elif defined(CURRENT_DECOUPLING)
+#define TEST_NAME       "test_current_decoupling"
+#else
+#define TEST_NAME       "test_current_pi"
+#endif
+
+/* Estimated BEMF over the BEMF of the model */
+static double bemfEstimate = 1.0;
+
+/* Prints a line of the benchmark */
+static void PrintResult(const char *name,const STEP_RESULT_T *pResult)
+{
+    printf("%-10s %5d %7d %9.1f%% %7.1f%%",name,pResult->rise,
+           pResult->settle,100 * pResult->overshoot,100 * pResult->idPeak);
+#ifdef DEADBEAT_CURRENT_CONTROL
+    printf(" %10.1f%% %7d",100 * pResult->predictError,pResult->limited);
+#endif
+    printf("\n");
+}
+
+/* One control cycle with the estimator replaced by the model */
+static void ControlCycle(PLANT_T *pPlant)
+{
+    MOTOR_AXIS_T *pAxis = &axisA;
+
+    PlantPhaseCurrents(pPlant,&pAxis->iabc.a,&pAxis->iabc.b);
+    MC_TransformClarke_Assembly(&pAxis->iabc,&pAxis->ialphabeta);
+    MC_TransformPark_Assembly(&pAxis->ialphabeta,&pAxis->sincosTheta,
+                              &pAxis->idq);
+    pAxis->estimator.qVelEstim = (int16_t)lround(pPlant->speed);
+    pAxis->estimator.qEsdf = 0;
+    pAxis->estimator.qEsqf = (int16_t)lround(PlantBemf(pPlant) * 
+                                             bemfEstimate / 2);
+    /* The q current reference (qVelRef in torque mode) is held */
+    pAxis->ctrlParm.speedRampCount = 0;
+    DoControl(pAxis);
+    pAxis->thetaElectrical = PlantAngle(pPlant);
+    CalculateModulation(pAxis);
+
+    /* The voltage calculated in this cycle is applied in the next one */
+    PlantStep(pPlant);
+    pPlant->valpha = (double)pAxis->valphabeta.alpha * 
+                                            (1 << VOLTAGE_SCALE_SHIFT);
+    pPlant->vbeta = (double)pAxis->valphabeta.beta * 
+                                            (1 << VOLTAGE_SCALE_SHIFT);
+}
+
+/* Starts the current control in steady state at the speed of the model,
+   with the BEMF applied and zero current */
+static void StartControl(PLANT_T *pPlant)
+{
+    MOTOR_AXIS_T *pAxis = &axisA;
+    double bemf = PlantBemf(pPlant);
+
+    ResetParmeters();
+    pAxis->uGF.bits.RunMotor = 1;
+    pAxis->uGF.bits.OpenLoop = 0;
+    pAxis->uGF.bits.ChangeMode = 0;
+    pAxis->ctrlParm.qVelRef = 0;
+    pAxis->vdq.d = 0;
+    pAxis->vdq.q = (int16_t)lround(bemf / (1 << VOLTAGE_SCALE_SHIFT));
+#ifdef DEADBEAT_CURRENT_CONTROL
+    DeadbeatInitialize(&pAxis->deadbeatParm,&pAxis->vdq);
+#elif !defined(CURRENT_DECOUPLING)
+    pAxis->piInputIq.piState.integrator = (int32_t)pAxis->vdq.q << 16;
+#endif
+    pAxis->thetaElectrical = PlantAngle(pPlant);
+    CalculateModulation(pAxis);
+    pPlant->valpha = -bemf * sin(pPlant->theta);
+    pPlant->vbeta = bemf * cos(pPlant->theta);
+}
+
+/* q current step at the speed held by the model, after StartControl() */
+static void CurrentStep(PLANT_T *pPlant,int16_t step,STEP_RESULT_T *pResult)
+{
+    double id = 0,iq = 0;
+    int k;
+#ifdef DEADBEAT_CURRENT_CONTROL
+    MC_DQ_T idqPredict;
+#endif
+
+    for (k = 0; k < SETTLE_CYCLES; k++)
+    {
+        ControlCycle(pPlant);
+    }
+    axisA.ctrlParm.qVelRef = step;
+    pResult->rise = -1;
+    pResult->settle = 0;
+    pResult->overshoot = 0;
+    pResult->idPeak = 0;
+    pResult->predictError = 0;
+    pResult->limited = 0;
+    for (k = 1; k <= STEP_CYCLES; k++)
+    {
+#ifdef DEADBEAT_CURRENT_CONTROL
+        idqPredict = axisA.deadbeatParm.idqPredict;
+#endif
+        ControlCycle(pPlant);
+#ifdef DEADBEAT_CURRENT_CONTROL
+        pResult->predictError = fmax(pResult->predictError,
+                    fmax(fabs(axisA.idq.d - idqPredict.d),
+                         fabs(axisA.idq.q - idqPredict.q)) / step);
+        if (axisA.vdq.q != axisA.deadbeatParm.vdqOut.q)
+        {
+            pResult->limited++;
+        }
+#endif
+        iq = (double)axisA.idq.q / step;
+        id = (double)axisA.idq.d / step;
+        if ((pResult->rise < 0) && (iq >= 0.9))
+        {
+            pResult->rise = k;
+        }
+        if (fabs(iq - 1) > SETTLE_BAND)
+        {
+            pResult->settle = k;
+        }
+        pResult->overshoot = fmax(pResult->overshoot,iq - 1);
+        pResult->idPeak = fmax(pResult->idPeak,fabs(id));
+    }
+    pResult->iqError = iq - 1;
+    pResult->idError = id;
+}
+
+int main(void)
+{
+    PLANT_T plant;
+    STEP_RESULT_T result[SPEED_COUNT],mismatchResult;
+    char name[16];
+    unsigned int i;
+#ifdef DEADBEAT_CURRENT_CONTROL
+    STEP_RESULT_T gainResult[GAIN_COUNT][GAIN_LS_COUNT];
+    int gainSettleMax[GAIN_COUNT];
+    unsigned int j;
+#endif
+
+    axisA.ctrlParm.currentSensing = CURRENT_SENSING_DEFAULT;
+    axisA.ctrlParm.currentSensingRequest = CURRENT_SENSING_DEFAULT;
+    PWMCalculateTiming(PWMFREQUENCY_HZ);
+    axisA.ctrlParm.pwmFrequencyRequest = pwmTiming.frequency;
+    MCAPP_MeasureFilterInit(&axisA.measureInputs);
+
+#if defined(DEADBEAT_CURRENT_CONTROL)
+    printf("deadbeat current control, step %d\n",IQ_STEP);
+    printf("speed       rise  settle  overshoot  id peak  prediction  limit\n");
+#elif defined(CURRENT_DECOUPLING)
+    printf("current PI with decoupling, step %d\n",IQ_STEP);
+    printf("speed       rise  settle  overshoot  id peak\n");
+#else
+    printf("current PI, step %d\n",IQ_STEP);
+    printf("speed       rise  settle  overshoot  id peak\n");
+#endif
+    for (i = 0; i < SPEED_COUNT; i++)
+    {
+        PlantInitialize(&plant);
+        plant.speed = speeds[i];
+        StartControl(&plant);
+        CurrentStep(&plant,IQ_STEP,&result[i]);
+        snprintf(name,sizeof(name),"%d",speeds[i]);
+        PrintResult(name,&result[i]);
+
+        CHECK(result[i].rise > 0,"speed %d: step not reached",speeds[i]);
+        CHECK((fabs(result[i].iqError) < ERROR_MAX) && 
+              (fabs(result[i].idError) < ERROR_MAX),
+              "speed %d: error %.3f %.3f at the end",speeds[i],
+              result[i].iqError,result[i].idError);
+#if defined(CURRENT_DECOUPLING) || defined(DEADBEAT_CURRENT_CONTROL)
+        /* The response does not depend on the speed */
+        CHECK(result[i].idPeak < ID_PEAK_MAX,"speed %d: d current peak %.3f",
+              speeds[i],result[i].idPeak);
+#endif
+#ifdef CURRENT_DECOUPLING
+        CHECK(result[i].settle <= 2 * result[0].settle,
+              "speed %d: settling time %d, %d at standstill",speeds[i],
+              result[i].settle,result[0].settle);
+#endif
+#ifdef DEADBEAT_CURRENT_CONTROL
+        /* Up to the voltage limit, which depends on the BEMF */
+        CHECK(result[i].settle <= DEADBEAT_SETTLE_MAX + result[i].limited,
+              "speed %d: settling time %d, %d cycles at the voltage limit",
+              speeds[i],result[i].settle,result[i].limited);
+        /* The delay compensation predicts the next measurement */
+        CHECK(result[i].predictError < PREDICT_ERROR_MAX,
+              "speed %d: prediction error %.3f",speeds[i],
+              result[i].predictError);
+#endif
+    }
+#if !defined(CURRENT_DECOUPLING) && !defined(DEADBEAT_CURRENT_CONTROL)
+    /* Without decoupling the d current deviation is proportional to the 
+       speed */
+    CHECK(result[3].idPeak > 2 * result[1].idPeak,
+          "d current peak %.3f at nominal speed, %.3f at the end speed",
+          result[3].idPeak,result[1].idPeak);
+#endif
+
+    printf("mismatch at speed %d\n",MISMATCH_SPEED);
+    for (i = 0; i < MISMATCH_COUNT; i++)
+    {
+        PlantInitialize(&plant);
+        plant.speed = MISMATCH_SPEED;
+        plant.ls *= mismatches[i].ls;
+        plant.rs *= mismatches[i].rs;
+        bemfEstimate = 1 / mismatches[i].bemf;
+        StartControl(&plant);
+        CurrentStep(&plant,IQ_STEP,&mismatchResult);
+        PrintResult(mismatches[i].name,&mismatchResult);
+
+        CHECK((mismatchResult.rise > 0) && 
+              (fabs(mismatchResult.iqError) < ERROR_MAX) && 
+              (fabs(mismatchResult.idError) < ERROR_MAX),
+              "%s: error %.3f %.3f at the end",mismatches[i].name,
+              mismatchResult.iqError,mismatchResult.idError);
+#ifdef DEADBEAT_CURRENT_CONTROL
+        CHECK(mismatchResult.overshoot < DEADBEAT_OVERSHOOT_MAX,
+              "%s: overshoot %.3f",mismatches[i].name,
+              mismatchResult.overshoot);
+#endif
+    }
+    bemfEstimate = 1.0;
+
+#ifdef DEADBEAT_CURRENT_CONTROL
+    /* DEADBEAT_GAIN against a lower and a full deadbeat gain, small steps
+       within the voltage limit with the inductance mismatch */
+    printf("gain, step %d at speed %d\n",IQ_STEP/5,MISMATCH_SPEED);
+    for (i = 0; i < GAIN_COUNT; i++)
+    {
+        gainSettleMax[i] = 0;
+        for (j = 0; j < GAIN_LS_COUNT; j++)
+        {
+            PlantInitialize(&plant);
+            plant.speed = MISMATCH_SPEED;
+            plant.ls *= gainLs[j];
+            StartControl(&plant);
+            axisA.deadbeatParm.qGain = gains[i];
+            CurrentStep(&plant,IQ_STEP/5,&gainResult[i][j]);
+            snprintf(name,sizeof(name),"%.2f Ls x%.1f",gains[i] / 32768.0,
+                     gainLs[j]);
+            PrintResult(name,&gainResult[i][j]);
+            gainSettleMax[i] = fmax(gainSettleMax[i],
+                                    gainResult[i][j].settle);
+        }
+    }
+    CHECK(gainResult[1][1].settle < gainResult[0][1].settle,
+          "settling time %d, %d with the lower gain",
+          gainResult[1][1].settle,gainResult[0][1].settle);
+    CHECK((gainResult[1][0].overshoot < gainResult[2][0].overshoot) &&
+          (gainSettleMax[1] < gainSettleMax[2]),
+          "overshoot %.3f, settling time %d, %.3f and %d with the full gain",
+          gainResult[1][0].overshoot,gainSettleMax[1],
+          gainResult[2][0].overshoot,gainSettleMax[2]);
+
+    /* DEADBEAT_KI - steady state error with the resistance mismatch */
+    for (i = 0; i < 2; i++)
+    {
+        PlantInitialize(&plant);
+        plant.speed = MISMATCH_SPEED;
+        plant.rs *= mismatches[5].rs;
+        StartControl(&plant);
+        if (i == 0)
+        {
+            axisA.deadbeatParm.qKi = 0;
+        }
+        CurrentStep(&plant,IQ_STEP,&mismatchResult);
+        printf("%s %s integral: settling time %d, error %.1f%%\n",
+               mismatches[5].name,(i == 0) ? "without" : "with",
+               mismatchResult.settle,100 * mismatchResult.iqError);
+        if (i == 0)
+        {
+            CHECK(fabs(mismatchResult.iqError) > ERROR_MAX,
+                  "%s: error %.3f without the integral",mismatches[5].name,
+                  mismatchResult.iqError);
+        }
+        else
+        {
+            CHECK(mismatchResult.settle < DEADBEAT_KI_SETTLE_MAX,
+                  "%s: settling time %d",mismatches[5].name,
+                  mismatchResult.settle);
+        }
+    }
+#endif
+
+    return CHECK_RESULT(TEST_NAME);
+}
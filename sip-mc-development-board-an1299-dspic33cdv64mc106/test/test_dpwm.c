@@ -0,0 +1,316 @@
+/*******************************************************************************
+* Copyright (c) 2017 released Microchip Technology Inc.  All rights reserved.
+*
+* SOFTWARE LICENSE AGREEMENT:
+* 
+* Microchip Technology Incorporated ("Microchip") retains all ownership and
+* intellectual property rights in the code accompanying this message and in all
+* derivatives hereto.  You may use this code, and any derivatives created by
+* any person or entity by or on your behalf, exclusively with Microchip's
+* proprietary products.  Your acceptance and/or use of this code constitutes
+* agreement to the terms and conditions of this notice.
+*
+* CODE ACCOMPANYING THIS MESSAGE IS SUPPLIED BY MICROCHIP "AS IS".  NO
+* WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
+* TO, IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE APPLY TO THIS CODE, ITS INTERACTION WITH MICROCHIP'S
+* PRODUCTS, COMBINATION WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION.
+*
+* YOU ACKNOWLEDGE AND AGREE THAT, IN NO EVENT, SHALL MICROCHIP BE LIABLE,
+* WHETHER IN CONTRACT, WARRANTY, TORT (INCLUDING NEGLIGENCE OR BREACH OF
+* STATUTORY DUTY),STRICT LIABILITY, INDEMNITY, CONTRIBUTION, OR OTHERWISE,
+* FOR ANY INDIRECT, SPECIAL,PUNITIVE, EXEMPLARY, INCIDENTAL OR CONSEQUENTIAL
+* LOSS, DAMAGE, FOR COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE CODE,
+* HOWSOEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE POSSIBILITY OR
+* THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT ALLOWABLE BY LAW,
+* MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY RELATED TO THIS CODE,
+* SHALL NOT EXCEED THE PRICE YOU PAID DIRECTLY TO MICROCHIP SPECIFICALLY TO
+* HAVE THIS CODE DEVELOPED.
+*
+* You agree that you are solely responsible for testing the code and
+* determining its suitability.  Microchip has no obligation to modify, test,
+* certify, or support the code.
+*
+*******************************************************************************/
+/* Discontinuous PWM of dpwm.c with dual shunt current sensing. The d-q 
+   voltage is modulated over a full turn at modulation indexes above the
+   threshold, at the lowest, default and highest PWM frequency, for every
+   mode. The clamped phase has to sit at 0 or at the PWM period, the line 
+   voltages have to be the ones of the continuous SVM, the clamped phase 
+   and rail have to follow the definition of the mode, and phases a and b,
+   measured in the low side shunts, are only clamped low */
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <xc.h>
+#include "userparms.h"
+#include "general.h"
+#include "dpwm.h"
+#include "pwm.h"
+#include "check.h"
+
+/* Selections closer than this to the boundary of two clamp intervals are
+   not compared, in PWM counts times 3 */
+#define BOUNDARY_MARGIN     6
+
+static const char *modeName[] = {"continuous","DPWM0","DPWM1","DPWM2",
+                                 "DPWMMIN","DPWMMAX"};
+
+/* Phase voltages of vdq at angle, as calculated by CalculateModulation() */
+static void Modulate(int16_t vd,int16_t vq,int16_t angle,MC_ABC_T *pVabc)
+{
+    MC_DQ_T vdq;
+    MC_SINCOS_T sincos;
+    MC_ALPHABETA_T valphabeta;
+
+    vdq.d = vd;
+    vdq.q = vq;
+    MC_CalculateSineCosine_Assembly_Ram(angle,&sincos);
+    MC_TransformParkInverse_Assembly(&vdq,&sincos,&valphabeta);
+    MC_TransformClarkeInverseSwappedInput_Assembly(&valphabeta,pVabc);
+}
+
+/* Clamped phase and rail by the definition of the mode for the positive
+   phase sequence a-b-c: DPWM1 clamps the phase with the highest phase 
+   voltage amplitude, DPWM0 and DPWM2 the phase of the highest line voltage
+   amplitude with the phase it leads or lags. The phase voltages are taken
+   from the continuous SVM duty cycles, the input of the phase shifted SVM 
+   is not the phase voltage. Returns 0 if the phase is too close to the 
+   boundary of the clamp interval */
+static uint16_t ReferenceClamp(uint16_t mode,const uint16_t *pSvmDuty,
+                               uint16_t *pPhase,int16_t *pClamp)
+{
+    int32_t v[3],reference[3],second;
+    uint16_t i;
+
+    /* Phase voltages without zero sequence, times 3 */
+    for (i = 0; i < 3; i++)
+    {
+        v[i] = 2 * (int32_t)pSvmDuty[i] - pSvmDuty[(i + 1) % 3] - 
+               pSvmDuty[(i + 2) % 3];
+    }
+    for (i = 0; i < 3; i++)
+    {
+        switch (mode)
+        {
+            case DPWM_MODE_DPWM0:
+                reference[i] = labs(v[i] - v[(i + 1) % 3]);
+                break;
+            case DPWM_MODE_DPWM1:
+                reference[i] = labs(v[i]);
+                break;
+            case DPWM_MODE_DPWM2:
+                reference[i] = labs(v[i] - v[(i + 2) % 3]);
+                break;
+            case DPWM_MODE_DPWMMIN:
+                reference[i] = -v[i];
+                break;
+            default:
+                reference[i] = v[i];
+                break;
+        }
+    }
+    *pPhase = 0;
+    for (i = 1; i < 3; i++)
+    {
+        if (reference[i] > reference[*pPhase])
+        {
+            *pPhase = i;
+        }
+    }
+    second = reference[(*pPhase + 1) % 3];
+    if (reference[(*pPhase + 2) % 3] > second)
+    {
+        second = reference[(*pPhase + 2) % 3];
+    }
+    switch (mode)
+    {
+        case DPWM_MODE_DPWM0:
+            *pClamp = (v[*pPhase] > v[(*pPhase + 1) % 3]) ? 
+                      DPWM_CLAMP_HIGH : DPWM_CLAMP_LOW;
+            break;
+        case DPWM_MODE_DPWM1:
+            *pClamp = (v[*pPhase] > 0) ? DPWM_CLAMP_HIGH : DPWM_CLAMP_LOW;
+            break;
+        case DPWM_MODE_DPWM2:
+            *pClamp = (v[*pPhase] > v[(*pPhase + 2) % 3]) ? 
+                      DPWM_CLAMP_HIGH : DPWM_CLAMP_LOW;
+            break;
+        case DPWM_MODE_DPWMMIN:
+            *pClamp = DPWM_CLAMP_LOW;
+            break;
+        default:
+            *pClamp = DPWM_CLAMP_HIGH;
+            break;
+    }
+    return (reference[*pPhase] - second) >= BOUNDARY_MARGIN;
+}
+
+/* Modulates vdq at angle with continuous SVM and with the discontinuous
+   mode and compares the duty cycles */
+static void CompareModulation(uint16_t mode,int16_t vq,int16_t angle,
+                              uint16_t period)
+{
+    DPWM_PARM_T dpwm;
+    MC_DQ_T vdq;
+    MC_ABC_T vabc;
+    MC_DUTYCYCLEOUT_T svm,dutycycle;
+    uint16_t duty[3],svmDuty[3],phase,i;
+    int16_t clamp;
+
+    DpwmInitialize(&dpwm);
+    dpwm.mode = mode;
+    vdq.d = 0;
+    vdq.q = vq;
+    DpwmUpdateModulation(&dpwm,&vdq);
+    CHECK(dpwm.active == 1,"%s not active at vq %d",modeName[mode],vq);
+
+    Modulate(0,vq,angle,&vabc);
+    MC_CalculateSpaceVectorPhaseShifted_Assembly(&vabc,period,&svm);
+    dutycycle = svm;
+    DpwmApply(&dpwm,&dutycycle,period);
+
+    duty[0] = dutycycle.dutycycle1;
+    duty[1] = dutycycle.dutycycle2;
+    duty[2] = dutycycle.dutycycle3;
+    svmDuty[0] = svm.dutycycle1;
+    svmDuty[1] = svm.dutycycle2;
+    svmDuty[2] = svm.dutycycle3;
+
+    /* Only the zero sequence changes */
+    for (i = 0; i < 3; i++)
+    {
+        CHECK(duty[i] <= period,"%s duty %u of phase %u above the period "
+              "%u, vq %d angle %d",modeName[mode],duty[i],i,period,vq,angle);
+        CHECK((int16_t)(duty[i] - duty[(i + 1) % 3]) == 
+              (int16_t)(svmDuty[i] - svmDuty[(i + 1) % 3]),
+              "%s line voltage %u-%u %d, SVM %d, vq %d angle %d",
+              modeName[mode],i,(i + 1) % 3,
+              (int16_t)(duty[i] - duty[(i + 1) % 3]),
+              (int16_t)(svmDuty[i] - svmDuty[(i + 1) % 3]),vq,angle);
+    }
+    /* The clamped phase sits on the rail */
+    if (dpwm.clamp == DPWM_CLAMP_HIGH)
+    {
+        CHECK((duty[0] == period) || (duty[1] == period) || 
+              (duty[2] == period),"%s high clamp without a phase at the "
+              "period, vq %d angle %d",modeName[mode],vq,angle);
+    }
+    else
+    {
+        CHECK(dpwm.clamp == DPWM_CLAMP_LOW,"%s not clamped, vq %d angle %d",
+              modeName[mode],vq,angle);
+        CHECK((duty[0] == 0) || (duty[1] == 0) || (duty[2] == 0),
+              "%s low clamp without a phase at 0, vq %d angle %d",
+              modeName[mode],vq,angle);
+    }
+    /* The low side switches of phases a and b are on in every cycle */
+    CHECK((duty[0] < period) && (duty[1] < period),
+          "%s phase a or b clamped high, duties %u %u %u, vq %d angle %d",
+          modeName[mode],duty[0],duty[1],duty[2],vq,angle);
+
+    /* Phase and rail of the mode, a high clamp of phase a or b is replaced
+       by the low clamp of the phase with the lowest voltage */
+    if (ReferenceClamp(mode,svmDuty,&phase,&clamp))
+    {
+        if ((clamp == DPWM_CLAMP_HIGH) && (phase != 2))
+        {
+            clamp = DPWM_CLAMP_LOW;
+            phase = 0;
+            for (i = 1; i < 3; i++)
+            {
+                if (svmDuty[i] < svmDuty[phase])
+                {
+                    phase = i;
+                }
+            }
+        }
+        CHECK((dpwm.clamp == clamp) && 
+              (duty[phase] == ((clamp == DPWM_CLAMP_HIGH) ? period : 0)),
+              "%s clamp %d of phase %u, expected %d, duties %u %u %u, "
+              "vq %d angle %d",modeName[mode],dpwm.clamp,phase,clamp,
+              duty[0],duty[1],duty[2],vq,angle);
+    }
+}
+
+/* Continuous SVM below the threshold, with hysteresis */
+static void CheckThreshold(uint16_t period)
+{
+    DPWM_PARM_T dpwm;
+    MC_DQ_T vdq;
+    MC_ABC_T vabc;
+    MC_DUTYCYCLEOUT_T svm,dutycycle;
+    const int16_t vqOn = Q15(DPWM_MODULATION_ON + 0.01);
+    const int16_t vqHysteresis = 
+                    Q15((DPWM_MODULATION_ON + DPWM_MODULATION_OFF) / 2);
+    const int16_t vqOff = Q15(DPWM_MODULATION_OFF - 0.01);
+    uint16_t mode;
+
+    for (mode = DPWM_MODE_CONTINUOUS; mode <= DPWM_MODE_DPWMMAX; mode++)
+    {
+        DpwmInitialize(&dpwm);
+        dpwm.mode = mode;
+        vdq.d = 0;
+        vdq.q = vqHysteresis;
+        DpwmUpdateModulation(&dpwm,&vdq);
+        CHECK(dpwm.active == 0,"%s active below the on threshold",
+              modeName[mode]);
+        vdq.q = vqOn;
+        DpwmUpdateModulation(&dpwm,&vdq);
+        CHECK(dpwm.active == (mode != DPWM_MODE_CONTINUOUS),
+              "%s active %u above the on threshold",modeName[mode],
+              dpwm.active);
+        vdq.q = vqHysteresis;
+        DpwmUpdateModulation(&dpwm,&vdq);
+        CHECK(dpwm.active == (mode != DPWM_MODE_CONTINUOUS),
+              "%s active %u within the hysteresis",modeName[mode],
+              dpwm.active);
+        vdq.d = vqOff;
+        vdq.q = 0;
+        DpwmUpdateModulation(&dpwm,&vdq);
+        CHECK(dpwm.active == 0,"%s active below the off threshold",
+              modeName[mode]);
+
+        /* The continuous pattern is left unchanged */
+        Modulate(vdq.d,vdq.q,0x1234,&vabc);
+        MC_CalculateSpaceVectorPhaseShifted_Assembly(&vabc,period,&svm);
+        dutycycle = svm;
+        DpwmApply(&dpwm,&dutycycle,period);
+        CHECK((dpwm.clamp == DPWM_CLAMP_NONE) && 
+              (dutycycle.dutycycle1 == svm.dutycycle1) &&
+              (dutycycle.dutycycle2 == svm.dutycycle2) &&
+              (dutycycle.dutycycle3 == svm.dutycycle3),
+              "%s duty cycles changed when not active",modeName[mode]);
+    }
+}
+
+int main(void)
+{
+    const uint16_t frequency[] = {PWMFREQUENCY_MIN_HZ,PWMFREQUENCY_HZ,
+                                  PWMFREQUENCY_MAX_HZ};
+    /* Up to the voltage limit of the current controllers, 
+       sqrt(MAX_VOLTAGE_VECTOR) of pmsm.c */
+    const int16_t magnitude[] = {Q15(DPWM_MODULATION_ON + 0.01),Q15(0.75),
+                                 Q15(0.9),Q15(0.95)};
+    uint16_t f,m,mode,period;
+    int32_t angle;
+
+    for (f = 0; f < sizeof(frequency)/sizeof(frequency[0]); f++)
+    {
+        PWMCalculateTiming(frequency[f]);
+        period = pwmTiming.loopTimeTcy;
+        CheckThreshold(period);
+        for (mode = DPWM_MODE_DPWM0; mode <= DPWM_MODE_DPWMMAX; mode++)
+        {
+            for (m = 0; m < sizeof(magnitude)/sizeof(magnitude[0]); m++)
+            {
+                for (angle = 0; angle < 65536; angle += 7)
+                {
+                    CompareModulation(mode,magnitude[m],(int16_t)angle,
+                                      period);
+                }
+            }
+        }
+    }
+    return CHECK_RESULT("test_dpwm");
+}
@@ -0,0 +1,213 @@
+/*******************************************************************************
+* Copyright (c) 2017 released Microchip Technology Inc.  All rights reserved.
+*
+* SOFTWARE LICENSE AGREEMENT:
+* 
+* Microchip Technology Incorporated ("Microchip") retains all ownership and
+* intellectual property rights in the code accompanying this message and in all
+* derivatives hereto.  You may use this code, and any derivatives created by
+* any person or entity by or on your behalf, exclusively with Microchip's
+* proprietary products.  Your acceptance and/or use of this code constitutes
+* agreement to the terms and conditions of this notice.
+*
+* CODE ACCOMPANYING THIS MESSAGE IS SUPPLIED BY MICROCHIP "AS IS".  NO
+* WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
+* TO, IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE APPLY TO THIS CODE, ITS INTERACTION WITH MICROCHIP'S
+* PRODUCTS, COMBINATION WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION.
+*
+* YOU ACKNOWLEDGE AND AGREE THAT, IN NO EVENT, SHALL MICROCHIP BE LIABLE,
+* WHETHER IN CONTRACT, WARRANTY, TORT (INCLUDING NEGLIGENCE OR BREACH OF
+* STATUTORY DUTY),STRICT LIABILITY, INDEMNITY, CONTRIBUTION, OR OTHERWISE,
+* FOR ANY INDIRECT, SPECIAL,PUNITIVE, EXEMPLARY, INCIDENTAL OR CONSEQUENTIAL
+* LOSS, DAMAGE, FOR COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE CODE,
+* HOWSOEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE POSSIBILITY OR
+* THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT ALLOWABLE BY LAW,
+* MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY RELATED TO THIS CODE,
+* SHALL NOT EXCEED THE PRICE YOU PAID DIRECTLY TO MICROCHIP SPECIFICALLY TO
+* HAVE THIS CODE DEVELOPED.
+*
+* You agree that you are solely responsible for testing the code and
+* determining its suitability.  Microchip has no obligation to modify, test,
+* certify, or support the code.
+*
+*******************************************************************************/
+/* Inertia and friction identification on the motor model with a known 
+   inertia and viscous friction. The firmware runs from the ADC interrupt 
+   with dual shunt current sensing and the estimator: start up in open 
+   loop, closed loop at the end speed, then the identification sequence. 
+   The identified inertia and friction are compared with the model at 
+   20 kHz and 40 kHz, and the speed controller with the calculated gains 
+   has to settle at the speed reference */
+#include <stdint.h>
+#include <math.h>
+#include <stdio.h>
+
+#include <xc.h>
+#include "userparms.h"
+#include "axis.h"
+#include "pwm.h"
+#include "plant.h"
+#include "check.h"
+
+void ApplyConfigurationRequest(void);
+void ResetParmeters(void);
+extern MOTOR_AXIS_T axisA;
+
+/* Inertia of the model, current per speed change per s: MECHID_CURRENT 
+   accelerates through the speed band in about 0.3 s */
+#define PLANT_INERTIA       0.06
+/* High inertia, the acceleration through the speed band takes about 1.9 s,
+   more than 65535 cycles at 40 kHz but within MECHID_TIMEOUT */
+#define PLANT_INERTIA_HIGH  0.24
+/* Viscous friction of the model, current per speed: 20% of MECHID_CURRENT
+   in the middle of the speed band */
+#define PLANT_VISCOUS       (0.2 * MECHID_CURRENT / \
+                             ((MECHID_SPEED_LOW + MECHID_SPEED_HIGH) / 2))
+/* Deviation of the identified inertia and friction */
+#define INERTIA_ERROR_MAX   0.1
+#define FRICTION_ERROR_MAX  0.2
+/* Cycles at 20 kHz of the start up and to settle in closed loop */
+#define START_CYCLES        60000
+/* Cycles at 20 kHz of the speed ripple measurement */
+#define RIPPLE_CYCLES       20000
+/* Speed ripple, peak to peak, with the calculated gains */
+#define RIPPLE_MAX          (ENDSPEED_ELECTR / 100)
+
+/* Runs the firmware on the model for a time given in cycles at 20 kHz */
+static void Run(PLANT_T *pPlant,uint32_t cycles)
+{
+    uint32_t k;
+
+    cycles = cycles * pwmTiming.frequency / PWMFREQUENCY_HZ;
+    for (k = 0; k < cycles; k++)
+    {
+        PlantControlCycle(pPlant);
+    }
+}
+
+/* Runs the firmware on the model, returns the peak to peak speed ripple */
+static double Ripple(PLANT_T *pPlant)
+{
+    double speedMin = pPlant->speed,speedMax = pPlant->speed;
+    uint32_t k,cycles;
+
+    cycles = (uint32_t)RIPPLE_CYCLES * pwmTiming.frequency / PWMFREQUENCY_HZ;
+    for (k = 0; k < cycles; k++)
+    {
+        PlantControlCycle(pPlant);
+        speedMin = fmin(speedMin,pPlant->speed);
+        speedMax = fmax(speedMax,pPlant->speed);
+    }
+    return speedMax - speedMin;
+}
+
+/* Identification at the PWM frequency with the inertia of the model. The 
+   speed controller starts with the gains kp and ki, the default gains when
+   0 */
+static void Identification(uint16_t frequency,double plantInertia,
+                           int16_t kp,int16_t ki)
+{
+    PLANT_T plant;
+    MECHID_PARM_T *pMechId = &axisA.mechIdParm;
+    double inertia,friction,rippleInitial,ripple;
+    uint32_t k,timeout;
+
+    /* Stopped - apply the frequency and measure the current offsets */
+    axisA.ctrlParm.pwmFrequencyRequest = frequency;
+    ApplyConfigurationRequest();
+    if (kp != 0)
+    {
+        axisA.piInputOmega.piState.kp = kp;
+        axisA.piInputOmega.piState.ki = ki;
+    }
+    PlantInitialize(&plant);
+    plant.speedHold = 0;
+    plant.inertia = plantInertia;
+    plant.viscous = PLANT_VISCOUS;
+    Run(&plant,2 * OFFSET_COUNT_MAX);
+
+    /* Start up to closed loop at the end speed (potentiometer at 0) */
+    axisA.uGF.bits.RunMotor = 1;
+    Run(&plant,START_CYCLES);
+    CHECK(axisA.uGF.bits.OpenLoop == 0,"%u Hz: start up failed",frequency);
+    rippleInitial = Ripple(&plant);
+
+    /* The sequence ends within the timeout of its states */
+    pMechId->request = 1;
+    timeout = (uint32_t)(4.0 * MECHID_TIMEOUT * frequency / PWMFREQUENCY_HZ);
+    for (k = 0; k < timeout; k++)
+    {
+        PlantControlCycle(&plant);
+        if ((pMechId->request == 0) && 
+            (pMechId->state == MECHID_STATE_IDLE))
+        {
+            break;
+        }
+    }
+    CHECK(pMechId->valid == 1,"%u Hz: identification not completed",
+          frequency);
+
+    /* Inertia per loop cycle, friction in the middle of the band */
+    inertia = plantInertia * frequency;
+    friction = PLANT_VISCOUS * (MECHID_SPEED_LOW + MECHID_SPEED_HIGH) / 2;
+    printf("%u Hz: band crossing %lu and %lu cycles, inertia %ld (model "
+           "%.0f), friction %d (model %.0f), speed kp %d ki %d\n",frequency,
+           (unsigned long)pMechId->accelTime,
+           (unsigned long)pMechId->decelTime,(long)pMechId->inertia,inertia,
+           pMechId->frictionCurrent,friction,pMechId->qSpeedKp,
+           pMechId->qSpeedKi);
+    CHECK(fabs(pMechId->inertia / inertia - 1) < INERTIA_ERROR_MAX,
+          "%u Hz: inertia %ld, model %.0f",frequency,
+          (long)pMechId->inertia,inertia);
+    CHECK(fabs(pMechId->frictionCurrent / friction - 1) < FRICTION_ERROR_MAX,
+          "%u Hz: friction %d, model %.0f",frequency,
+          pMechId->frictionCurrent,friction);
+    CHECK((axisA.piInputOmega.piState.kp == pMechId->qSpeedKp) &&
+          (axisA.piInputOmega.piState.ki == pMechId->qSpeedKi),
+          "%u Hz: speed controller gains not updated",frequency);
+
+    /* The speed controller with the calculated gains settles back at the 
+       end speed, the default gains are not tuned for the model */
+    Run(&plant,START_CYCLES);
+    ripple = Ripple(&plant);
+    printf("%u Hz: speed ripple %.0f with the initial gains, %.1f with the "
+           "calculated gains\n",frequency,rippleInitial,ripple);
+    CHECK(fabs(plant.speed - ENDSPEED_ELECTR) < RIPPLE_MAX,
+          "%u Hz: speed %.0f after the identification",frequency,
+          plant.speed);
+    CHECK(ripple < RIPPLE_MAX,"%u Hz: speed ripple %.1f",frequency,ripple);
+
+    ResetParmeters();
+}
+
+int main(void)
+{
+    int16_t kp,ki;
+
+    axisA.ctrlParm.currentSensing = CURRENT_SENSING_DUAL_SHUNT;
+    axisA.ctrlParm.currentSensingRequest = CURRENT_SENSING_DUAL_SHUNT;
+    PWMCalculateTiming(PWMFREQUENCY_HZ);
+    axisA.ctrlParm.pwmFrequencyRequest = pwmTiming.frequency;
+    MCAPP_MeasureFilterInit(&axisA.measureInputs);
+#ifdef POWER_METERING
+    MeterInitialize(&axisA.meter);
+#endif
+#ifdef FAULT_SNAPSHOT
+    SnapshotInitialize(&axisA.snapshot);
+#endif
+    ResetParmeters();
+
+    Identification(PWMFREQUENCY_HZ,PLANT_INERTIA,0,0);
+    Identification(PWMFREQUENCY_MAX_HZ,PLANT_INERTIA,0,0);
+    /* The default gains do not hold the speed with the high inertia, the 
+       gains identified with PLANT_INERTIA are scaled to it */
+    kp = axisA.mechIdParm.qSpeedKp * (PLANT_INERTIA_HIGH / PLANT_INERTIA);
+    ki = axisA.mechIdParm.qSpeedKi * (PLANT_INERTIA_HIGH / PLANT_INERTIA);
+    Identification(PWMFREQUENCY_MAX_HZ,PLANT_INERTIA_HIGH,kp,ki);
+    CHECK(axisA.mechIdParm.accelTime > UINT16_MAX,
+          "high inertia: band crossing %lu cycles",
+          (unsigned long)axisA.mechIdParm.accelTime);
+
+    return CHECK_RESULT("test_mechid");
+}
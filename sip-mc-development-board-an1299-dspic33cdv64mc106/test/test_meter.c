@@ -0,0 +1,244 @@
+/*******************************************************************************
+* Copyright (c) 2017 released Microchip Technology Inc.  All rights reserved.
+*
+* SOFTWARE LICENSE AGREEMENT:
+* 
+* Microchip Technology Incorporated ("Microchip") retains all ownership and
+* intellectual property rights in the code accompanying this message and in all
+* derivatives hereto.  You may use this code, and any derivatives created by
+* any person or entity by or on your behalf, exclusively with Microchip's
+* proprietary products.  Your acceptance and/or use of this code constitutes
+* agreement to the terms and conditions of this notice.
+*
+* CODE ACCOMPANYING THIS MESSAGE IS SUPPLIED BY MICROCHIP "AS IS".  NO
+* WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
+* TO, IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE APPLY TO THIS CODE, ITS INTERACTION WITH MICROCHIP'S
+* PRODUCTS, COMBINATION WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION.
+*
+* YOU ACKNOWLEDGE AND AGREE THAT, IN NO EVENT, SHALL MICROCHIP BE LIABLE,
+* WHETHER IN CONTRACT, WARRANTY, TORT (INCLUDING NEGLIGENCE OR BREACH OF
+* STATUTORY DUTY),STRICT LIABILITY, INDEMNITY, CONTRIBUTION, OR OTHERWISE,
+* FOR ANY INDIRECT, SPECIAL,PUNITIVE, EXEMPLARY, INCIDENTAL OR CONSEQUENTIAL
+* LOSS, DAMAGE, FOR COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE CODE,
+* HOWSOEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE POSSIBILITY OR
+* THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT ALLOWABLE BY LAW,
+* MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY RELATED TO THIS CODE,
+* SHALL NOT EXCEED THE PRICE YOU PAID DIRECTLY TO MICROCHIP SPECIFICALLY TO
+* HAVE THIS CODE DEVELOPED.
+*
+* You agree that you are solely responsible for testing the code and
+* determining its suitability.  Microchip has no obligation to modify, test,
+* certify, or support the code.
+*
+*******************************************************************************/
+/* Power and energy metering on the motor model. The firmware runs from the
+   ADC interrupt with dual shunt current sensing and the estimator, started 
+   up to closed loop at the end speed with a load on the shaft. The 
+   electrical, DC input and shaft power of the meter are compared with the 
+   power the model takes from the inverter and converts to torque, every 
+   decimation period, and the energy counters with the integrated power of
+   the model, at 20 kHz and 40 kHz */
+#include <stdint.h>
+#include <math.h>
+#include <stdio.h>
+
+#include <xc.h>
+#include "userparms.h"
+#include "general.h"
+#include "axis.h"
+#include "dcbus.h"
+#include "adc.h"
+#include "pwm.h"
+#include "plant.h"
+#include "check.h"
+
+void ApplyConfigurationRequest(void);
+void ResetParmeters(void);
+extern MOTOR_AXIS_T axisA;
+
+/* Mechanical parameters of the model as in test_stall, the default speed
+   controller gains are stable */
+#define PLANT_INERTIA       0.013
+#define PLANT_VISCOUS       0.02
+/* Load torque, current */
+#define PLANT_LOAD          NORM_CURRENT(1.0)
+/* Cycles at 20 kHz of the start up and to settle in closed loop */
+#define START_CYCLES        60000
+/* Decimation periods compared */
+#define METER_PERIODS       40
+/* Deviation of the powers, relative and in Q15 of METER_POWER_BASE_WATTS */
+#define POWER_ERROR_MAX     0.03
+#define POWER_ERROR_MIN     8
+/* Deviation of the electrical and DC input energy. The shaft power is 
+   calculated from the estimated BEMF, its energy has the error of the 
+   estimator and is compared with POWER_ERROR_MAX */
+#define ENERGY_ERROR_MAX    0.01
+
+/* Powers of the model summed over the cycles, Q15 of 
+   METER_POWER_BASE_WATTS */
+typedef struct
+{
+    double electrical;
+    double shaft;
+} PLANT_POWER_T;
+
+/* Runs the firmware on the model for a time given in cycles at 20 kHz */
+static void Run(PLANT_T *pPlant,uint32_t cycles)
+{
+    uint32_t k;
+
+    cycles = cycles * pwmTiming.frequency / PWMFREQUENCY_HZ;
+    for (k = 0; k < cycles; k++)
+    {
+        PlantControlCycle(pPlant);
+    }
+}
+
+/* One cycle of the firmware on the model, adds the powers of the model in 
+   the cycle: the voltage applied by the inverter times the current and the
+   BEMF times the q current, averaged over the cycle. With SVM a d-q 
+   voltage of 1 is a phase voltage amplitude of Vbus/sqrt(3) */
+static void PowerCycle(PLANT_T *pPlant,PLANT_POWER_T *pPower)
+{
+    double valpha = pPlant->valpha,vbeta = pPlant->vbeta;
+    double ialpha = pPlant->ialpha,ibeta = pPlant->ibeta;
+    double bemf = PlantBemf(pPlant),id,iq,iqStart,scale;
+
+    PlantDqCurrents(pPlant,&id,&iqStart);
+    PlantControlCycle(pPlant);
+    PlantDqCurrents(pPlant,&id,&iq);
+    if (axisA.uGF.bits.RunMotor == 0)
+    {
+        return;
+    }
+    ialpha = (ialpha + pPlant->ialpha) / 2;
+    ibeta = (ibeta + pPlant->ibeta) / 2;
+    iq = (iqStart + iq) / 2;
+    bemf = (bemf + PlantBemf(pPlant)) / 2;
+
+    scale = sqrt(3) / 2 / 32768 * axisA.measureInputs.dcBusVoltage / 32768;
+    pPower->electrical += (valpha * ialpha + vbeta * ibeta) * scale;
+    pPower->shaft += bemf * iq * scale;
+}
+
+/* Compares a power of the meter with the model */
+static void CheckPower(const char *name,uint16_t frequency,int16_t power,
+                       double reference)
+{
+    CHECK(fabs(power - reference) <= 
+          fmax(POWER_ERROR_MAX * fabs(reference),POWER_ERROR_MIN),
+          "%u Hz: %s power %d, model %.1f",frequency,name,power,reference);
+}
+
+/* Compares an energy counter of the meter with the model, in Ws */
+static void CheckEnergy(const char *name,uint16_t frequency,int64_t energy,
+                        double reference,double errorMax)
+{
+    double meter = energy * METER_ENERGY_UNIT_WS;
+
+    printf("%u Hz: %s energy %.3f Ws, model %.3f Ws\n",frequency,name,
+           meter,reference);
+    CHECK(fabs(meter - reference) <= errorMax * fabs(reference),
+          "%u Hz: %s energy %.3f Ws, model %.3f Ws",frequency,name,meter,
+          reference);
+}
+
+/* Metering at the PWM frequency */
+static void Metering(uint16_t frequency)
+{
+    PLANT_T plant;
+    METER_T *pMeter = &axisA.meter;
+    PLANT_POWER_T period,total = {0,0};
+    int64_t acEnergy,shaftEnergy,dcEnergy;
+    double dt;
+    uint16_t n,k;
+
+    /* Stopped - apply the frequency and measure the current offsets */
+    axisA.ctrlParm.pwmFrequencyRequest = frequency;
+    ApplyConfigurationRequest();
+    PlantInitialize(&plant);
+    plant.speedHold = 0;
+    plant.inertia = PLANT_INERTIA;
+    plant.viscous = PLANT_VISCOUS;
+    plant.load = PLANT_LOAD;
+    Run(&plant,2 * OFFSET_COUNT_MAX);
+
+    /* Start up to closed loop at the end speed (potentiometer at 0) */
+    axisA.uGF.bits.RunMotor = 1;
+    Run(&plant,START_CYCLES);
+    CHECK(axisA.uGF.bits.OpenLoop == 0,"%u Hz: start up failed",frequency);
+
+    /* From the start of a decimation period */
+    while (pMeter->count != 0)
+    {
+        PlantControlCycle(&plant);
+    }
+    acEnergy = pMeter->acEnergy;
+    shaftEnergy = pMeter->shaftEnergy;
+    dcEnergy = pMeter->dcEnergy;
+    for (n = 0; n < METER_PERIODS; n++)
+    {
+        period.electrical = 0;
+        period.shaft = 0;
+        for (k = 0; k < (1 << METER_DECIMATION_BITS); k++)
+        {
+            PowerCycle(&plant,&period);
+        }
+        total.electrical += period.electrical;
+        total.shaft += period.shaft;
+        period.electrical /= (1 << METER_DECIMATION_BITS);
+        period.shaft /= (1 << METER_DECIMATION_BITS);
+        if (n == 0)
+        {
+            printf("%u Hz: electrical %d, DC %d, shaft %d, model %.1f and "
+                   "%.1f, efficiency %d\n",frequency,pMeter->qAcPower,
+                   pMeter->qDcPower,pMeter->qShaftPower,period.electrical,
+                   period.shaft,pMeter->qEfficiency);
+        }
+        /* The inverter of the model has no losses */
+        CheckPower("electrical",frequency,pMeter->qAcPower,
+                   period.electrical);
+        CheckPower("DC input",frequency,pMeter->qDcPower,period.electrical);
+        CheckPower("shaft",frequency,pMeter->qShaftPower,period.shaft);
+    }
+    CHECK(fabs(pMeter->qEfficiency - 32768 * total.shaft / total.electrical)
+          <= Q15(0.02),"%u Hz: efficiency %d, model %.0f",frequency,
+          pMeter->qEfficiency,32768 * total.shaft / total.electrical);
+
+    /* Energies in Ws */
+    dt = 1.0 / pwmTiming.frequency;
+    CheckEnergy("electrical",frequency,pMeter->acEnergy - acEnergy,
+                total.electrical / 32768 * METER_POWER_BASE_WATTS * dt,
+                ENERGY_ERROR_MAX);
+    CheckEnergy("DC input",frequency,pMeter->dcEnergy - dcEnergy,
+                total.electrical / 32768 * METER_POWER_BASE_WATTS * dt,
+                ENERGY_ERROR_MAX);
+    CheckEnergy("shaft",frequency,pMeter->shaftEnergy - shaftEnergy,
+                total.shaft / 32768 * METER_POWER_BASE_WATTS * dt,
+                POWER_ERROR_MAX);
+
+    axisA.uGF.bits.RunMotor = 0;
+    Run(&plant,1);
+}
+
+int main(void)
+{
+    axisA.ctrlParm.currentSensing = CURRENT_SENSING_DUAL_SHUNT;
+    axisA.ctrlParm.currentSensingRequest = CURRENT_SENSING_DUAL_SHUNT;
+    PWMCalculateTiming(PWMFREQUENCY_HZ);
+    axisA.ctrlParm.pwmFrequencyRequest = pwmTiming.frequency;
+    MCAPP_MeasureFilterInit(&axisA.measureInputs);
+    MeterInitialize(&axisA.meter);
+#ifdef FAULT_SNAPSHOT
+    SnapshotInitialize(&axisA.snapshot);
+#endif
+    ResetParmeters();
+    /* DC bus at the nominal voltage */
+    ADCBUF_VBUS_A = (uint16_t)DCBUS_NOMINAL << 1;
+
+    Metering(PWMFREQUENCY_HZ);
+    Metering(PWMFREQUENCY_MAX_HZ);
+
+    return CHECK_RESULT("test_meter");
+}
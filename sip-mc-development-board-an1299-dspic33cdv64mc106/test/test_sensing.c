@@ -0,0 +1,381 @@
+/*******************************************************************************
+* Copyright (c) 2017 released Microchip Technology Inc.  All rights reserved.
+*
+* SOFTWARE LICENSE AGREEMENT:
+* 
+* Microchip Technology Incorporated ("Microchip") retains all ownership and
+* intellectual property rights in the code accompanying this message and in all
+* derivatives hereto.  You may use this code, and any derivatives created by
+* any person or entity by or on your behalf, exclusively with Microchip's
+* proprietary products.  Your acceptance and/or use of this code constitutes
+* agreement to the terms and conditions of this notice.
+*
+* CODE ACCOMPANYING THIS MESSAGE IS SUPPLIED BY MICROCHIP "AS IS".  NO
+* WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
+* TO, IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE APPLY TO THIS CODE, ITS INTERACTION WITH MICROCHIP'S
+* PRODUCTS, COMBINATION WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION.
+*
+* YOU ACKNOWLEDGE AND AGREE THAT, IN NO EVENT, SHALL MICROCHIP BE LIABLE,
+* WHETHER IN CONTRACT, WARRANTY, TORT (INCLUDING NEGLIGENCE OR BREACH OF
+* STATUTORY DUTY),STRICT LIABILITY, INDEMNITY, CONTRIBUTION, OR OTHERWISE,
+* FOR ANY INDIRECT, SPECIAL,PUNITIVE, EXEMPLARY, INCIDENTAL OR CONSEQUENTIAL
+* LOSS, DAMAGE, FOR COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE CODE,
+* HOWSOEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE POSSIBILITY OR
+* THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT ALLOWABLE BY LAW,
+* MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY RELATED TO THIS CODE,
+* SHALL NOT EXCEED THE PRICE YOU PAID DIRECTLY TO MICROCHIP SPECIFICALLY TO
+* HAVE THIS CODE DEVELOPED.
+*
+* You agree that you are solely responsible for testing the code and
+* determining its suitability.  Microchip has no obligation to modify, test,
+* certify, or support the code.
+*
+*******************************************************************************/
+/* Current sensing paths of pmsm.c: the single shunt ADC interrupt with the
+   bus current reconstruction and the dual shunt ADC interrupt with the 
+   phase current inputs, and the switch between them with 
+   ctrlParm.currentSensingRequest applied by ApplyConfigurationRequest() 
+   while the motor is stopped. The ADC results are set from known phase 
+   currents and offsets, the phase currents used by the control and the 
+   PWM and ADC registers written by the interrupts are checked. With noise
+   on the bus current conversions the variance of the reconstructed phase
+   currents has to follow the number of conversions averaged per window 
+   (SINGLE_SHUNT_OVERSAMPLING) */
+#include <stdint.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <xc.h>
+#include "userparms.h"
+#include "axis.h"
+#include "pwm.h"
+#include "adc.h"
+#include "measure.h"
+#include "check.h"
+
+void ApplyConfigurationRequest(void);
+void ResetParmeters(void);
+void _ADCInterruptSingleShunt(void);
+void _ADCInterruptDualShunt(void);
+extern MOTOR_AXIS_T axisA;
+
+/* Raw offsets of the current inputs */
+#define OFFSET_IA       150
+#define OFFSET_IB       -230
+#define OFFSET_IBUS     310
+/* Result of an input which is not converted in the current sensing mode */
+#define NOT_CONVERTED   0x5A5A
+/* Amplitude of the phase currents */
+#define CURRENT_AMPLITUDE   6000.0
+/* Standard deviation of the noise of a bus current conversion, the 
+   variance of the reconstructed currents has to be within 
+   NOISE_VARIANCE_ERROR of the expected value */
+#define NOISE_SIGMA         40.0
+#define NOISE_VARIANCE_ERROR 0.05
+/* Bus current conversions averaged in a measurement window */
+#ifdef SINGLE_SHUNT_OVERSAMPLING
+    #define IBUS_SAMPLES    2
+    #define TEST_NAME       "test_sensing_oversampling"
+#else
+    #define IBUS_SAMPLES    1
+    #define TEST_NAME       "test_sensing"
+#endif
+
+/* Phases measured by the two bus current samples of each SVM sector, 
+   0 = a, 1 = b, 2 = c. The first sample is the phase current, the second 
+   one the negated phase current */
+static const uint16_t ibus1Phase[7] = {0, 1, 0, 0, 2, 1, 2};
+static const uint16_t ibus2Phase[7] = {0, 2, 1, 2, 0, 0, 1};
+
+static void SetPhaseInputs(int16_t ia,int16_t ib)
+{
+    /* The phase current amplifiers are inverting */
+    ADCBUF0 = (uint16_t)-(ia + OFFSET_IA);
+    ADCBUF4 = (uint16_t)-(ib + OFFSET_IB);
+}
+
+/* Noise of one conversion, approximately normal */
+static int16_t Noise(double sigma)
+{
+    double sum = 0;
+    int k;
+
+    for (k = 0; k < 12; k++)
+    {
+        sum += (double)rand() / RAND_MAX;
+    }
+    return (int16_t)lround((sum - 6) * sigma);
+}
+
+/* Bus current conversions of one window, AN1 and AN7 convert the same 
+   amplifier output with independent noise */
+static void SetBusInputs(int16_t ibus,double sigma)
+{
+    ADCBUF1 = (uint16_t)(ibus + OFFSET_IBUS + Noise(sigma));
+    ADCBUF7 = (uint16_t)(ibus + OFFSET_IBUS + Noise(sigma));
+}
+
+/* One PWM cycle with single shunt current sensing, the bus current is 
+   converted at the two trigger points of the pattern applied in the cycle */
+static void PwmCycleSingleShunt(const int16_t *iabc,double sigma)
+{
+    int16_t sector = axisA.singleShuntParam.sectorSVM;
+
+    ADCBUF0 = NOT_CONVERTED;
+    ADCBUF4 = NOT_CONVERTED;
+    IFS4bits.PWM1IF = 1;
+    SetBusInputs(iabc[ibus1Phase[sector]],sigma);
+    _ADCInterruptSingleShunt();
+    SetBusInputs(-iabc[ibus2Phase[sector]],sigma);
+    _ADCInterruptSingleShunt();
+}
+
+/* One PWM cycle with dual shunt current sensing */
+static void PwmCycleDualShunt(const int16_t *iabc)
+{
+    SetPhaseInputs(iabc[0],iabc[1]);
+    ADCBUF1 = NOT_CONVERTED;
+    ADCBUF7 = NOT_CONVERTED;
+    _ADCInterruptDualShunt();
+}
+
+static void PwmCycle(const int16_t *iabc)
+{
+    if (axisA.ctrlParm.currentSensing == CURRENT_SENSING_SINGLE_SHUNT)
+    {
+        PwmCycleSingleShunt(iabc,0);
+    }
+    else
+    {
+        PwmCycleDualShunt(iabc);
+    }
+}
+
+/* Offset measurement at standstill, the bus current is converted at the
+   single shunt trigger points and with the phase currents */
+static void MeasureOffsets(void)
+{
+    const int16_t zero[3] = {0, 0, 0};
+    int16_t i;
+
+    for (i = 0; i <= OFFSET_COUNT_MAX; i++)
+    {
+        SetPhaseInputs(0,0);
+        SetBusInputs(0,0);
+        if (axisA.ctrlParm.currentSensing == CURRENT_SENSING_SINGLE_SHUNT)
+        {
+            IFS4bits.PWM1IF = 1;
+            _ADCInterruptSingleShunt();
+            _ADCInterruptSingleShunt();
+        }
+        else
+        {
+            _ADCInterruptDualShunt();
+        }
+    }
+    CHECK(MCAPP_MeasureCurrentOffsetStatus(&axisA.measureInputs) == 1,
+          "offset measurement not completed");
+    CHECK((axisA.measureInputs.current.offsetIa == OFFSET_IA) &&
+          (axisA.measureInputs.current.offsetIb == OFFSET_IB) &&
+          (axisA.measureInputs.current.offsetIbus == OFFSET_IBUS),
+          "offsets %d %d %d",axisA.measureInputs.current.offsetIa,
+          axisA.measureInputs.current.offsetIb,
+          axisA.measureInputs.current.offsetIbus);
+    PwmCycle(zero);
+}
+
+/* Runs the motor in open loop with balanced phase currents, checks the
+   phase currents seen by the control and the PWM registers */
+static void RunMotor(uint16_t cycles)
+{
+    uint16_t k,sectorCount[7] = {0};
+    int16_t iabc[3],sector;
+    double angle;
+    const MC_DUTYCYCLEOUT_T *pDuty1,*pDuty2;
+
+    axisA.uGF.bits.RunMotor = 1;
+    for (k = 0; k < cycles; k++)
+    {
+        angle = k * 0.01;
+        iabc[0] = (int16_t)(CURRENT_AMPLITUDE * cos(angle));
+        iabc[1] = (int16_t)(CURRENT_AMPLITUDE * cos(angle - 2.0*M_PI/3));
+        iabc[2] = -iabc[0] - iabc[1];
+        sector = axisA.singleShuntParam.sectorSVM;
+        PwmCycle(iabc);
+
+        CHECK((axisA.iabc.a == iabc[0]) && (axisA.iabc.b == iabc[1]),
+              "cycle %u: currents %d %d, expected %d %d",k,axisA.iabc.a,
+              axisA.iabc.b,iabc[0],iabc[1]);
+        if (axisA.ctrlParm.currentSensing == CURRENT_SENSING_SINGLE_SHUNT)
+        {
+            sectorCount[sector]++;
+            CHECK(axisA.singleShuntParam.Ic == iabc[2],"cycle %u: Ic %d",
+                  k,axisA.singleShuntParam.Ic);
+            /* Dual edge pattern and bus current triggers of the next 
+               cycle */
+            pDuty1 = &axisA.singleShuntParam.pwmDutycycle1;
+            pDuty2 = &axisA.singleShuntParam.pwmDutycycle2;
+            CHECK((PG1PHASE == pDuty1->dutycycle1 + (DEADTIME >> 1)) &&
+                  (PG2PHASE == pDuty1->dutycycle2 + (DEADTIME >> 1)) &&
+                  (PG3PHASE == pDuty1->dutycycle3 + (DEADTIME >> 1)) &&
+                  (PG1DC == pDuty2->dutycycle1 - (DEADTIME >> 1)) &&
+                  (PG2DC == pDuty2->dutycycle2 - (DEADTIME >> 1)) &&
+                  (PG3DC == pDuty2->dutycycle3 - (DEADTIME >> 1)),
+                  "cycle %u: single shunt duty cycle registers",k);
+#ifdef SINGLE_SHUNT_OVERSAMPLING
+            /* AN7 (PWM2) ahead of AN1 (PWM1), centered on the trigger */
+            CHECK((PG1TRIGB == (uint16_t)(axisA.singleShuntParam.trigger1 + 
+                                    (SS_OVERSAMPLE_SPACING >> 1))) &&
+                  (PG1TRIGC == (uint16_t)(axisA.singleShuntParam.trigger2 + 
+                                    (SS_OVERSAMPLE_SPACING >> 1))) &&
+                  (PG2TRIGB == (uint16_t)(axisA.singleShuntParam.trigger1 - 
+                                    (SS_OVERSAMPLE_SPACING >> 1))) &&
+                  (PG2TRIGC == (uint16_t)(axisA.singleShuntParam.trigger2 - 
+                                    (SS_OVERSAMPLE_SPACING >> 1))),
+                  "cycle %u: bus current triggers %u %u %u %u",k,PG1TRIGB,
+                  PG1TRIGC,PG2TRIGB,PG2TRIGC);
+#else
+            CHECK((PG1TRIGB == (uint16_t)axisA.singleShuntParam.trigger1) &&
+                  (PG1TRIGC == (uint16_t)axisA.singleShuntParam.trigger2),
+                  "cycle %u: bus current triggers %u %u",k,PG1TRIGB,
+                  PG1TRIGC);
+#endif
+        }
+        else
+        {
+            CHECK((PG1DC == axisA.pwmDutycycle.dutycycle1) &&
+                  (PG2DC == axisA.pwmDutycycle.dutycycle2) &&
+                  (PG3DC == axisA.pwmDutycycle.dutycycle3),
+                  "cycle %u: dual shunt duty cycle registers",k);
+        }
+    }
+    if (axisA.ctrlParm.currentSensing == CURRENT_SENSING_SINGLE_SHUNT)
+    {
+        for (sector = 1; sector <= 6; sector++)
+        {
+            CHECK(sectorCount[sector] > 0,"sector %d not covered",sector);
+        }
+    }
+}
+
+/* Runs the motor in open loop with noise on the bus current conversions. 
+   A phase current measured by one window has the variance of the window,
+   NOISE_SIGMA^2/IBUS_SAMPLES, the middle phase is calculated from both 
+   windows and has twice the variance */
+static void RunMotorNoise(uint16_t cycles)
+{
+    uint16_t k,phase;
+    int16_t iabc[3],sector,error;
+    double angle,errorSquare = 0,expected = 0,ratio;
+
+    srand(1);
+    for (k = 0; k < cycles; k++)
+    {
+        angle = k * 0.01;
+        iabc[0] = (int16_t)(CURRENT_AMPLITUDE * cos(angle));
+        iabc[1] = (int16_t)(CURRENT_AMPLITUDE * cos(angle - 2.0*M_PI/3));
+        iabc[2] = -iabc[0] - iabc[1];
+        sector = axisA.singleShuntParam.sectorSVM;
+        PwmCycleSingleShunt(iabc,NOISE_SIGMA);
+
+        for (phase = 0; phase < 2; phase++)
+        {
+            error = (phase == 0) ? axisA.iabc.a - iabc[0] : 
+                                   axisA.iabc.b - iabc[1];
+            errorSquare += (double)error * error;
+            if ((phase == ibus1Phase[sector]) || 
+                (phase == ibus2Phase[sector]))
+            {
+                expected += NOISE_SIGMA * NOISE_SIGMA / IBUS_SAMPLES;
+            }
+            else
+            {
+                expected += 2 * NOISE_SIGMA * NOISE_SIGMA / IBUS_SAMPLES;
+            }
+        }
+    }
+    ratio = errorSquare / expected;
+    printf("single shunt, %d conversion(s) per window: current noise "
+           "variance %.1f, expected %.1f\n",IBUS_SAMPLES,
+           errorSquare / (2 * cycles),expected / (2 * cycles));
+    CHECK(fabs(ratio - 1) < NOISE_VARIANCE_ERROR,
+          "current noise variance %.3f of the expected value",ratio);
+}
+
+/* Stops the motor as the button does, then the main loop applies the 
+   requested configuration */
+static void ChangeConfiguration(uint16_t currentSensing,uint16_t frequency)
+{
+    ResetParmeters();
+    axisA.ctrlParm.currentSensingRequest = currentSensing;
+    axisA.ctrlParm.pwmFrequencyRequest = frequency;
+    ApplyConfigurationRequest();
+
+    CHECK(axisA.ctrlParm.currentSensing == currentSensing,
+          "current sensing %u, requested %u",axisA.ctrlParm.currentSensing,
+          currentSensing);
+    CHECK((pwmTiming.frequency == frequency) && 
+          (MPER == pwmTiming.loopTimeTcy) &&
+          (axisA.pwmPeriod == pwmTiming.loopTimeTcy),
+          "PWM frequency %u, requested %u",pwmTiming.frequency,frequency);
+    if (currentSensing == CURRENT_SENSING_SINGLE_SHUNT)
+    {
+        CHECK((_ADCAN1IE == 1) && (_ADCAN15IE == 0),
+              "single shunt interrupt enable");
+        CHECK((PG1CONLbits.MODSEL == 6) && (PG1EVTHbits.ADTR2EN2 == 1) &&
+              (PG1EVTHbits.ADTR2EN3 == 1),"single shunt PWM mode");
+        CHECK((ADTRIG0Lbits.TRGSRC1 == 0x5) && (ADTRIG0Lbits.TRGSRC0 == 0) &&
+              (ADTRIG1Lbits.TRGSRC4 == 0),"single shunt ADC triggers");
+#ifdef SINGLE_SHUNT_OVERSAMPLING
+        CHECK((ADTRIG1Hbits.TRGSRC7 == 0x7) && (PG2EVTHbits.ADTR2EN2 == 1) &&
+              (PG2EVTHbits.ADTR2EN3 == 1),"oversampling ADC triggers");
+#endif
+    }
+    else
+    {
+        CHECK((_ADCAN1IE == 0) && (_ADCAN15IE == 1),
+              "dual shunt interrupt enable");
+        CHECK((PG1CONLbits.MODSEL == 4) && (PG1EVTHbits.ADTR2EN2 == 0) &&
+              (PG1EVTHbits.ADTR2EN3 == 0),"dual shunt PWM mode");
+        CHECK((ADTRIG0Lbits.TRGSRC1 == 0) && (ADTRIG0Lbits.TRGSRC0 == 0x4) &&
+              (ADTRIG1Lbits.TRGSRC4 == 0x4),"dual shunt ADC triggers");
+    }
+}
+
+int main(void)
+{
+    /* Initialization of main() for the default current sensing mode */
+    axisA.ctrlParm.currentSensing = CURRENT_SENSING_DEFAULT;
+    axisA.ctrlParm.currentSensingRequest = CURRENT_SENSING_DEFAULT;
+    PWMCalculateTiming(PWMFREQUENCY_HZ);
+    axisA.ctrlParm.pwmFrequencyRequest = pwmTiming.frequency;
+    MCAPP_MeasureFilterInit(&axisA.measureInputs);
+#ifdef POWER_METERING
+    MeterInitialize(&axisA.meter);
+#endif
+#ifdef FAULT_SNAPSHOT
+    SnapshotInitialize(&axisA.snapshot);
+#endif
+    ResetParmeters();
+    InitPWMGenerators();
+    ADCConfigureCurrentSensing(CURRENT_SENSING_DEFAULT);
+
+    MeasureOffsets();
+    RunMotor(20000);
+
+    /* Switch to the other mode and back, at another PWM frequency */
+    ChangeConfiguration(!CURRENT_SENSING_DEFAULT,PWMFREQUENCY_MAX_HZ);
+    MeasureOffsets();
+    RunMotor(20000);
+    ChangeConfiguration(CURRENT_SENSING_DEFAULT,PWMFREQUENCY_HZ);
+    MeasureOffsets();
+    RunMotor(20000);
+    if (axisA.ctrlParm.currentSensing == CURRENT_SENSING_SINGLE_SHUNT)
+    {
+        RunMotorNoise(20000);
+    }
+
+    return CHECK_RESULT(TEST_NAME);
+}
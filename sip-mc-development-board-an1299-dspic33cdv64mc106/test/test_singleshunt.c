@@ -0,0 +1,367 @@
+/*******************************************************************************
+* Copyright (c) 2017 released Microchip Technology Inc.  All rights reserved.
+*
+* SOFTWARE LICENSE AGREEMENT:
+* 
+* Microchip Technology Incorporated ("Microchip") retains all ownership and
+* intellectual property rights in the code accompanying this message and in all
+* derivatives hereto.  You may use this code, and any derivatives created by
+* any person or entity by or on your behalf, exclusively with Microchip's
+* proprietary products.  Your acceptance and/or use of this code constitutes
+* agreement to the terms and conditions of this notice.
+*
+* CODE ACCOMPANYING THIS MESSAGE IS SUPPLIED BY MICROCHIP "AS IS".  NO
+* WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
+* TO, IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE APPLY TO THIS CODE, ITS INTERACTION WITH MICROCHIP'S
+* PRODUCTS, COMBINATION WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION.
+*
+* YOU ACKNOWLEDGE AND AGREE THAT, IN NO EVENT, SHALL MICROCHIP BE LIABLE,
+* WHETHER IN CONTRACT, WARRANTY, TORT (INCLUDING NEGLIGENCE OR BREACH OF
+* STATUTORY DUTY),STRICT LIABILITY, INDEMNITY, CONTRIBUTION, OR OTHERWISE,
+* FOR ANY INDIRECT, SPECIAL,PUNITIVE, EXEMPLARY, INCIDENTAL OR CONSEQUENTIAL
+* LOSS, DAMAGE, FOR COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE CODE,
+* HOWSOEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE POSSIBILITY OR
+* THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT ALLOWABLE BY LAW,
+* MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY RELATED TO THIS CODE,
+* SHALL NOT EXCEED THE PRICE YOU PAID DIRECTLY TO MICROCHIP SPECIFICALLY TO
+* HAVE THIS CODE DEVELOPED.
+*
+* You agree that you are solely responsible for testing the code and
+* determining its suitability.  Microchip has no obligation to modify, test,
+* certify, or support the code.
+*
+*******************************************************************************/
+/* Single shunt space vector modulation and phase current reconstruction of
+   singleshunt.c, driven by the sector table, against the sector if-tree 
+   they replaced. Every combination of the signs of Va, Vb and Vc is 
+   modulated at magnitudes from zero to full scale, including the windows 
+   around tcrit, at the lowest, default and highest PWM frequency */
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <xc.h>
+#include "userparms.h"
+#include "singleshunt.h"
+#include "pwm.h"
+#include "check.h"
+
+static void Reference_CalculateSwitchingTime(SINGLE_SHUNT_PARM_T *,uint16_t);
+
+/* Space vector modulation of singleshunt.c before the sector table, the
+   ADC trigger registers are written by the caller */
+static void Reference_CalculateSpaceVectorPhaseShifted(MC_ABC_T *abc,
+                                    uint16_t iPwmPeriod,
+                                    SINGLE_SHUNT_PARM_T *pSingleShunt)
+{ 
+    MC_DUTYCYCLEOUT_T *pdcout1 = &pSingleShunt->pwmDutycycle1;
+    MC_DUTYCYCLEOUT_T *pdcout2 = &pSingleShunt->pwmDutycycle2;   
+    if (abc->a >= 0)
+    {
+        if (abc->b >= 0)
+        {
+            pSingleShunt->sectorSVM  = 3; 
+            pSingleShunt->T1 = abc->a;
+            pSingleShunt->T2 = abc->b;
+            Reference_CalculateSwitchingTime(pSingleShunt,iPwmPeriod);
+            pdcout1->dutycycle1 = pSingleShunt->Ta1;
+            pdcout1->dutycycle2 = pSingleShunt->Tb1;
+            pdcout1->dutycycle3 = pSingleShunt->Tc1;
+            pdcout2->dutycycle1 = pSingleShunt->Ta2;
+            pdcout2->dutycycle2 = pSingleShunt->Tb2;
+            pdcout2->dutycycle3 = pSingleShunt->Tc2;
+        }
+        else
+        {
+            if (abc->c >= 0)
+            {
+                pSingleShunt->sectorSVM  = 5;
+                pSingleShunt->T1 = abc->c;
+                pSingleShunt->T2 = abc->a;
+                Reference_CalculateSwitchingTime(pSingleShunt,iPwmPeriod);
+                pdcout1->dutycycle1 = pSingleShunt->Tc1;
+                pdcout1->dutycycle2 = pSingleShunt->Ta1;
+                pdcout1->dutycycle3 = pSingleShunt->Tb1;
+                pdcout2->dutycycle1 = pSingleShunt->Tc2;
+                pdcout2->dutycycle2 = pSingleShunt->Ta2;
+                pdcout2->dutycycle3 = pSingleShunt->Tb2;
+            }
+            else
+            {
+                pSingleShunt->sectorSVM  = 1;
+                pSingleShunt->T1 = -abc->c;
+                pSingleShunt->T2 = -abc->b;
+                Reference_CalculateSwitchingTime(pSingleShunt,iPwmPeriod);
+                pdcout1->dutycycle1 = pSingleShunt->Tb1;
+                pdcout1->dutycycle2 = pSingleShunt->Ta1;
+                pdcout1->dutycycle3 = pSingleShunt->Tc1;
+                pdcout2->dutycycle1 = pSingleShunt->Tb2;
+                pdcout2->dutycycle2 = pSingleShunt->Ta2;
+                pdcout2->dutycycle3 = pSingleShunt->Tc2;
+            }
+        }
+    }
+    else
+    {
+        if (abc->b >= 0)
+        {
+            if (abc->c >= 0)
+            {
+                pSingleShunt->sectorSVM  = 6;
+                pSingleShunt->T1 = abc->b;
+                pSingleShunt->T2 = abc->c;
+                Reference_CalculateSwitchingTime(pSingleShunt,iPwmPeriod);
+                pdcout1->dutycycle1 = pSingleShunt->Tb1;
+                pdcout1->dutycycle2 = pSingleShunt->Tc1;
+                pdcout1->dutycycle3 = pSingleShunt->Ta1;
+                pdcout2->dutycycle1 = pSingleShunt->Tb2;
+                pdcout2->dutycycle2 = pSingleShunt->Tc2;
+                pdcout2->dutycycle3 = pSingleShunt->Ta2;
+            }
+            else
+            {
+                pSingleShunt->sectorSVM  = 2;
+                pSingleShunt->T1 = -abc->a;
+                pSingleShunt->T2 = -abc->c;
+                Reference_CalculateSwitchingTime(pSingleShunt,iPwmPeriod);
+                pdcout1->dutycycle1 = pSingleShunt->Ta1;
+                pdcout1->dutycycle2 = pSingleShunt->Tc1;
+                pdcout1->dutycycle3 = pSingleShunt->Tb1;
+                pdcout2->dutycycle1 = pSingleShunt->Ta2;
+                pdcout2->dutycycle2 = pSingleShunt->Tc2;
+                pdcout2->dutycycle3 = pSingleShunt->Tb2;
+            }
+        }
+        else
+        {
+            pSingleShunt->sectorSVM  = 4;
+            pSingleShunt->T1 = -abc->b;
+            pSingleShunt->T2 = -abc->a;
+            Reference_CalculateSwitchingTime(pSingleShunt,iPwmPeriod);
+            pdcout1->dutycycle1 = pSingleShunt->Tc1;
+            pdcout1->dutycycle2 = pSingleShunt->Tb1;
+            pdcout1->dutycycle3 = pSingleShunt->Ta1;
+            pdcout2->dutycycle1 = pSingleShunt->Tc2;
+            pdcout2->dutycycle2 = pSingleShunt->Tb2;
+            pdcout2->dutycycle3 = pSingleShunt->Ta2;
+        }
+    }
+    pSingleShunt->trigger1 = (iPwmPeriod + pSingleShunt->tDelaySample);
+    pSingleShunt->trigger1 = pSingleShunt->trigger1 - 
+                        ((pSingleShunt->Ta1 + pSingleShunt->Tb1) >> 1);
+    pSingleShunt->trigger2 = (iPwmPeriod +  pSingleShunt->tDelaySample);
+    pSingleShunt->trigger2 = pSingleShunt->trigger2 - 
+                        ((pSingleShunt->Tb1 + pSingleShunt->Tc1) >> 1);
+}
+
+static void Reference_CalculateSwitchingTime(SINGLE_SHUNT_PARM_T *pSingleShunt,
+                                             uint16_t iPwmPeriod)
+{
+    pSingleShunt->T1 = (int16_t) (__builtin_mulss(iPwmPeriod,
+                                                  pSingleShunt->T1) >> 15);
+    pSingleShunt->T2 = (int16_t) (__builtin_mulss(iPwmPeriod,
+                                                  pSingleShunt->T2) >> 15);
+    pSingleShunt->T7 = (iPwmPeriod-pSingleShunt->T1-pSingleShunt->T2)>>1;
+    if (pSingleShunt->T1 > pSingleShunt->tcrit)
+    {
+        pSingleShunt->Tc1 = pSingleShunt->T7;
+        pSingleShunt->Tc2 = pSingleShunt->T7;
+    }
+    else
+    {
+        pSingleShunt->Tc1 = pSingleShunt->T7 - 
+                            (pSingleShunt->tcrit-pSingleShunt->T1);
+        pSingleShunt->Tc2 = pSingleShunt->T7 + 
+                            (pSingleShunt->tcrit-pSingleShunt->T1);
+    }
+    pSingleShunt->Tb1 = pSingleShunt->T7 + pSingleShunt->T1;
+    pSingleShunt->Tb2 = pSingleShunt->Tb1;
+    if (pSingleShunt->T2 > pSingleShunt->tcrit)
+    {
+        pSingleShunt->Ta1 = pSingleShunt->Tb1 + pSingleShunt->T2;
+        pSingleShunt->Ta2 = pSingleShunt->Tb2 + pSingleShunt->T2;
+    }
+    else
+    {
+        pSingleShunt->Ta1 = pSingleShunt->Tb1 + pSingleShunt->tcrit;
+        pSingleShunt->Ta2 = pSingleShunt->Tb2 + pSingleShunt->T2 + 
+                            pSingleShunt->T2 - pSingleShunt->tcrit;
+    }
+}
+
+/* Phase current reconstruction of singleshunt.c before the sector table */
+static void Reference_PhaseCurrentReconstruction(
+                                        SINGLE_SHUNT_PARM_T *pSingleShunt)
+{
+    switch(pSingleShunt->sectorSVM)
+    {
+        case 1:
+            pSingleShunt->Ib = pSingleShunt->Ibus1;
+            pSingleShunt->Ic = -pSingleShunt->Ibus2;
+            pSingleShunt->Ia = -pSingleShunt->Ic - pSingleShunt->Ib;
+        break;
+        case 2:
+            pSingleShunt->Ia = pSingleShunt->Ibus1;
+            pSingleShunt->Ib = -pSingleShunt->Ibus2;
+            pSingleShunt->Ic = -pSingleShunt->Ia - pSingleShunt->Ib;
+        break;
+        case 3:
+            pSingleShunt->Ia = pSingleShunt->Ibus1; 
+            pSingleShunt->Ic = -pSingleShunt->Ibus2;
+            pSingleShunt->Ib = -pSingleShunt->Ia - pSingleShunt->Ic;
+        break;
+        case 4:
+            pSingleShunt->Ic = pSingleShunt->Ibus1; 
+            pSingleShunt->Ia = -pSingleShunt->Ibus2; 
+            pSingleShunt->Ib = -pSingleShunt->Ia - pSingleShunt->Ic;
+        break;
+        case 5:
+            pSingleShunt->Ib = pSingleShunt->Ibus1; 
+            pSingleShunt->Ia = -pSingleShunt->Ibus2; 
+            pSingleShunt->Ic = -pSingleShunt->Ia - pSingleShunt->Ib;
+        break;
+        case 6:
+            pSingleShunt->Ic = pSingleShunt->Ibus1; 
+            pSingleShunt->Ib = -pSingleShunt->Ibus2;
+            pSingleShunt->Ia = -pSingleShunt->Ic - pSingleShunt->Ib;
+        break;   
+    }  
+}
+
+static int16_t indexCount[8];
+
+/* Modulates vabc with both implementations and compares the patterns and
+   triggers, then the reconstruction of a set of bus currents */
+static void CompareModulation(int16_t va,int16_t vb,int16_t vc,
+                              uint16_t period,int16_t ibus1,int16_t ibus2)
+{
+    SINGLE_SHUNT_PARM_T table,reference;
+    MC_ABC_T vabc;
+    uint16_t index;
+
+    SingleShunt_InitializeParameters(&table);
+    SingleShunt_InitializeParameters(&reference);
+    vabc.a = va;
+    vabc.b = vb;
+    vabc.c = vc;
+    index = (va >= 0) | ((vb >= 0) << 1) | ((vc >= 0) << 2);
+    indexCount[index]++;
+
+    SingleShunt_CalculateSpaceVectorPhaseShifted(&vabc,period,&table);
+    Reference_CalculateSpaceVectorPhaseShifted(&vabc,period,&reference);
+
+    CHECK(table.sectorIndex == index,"index %u, expected %u",
+          table.sectorIndex,index);
+    CHECK((table.sectorSVM == reference.sectorSVM) &&
+          (table.T1 == reference.T1) && (table.T2 == reference.T2) &&
+          (table.T7 == reference.T7) &&
+          (table.Ta1 == reference.Ta1) && (table.Ta2 == reference.Ta2) &&
+          (table.Tb1 == reference.Tb1) && (table.Tb2 == reference.Tb2) &&
+          (table.Tc1 == reference.Tc1) && (table.Tc2 == reference.Tc2),
+          "switching times of (%d,%d,%d) period %u, sector %d/%d",
+          va,vb,vc,period,table.sectorSVM,reference.sectorSVM);
+    CHECK(memcmp(&table.pwmDutycycle1,&reference.pwmDutycycle1,
+                 sizeof(MC_DUTYCYCLEOUT_T)) == 0 &&
+          memcmp(&table.pwmDutycycle2,&reference.pwmDutycycle2,
+                 sizeof(MC_DUTYCYCLEOUT_T)) == 0,
+          "duty cycles of (%d,%d,%d) period %u",va,vb,vc,period);
+    CHECK((table.trigger1 == reference.trigger1) &&
+          (table.trigger2 == reference.trigger2),
+          "triggers of (%d,%d,%d) period %u",va,vb,vc,period);
+
+    /* The trigger registers are written as by the if-tree version */
+    SingleShunt_SetTriggersInverterA(&table);
+#ifndef SINGLE_SHUNT_OVERSAMPLING
+    CHECK((INVERTERA_PWM_TRIGB == (uint16_t)reference.trigger1) &&
+          (INVERTERA_PWM_TRIGC == (uint16_t)reference.trigger2),
+          "trigger registers of (%d,%d,%d) period %u",va,vb,vc,period);
+#endif
+
+    table.Ibus1 = ibus1;
+    table.Ibus2 = ibus2;
+    reference.Ibus1 = ibus1;
+    reference.Ibus2 = ibus2;
+    SingleShunt_PhaseCurrentReconstruction(&table);
+    Reference_PhaseCurrentReconstruction(&reference);
+    CHECK((table.Ia == reference.Ia) && (table.Ib == reference.Ib) &&
+          (table.Ic == reference.Ic),
+          "currents of sector %d from (%d,%d): (%d,%d,%d), expected "
+          "(%d,%d,%d)",reference.sectorSVM,ibus1,ibus2,table.Ia,table.Ib,
+          table.Ic,reference.Ia,reference.Ib,reference.Ic);
+}
+
+int main(void)
+{
+    const uint16_t frequency[] = {PWMFREQUENCY_MIN_HZ,PWMFREQUENCY_HZ,
+                                  PWMFREQUENCY_MAX_HZ};
+    const int16_t magnitude[] = {0,1,100,1000,4000,16384,32767};
+    uint16_t f,i,m,index,period,angle;
+    int16_t v[3],ibus1,ibus2,tcritVoltage;
+    int32_t k;
+
+    srand(1);
+    for (f = 0; f < sizeof(frequency)/sizeof(frequency[0]); f++)
+    {
+        PWMCalculateTiming(frequency[f]);
+        period = pwmTiming.loopTimeTcy;
+        /* Phase voltage giving a T1 or T2 window of tcrit */
+        tcritVoltage = (int16_t)(((int32_t)SSTCRIT << 15) / period);
+
+        /* All sign combinations, including (0,0,0) and (1,1,1) which only
+           occur by rounding, at magnitudes up to full scale and around the
+           critical window */
+        for (index = 0; index < 8; index++)
+        {
+            for (k = 0; k < 2000; k++)
+            {
+                for (i = 0; i < 3; i++)
+                {
+                    if (k < (int32_t)(sizeof(magnitude)/sizeof(magnitude[0])))
+                    {
+                        m = magnitude[k];
+                    }
+                    else if (k < 1000)
+                    {
+                        m = tcritVoltage - 20 + rand() % 41;
+                    }
+                    else
+                    {
+                        m = rand() % 32768;
+                    }
+                    if ((i > 0) && (k >= 1000) && (rand() & 1))
+                    {
+                        m = m >> (rand() % 15);
+                    }
+                    v[i] = ((index >> i) & 1) ? m : -1 - (int16_t)m;
+                }
+                ibus1 = rand() % 32768 - 16384;
+                ibus2 = rand() % 32768 - 16384;
+                CompareModulation(v[0],v[1],v[2],period,ibus1,ibus2);
+            }
+        }
+        /* Balanced three phase voltages over a full turn */
+        for (m = 0; m < sizeof(magnitude)/sizeof(magnitude[0]); m++)
+        {
+            for (k = 0; k < 65536; k += 97)
+            {
+                angle = (uint16_t)k;
+                v[0] = (int16_t)(magnitude[m] * 
+                                 sin(angle * 2.0 * M_PI / 65536.0));
+                v[1] = (int16_t)(magnitude[m] * 
+                          sin(angle * 2.0 * M_PI / 65536.0 - 2.0 * M_PI/3));
+                v[2] = (int16_t)(magnitude[m] * 
+                          sin(angle * 2.0 * M_PI / 65536.0 + 2.0 * M_PI/3));
+                CompareModulation(v[0],v[1],v[2],period,
+                                  rand() % 32768 - 16384,
+                                  rand() % 32768 - 16384);
+            }
+        }
+    }
+    for (index = 0; index < 8; index++)
+    {
+        CHECK(indexCount[index] > 0,"sign index %u not covered",index);
+    }
+    return CHECK_RESULT("test_singleshunt");
+}
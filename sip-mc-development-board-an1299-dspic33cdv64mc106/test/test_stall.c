@@ -0,0 +1,198 @@
+/*******************************************************************************
+* Copyright (c) 2017 released Microchip Technology Inc.  All rights reserved.
+*
+* SOFTWARE LICENSE AGREEMENT:
+* 
+* Microchip Technology Incorporated ("Microchip") retains all ownership and
+* intellectual property rights in the code accompanying this message and in all
+* derivatives hereto.  You may use this code, and any derivatives created by
+* any person or entity by or on your behalf, exclusively with Microchip's
+* proprietary products.  Your acceptance and/or use of this code constitutes
+* agreement to the terms and conditions of this notice.
+*
+* CODE ACCOMPANYING THIS MESSAGE IS SUPPLIED BY MICROCHIP "AS IS".  NO
+* WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED
+* TO, IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE APPLY TO THIS CODE, ITS INTERACTION WITH MICROCHIP'S
+* PRODUCTS, COMBINATION WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION.
+*
+* YOU ACKNOWLEDGE AND AGREE THAT, IN NO EVENT, SHALL MICROCHIP BE LIABLE,
+* WHETHER IN CONTRACT, WARRANTY, TORT (INCLUDING NEGLIGENCE OR BREACH OF
+* STATUTORY DUTY),STRICT LIABILITY, INDEMNITY, CONTRIBUTION, OR OTHERWISE,
+* FOR ANY INDIRECT, SPECIAL,PUNITIVE, EXEMPLARY, INCIDENTAL OR CONSEQUENTIAL
+* LOSS, DAMAGE, FOR COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE CODE,
+* HOWSOEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE POSSIBILITY OR
+* THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT ALLOWABLE BY LAW,
+* MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY RELATED TO THIS CODE,
+* SHALL NOT EXCEED THE PRICE YOU PAID DIRECTLY TO MICROCHIP SPECIFICALLY TO
+* HAVE THIS CODE DEVELOPED.
+*
+* You agree that you are solely responsible for testing the code and
+* determining its suitability.  Microchip has no obligation to modify, test,
+* certify, or support the code.
+*
+*******************************************************************************/
+/* Stall detection on the motor model. The firmware runs from the ADC 
+   interrupt with dual shunt current sensing and the estimator, started up
+   to closed loop at the end speed. A locked rotor has to be detected 
+   before the current reaches the overcurrent threshold, also after the 
+   restarts, and stop the motor after STALL_RESTART_MAX restarts, a load step within the capability of 
+   the drive must not be detected, and after a stable period the restarts
+   are forgotten */
+#include <stdint.h>
+#include <math.h>
+#include <stdio.h>
+
+#include <xc.h>
+#include "userparms.h"
+#include "axis.h"
+#include "pwm.h"
+#include "plant.h"
+#include "check.h"
+
+void ResetParmeters(void);
+extern MOTOR_AXIS_T axisA;
+
+/* Mechanical parameters of the model, current per speed change per s and 
+   current per speed: the default speed controller gains are stable */
+#define PLANT_INERTIA       0.013
+#define PLANT_VISCOUS       0.02
+/* Cycles of the start up and to settle in closed loop */
+#define START_CYCLES        60000
+/* Load step, current */
+#define LOAD_STEP           NORM_CURRENT(1.0)
+
+/* Peak phase current of the model since the last reset */
+static double currentPeak;
+
+/* Runs the firmware on the model */
+static void Run(PLANT_T *pPlant,uint32_t cycles)
+{
+    uint32_t k;
+
+    for (k = 0; k < cycles; k++)
+    {
+        PlantControlCycle(pPlant);
+        currentPeak = fmax(currentPeak,hypot(pPlant->ialpha,pPlant->ibeta));
+    }
+}
+
+/* Stops the motor and the model, measures the current offsets and starts 
+   up to closed loop */
+static void Start(PLANT_T *pPlant)
+{
+    ResetParmeters();
+    PlantInitialize(pPlant);
+    pPlant->speedHold = 0;
+    pPlant->inertia = PLANT_INERTIA;
+    pPlant->viscous = PLANT_VISCOUS;
+    Run(pPlant,2 * OFFSET_COUNT_MAX);
+    axisA.uGF.bits.RunMotor = 1;
+    Run(pPlant,START_CYCLES);
+}
+
+/* The rotor is locked in closed loop until the motor is stopped */
+static void LockedRotor(void)
+{
+    PLANT_T plant;
+    uint16_t detections;
+    uint32_t k;
+
+    Start(&plant);
+    CHECK(axisA.uGF.bits.OpenLoop == 0,"locked rotor: start up failed");
+    detections = axisA.stallParm.detectionCount;
+
+    plant.speedHold = 1;
+    plant.speed = 0;
+    currentPeak = 0;
+    for (k = 0; (k < 20 * START_CYCLES) && axisA.uGF.bits.RunMotor; k++)
+    {
+        Run(&plant,1);
+    }
+    printf("locked rotor: %u detections, source 0x%x, stopped after %u "
+           "cycles, peak current %.0f\n",
+           axisA.stallParm.detectionCount - detections,
+           axisA.stallParm.source,k,currentPeak);
+    CHECK(axisA.uGF.bits.RunMotor == 0,"locked rotor: motor not stopped");
+    CHECK(currentPeak < Q15_OVER_CURRENT_THRESHOLD,
+          "locked rotor: current %.0f",currentPeak);
+    CHECK(axisA.stallParm.source == STALL_SOURCE_CURRENT,
+          "locked rotor: source 0x%x",axisA.stallParm.source);
+    CHECK(axisA.stallParm.detectionCount - detections == 
+          STALL_RESTART_MAX + 1,"locked rotor: %u detections",
+          axisA.stallParm.detectionCount - detections);
+}
+
+/* A load step in closed loop */
+static void LoadStep(void)
+{
+    PLANT_T plant;
+    uint16_t detections;
+
+    Start(&plant);
+    CHECK(axisA.uGF.bits.OpenLoop == 0,"load step: start up failed");
+    detections = axisA.stallParm.detectionCount;
+
+    plant.load = LOAD_STEP;
+    Run(&plant,START_CYCLES);
+    plant.load = 0;
+    Run(&plant,START_CYCLES);
+    printf("load step: %u detections, speed %.0f\n",
+           axisA.stallParm.detectionCount - detections,plant.speed);
+    CHECK(axisA.stallParm.detectionCount == detections,
+          "load step: %u detections",
+          axisA.stallParm.detectionCount - detections);
+    CHECK(axisA.uGF.bits.RunMotor && (axisA.uGF.bits.OpenLoop == 0),
+          "load step: motor stopped or restarted");
+}
+
+/* A short locked rotor is recovered, then the restarts are forgotten */
+static void StablePeriod(void)
+{
+    PLANT_T plant;
+    uint16_t detections;
+    uint32_t k;
+
+    Start(&plant);
+    detections = axisA.stallParm.detectionCount;
+
+    plant.speedHold = 1;
+    plant.speed = 0;
+    for (k = 0; (k < START_CYCLES) && 
+                (axisA.stallParm.detectionCount == detections); k++)
+    {
+        Run(&plant,1);
+    }
+    plant.speedHold = 0;
+    CHECK(axisA.stallParm.restartCount == 1,"stable period: %u restarts",
+          axisA.stallParm.restartCount);
+
+    Run(&plant,2 * START_CYCLES + STALL_STABLE_TIME);
+    printf("stable period: speed %.0f, %u restarts\n",plant.speed,
+           axisA.stallParm.restartCount);
+    CHECK(axisA.uGF.bits.RunMotor && (axisA.uGF.bits.OpenLoop == 0),
+          "stable period: motor not recovered");
+    CHECK(axisA.stallParm.restartCount == 0,"stable period: %u restarts",
+          axisA.stallParm.restartCount);
+}
+
+int main(void)
+{
+    axisA.ctrlParm.currentSensing = CURRENT_SENSING_DUAL_SHUNT;
+    axisA.ctrlParm.currentSensingRequest = CURRENT_SENSING_DUAL_SHUNT;
+    PWMCalculateTiming(PWMFREQUENCY_HZ);
+    axisA.ctrlParm.pwmFrequencyRequest = pwmTiming.frequency;
+    MCAPP_MeasureFilterInit(&axisA.measureInputs);
+#ifdef POWER_METERING
+    MeterInitialize(&axisA.meter);
+#endif
+#ifdef FAULT_SNAPSHOT
+    SnapshotInitialize(&axisA.snapshot);
+#endif
+
+    LockedRotor();
+    LoadStep();
+    StablePeriod();
+
+    return CHECK_RESULT("test_stall");
+}
@@ -78,9 +78,161 @@ constant slope. The slope is determined by TUNING_DELAY_RAMPUP constant.
 /* Definition for torque mode - for a separate tuning of the current PI
 controllers, tuning mode will disable the speed PI controller */
 #undef TORQUE_MODE
-/* FOC with single shunt is enabled */
-/* undef to work with dual Shunt  */    
+/* Current controller decoupling - in closed loop the cross coupling speed 
+   voltages -omega*Ls*Iq (d axis) and omega*Ls*Id (q axis) are calculated 
+   from estimator.qVelEstim and motorParm.qLsDt and fed forward to the 
+   current PI outputs. undef for independent d and q current controllers */
+#undef CURRENT_DECOUPLING
+/* BEMF and resistive voltage feed forward - in closed loop the BEMF 
+   (from estimator.qVelEstim and motorParm.qInvKFi) and Rs*I (from the 
+   current references and motorParm.qRs) are added to the current PI 
+   outputs before the voltage limit, the PIs only correct the error.
+   undef to have the voltages from the current PI outputs only */
+#undef BEMF_FEED_FORWARD
+/* Overmodulation - the voltage vector is allowed beyond the circle 
+   inscribed in the SVM hexagon. Region I limits the phase references to 
+   the hexagon, region II moves to six step. The d-q voltage limiter uses 
+   OVM_MAX_VOLTAGE_VECTOR (overmod.h) instead of MAX_VOLTAGE_VECTOR.
+   undef to stay in the linear modulation range */
+#undef OVERMODULATION
+/* With overmodulation the d-q and alpha-beta voltages (current controller
+   outputs, feed forward, estimator input) are carried at half scale, 
+   Q15(0.5) is the inscribed circle, so the voltage commands can reach the 
+   six step amplitude OVM_SIXSTEP */
+#ifdef OVERMODULATION
+    #define VOLTAGE_SCALE_SHIFT         1
+#else
+    #define VOLTAGE_SCALE_SHIFT         0
+#endif
+/* Deadbeat current control - in closed loop the d and q current PIs are 
+   replaced by a one step predictive controller (deadbeat.c) using 
+   motorParm.qRs, motorParm.qLsDt and the estimated BEMF, with compensation
+   of the one cycle delay of the PWM update. The decoupling and BEMF feed
+   forward are part of the controller, CURRENT_DECOUPLING and 
+   BEMF_FEED_FORWARD are not used with it. 
+   undef to use the current PI controllers */
+#undef DEADBEAT_CURRENT_CONTROL
+/* Inertia and friction identification - in closed loop, setting 
+   axisA.mechIdParm.request (mechid.h) starts a torque step sequence that measures
+   the rotor and load inertia and the friction, then the speed controller 
+   gains are calculated for SPEEDCNTR_BANDWIDTH_HZ.
+   undef to remove the identification */
+#undef MECHANICAL_IDENTIFICATION
+/* Jerk limited (S-curve) speed profile - the speed reference follows the
+   target speed with the acceleration and jerk limits SPEED_PROFILE_ACCEL 
+   and SPEED_PROFILE_JERK, and the acceleration times the inertia is fed 
+   forward to the q current reference. undef for the constant ramp 
+   SPEEDREFRAMP */
+#undef SPEED_PROFILE_SCURVE
+/* Torque ripple and cogging compensation - below COGGING_SPEED_MAX the 
+   speed ripple is learned against the electrical angle into a table 
+   (cogging.c) and the learned correction is added to the q current 
+   reference. undef to remove the compensation */
+#undef COGGING_COMPENSATION
+/* Discontinuous PWM - above the modulation index DPWM_MODULATION_ON one 
+   phase is clamped to a DC rail in each 60 or 120 degree interval (dpwm.c),
+   the switching losses are reduced by about one third. The mode is selected
+   with axisA.dpwmParm.mode (dpwm.h), DPWM_MODE_DEFAULT at power up. With 
+   single shunt the clamp is applied when both measurement windows are 
+   longer than SSTCRIT. With dual shunt phases a and b are clamped only to
+   the negative rail, as their currents are sampled in the low side 
+   shunts. undef for continuous SVM */
+#undef DISCONTINUOUS_PWM
+/* Double update - with dual shunt the current controllers are executed at 
+   the PWM valley (measured currents) and again at the PWM peak (currents 
+   predicted over half a cycle), and the duty cycles are updated for each 
+   half cycle, halving the control delay. The peak step is disabled if a 
+   control step does not complete within its half cycle 
+   DOUBLE_UPDATE_OVERRUN_LIMIT times. Single shunt samples in both half 
+   cycles and keeps one update per cycle, DEADBEAT_CURRENT_CONTROL keeps 
+   one update per cycle too. undef for one update per cycle */
+#undef DOUBLE_UPDATE
+/* FOC with single shunt is enabled at power up */
+/* undef to start with dual Shunt. Both current sensing modes are compiled in,
+   the mode can be changed at run time through 
+   axisA.ctrlParm.currentSensingRequest and is applied while the motor is 
+   stopped */    
 #define SINGLE_SHUNT 
+/* Current sensing modes */
+#define CURRENT_SENSING_DUAL_SHUNT      0
+#define CURRENT_SENSING_SINGLE_SHUNT    1
+#ifdef SINGLE_SHUNT
+    #define CURRENT_SENSING_DEFAULT     CURRENT_SENSING_SINGLE_SHUNT
+#else
+    #define CURRENT_SENSING_DEFAULT     CURRENT_SENSING_DUAL_SHUNT
+#endif
+/* Single shunt bus current oversampling - the bus current is converted twice
+   inside each active vector window (AN1 triggered by PWM1, AN7 triggered by
+   PWM2, both connected to the bus current amplifier output) and the two
+   conversions are averaged, which halves the noise variance of the bus 
+   current. The critical window SSTCRITINSEC and the pattern distortion are
+   unchanged. undef to take one sample per window */
+#undef SINGLE_SHUNT_OVERSAMPLING
+/* Single shunt current prediction - when only one of the two measurement
+   windows is shorter than the critical time, the pattern is not distorted.
+   The missing phase current is predicted from the previous currents, the 
+   applied voltage and the motor model, and fused with the valid sample.
+   undef to always distort the pattern to SSTCRIT */
+#undef SINGLE_SHUNT_CURRENT_PREDICTION
+/* Bus current offset tracking - with single shunt current sensing the bus 
+   current is also converted at the PWM valley (AN7), where the zero vector
+   is applied and the bus current is zero. While the motor runs the bus 
+   current offset follows the drift of this sample through a rate limited 
+   filter (measure.c). Not available with SINGLE_SHUNT_OVERSAMPLING, which 
+   uses AN7 in the measurement windows. undef to keep the offset measured 
+   at standstill */
+#undef CURRENT_OFFSET_TRACKING
+#ifdef SINGLE_SHUNT_OVERSAMPLING
+    #undef CURRENT_OFFSET_TRACKING
+#endif
+/* DC bus voltage compensation - the voltage commands are normalized to 
+   DC_BUS_NOMINAL_VOLTS and the modulation is scaled by the nominal over the
+   measured DC bus voltage (dcbus.c), the current loop gain does not change 
+   with the supply. The voltage limit of the current controllers follows 
+   the measured voltage. undef to modulate with the nominal DC bus voltage */
+#undef DC_BUS_COMPENSATION
+/* MOSFET temperature derating - the power stage temperature sensor (RA3/AN3, 
+   10mV/degC with 500mV at 0degC) is converted with the potentiometer and 
+   filtered (measure.c). Above MOSFET_TEMP_DERATE_START the q current limit
+   of the speed controller is reduced linearly from SPEEDCNTR_OUTMAX to 
+   MOSFET_TEMP_DERATE_CURRENT at MOSFET_TEMP_DERATE_END. undef to keep the 
+   q current limit at SPEEDCNTR_OUTMAX */
+#undef MOSFET_TEMPERATURE_DERATING
+/* I2t protection - thermal models of the motor winding and the inverter 
+   are driven by the squared current (i2t.c). The q current limit is 
+   SPEEDCNTR_OUTMAX while the models are cool, and is reduced towards the 
+   rated current as a model approaches its thermal limit, so short boost 
+   currents are allowed and the steady state current is the rated current.
+   undef to remove the protection */
+#undef I2T_PROTECTION
+/* Stall detection - in closed loop the consistency of the estimator is 
+   checked every cycle: the d BEMF, the BEMF speed against the filtered 
+   speed and the q current against the speed (stall.c). When the rotor is 
+   lost the torque is removed for STALL_CATCH_TIME, then closed loop is 
+   resumed at the estimated speed (catch spin) or the motor is restarted 
+   from open loop. After STALL_RESTART_MAX restarts the motor is stopped,
+   the restarts are forgotten after STALL_STABLE_TIME in closed loop 
+   without detection. undef to remove the detection */
+#undef STALL_DETECTION
+/* Power and energy metering - the electrical, shaft and DC input power are
+   averaged over 2^METER_DECIMATION_BITS cycles and integrated to energy 
+   counters (meter.c), read through X2CScope as axisA.meter. undef to 
+   remove the metering */
+#undef POWER_METERING
+/* Fault snapshot - the currents, voltages, angle, speed, DC bus voltage 
+   and single shunt bus currents of the last SNAPSHOT_LENGTH control cycles
+   are recorded in a ring buffer (snapshot.c). A PWM fault, gate driver 
+   fault or stall stop freezes the buffer with the fault source, read 
+   through X2CScope as axisA.snapshot. undef to remove the recording */
+#undef FAULT_SNAPSHOT
+/* Fault log - the PWM fault, gate driver fault (with the gate driver 
+   status) and stall stop events, the run time, the number of starts and 
+   the peak MOSFET temperature are logged in two pages of program flash 
+   (flashlog.c). The records are written in sequence through the pages to
+   spread the wear, by the main loop while the motor is stopped. The 
+   statistics are restored at power up, read through X2CScope as 
+   axisA.flashLog. undef to remove the log */
+#undef FLASH_FAULT_LOG
 
 #define INTERNAL_OPAMP_CONFIG    
 
@@ -195,11 +347,122 @@ minimum value accepted */
 #define Q_CURRCNTR_CTERM       Q15(0.999)
 #define Q_CURRCNTR_OUTMAX      0x7FFF
 
+/* Current Control Loop Gain Calculation 
+   The d and q current PI gains are calculated from motorParm.qRs and 
+   motorParm.qLsDtBase for the bandwidth CURRCNTR_BANDWIDTH_HZ, replacing the
+   PTERM and ITERM values above. undef to use the PTERM and ITERM values */
+#undef CURRCNTR_GAIN_CALCULATION
+/* Current loop bandwidth in Hz, below 1/(2*pi*LOOPTIME_SEC) */
+#define CURRCNTR_BANDWIDTH_HZ  400.0
+
 /* Velocity Control Loop Coefficients */
 #define SPEEDCNTR_PTERM        Q15(0.05)
 #define SPEEDCNTR_ITERM        Q15(0.001)
 #define SPEEDCNTR_CTERM        Q15(0.999)
 #define SPEEDCNTR_OUTMAX       0x5000
+
+/* I2t Protection (I2T_PROTECTION) */
+/* Continuous current (peak) and thermal time constant in s of the motor 
+   winding and of the inverter */
+#define I2T_MOTOR_RATED_CURRENT     NORM_CURRENT(3.0)
+#define I2T_MOTOR_TIME_CONSTANT     30.0
+#define I2T_INVERTER_RATED_CURRENT  NORM_CURRENT(8.0)
+#define I2T_INVERTER_TIME_CONSTANT  2.0
+/* Fraction of the thermal limit where the current limit starts to 
+   decrease */
+#define I2T_LOAD_START              0.8
+
+/* Stall Detection (STALL_DETECTION) */
+/* Below STALL_SPEED_MIN (electrical RPM) the q current has to be below 
+   STALL_CURRENT_MIN, above it the d BEMF has to be below STALL_BEMF_RATIO 
+   of the q BEMF */
+#define STALL_SPEED_MIN        (ENDSPEED_ELECTR/2)
+#define STALL_CURRENT_MIN      NORM_CURRENT(1.0)
+#define STALL_BEMF_RATIO       Q15(0.5)
+/* Maximum difference of the BEMF speed and the estimated speed, 
+   electrical RPM */
+#define STALL_SPEED_ERROR      (ENDSPEED_ELECTR)
+/* Detection, blanking after entering closed loop and catch spin times in 
+   control cycles at the default loop time (20000 is 1s) */
+#define STALL_DETECT_TIME      1000
+#define STALL_BLANKING_TIME    10000
+#define STALL_CATCH_TIME       2000
+/* Restarts before the motor is stopped */
+#define STALL_RESTART_MAX      3
+/* Monitoring time after the blanking without detection that clears the 
+   restart counter, control cycles at the default loop time (up to 65535 
+   at the highest PWM frequency) */
+#define STALL_STABLE_TIME      20000
+
+/* MOSFET Temperature Derating (MOSFET_TEMPERATURE_DERATING) */
+/* Temperatures in degC where the derating starts and ends */
+#define MOSFET_TEMP_DERATE_START    85
+#define MOSFET_TEMP_DERATE_END      115
+/* q current limit at and above MOSFET_TEMP_DERATE_END */
+#define MOSFET_TEMP_DERATE_CURRENT  NORM_CURRENT(4.0)
+
+/* Mechanical Identification (MECHANICAL_IDENTIFICATION) */
+/* Torque current of the acceleration and deceleration steps */
+#define MECHID_CURRENT         NORM_CURRENT(0.5)
+/* Speed band of the measurement, electrical RPM */
+#define MECHID_SPEED_LOW       (1000*NOPOLESPAIRS)
+#define MECHID_SPEED_HIGH      (1800*NOPOLESPAIRS)
+/* Maximum duration of one step in loop cycles at the default PWM 
+   frequency (3 s), scaled to the actual PWM frequency */
+#define MECHID_TIMEOUT         60000
+/* Speed loop bandwidth used for the identified gains, Hz */
+#define SPEEDCNTR_BANDWIDTH_HZ 10.0
+
+/* S-curve Speed Profile (SPEED_PROFILE_SCURVE) */
+/* Acceleration limit, electrical RPM per second */
+#define SPEED_PROFILE_ACCEL    (5000.0*NOPOLESPAIRS)
+/* Jerk limit, electrical RPM per second^2 - full acceleration in 0.1 s */
+#define SPEED_PROFILE_JERK     (50000.0*NOPOLESPAIRS)
+/* Inertia for the acceleration feed forward - q current for a speed change
+   of 1 electrical RPM per loop cycle, 0 disables the feed forward. 
+   Replaced by the identified value with MECHANICAL_IDENTIFICATION */
+#define SPEED_PROFILE_INERTIA  0
+
+/* Cogging Compensation (COGGING_COMPENSATION) */
+/* Compensation and learning active below this speed, electrical RPM */
+#define COGGING_SPEED_MAX      (500*NOPOLESPAIRS)
+/* Learning executed every COGGING_LEARN_DIVIDER loop cycles at LOOPTIME_SEC,
+   the interval is kept constant in time at other PWM frequencies */
+#define COGGING_LEARN_DIVIDER  2
+/* Learning gain - q current added per electrical RPM of speed change over
+   the learning interval, a fraction of inertia*COGGING_LEARN_DIVIDER */
+#define COGGING_LEARN_GAIN     2
+/* Mean filter of the speed change */
+#define COGGING_MEAN_FILTER    Q15(0.002)
+/* Limit of the learned correction */
+#define COGGING_TABLE_LIMIT    NORM_CURRENT(1.0)
+
+/* Discontinuous PWM (DISCONTINUOUS_PWM) */
+/* Mode at power up - DPWM2 follows the lagging current of the motor, 
+   DPWMMAX keeps the high side on for 120 degrees and needs bootstrap 
+   capacitors sized for it */
+#define DPWM_MODE_DEFAULT      DPWM_MODE_DPWM2
+/* Modulation index (voltage vector amplitude relative to the linear 
+   modulation limit) to enable and disable the discontinuous modes */
+#define DPWM_MODULATION_ON     0.6
+#define DPWM_MODULATION_OFF    0.5
+
+/* DC Bus Voltage Compensation (DC_BUS_COMPENSATION) */
+/* DC bus voltage at the ADC full scale, given by the DC bus voltage 
+   divider of the board */
+#define DC_BUS_FULL_SCALE_VOLTS 36.3
+/* DC bus voltage the voltage commands are normalized to */
+#define DC_BUS_NOMINAL_VOLTS   24.0
+
+/* Double Update (DOUBLE_UPDATE) */
+/* Half cycle overruns tolerated before the peak step is disabled */
+#define DOUBLE_UPDATE_OVERRUN_LIMIT 4
+
+/* Deadbeat Current Control Coefficients */
+/* Fraction of the predicted current error corrected in one cycle */
+#define DEADBEAT_GAIN          Q15(0.8)
+/* Integral gain of the steady state error correction */
+#define DEADBEAT_KI            Q15(0.2)
 /******************************** Field Weakening *****************************/
 /* Field Weakening constant for constant torque range 
    Flux reference value */